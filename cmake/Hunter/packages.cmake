@@ -25,3 +25,4 @@ hunter_add_package(intx)
 hunter_add_package(Microsoft.GSL)
 hunter_add_package(nlohmann_json)
 hunter_add_package(Protobuf)
+hunter_add_package(ZLIB)
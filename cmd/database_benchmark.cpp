@@ -0,0 +1,164 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <silkrpc/config.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <asio/co_spawn.hpp>
+#include <asio/thread_pool.hpp>
+#include <grpcpp/grpcpp.h>
+#include <silkworm/common/util.hpp>
+
+#include <silkrpc/context_pool.hpp>
+#include <silkrpc/common/constants.hpp>
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/ethdb/local/local_database.hpp>
+
+ABSL_FLAG(std::string, chaindata, silkrpc::common::kEmptyChainData, "chain data path as string");
+ABSL_FLAG(std::string, target, silkrpc::common::kDefaultTarget, "server location as string <address>:<port>");
+ABSL_FLAG(std::string, table, "", "database table name");
+ABSL_FLAG(std::string, seekkey, "", "seek key as hex string w/o leading 0x");
+ABSL_FLAG(uint32_t, rows, 10, "number of rows read with next after each seek");
+ABSL_FLAG(uint32_t, iterations, 1000, "number of transactions run for each database");
+ABSL_FLAG(uint32_t, numWorkers, std::thread::hardware_concurrency(), "number of worker threads as 32-bit integer");
+ABSL_FLAG(silkrpc::LogLevel, logLevel, silkrpc::LogLevel::Critical, "logging level");
+
+using silkrpc::LogLevel;
+
+asio::awaitable<std::size_t> read_rows(silkrpc::ethdb::Database& database, const std::string& table_name, const silkworm::Bytes& seek_key,
+    uint32_t rows, uint32_t iterations) {
+    std::size_t bytes{0};
+    for (uint32_t i{0}; i < iterations; ++i) {
+        const auto transaction = co_await database.begin();
+        const auto cursor = co_await transaction->cursor(table_name);
+        auto kv_pair = co_await cursor->seek(seek_key);
+        bytes += kv_pair.key.size() + kv_pair.value.size();
+        for (uint32_t j{0}; j < rows && !kv_pair.key.empty(); ++j) {
+            kv_pair = co_await cursor->next();
+            bytes += kv_pair.key.size() + kv_pair.value.size();
+        }
+        co_await transaction->close();
+    }
+    co_return bytes;
+}
+
+void run(const std::string& scenario, silkrpc::ContextPool& context_pool, const std::string& table_name, const silkworm::Bytes& seek_key,
+    uint32_t rows, uint32_t iterations) {
+    auto& context = context_pool.get_context();
+    std::size_t bytes{0};
+    const auto start = std::chrono::steady_clock::now();
+    asio::co_spawn(*context.io_context, read_rows(*context.database, table_name, seek_key, rows, iterations), [&](std::exception_ptr eptr, std::size_t result) {
+        if (eptr) {
+            try {
+                std::rethrow_exception(eptr);
+            } catch (const std::exception& e) {
+                std::cerr << scenario << " failed: " << e.what() << "\n" << std::flush;
+            }
+        }
+        bytes = result;
+        context_pool.stop();
+    });
+    context_pool.run();
+    const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << scenario << " transactions: " << iterations << " bytes: " << bytes << " latency: " << elapsed / iterations << " usec/tx\n";
+}
+
+int main(int argc, char* argv[]) {
+    absl::SetProgramUsageMessage("Compare the local chain data access against the remote KV interface of Erigon");
+    absl::ParseCommandLine(argc, argv);
+
+    SILKRPC_LOG_VERBOSITY(absl::GetFlag(FLAGS_logLevel));
+
+    try {
+        auto chaindata{absl::GetFlag(FLAGS_chaindata)};
+        if (chaindata.empty() || !std::filesystem::exists(chaindata)) {
+            std::cerr << "Parameter chaindata is invalid: [" << chaindata << "]\n";
+            std::cerr << "Use --chaindata flag to specify the path of Erigon database\n";
+            return -1;
+        }
+
+        auto target{absl::GetFlag(FLAGS_target)};
+        if (target.empty() || target.find(":") == std::string::npos) {
+            std::cerr << "Parameter target is invalid: [" << target << "]\n";
+            std::cerr << "Use --target flag to specify the location of Erigon running instance\n";
+            return -1;
+        }
+
+        auto table_name{absl::GetFlag(FLAGS_table)};
+        if (table_name.empty()) {
+            std::cerr << "Parameter table is invalid: [" << table_name << "]\n";
+            std::cerr << "Use --table flag to specify the name of Erigon database table\n";
+            return -1;
+        }
+
+        auto seek_key{absl::GetFlag(FLAGS_seekkey)};
+        const auto seek_key_bytes_optional = silkworm::from_hex(seek_key);
+        if (!seek_key_bytes_optional.has_value()) {
+            std::cerr << "Parameter seek key is invalid: [" << seek_key << "]\n";
+            std::cerr << "Use --seekkey flag to specify the seek key in Erigon database table\n";
+            return -1;
+        }
+        const auto seek_key_bytes = seek_key_bytes_optional.value();
+
+        const auto iterations{absl::GetFlag(FLAGS_iterations)};
+        if (iterations == 0) {
+            std::cerr << "Parameter iterations is invalid: [" << iterations << "]\n";
+            std::cerr << "Use --iterations flag to specify the number of transactions run for each database\n";
+            return -1;
+        }
+
+        const auto numWorkers{absl::GetFlag(FLAGS_numWorkers)};
+        if (numWorkers == 0) {
+            std::cerr << "Parameter numWorkers is invalid: [" << numWorkers << "]\n";
+            std::cerr << "Use --numWorkers flag to specify the number of worker threads executing the local database reads\n";
+            return -1;
+        }
+
+        const auto rows{absl::GetFlag(FLAGS_rows)};
+
+        // TODO(canepat): handle also secure channel for remote
+        silkrpc::ChannelFactory create_channel = [&]() {
+            return grpc::CreateChannel(target, grpc::InsecureChannelCredentials());
+        };
+
+        silkrpc::ContextPool remote_pool{1, create_channel};
+        run("remote", remote_pool, table_name, seek_key_bytes, rows, iterations);
+
+        auto env = std::make_shared<silkrpc::ethdb::local::Environment>(chaindata);
+        asio::thread_pool workers{numWorkers};
+        silkrpc::DatabaseFactory create_database = [&](asio::io_context& io_context) {
+            return std::make_unique<silkrpc::ethdb::local::LocalDatabase>(io_context, env, workers);
+        };
+        silkrpc::ContextPool local_pool{1, create_channel, {}, create_database};
+        run("local", local_pool, table_name, seek_key_bytes, rows, iterations);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << "\n" << std::flush;
+    } catch (...) {
+        std::cerr << "Unexpected exception\n" << std::flush;
+    }
+
+    return 0;
+}
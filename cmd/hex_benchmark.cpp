@@ -0,0 +1,132 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <silkworm/common/util.hpp>
+
+#include <silkrpc/common/hex.hpp>
+#include <silkrpc/json/types.hpp>
+
+ABSL_FLAG(uint32_t, iterations, 1000000, "number of values converted for each scenario");
+
+// The byte-at-a-time conversion used before the hex kernels, kept here as baseline
+std::string legacy_to_hex_no_leading_zeros(silkworm::ByteView bytes) {
+    static const char* kHexDigits{"0123456789abcdef"};
+
+    std::string out{};
+    out.reserve(2 * bytes.length());
+
+    bool found_nonzero{false};
+    for (size_t i{0}; i < bytes.length(); ++i) {
+        uint8_t x{bytes[i]};
+        char lo{kHexDigits[x & 0x0f]};
+        char hi{kHexDigits[x >> 4]};
+        if (!found_nonzero && hi != '0') {
+            found_nonzero = true;
+        }
+        if (found_nonzero) {
+            out.push_back(hi);
+        }
+        if (!found_nonzero && lo != '0') {
+            found_nonzero = true;
+        }
+        if (found_nonzero || i == bytes.length() - 1) {
+            out.push_back(lo);
+        }
+    }
+
+    return out;
+}
+
+template <typename F>
+double measure(uint32_t iterations, F&& f) {
+    std::size_t sink{0};
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i{0}; i < iterations; ++i) {
+        sink += f();
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 0) {
+        std::cerr << "unexpected empty conversions\n";
+    }
+    return elapsed;
+}
+
+void report(const std::string& scenario, std::size_t size, uint32_t iterations, double legacy, double scalar, double simd) {
+    const auto mb = static_cast<double>(size) * iterations / (1024 * 1024);
+    std::cout << scenario << " legacy: " << mb / legacy << " MB/s scalar: " << mb / scalar << " MB/s "
+        << silkrpc::hex::instruction_set() << ": " << mb / simd << " MB/s speedup: " << legacy / simd << "x\n";
+}
+
+int main(int argc, char* argv[]) {
+    absl::SetProgramUsageMessage("Compare the SIMD hex kernels against the scalar and the byte-at-a-time conversions");
+    absl::ParseCommandLine(argc, argv);
+
+    const auto iterations{absl::GetFlag(FLAGS_iterations)};
+    if (iterations == 0) {
+        std::cerr << "Parameter iterations is invalid: [" << iterations << "]\n";
+        std::cerr << "Use --iterations flag to specify the number of values converted for each scenario\n";
+        return -1;
+    }
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> byte{0, 255};
+    for (const std::size_t size : {20, 32, 256, 4096}) {
+        silkworm::Bytes bytes(size, 0);
+        for (auto& b : bytes) {
+            b = static_cast<uint8_t>(byte(generator));
+        }
+        const auto scaled_iterations = static_cast<uint32_t>(iterations * 32 / size + 1);
+
+        std::string digits(2 * size, '\0');
+        const auto legacy_encode = measure(scaled_iterations, [&]() { return silkworm::to_hex(bytes).size(); });
+        const auto scalar_encode = measure(scaled_iterations, [&]() {
+            silkrpc::hex::scalar::encode(bytes.data(), size, digits.data());
+            return digits.size();
+        });
+        const auto simd_encode = measure(scaled_iterations, [&]() {
+            silkrpc::hex::encode(bytes.data(), size, digits.data());
+            return digits.size();
+        });
+        report("encode " + std::to_string(size) + "B", size, scaled_iterations, legacy_encode, scalar_encode, simd_encode);
+
+        silkworm::Bytes decoded(size, 0);
+        const auto legacy_decode = measure(scaled_iterations, [&]() { return silkworm::from_hex(digits)->size(); });
+        const auto scalar_decode = measure(scaled_iterations, [&]() { return silkrpc::hex::scalar::decode(digits.data(), size, decoded.data()) ? size : 0; });
+        const auto simd_decode = measure(scaled_iterations, [&]() { return silkrpc::hex::decode(digits.data(), size, decoded.data()) ? size : 0; });
+        report("decode " + std::to_string(size) + "B", size, scaled_iterations, legacy_decode, scalar_decode, simd_decode);
+    }
+
+    // Quantities are mostly small numbers in wide words, e.g. 256-bit balances, so the leading zero trim dominates
+    silkworm::Bytes quantity(32, 0);
+    quantity[29] = 0x0d;
+    quantity[30] = 0xe0;
+    quantity[31] = 0xb6;
+    const auto legacy_quantity = measure(iterations, [&]() { return legacy_to_hex_no_leading_zeros(quantity).size(); });
+    const auto simd_quantity = measure(iterations, [&]() { return silkrpc::to_hex_no_leading_zeros(quantity).size(); });
+    std::cout << "quantity 32B legacy: " << legacy_quantity * 1e9 / iterations << " ns " << silkrpc::hex::instruction_set() << ": "
+        << simd_quantity * 1e9 / iterations << " ns speedup: " << legacy_quantity / simd_quantity << "x\n";
+
+    return 0;
+}
@@ -0,0 +1,386 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+
+#include <silkrpc/http/request.hpp>
+#include <silkrpc/http/request_parser.hpp>
+#include <silkrpc/http/scanner.hpp>
+
+ABSL_FLAG(uint32_t, iterations, 10000, "number of requests parsed for each scenario");
+ABSL_FLAG(uint32_t, chunk, 8192, "size in bytes of the read chunks fed to the parser");
+
+// The byte-at-a-time parser used before the vectorized one, kept here as baseline
+class LegacyRequestParser {
+public:
+    enum ResultType { good, bad, indeterminate };
+
+    void reset() { state_ = method_start; }
+
+    std::tuple<ResultType, const char*> parse(silkrpc::http::Request& req, const char* begin, const char* end) {
+        while (begin != end) {
+            ResultType result = consume(req, *begin++);
+            if (result == good || result == bad) {
+                return std::make_tuple(result, begin);
+            }
+        }
+        return std::make_tuple(indeterminate, begin);
+    }
+
+private:
+    ResultType consume(silkrpc::http::Request& req, char input);
+
+    static bool is_char(int c);
+    static bool is_ctl(int c);
+    static bool is_tspecial(int c);
+    static bool is_digit(int c);
+
+    enum State {
+        method_start,
+        method,
+        uri,
+        http_version_h,
+        http_version_t_1,
+        http_version_t_2,
+        http_version_p,
+        http_version_slash,
+        http_version_major_start,
+        http_version_major,
+        http_version_minor_start,
+        http_version_minor,
+        expecting_newline_1,
+        header_line_start,
+        header_lws,
+        header_name,
+        space_before_header_value,
+        header_value,
+        expecting_newline_2,
+        expecting_newline_3,
+        content_start
+    } state_{method_start};
+};
+
+LegacyRequestParser::ResultType LegacyRequestParser::consume(silkrpc::http::Request& req, char input) {
+    switch (state_) {
+        case method_start:
+            if (!is_char(input) || is_ctl(input) || is_tspecial(input)) {
+                return bad;
+            } else {
+                state_ = method;
+                req.method.push_back(input);
+                return indeterminate;
+            }
+        case method:
+            if (input == ' ') {
+                state_ = uri;
+                return indeterminate;
+            } else if (!is_char(input) || is_ctl(input) || is_tspecial(input)) {
+                return bad;
+            } else {
+                req.method.push_back(input);
+                return indeterminate;
+            }
+        case uri:
+            if (input == ' ') {
+                state_ = http_version_h;
+                return indeterminate;
+            } else if (is_ctl(input)) {
+                return bad;
+            } else {
+                req.uri.push_back(input);
+                return indeterminate;
+            }
+        case http_version_h:
+            if (input == 'H') {
+                state_ = http_version_t_1;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case http_version_t_1:
+            if (input == 'T') {
+                state_ = http_version_t_2;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case http_version_t_2:
+            if (input == 'T') {
+                state_ = http_version_p;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case http_version_p:
+            if (input == 'P') {
+                state_ = http_version_slash;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case http_version_slash:
+            if (input == '/') {
+                req.http_version_major = 0;
+                req.http_version_minor = 0;
+                state_ = http_version_major_start;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case http_version_major_start:
+            if (is_digit(input)) {
+                req.http_version_major = req.http_version_major * 10 + input - '0';
+                state_ = http_version_major;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case http_version_major:
+            if (input == '.') {
+                state_ = http_version_minor_start;
+                return indeterminate;
+            } else if (is_digit(input)) {
+                req.http_version_major = req.http_version_major * 10 + input - '0';
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case http_version_minor_start:
+            if (is_digit(input)) {
+                req.http_version_minor = req.http_version_minor * 10 + input - '0';
+                state_ = http_version_minor;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case http_version_minor:
+            if (input == '\r') {
+                state_ = expecting_newline_1;
+                return indeterminate;
+            } else if (is_digit(input)) {
+                req.http_version_minor = req.http_version_minor * 10 + input - '0';
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case expecting_newline_1:
+            if (input == '\n') {
+                state_ = header_line_start;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case header_line_start:
+            if (input == '\r') {
+                state_ = expecting_newline_3;
+                return indeterminate;
+            } else if (!req.headers.empty() && (input == ' ' || input == '\t')) {
+                state_ = header_lws;
+                return indeterminate;
+            } else if (!is_char(input) || is_ctl(input) || is_tspecial(input)) {
+                return bad;
+            } else {
+                req.headers.push_back(silkrpc::http::Header());
+                req.headers.back().name.push_back(input);
+                state_ = header_name;
+                return indeterminate;
+            }
+        case header_lws:
+            if (input == '\r') {
+                state_ = expecting_newline_2;
+                return indeterminate;
+            } else if (input == ' ' || input == '\t') {
+                return indeterminate;
+            } else if (is_ctl(input)) {
+                return bad;
+            } else {
+                state_ = header_value;
+                req.headers.back().value.push_back(input);
+                return indeterminate;
+            }
+        case header_name:
+            if (input == ':') {
+                state_ = space_before_header_value;
+                return indeterminate;
+            } else if (!is_char(input) || is_ctl(input) || is_tspecial(input)) {
+                return bad;
+            } else {
+                req.headers.back().name.push_back(input);
+                return indeterminate;
+            }
+        case space_before_header_value:
+            if (input == ' ') {
+                state_ = header_value;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case header_value:
+            if (input == '\r') {
+                state_ = expecting_newline_2;
+                return indeterminate;
+            } else if (is_ctl(input)) {
+                return bad;
+            } else {
+                req.headers.back().value.push_back(input);
+                return indeterminate;
+            }
+        case expecting_newline_2:
+            if (input == '\n') {
+                state_ = header_line_start;
+                return indeterminate;
+            } else {
+                return bad;
+            }
+        case expecting_newline_3:
+            if (input == '\n') {
+                state_ = content_start;
+                if (req.content_length == 0) {
+                    const auto it = std::find_if(req.headers.begin(), req.headers.end(), [&](const silkrpc::http::Header& h){
+                        return h.name == "Content-Length";
+                    });
+                    if (it == req.headers.end()) {
+                        return bad;
+                    }
+                    req.content_length = std::atoi((*it).value.c_str());
+                }
+                return req.content_length == 0 ? good : indeterminate;
+            } else {
+                return bad;
+            }
+        case content_start:
+            req.content.push_back(input);
+            if (req.content.length() < req.content_length) {
+                return indeterminate;
+            } else {
+                return good;
+            }
+        default:
+            return bad;
+    }
+}
+
+bool LegacyRequestParser::is_char(int c) {
+    return c >= 0 && c <= 127;
+}
+
+bool LegacyRequestParser::is_ctl(int c) {
+    return (c >= 0 && c <= 31) || (c == 127);
+}
+
+bool LegacyRequestParser::is_tspecial(int c) {
+    switch (c) {
+        case '(': case ')': case '<': case '>': case '@':
+        case ',': case ';': case ':': case '\\': case '"':
+        case '/': case '[': case ']': case '?': case '=':
+        case '{': case '}': case ' ': case '\t':
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool LegacyRequestParser::is_digit(int c) {
+    return c >= '0' && c <= '9';
+}
+
+template <typename Parser>
+double run(const std::string& scenario, const std::string& data, uint32_t iterations, std::size_t chunk) {
+    Parser parser;
+    silkrpc::http::Request request;
+    std::size_t parsed{0};
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i{0}; i < iterations; ++i) {
+        request.reset();
+        parser.reset();
+        const char* begin = data.data();
+        const char* const end = data.data() + data.size();
+        while (begin != end) {
+            const char* chunk_end = begin + std::min(chunk, static_cast<std::size_t>(end - begin));
+            const auto [result, consumed] = parser.parse(request, begin, chunk_end);
+            begin = consumed;
+            if (result == Parser::good) {
+                ++parsed;
+                break;
+            }
+            if (result == Parser::bad) {
+                std::cerr << scenario << ": bad request\n";
+                std::exit(-1);
+            }
+        }
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (parsed != iterations) {
+        std::cerr << scenario << ": incomplete requests " << iterations - parsed << "\n";
+        std::exit(-1);
+    }
+    return elapsed;
+}
+
+std::string make_request(std::size_t content_size) {
+    std::string content{R"([{"jsonrpc":"2.0","id":0,"method":"eth_getBlockByNumber","params":["0x1",true]})"};
+    while (content.size() + 80 < content_size) {
+        content += R"(,{"jsonrpc":"2.0","id":1,"method":"eth_getBlockByNumber","params":["0x1",true]})";
+    }
+    content += "]";
+    return "POST / HTTP/1.1\r\n"
+        "Host: localhost:51515\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/90.0 Safari/537.36\r\n"
+        "Accept: application/json\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: " + std::to_string(content.size()) + "\r\n"
+        "\r\n" + content;
+}
+
+int main(int argc, char* argv[]) {
+    absl::SetProgramUsageMessage("Compare the vectorized HTTP request parser against the byte-at-a-time one");
+    absl::ParseCommandLine(argc, argv);
+
+    const auto iterations{absl::GetFlag(FLAGS_iterations)};
+    if (iterations == 0) {
+        std::cerr << "Parameter iterations is invalid: [" << iterations << "]\n";
+        std::cerr << "Use --iterations flag to specify the number of requests parsed for each scenario\n";
+        return -1;
+    }
+    const auto chunk{absl::GetFlag(FLAGS_chunk)};
+    if (chunk == 0) {
+        std::cerr << "Parameter chunk is invalid: [" << chunk << "]\n";
+        std::cerr << "Use --chunk flag to specify the size in bytes of the read chunks\n";
+        return -1;
+    }
+
+    std::cout << "instruction set: " << silkrpc::http::scanner::instruction_set() << "\n";
+    for (const std::size_t content_size : {100, 1024, 100 * 1024}) {
+        const auto data = make_request(content_size);
+        const auto scenario = "content " + std::to_string(content_size) + "B";
+        const auto legacy = run<LegacyRequestParser>(scenario, data, iterations, chunk);
+        const auto vectorized = run<silkrpc::http::RequestParser>(scenario, data, iterations, chunk);
+        const auto mb = static_cast<double>(data.size()) * iterations / (1024 * 1024);
+        std::cout << scenario << " legacy: " << mb / legacy << " MB/s vectorized: " << mb / vectorized << " MB/s speedup: " << legacy / vectorized << "x\n";
+    }
+
+    return 0;
+}
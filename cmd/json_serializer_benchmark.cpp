@@ -0,0 +1,130 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <evmc/evmc.hpp>
+#include <intx/intx.hpp>
+#include <nlohmann/json.hpp>
+
+#include <silkrpc/json/serializer.hpp>
+#include <silkrpc/json/types.hpp>
+
+ABSL_FLAG(uint32_t, iterations, 100, "number of replies serialized for each scenario");
+ABSL_FLAG(uint32_t, items, 1000, "number of logs or transactions in each reply");
+
+using evmc::literals::operator""_address, evmc::literals::operator""_bytes32;
+
+silkrpc::Logs make_logs(uint32_t items) {
+    silkrpc::Logs logs;
+    logs.reserve(items);
+    for (uint32_t i{0}; i < items; ++i) {
+        silkrpc::Log log{
+            0x0715a7794a1dc8e42615f059dd6e406a6594651a_address,
+            {0xddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef_bytes32, 0x000000000000000000000000a0b86991c6218b36c1d19d4a2e9eb0ce3606eb48_bytes32},
+            silkworm::Bytes(64, static_cast<uint8_t>(i)),
+            12000000 + i / 100,
+            0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32,
+            i % 100,
+            0xb02a3b0ee16c858afaa34bcd6770b3c20ee56aa2f75858733eb0e927b5b7126f_bytes32,
+            i,
+            false
+        };
+        logs.push_back(std::move(log));
+    }
+    return logs;
+}
+
+silkrpc::Block make_block(uint32_t items) {
+    silkrpc::Block block{};
+    block.hash = 0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32;
+    block.block.header.number = 12000000;
+    block.block.header.gas_limit = 15000000;
+    block.block.header.difficulty = intx::uint256{7000000000000000};
+    block.total_difficulty = intx::uint256{7000000000000000} * 12000000;
+    block.full_tx = true;
+    block.block.transactions.reserve(items);
+    for (uint32_t i{0}; i < items; ++i) {
+        silkworm::Transaction transaction{};
+        transaction.nonce = i;
+        transaction.gas_price = intx::uint256{20000000000};
+        transaction.gas_limit = 21000;
+        transaction.to = 0x0715a7794a1dc8e42615f059dd6e406a6594651a_address;
+        transaction.value = intx::uint256{1000000000000000000};
+        transaction.data = silkworm::Bytes(68, static_cast<uint8_t>(i));
+        transaction.from = 0x22ea9f6b28db76a7162054c05ed812deb2f519cd_address;
+        transaction.r = intx::uint256{i + 1};
+        transaction.s = intx::uint256{i + 2};
+        block.block.transactions.push_back(std::move(transaction));
+    }
+    return block;
+}
+
+template <typename T>
+void run(const std::string& scenario, const T& value, uint32_t iterations) {
+    std::size_t size{0};
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i{0}; i < iterations; ++i) {
+        size += nlohmann::json(value).dump().size();
+    }
+    const auto dom = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::string out;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i{0}; i < iterations; ++i) {
+        out.clear();
+        silkrpc::json::serialize(out, value);
+        size -= out.size();
+    }
+    const auto direct = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (size != 0) {
+        std::cerr << scenario << ": serialized sizes differ\n";
+        std::exit(-1);
+    }
+
+    const auto mb = static_cast<double>(out.size()) * iterations / (1024 * 1024);
+    std::cout << scenario << " dom: " << mb / dom << " MB/s direct: " << mb / direct << " MB/s speedup: " << dom / direct << "x\n";
+}
+
+int main(int argc, char* argv[]) {
+    absl::SetProgramUsageMessage("Compare the direct JSON serializers against the nlohmann::json DOM serialization");
+    absl::ParseCommandLine(argc, argv);
+
+    const auto iterations{absl::GetFlag(FLAGS_iterations)};
+    if (iterations == 0) {
+        std::cerr << "Parameter iterations is invalid: [" << iterations << "]\n";
+        std::cerr << "Use --iterations flag to specify the number of replies serialized for each scenario\n";
+        return -1;
+    }
+    const auto items{absl::GetFlag(FLAGS_items)};
+    if (items == 0) {
+        std::cerr << "Parameter items is invalid: [" << items << "]\n";
+        std::cerr << "Use --items flag to specify the number of logs or transactions in each reply\n";
+        return -1;
+    }
+
+    run(std::to_string(items) + " logs", make_logs(items), iterations);
+    run("block with " + std::to_string(items) + " full transactions", make_block(items), iterations);
+
+    return 0;
+}
@@ -20,6 +20,7 @@
 #include <cstring>
 #include <exception>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
 #include <evmc/evmc.hpp>
@@ -38,6 +39,7 @@
 #include <silkrpc/ethdb/bitmap.hpp>
 #include <silkrpc/ethdb/tables.hpp>
 #include <silkrpc/ethdb/transaction_database.hpp>
+#include <silkrpc/json/serializer.hpp>
 #include <silkrpc/json/types.hpp>
 #include <silkrpc/types/block.hpp>
 #include <silkrpc/types/call.hpp>
@@ -152,7 +154,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_gas_price(const nlohmann::json&
 
 // https://eth.wiki/json-rpc/API#eth_getblockbyhash
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_by_hash(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid eth_getBlockByHash params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -189,9 +191,55 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_by_hash(const nlohman
     co_return;
 }
 
+// https://eth.wiki/json-rpc/API#eth_getblockbyhash
+asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_by_hash_stream(const nlohmann::json& request, StreamWriter& writer) {
+    const auto& params = request["params"];
+    if (params.size() != 2) {
+        auto error_msg = "invalid eth_getBlockByHash params: " + params.dump();
+        SILKRPC_ERROR << error_msg << "\n";
+        co_await writer.write(make_json_error(request["id"], 100, error_msg).dump() + "\n");
+        co_return;
+    }
+    auto block_hash = params[0].get<evmc::bytes32>();
+    auto full_tx = params[1].get<bool>();
+    SILKRPC_DEBUG << "block_hash: " << block_hash << " full_tx: " << std::boolalpha << full_tx << "\n";
+
+    const uint32_t request_id = request["id"];
+    std::string content;
+
+    auto tx = co_await database_->begin();
+
+    try {
+        ethdb::TransactionDatabase tx_database{*tx};
+
+        const auto block_with_hash = co_await core::rawdb::read_block_by_hash(tx_database, block_hash);
+        const auto block_number = block_with_hash.block.header.number;
+        const auto total_difficulty = co_await core::rawdb::read_total_difficulty(tx_database, block_hash, block_number);
+        const Block extended_block{block_with_hash, total_difficulty, full_tx};
+
+        // The full block is written straight into the content, without building its DOM
+        json::serialize_content(content, request_id, extended_block);
+        content.push_back('\n');
+    } catch (const std::invalid_argument& iv) {
+        SILKRPC_DEBUG << "invalid_argument: " << iv.what() << " processing request: " << request.dump() << "\n";
+        content = make_json_content(request_id, {}).dump() + "\n";
+    } catch (const std::exception& e) {
+        SILKRPC_ERROR << "exception: " << e.what() << " processing request: " << request.dump() << "\n";
+        content = make_json_error(request_id, 100, e.what()).dump() + "\n";
+    } catch (...) {
+        SILKRPC_ERROR << "unexpected exception processing request: " << request.dump() << "\n";
+        content = make_json_error(request_id, 100, "unexpected exception").dump() + "\n";
+    }
+
+    co_await writer.write(content);
+
+    co_await tx->close(); // RAII not (yet) available with coroutines
+    co_return;
+}
+
 // https://eth.wiki/json-rpc/API#eth_getblockbynumber
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_by_number(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid getBlockByNumber params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -228,9 +276,55 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_by_number(const nlohm
     co_return;
 }
 
+// https://eth.wiki/json-rpc/API#eth_getblockbynumber
+asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_by_number_stream(const nlohmann::json& request, StreamWriter& writer) {
+    const auto& params = request["params"];
+    if (params.size() != 2) {
+        auto error_msg = "invalid getBlockByNumber params: " + params.dump();
+        SILKRPC_ERROR << error_msg << "\n";
+        co_await writer.write(make_json_error(request["id"], 100, error_msg).dump() + "\n");
+        co_return;
+    }
+    const auto block_id = params[0].get<std::string>();
+    auto full_tx = params[1].get<bool>();
+    SILKRPC_DEBUG << "block_id: " << block_id << " full_tx: " << std::boolalpha << full_tx << "\n";
+
+    const uint32_t request_id = request["id"];
+    std::string content;
+
+    auto tx = co_await database_->begin();
+
+    try {
+        ethdb::TransactionDatabase tx_database{*tx};
+
+        const auto block_number = co_await core::get_block_number(block_id, tx_database);
+        const auto block_with_hash = co_await core::rawdb::read_block_by_number(tx_database, block_number);
+        const auto total_difficulty = co_await core::rawdb::read_total_difficulty(tx_database, block_with_hash.hash, block_number);
+        const Block extended_block{block_with_hash, total_difficulty, full_tx};
+
+        // The full block is written straight into the content, without building its DOM
+        json::serialize_content(content, request_id, extended_block);
+        content.push_back('\n');
+    } catch (const std::invalid_argument& iv) {
+        SILKRPC_DEBUG << "invalid_argument: " << iv.what() << " processing request: " << request.dump() << "\n";
+        content = make_json_content(request_id, {}).dump() + "\n";
+    } catch (const std::exception& e) {
+        SILKRPC_ERROR << "exception: " << e.what() << " processing request: " << request.dump() << "\n";
+        content = make_json_error(request_id, 100, e.what()).dump() + "\n";
+    } catch (...) {
+        SILKRPC_ERROR << "unexpected exception processing request: " << request.dump() << "\n";
+        content = make_json_error(request_id, 100, "unexpected exception").dump() + "\n";
+    }
+
+    co_await writer.write(content);
+
+    co_await tx->close(); // RAII not (yet) available with coroutines
+    co_return;
+}
+
 // https://eth.wiki/json-rpc/API#eth_getblocktransactioncountbyhash
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_transaction_count_by_hash(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 1) {
         auto error_msg = "invalid eth_getBlockTransactionCountByHash params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -263,7 +357,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_transaction_count_by_
 
 // https://eth.wiki/json-rpc/API#eth_getblocktransactioncountbynumber
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_transaction_count_by_number(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 1) {
         auto error_msg = "invalid eth_getBlockTransactionCountByNumber params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -296,7 +390,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_block_transaction_count_by_
 
 // https://eth.wiki/json-rpc/API#eth_getunclebyblockhashandindex
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_uncle_by_block_hash_and_index(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid eth_getUncleByBlockHashAndIndex params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -344,7 +438,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_uncle_by_block_hash_and_ind
 
 // https://eth.wiki/json-rpc/API#eth_getunclebyblocknumberandindex
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_uncle_by_block_number_and_index(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid eth_getUncleByBlockNumberAndIndex params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -391,7 +485,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_uncle_by_block_number_and_i
 
 // https://eth.wiki/json-rpc/API#eth_getunclecountbyblockhash
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_uncle_count_by_block_hash(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 1) {
         auto error_msg = "invalid eth_getUncleCountByBlockHash params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -424,7 +518,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_uncle_count_by_block_hash(c
 
 // https://eth.wiki/json-rpc/API#eth_getunclecountbyblocknumber
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_uncle_count_by_block_number(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 1) {
         auto error_msg = "invalid eth_getUncleCountByBlockNumber params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -458,7 +552,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_uncle_count_by_block_number
 
 // https://eth.wiki/json-rpc/API#eth_gettransactionbyhash
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_by_hash(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 1) {
         auto error_msg = "invalid eth_getTransactionByHash params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -498,7 +592,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_by_hash(const n
 
 // https://eth.wiki/json-rpc/API#eth_gettransactionbyblockhashandindex
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_by_block_hash_and_index(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid eth_getTransactionByBlockHashAndIndex params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -540,7 +634,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_by_block_hash_a
 
 // https://eth.wiki/json-rpc/API#eth_gettransactionbyblocknumberandindex
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_by_block_number_and_index(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid eth_getTransactionByBlockNumberAndIndex params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -582,7 +676,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_by_block_number
 
 // https://eth.wiki/json-rpc/API#eth_gettransactionreceipt
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_receipt(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 1) {
         auto error_msg = "invalid eth_getTransactionReceipt params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -655,7 +749,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_estimate_gas(const nlohmann::js
 
 // https://eth.wiki/json-rpc/API#eth_getbalance
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_balance(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid eth_getBalance params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -690,7 +784,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_balance(const nlohmann::jso
 
 // https://eth.wiki/json-rpc/API#eth_getcode
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_code(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid eth_getCode params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -730,7 +824,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_code(const nlohmann::json&
 
 // https://eth.wiki/json-rpc/API#eth_gettransactioncount
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_count(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid eth_getTransactionCount params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -768,7 +862,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_count(const nlo
 
 // https://eth.wiki/json-rpc/API#eth_getstorageat
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_storage_at(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 3) {
         auto error_msg = "invalid eth_getStorageAt params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -808,7 +902,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_storage_at(const nlohmann::
 
 // https://eth.wiki/json-rpc/API#eth_call
 asio::awaitable<void> EthereumRpcApi::handle_eth_call(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 2) {
         auto error_msg = "invalid eth_call params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -953,7 +1047,7 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_uninstall_filter(const nlohmann
 
 // https://eth.wiki/json-rpc/API#eth_getlogs
 asio::awaitable<void> EthereumRpcApi::handle_eth_get_logs(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 1) {
         auto error_msg = "invalid eth_getLogs params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -970,100 +1064,150 @@ asio::awaitable<void> EthereumRpcApi::handle_eth_get_logs(const nlohmann::json&
     try {
         ethdb::TransactionDatabase tx_database{*tx};
 
-        uint64_t start{}, end{};
-        if (filter.block_hash.has_value()) {
-            auto block_hash_bytes = silkworm::from_hex(filter.block_hash.value());
-            if (!block_hash_bytes.has_value()) {
-                auto error_msg = "invalid eth_getLogs filter block_hash: " + filter.block_hash.value();
-                SILKRPC_ERROR << error_msg << "\n";
-                reply = make_json_error(request["id"], 100, error_msg);
-                co_await tx->close(); // RAII not (yet) available with coroutines
-                co_return;
-            }
-            auto block_hash = silkworm::to_bytes32(block_hash_bytes.value());
-            auto block_number = co_await core::rawdb::read_header_number(tx_database, block_hash);
-            start = end = block_number;
-        } else {
-            auto latest_block_number = co_await core::get_latest_block_number(tx_database);
-            start = filter.from_block.value_or(latest_block_number);
-            end = filter.to_block.value_or(latest_block_number);
-        }
-        SILKRPC_INFO << "start block: " << start << " end block: " << end << "\n";
+        co_await get_logs(tx_database, filter, [&](std::vector<Log>& block_logs) -> asio::awaitable<void> {
+            logs.insert(logs.end(), block_logs.begin(), block_logs.end());
+            co_return;
+        });
+        SILKRPC_INFO << "logs.size(): " << logs.size() << "\n";
 
-        roaring::Roaring block_numbers;
-        block_numbers.addRange(start, end + 1);
+        reply = make_json_content(request["id"], logs);
+    } catch (const std::invalid_argument& iv) {
+        SILKRPC_DEBUG << "invalid_argument: " << iv.what() << " processing request: " << request.dump() << "\n";
+        reply = make_json_content(request["id"], std::vector<Log>{});
+    } catch (const std::exception& e) {
+        SILKRPC_ERROR << "exception: " << e.what() << " processing request: " << request.dump() << "\n";
+        reply = make_json_error(request["id"], 100, e.what());
+    } catch (...) {
+        SILKRPC_ERROR << "unexpected exception processing request: " << request.dump() << "\n";
+        reply = make_json_error(request["id"], 100, "unexpected exception");
+    }
 
-        SILKRPC_DEBUG << "block_numbers.cardinality(): " << block_numbers.cardinality() << "\n";
+    co_await tx->close(); // RAII not (yet) available with coroutines
+    co_return;
+}
 
-        if (filter.topics.has_value()) {
-            auto topics_bitmap = co_await get_topics_bitmap(tx_database, filter.topics.value(), start, end);
-            SILKRPC_TRACE << "topics_bitmap: " << topics_bitmap.toString() << "\n";
-            if (topics_bitmap.isEmpty()) {
-                block_numbers = topics_bitmap;
-            } else {
-                block_numbers &= topics_bitmap;
-            }
-        }
-        SILKRPC_DEBUG << "block_numbers.cardinality(): " << block_numbers.cardinality() << "\n";
-        SILKRPC_TRACE << "block_numbers: " << block_numbers.toString() << "\n";
+asio::awaitable<void> EthereumRpcApi::handle_eth_get_logs_stream(const nlohmann::json& request, StreamWriter& writer) {
+    const auto& params = request["params"];
+    if (params.size() != 1) {
+        auto error_msg = "invalid eth_getLogs params: " + params.dump();
+        SILKRPC_ERROR << error_msg << "\n";
+        co_await writer.write(make_json_error(request["id"], 100, error_msg).dump() + "\n");
+        co_return;
+    }
+    auto filter = params[0].get<Filter>();
+    SILKRPC_DEBUG << "filter: " << filter << "\n";
 
-        if (filter.addresses.has_value()) {
-            auto addresses_bitmap = co_await get_addresses_bitmap(tx_database, filter.addresses.value(), start, end);
-            if (addresses_bitmap.isEmpty()) {
-                block_numbers = addresses_bitmap;
-            } else {
-                block_numbers &= addresses_bitmap;
-            }
-        }
-        SILKRPC_DEBUG << "block_numbers.cardinality(): " << block_numbers.cardinality() << "\n";
-        SILKRPC_TRACE << "block_numbers: " << block_numbers.toString() << "\n";
+    const uint32_t request_id = request["id"];
+    nlohmann::json error_reply;
 
-        if (block_numbers.cardinality() == 0) {
-            reply = make_json_content(request["id"], logs);
-            co_await tx->close(); // RAII not (yet) available with coroutines
-            co_return;
-        }
+    auto tx = co_await database_->begin();
 
-        std::vector<uint32_t> block_number_vector{};
-        block_number_vector.reserve(uint32_t(block_numbers.cardinality()));
-        SILKRPC_DEBUG << "block_number_vector vector size: " << block_number_vector.size() << "\n";
-        block_numbers.toUint32Array(block_number_vector.data());
-        for (auto block_to_match : block_numbers) {
-            SILKRPC_DEBUG << "block_to_match: " << block_to_match << "\n";
-            auto block_hash = co_await core::rawdb::read_canonical_block_hash(tx_database, uint64_t(block_to_match));
-            SILKRPC_DEBUG << "block_hash: " << silkworm::to_hex(block_hash) << "\n";
-
-            auto receipts = co_await core::get_receipts(tx_database, block_hash, uint64_t(block_to_match));
-            SILKRPC_DEBUG << "receipts.size(): " << receipts.size() << "\n";
-            std::vector<Log> unfiltered_logs{};
-            unfiltered_logs.reserve(receipts.size());
-            for (auto receipt : receipts) {
-                SILKRPC_DEBUG << "receipt.logs.size(): " << receipt.logs.size() << "\n";
-                unfiltered_logs.insert(unfiltered_logs.end(), receipt.logs.begin(), receipt.logs.end());
-            }
-            SILKRPC_DEBUG << "unfiltered_logs.size(): " << unfiltered_logs.size() << "\n";
-            auto filtered_logs = filter_logs(unfiltered_logs, filter);
-            SILKRPC_DEBUG << "filtered_logs.size(): " << filtered_logs.size() << "\n";
-            logs.insert(logs.end(), filtered_logs.begin(), filtered_logs.end());
-        }
-        SILKRPC_INFO << "logs.size(): " << logs.size() << "\n";
+    try {
+        ethdb::TransactionDatabase tx_database{*tx};
 
-        reply = make_json_content(request["id"], logs);
+        // Same content as make_json_content, whose keys are sorted, but sent block by block while walking the range
+        std::string content{R"({"id":)" + std::to_string(request_id) + R"(,"jsonrpc":"2.0","result":[)"};
+        std::size_t num_logs{0};
+        co_await get_logs(tx_database, filter, [&](std::vector<Log>& block_logs) -> asio::awaitable<void> {
+            for (const auto& log : block_logs) {
+                if (num_logs++ > 0) {
+                    content.push_back(',');
+                }
+                json::serialize(content, log);
+            }
+            co_await writer.write(content);
+            content.clear();
+        });
+        content.append("]}\n");
+        co_await writer.write(content);
+        SILKRPC_INFO << "logs.size(): " << num_logs << "\n";
     } catch (const std::invalid_argument& iv) {
         SILKRPC_DEBUG << "invalid_argument: " << iv.what() << " processing request: " << request.dump() << "\n";
-        reply = make_json_content(request["id"], logs);
+        error_reply = make_json_content(request_id, std::vector<Log>{});
     } catch (const std::exception& e) {
         SILKRPC_ERROR << "exception: " << e.what() << " processing request: " << request.dump() << "\n";
-        reply = make_json_error(request["id"], 100, e.what());
+        error_reply = make_json_error(request_id, 100, e.what());
     } catch (...) {
         SILKRPC_ERROR << "unexpected exception processing request: " << request.dump() << "\n";
-        reply = make_json_error(request["id"], 100, "unexpected exception");
+        error_reply = make_json_error(request_id, 100, "unexpected exception");
+    }
+
+    // The error replaces the partial content if nothing has been sent yet, otherwise the transfer is just aborted
+    if (!error_reply.is_null() && writer.discard()) {
+        co_await writer.write(error_reply.dump() + "\n");
     }
 
     co_await tx->close(); // RAII not (yet) available with coroutines
     co_return;
 }
 
+asio::awaitable<void> EthereumRpcApi::get_logs(core::rawdb::DatabaseReader& db_reader, Filter& filter, BlockLogsConsumer consume_logs) {
+    uint64_t start{}, end{};
+    if (filter.block_hash.has_value()) {
+        auto block_hash_bytes = silkworm::from_hex(filter.block_hash.value());
+        if (!block_hash_bytes.has_value()) {
+            throw std::runtime_error{"invalid eth_getLogs filter block_hash: " + filter.block_hash.value()};
+        }
+        auto block_hash = silkworm::to_bytes32(block_hash_bytes.value());
+        auto block_number = co_await core::rawdb::read_header_number(db_reader, block_hash);
+        start = end = block_number;
+    } else {
+        auto latest_block_number = co_await core::get_latest_block_number(db_reader);
+        start = filter.from_block.value_or(latest_block_number);
+        end = filter.to_block.value_or(latest_block_number);
+    }
+    SILKRPC_INFO << "start block: " << start << " end block: " << end << "\n";
+
+    roaring::Roaring block_numbers;
+    block_numbers.addRange(start, end + 1);
+
+    SILKRPC_DEBUG << "block_numbers.cardinality(): " << block_numbers.cardinality() << "\n";
+
+    if (filter.topics.has_value()) {
+        auto topics_bitmap = co_await get_topics_bitmap(db_reader, filter.topics.value(), start, end);
+        SILKRPC_TRACE << "topics_bitmap: " << topics_bitmap.toString() << "\n";
+        if (topics_bitmap.isEmpty()) {
+            block_numbers = topics_bitmap;
+        } else {
+            block_numbers &= topics_bitmap;
+        }
+    }
+    SILKRPC_DEBUG << "block_numbers.cardinality(): " << block_numbers.cardinality() << "\n";
+    SILKRPC_TRACE << "block_numbers: " << block_numbers.toString() << "\n";
+
+    if (filter.addresses.has_value()) {
+        auto addresses_bitmap = co_await get_addresses_bitmap(db_reader, filter.addresses.value(), start, end);
+        if (addresses_bitmap.isEmpty()) {
+            block_numbers = addresses_bitmap;
+        } else {
+            block_numbers &= addresses_bitmap;
+        }
+    }
+    SILKRPC_DEBUG << "block_numbers.cardinality(): " << block_numbers.cardinality() << "\n";
+    SILKRPC_TRACE << "block_numbers: " << block_numbers.toString() << "\n";
+
+    for (auto block_to_match : block_numbers) {
+        SILKRPC_DEBUG << "block_to_match: " << block_to_match << "\n";
+        auto block_hash = co_await core::rawdb::read_canonical_block_hash(db_reader, uint64_t(block_to_match));
+        SILKRPC_DEBUG << "block_hash: " << silkworm::to_hex(block_hash) << "\n";
+
+        auto receipts = co_await core::get_receipts(db_reader, block_hash, uint64_t(block_to_match));
+        SILKRPC_DEBUG << "receipts.size(): " << receipts.size() << "\n";
+        std::vector<Log> unfiltered_logs{};
+        unfiltered_logs.reserve(receipts.size());
+        for (auto receipt : receipts) {
+            SILKRPC_DEBUG << "receipt.logs.size(): " << receipt.logs.size() << "\n";
+            unfiltered_logs.insert(unfiltered_logs.end(), receipt.logs.begin(), receipt.logs.end());
+        }
+        SILKRPC_DEBUG << "unfiltered_logs.size(): " << unfiltered_logs.size() << "\n";
+        auto filtered_logs = filter_logs(unfiltered_logs, filter);
+        SILKRPC_DEBUG << "filtered_logs.size(): " << filtered_logs.size() << "\n";
+        if (!filtered_logs.empty()) {
+            co_await consume_logs(filtered_logs);
+        }
+    }
+}
+
 // https://eth.wiki/json-rpc/API#eth_sendrawtransaction
 asio::awaitable<void> EthereumRpcApi::handle_eth_send_raw_transaction(const nlohmann::json& request, nlohmann::json& reply) {
     auto tx = co_await database_->begin();
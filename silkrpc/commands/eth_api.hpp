@@ -17,6 +17,7 @@
 #ifndef SILKRPC_COMMANDS_ETH_API_HPP_
 #define SILKRPC_COMMANDS_ETH_API_HPP_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -31,6 +32,7 @@
 #include <silkrpc/context_pool.hpp>
 #include <silkrpc/core/rawdb/accessors.hpp>
 #include <silkrpc/croaring/roaring.hh>
+#include <silkrpc/json/stream_writer.hpp>
 #include <silkrpc/json/types.hpp>
 #include <silkrpc/ethbackend/backend.hpp>
 #include <silkrpc/ethdb/database.hpp>
@@ -58,7 +60,9 @@ protected:
     asio::awaitable<void> handle_eth_syncing(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_gas_price(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_get_block_by_hash(const nlohmann::json& request, nlohmann::json& reply);
+    asio::awaitable<void> handle_eth_get_block_by_hash_stream(const nlohmann::json& request, StreamWriter& writer);
     asio::awaitable<void> handle_eth_get_block_by_number(const nlohmann::json& request, nlohmann::json& reply);
+    asio::awaitable<void> handle_eth_get_block_by_number_stream(const nlohmann::json& request, StreamWriter& writer);
     asio::awaitable<void> handle_eth_get_block_transaction_count_by_hash(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_get_block_transaction_count_by_number(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_get_uncle_by_block_hash_and_index(const nlohmann::json& request, nlohmann::json& reply);
@@ -81,6 +85,7 @@ protected:
     asio::awaitable<void> handle_eth_get_filter_changes(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_uninstall_filter(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_get_logs(const nlohmann::json& request, nlohmann::json& reply);
+    asio::awaitable<void> handle_eth_get_logs_stream(const nlohmann::json& request, StreamWriter& writer);
     asio::awaitable<void> handle_eth_send_raw_transaction(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_send_transaction(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_sign_transaction(const nlohmann::json& request, nlohmann::json& reply);
@@ -93,6 +98,13 @@ protected:
     asio::awaitable<void> handle_eth_submit_work(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_subscribe(const nlohmann::json& request, nlohmann::json& reply);
     asio::awaitable<void> handle_eth_unsubscribe(const nlohmann::json& request, nlohmann::json& reply);
+
+    /// The consumer of the filtered logs of one block.
+    using BlockLogsConsumer = std::function<asio::awaitable<void>(std::vector<Log>& logs)>;
+
+    /// Walk in order the blocks in range matching the filter, passing the filtered logs of each block to the consumer.
+    asio::awaitable<void> get_logs(core::rawdb::DatabaseReader& db_reader, Filter& filter, BlockLogsConsumer consume_logs);
+
     asio::awaitable<roaring::Roaring> get_topics_bitmap(core::rawdb::DatabaseReader& db_reader, FilterTopics& topics, uint64_t start, uint64_t end);
     asio::awaitable<roaring::Roaring> get_addresses_bitmap(core::rawdb::DatabaseReader& db_reader, FilterAddresses& addresses, uint64_t start, uint64_t end);
     asio::awaitable<Receipts> get_receipts(core::rawdb::DatabaseReader& db_reader, uint64_t number, evmc::bytes32 hash);
@@ -44,7 +44,7 @@ asio::awaitable<void> Web3RpcApi::handle_web3_client_version(const nlohmann::jso
 
 // https://eth.wiki/json-rpc/API#web3_sha3
 asio::awaitable<void> Web3RpcApi::handle_web3_sha3(const nlohmann::json& request, nlohmann::json& reply) {
-    auto params = request["params"];
+    const auto& params = request["params"];
     if (params.size() != 1) {
         auto error_msg = "invalid web3_sha3 params: " + params.dump();
         SILKRPC_ERROR << error_msg << "\n";
@@ -18,6 +18,7 @@
 #define SILKRPC_COMMON_CONSTANTS_HPP_
 
 #include <chrono>
+#include <cstddef>
 #include <string>
 
 #include <boost/format.hpp>
@@ -45,9 +46,33 @@ constexpr const char* kOsName{
 constexpr const char* kAddressPortSeparator{":"};
 
 constexpr const char* kEmptyChainData{""};
+constexpr const char* kEmptyIpcPath{""};
 constexpr const char* kDefaultLocal{"localhost:8545"};
 constexpr const char* kDefaultTarget{"localhost:9090"};
 constexpr const std::chrono::milliseconds kDefaultTimeout{10000};
+constexpr const std::size_t kDefaultMaxBatchSize{100};
+constexpr const std::size_t kDefaultMaxAcceptsPerWakeup{16};
+constexpr const std::size_t kDefaultMaxPendingNotifications{1024};
+constexpr const std::size_t kDefaultCompressionThreshold{1024};
+constexpr const std::size_t kDefaultStreamBufferSize{65536};
+constexpr const std::size_t kDefaultMaxInFlight{0};
+constexpr const std::size_t kDefaultMaxQueueDepth{0};
+constexpr const std::size_t kDefaultMaxContextInFlight{256};
+constexpr const std::size_t kDefaultMaxContextQueueDepth{1024};
+constexpr const std::size_t kDefaultMaxContextHeavyInFlight{4};
+constexpr const std::chrono::seconds kDefaultRetryAfter{1};
+constexpr const std::chrono::milliseconds kDefaultHeaderReadTimeout{30000};
+constexpr const std::chrono::milliseconds kDefaultBodyReadTimeout{60000};
+constexpr const std::chrono::milliseconds kDefaultIdleTimeout{60000};
+constexpr const std::chrono::milliseconds kDefaultWriteTimeout{60000};
+constexpr const std::size_t kDefaultMaxConnections{0};
+constexpr const std::size_t kDefaultMaxBodySize{16 * 1024 * 1024};
+constexpr const bool kDefaultCoalesceRequests{true};
+constexpr const std::size_t kDefaultHttp2MaxConcurrentStreams{128};
+constexpr const std::size_t kDefaultWalkReadAhead{64};
+constexpr const std::size_t kDefaultTxPoolSize{8};
+constexpr const std::chrono::milliseconds kDefaultTxMaxAge{5000};
+constexpr const char* kDefaultApiSpec{"web3,net,eth,debug,trace,tg,parity"};
 
 }  // namespace silkrpc::common
 
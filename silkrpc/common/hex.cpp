@@ -0,0 +1,281 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hex.hpp"
+
+#include <array>
+#include <cstring>
+
+#include <boost/endian/conversion.hpp>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SILKRPC_COMMON_HEX_X86_64
+#include <immintrin.h>
+#endif
+
+namespace silkrpc::hex {
+
+static constexpr const char* kHexDigits{"0123456789abcdef"};
+
+// The two hex digits of each byte value
+static constexpr std::array<char, 512> make_digit_pairs() {
+    std::array<char, 512> pairs{};
+    for (std::size_t i{0}; i < 256; ++i) {
+        pairs[2 * i] = kHexDigits[i >> 4];
+        pairs[2 * i + 1] = kHexDigits[i & 0x0f];
+    }
+    return pairs;
+}
+
+static constexpr std::array<char, 512> kDigitPairs{make_digit_pairs()};
+
+// The value of each hex digit character, 0xFF for any other character
+static constexpr std::array<uint8_t, 256> make_digit_values() {
+    std::array<uint8_t, 256> values{};
+    values.fill(0xFF);
+    for (uint8_t i{0}; i < 10; ++i) {
+        values['0' + i] = i;
+    }
+    for (uint8_t i{0}; i < 6; ++i) {
+        values['a' + i] = values['A' + i] = 10 + i;
+    }
+    return values;
+}
+
+static constexpr std::array<uint8_t, 256> kDigitValues{make_digit_values()};
+
+namespace scalar {
+
+void encode(const uint8_t* data, std::size_t size, char* out) {
+    for (std::size_t i{0}; i < size; ++i) {
+        std::memcpy(out + 2 * i, &kDigitPairs[2 * data[i]], 2);
+    }
+}
+
+bool decode(const char* digits, std::size_t size, uint8_t* out) {
+    uint8_t invalid{0};
+    for (std::size_t i{0}; i < size; ++i) {
+        const uint8_t hi = kDigitValues[static_cast<uint8_t>(digits[2 * i])];
+        const uint8_t lo = kDigitValues[static_cast<uint8_t>(digits[2 * i + 1])];
+        invalid |= hi | lo;
+        out[i] = static_cast<uint8_t>(hi << 4 | lo);
+    }
+    return (invalid & 0xF0) == 0;
+}
+
+} // namespace scalar
+
+bool decode_prefixed(std::string_view text, uint8_t* out, std::size_t size) {
+    if (text.size() != 2 + 2 * size || text[0] != '0' || text[1] != 'x') {
+        return false;
+    }
+    return decode(text.data() + 2, size, out);
+}
+
+std::size_t count_leading_zero_digits(const uint8_t* data, std::size_t size) {
+    std::size_t i{0};
+    for (; i + 8 <= size; i += 8) {
+        const uint64_t word = boost::endian::load_big_u64(data + i);
+        if (word != 0) {
+            return 2 * i + __builtin_clzll(word) / 4;
+        }
+    }
+    for (; i < size; ++i) {
+        if (data[i] != 0) {
+            return 2 * i + (data[i] < 0x10 ? 1 : 0);
+        }
+    }
+    return 2 * size;
+}
+
+std::size_t encode_no_leading_zeros(const uint8_t* data, std::size_t size, char* out) {
+    if (size == 0) {
+        return 0;
+    }
+    auto zeros = count_leading_zero_digits(data, size);
+    if (zeros == 2 * size) {
+        --zeros;
+    }
+    const auto first_byte = zeros / 2;
+    char* dest = out;
+    if (zeros % 2 != 0) {
+        *dest++ = kHexDigits[data[first_byte] & 0x0f];
+        encode(data + first_byte + 1, size - first_byte - 1, dest);
+    } else {
+        encode(data + first_byte, size - first_byte, dest);
+    }
+    return 2 * size - zeros;
+}
+
+std::size_t encode_no_leading_zeros(uint64_t number, char* out) {
+    const std::size_t num_digits = number == 0 ? 1 : (67 - __builtin_clzll(number)) / 4;
+    for (std::size_t i{num_digits}; i > 0; --i) {
+        out[i - 1] = kHexDigits[number & 0x0f];
+        number >>= 4;
+    }
+    return num_digits;
+}
+
+#ifdef SILKRPC_COMMON_HEX_X86_64
+
+// Expand 16 bytes into their 32 hex digits, split in the digits of the first and of the last 8 bytes
+__attribute__((target("ssse3")))
+static inline void encode_16_ssse3(__m128i v, __m128i& first, __m128i& last) {
+    const __m128i digits_v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kHexDigits));
+    const __m128i nibble_mask_v = _mm_set1_epi8(0x0f);
+    const __m128i hi = _mm_shuffle_epi8(digits_v, _mm_and_si128(_mm_srli_epi16(v, 4), nibble_mask_v));
+    const __m128i lo = _mm_shuffle_epi8(digits_v, _mm_and_si128(v, nibble_mask_v));
+    first = _mm_unpacklo_epi8(hi, lo);
+    last = _mm_unpackhi_epi8(hi, lo);
+}
+
+__attribute__((target("ssse3")))
+static void encode_ssse3(const uint8_t* data, std::size_t size, char* out) {
+    for (; size >= 16; size -= 16, data += 16, out += 32) {
+        __m128i first, last;
+        encode_16_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), first, last);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), first);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), last);
+    }
+    scalar::encode(data, size, out);
+}
+
+__attribute__((target("avx2")))
+static void encode_avx2(const uint8_t* data, std::size_t size, char* out) {
+    const __m256i digits_v = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kHexDigits)));
+    const __m256i nibble_mask_v = _mm256_set1_epi8(0x0f);
+    for (; size >= 32; size -= 32, data += 32, out += 64) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        const __m256i hi = _mm256_shuffle_epi8(digits_v, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble_mask_v));
+        const __m256i lo = _mm256_shuffle_epi8(digits_v, _mm256_and_si256(v, nibble_mask_v));
+        // The unpacks interleave within each 128-bit lane: bytes 0-7|16-23 and 8-15|24-31, put back in order
+        const __m256i unpacked_lo = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i unpacked_hi = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(unpacked_lo, unpacked_hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(unpacked_lo, unpacked_hi, 0x31));
+    }
+    // The tail goes through the legacy SSE encoding, which stalls while the upper halves of the AVX registers are dirty
+    _mm256_zeroupper();
+    encode_ssse3(data, size, out);
+}
+
+// Convert 16 hex digit characters into their values, setting invalid to all ones in the lanes of non-digits
+__attribute__((target("ssse3")))
+static inline __m128i digit_values_ssse3(__m128i v, __m128i& invalid) {
+    const __m128i decimal = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    const __m128i alpha = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i is_decimal = _mm_cmpeq_epi8(_mm_min_epu8(decimal, _mm_set1_epi8(9)), decimal);
+    const __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    invalid = _mm_or_si128(invalid, _mm_andnot_si128(_mm_or_si128(is_decimal, is_alpha), _mm_set1_epi8(-1)));
+    return _mm_or_si128(_mm_and_si128(is_decimal, decimal), _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3")))
+static bool decode_ssse3(const char* digits, std::size_t size, uint8_t* out) {
+    // Each pair of digit values (hi, lo) is combined into hi * 16 + lo by a multiply-add of adjacent bytes
+    const __m128i weights_v = _mm_set1_epi16(0x0110);
+    __m128i invalid = _mm_setzero_si128();
+    for (; size >= 16; size -= 16, digits += 32, out += 16) {
+        const __m128i first = digit_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digits)), invalid);
+        const __m128i last = digit_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digits + 16)), invalid);
+        const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(first, weights_v), _mm_maddubs_epi16(last, weights_v));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+    }
+    return _mm_movemask_epi8(invalid) == 0 && scalar::decode(digits, size, out);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i digit_values_avx2(__m256i v, __m256i& invalid) {
+    const __m256i decimal = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+    const __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_decimal = _mm256_cmpeq_epi8(_mm256_min_epu8(decimal, _mm256_set1_epi8(9)), decimal);
+    const __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+    invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(_mm256_or_si256(is_decimal, is_alpha), _mm256_set1_epi8(-1)));
+    return _mm256_or_si256(_mm256_and_si256(is_decimal, decimal), _mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+static bool decode_avx2(const char* digits, std::size_t size, uint8_t* out) {
+    const __m256i weights_v = _mm256_set1_epi16(0x0110);
+    __m256i invalid = _mm256_setzero_si256();
+    for (; size >= 32; size -= 32, digits += 64, out += 32) {
+        const __m256i first = digit_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(digits)), invalid);
+        const __m256i last = digit_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(digits + 32)), invalid);
+        // The pack works within each 128-bit lane, giving the 64-bit quarters in 0, 2, 1, 3 order
+        const __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(first, weights_v), _mm256_maddubs_epi16(last, weights_v));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    const bool valid = _mm256_movemask_epi8(invalid) == 0;
+    _mm256_zeroupper();
+    return valid && decode_ssse3(digits, size, out);
+}
+
+enum class InstructionSet { scalar, ssse3, avx2 };
+
+static InstructionSet detect_instruction_set() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return InstructionSet::avx2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return InstructionSet::ssse3;
+    }
+    return InstructionSet::scalar;
+}
+
+static const InstructionSet kInstructionSet{detect_instruction_set()};
+
+void encode(const uint8_t* data, std::size_t size, char* out) {
+    switch (kInstructionSet) {
+        case InstructionSet::avx2: encode_avx2(data, size, out); break;
+        case InstructionSet::ssse3: encode_ssse3(data, size, out); break;
+        default: scalar::encode(data, size, out);
+    }
+}
+
+bool decode(const char* digits, std::size_t size, uint8_t* out) {
+    switch (kInstructionSet) {
+        case InstructionSet::avx2: return decode_avx2(digits, size, out);
+        case InstructionSet::ssse3: return decode_ssse3(digits, size, out);
+        default: return scalar::decode(digits, size, out);
+    }
+}
+
+const char* instruction_set() {
+    switch (kInstructionSet) {
+        case InstructionSet::avx2: return "avx2";
+        case InstructionSet::ssse3: return "ssse3";
+        default: return "scalar";
+    }
+}
+
+#else
+
+void encode(const uint8_t* data, std::size_t size, char* out) {
+    scalar::encode(data, size, out);
+}
+
+bool decode(const char* digits, std::size_t size, uint8_t* out) {
+    return scalar::decode(digits, size, out);
+}
+
+const char* instruction_set() {
+    return "scalar";
+}
+
+#endif // SILKRPC_COMMON_HEX_X86_64
+
+} // namespace silkrpc::hex
@@ -0,0 +1,60 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_COMMON_HEX_HPP_
+#define SILKRPC_COMMON_HEX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace silkrpc::hex {
+
+/// Write the 2 * size lowercase hex digits of the bytes in [data, data + size) into out.
+void encode(const uint8_t* data, std::size_t size, char* out);
+
+/// Read the 2 * size hex digits (either case) in [digits, digits + 2 * size) into size bytes in out.
+/// Return false if any character is not a hex digit, in which case the content of out is unspecified.
+bool decode(const char* digits, std::size_t size, uint8_t* out);
+
+/// Read the "0x" prefixed text of exactly 2 * size hex digits into size bytes in out, return false for any other text.
+bool decode_prefixed(std::string_view text, uint8_t* out, std::size_t size);
+
+/// Count the leading zero hex digits of the bytes in [data, data + size), i.e. 2 * size if all bytes are zero.
+std::size_t count_leading_zero_digits(const uint8_t* data, std::size_t size);
+
+/// Write the hex digits of the bytes without leading zeros into out (room for 2 * size digits), return how many.
+/// Zero bytes give a single "0", no bytes give no digits.
+std::size_t encode_no_leading_zeros(const uint8_t* data, std::size_t size, char* out);
+
+/// Write the hex digits of the number without leading zeros into out (room for 16 digits), return how many.
+std::size_t encode_no_leading_zeros(uint64_t number, char* out);
+
+/// The SIMD instruction set used by the hex kernels, selected at startup from the CPU capabilities.
+const char* instruction_set();
+
+/// Reference scalar implementations, always available.
+namespace scalar {
+
+void encode(const uint8_t* data, std::size_t size, char* out);
+
+bool decode(const char* digits, std::size_t size, uint8_t* out);
+
+} // namespace scalar
+
+} // namespace silkrpc::hex
+
+#endif // SILKRPC_COMMON_HEX_HPP_
@@ -0,0 +1,125 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "hex.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc {
+
+static std::string encode(const std::vector<uint8_t>& bytes) {
+    std::string out(2 * bytes.size(), '\0');
+    hex::encode(bytes.data(), bytes.size(), out.data());
+    return out;
+}
+
+static std::string encode_no_leading_zeros(const std::vector<uint8_t>& bytes) {
+    std::string out(2 * bytes.size(), '\0');
+    out.resize(hex::encode_no_leading_zeros(bytes.data(), bytes.size(), out.data()));
+    return out;
+}
+
+static std::string encode_no_leading_zeros(uint64_t number) {
+    std::string out(16, '\0');
+    out.resize(hex::encode_no_leading_zeros(number, out.data()));
+    return out;
+}
+
+TEST_CASE("encode hex", "[silkrpc][common][hex]") {
+    CHECK(encode({}) == "");
+    CHECK(encode({0x00}) == "00");
+    CHECK(encode({0x01, 0xab, 0xff, 0x10}) == "01abff10");
+
+    std::vector<uint8_t> bytes(40);
+    for (std::size_t i{0}; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 7);
+    }
+    CHECK(encode(bytes) == "00070e151c232a31383f464d545b626970777e858c939aa1a8afb6bdc4cbd2d9e0e7eef5fc030a11");
+}
+
+TEST_CASE("decode hex", "[silkrpc][common][hex]") {
+    std::vector<uint8_t> bytes(4);
+    CHECK(hex::decode("01abFF10", 4, bytes.data()));
+    CHECK(bytes == std::vector<uint8_t>{0x01, 0xab, 0xff, 0x10});
+    CHECK(hex::decode("", 0, bytes.data()));
+
+    CHECK(!hex::decode("01abFg10", 4, bytes.data()));
+    CHECK(!hex::decode("0x01ab10", 4, bytes.data()));
+
+    CHECK(hex::decode_prefixed("0x01abFF10", bytes.data(), 4));
+    CHECK(bytes == std::vector<uint8_t>{0x01, 0xab, 0xff, 0x10});
+    CHECK(!hex::decode_prefixed("01abFF10", bytes.data(), 4));
+    CHECK(!hex::decode_prefixed("0x01abFF", bytes.data(), 4));
+    CHECK(!hex::decode_prefixed("0x01abFF1000", bytes.data(), 4));
+    CHECK(!hex::decode_prefixed("0X01abFF10", bytes.data(), 4));
+
+    const std::string digits{"00070e151c232a31383f464d545b626970777e858c939aa1a8afb6bdc4cbd2d9e0e7eef5fc030a11"};
+    bytes.resize(digits.size() / 2);
+    CHECK(hex::decode(digits.data(), bytes.size(), bytes.data()));
+    CHECK(encode(bytes) == digits);
+    for (const auto invalid : {'/', ':', '@', 'G', '`', 'g', ' ', '\x80'}) {
+        for (const std::size_t position : {std::size_t{0}, std::size_t{17}, std::size_t{45}, digits.size() - 1}) {
+            auto wrong_digits{digits};
+            wrong_digits[position] = invalid;
+            CHECK(!hex::decode(wrong_digits.data(), bytes.size(), bytes.data()));
+        }
+    }
+}
+
+TEST_CASE("encode hex without leading zeros", "[silkrpc][common][hex]") {
+    CHECK(encode_no_leading_zeros(std::vector<uint8_t>{}) == "");
+    CHECK(encode_no_leading_zeros(std::vector<uint8_t>{0x00}) == "0");
+    CHECK(encode_no_leading_zeros(std::vector<uint8_t>(20, 0x00)) == "0");
+    CHECK(encode_no_leading_zeros(std::vector<uint8_t>{0x00, 0x0f}) == "f");
+    CHECK(encode_no_leading_zeros(std::vector<uint8_t>{0x00, 0x00, 0x10, 0x00}) == "1000");
+    CHECK(encode_no_leading_zeros(std::vector<uint8_t>{0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01, 0x02}) == "102");
+
+    CHECK(encode_no_leading_zeros(uint64_t{0}) == "0");
+    CHECK(encode_no_leading_zeros(uint64_t{0x0f}) == "f");
+    CHECK(encode_no_leading_zeros(uint64_t{4206337}) == "402f01");
+    CHECK(encode_no_leading_zeros(uint64_t{0xffffffffffffffff}) == "ffffffffffffffff");
+
+    CHECK(hex::count_leading_zero_digits(nullptr, 0) == 0);
+    const std::vector<uint8_t> bytes{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+    CHECK(hex::count_leading_zero_digits(bytes.data(), bytes.size()) == 21);
+}
+
+TEST_CASE("SIMD hex matches scalar hex", "[silkrpc][common][hex]") {
+    INFO("instruction set: " << hex::instruction_set());
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> byte{0, 255};
+    for (std::size_t size{0}; size < 200; ++size) {
+        std::vector<uint8_t> bytes(size);
+        for (auto& b : bytes) {
+            b = static_cast<uint8_t>(byte(generator));
+        }
+        std::string digits(2 * size, '\0');
+        std::string scalar_digits(2 * size, '\0');
+        hex::encode(bytes.data(), size, digits.data());
+        hex::scalar::encode(bytes.data(), size, scalar_digits.data());
+        CHECK(digits == scalar_digits);
+
+        std::vector<uint8_t> decoded(size);
+        CHECK(hex::decode(digits.data(), size, decoded.data()));
+        CHECK(decoded == bytes);
+    }
+}
+
+} // namespace silkrpc
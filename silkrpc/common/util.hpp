@@ -19,7 +19,9 @@
 
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <asio/buffer.hpp>
@@ -32,9 +34,27 @@
 
 namespace silkrpc {
 
+/// Key and value of a table row, viewing the bytes of the storage they come from (e.g. the reply message).
+/// The row keeps its storage alive, so copying a row shares the bytes instead of copying them.
 struct KeyValue {
-    silkworm::Bytes key;
-    silkworm::Bytes value;
+    KeyValue() = default;
+
+    KeyValue(const silkworm::ByteView& k, const silkworm::ByteView& v, std::shared_ptr<const void> storage)
+    : key{k}, value{v}, storage_{std::move(storage)} {}
+
+    /// Row owning its bytes, when the source storage cannot be shared
+    KeyValue(silkworm::Bytes k, silkworm::Bytes v) {
+        auto bytes = std::make_shared<const std::pair<silkworm::Bytes, silkworm::Bytes>>(std::move(k), std::move(v));
+        key = bytes->first;
+        value = bytes->second;
+        storage_ = std::move(bytes);
+    }
+
+    silkworm::ByteView key;
+    silkworm::ByteView value;
+
+private:
+    std::shared_ptr<const void> storage_;
 };
 
 } // namespace silkrpc
@@ -16,11 +16,44 @@
 
 #include "util.hpp"
 
+#include <memory>
+#include <string>
+
 #include <catch2/catch.hpp>
 
 namespace silkrpc {
 
 using Catch::Matchers::Message;
 
+TEST_CASE("KeyValue", "[silkrpc][common][util]") {
+    SECTION("default row is empty") {
+        const KeyValue kv_pair{};
+        CHECK(kv_pair.key.empty());
+        CHECK(kv_pair.value.empty());
+    }
+
+    SECTION("owning row outlives its source bytes") {
+        KeyValue kv_pair;
+        {
+            silkworm::Bytes key(32, 0x01);
+            silkworm::Bytes value(64, 0x02);
+            kv_pair = KeyValue{key, value};
+        }
+        CHECK(kv_pair.key == silkworm::Bytes(32, 0x01));
+        CHECK(kv_pair.value == silkworm::Bytes(64, 0x02));
+    }
+
+    SECTION("copies view the shared storage") {
+        auto storage = std::make_shared<std::string>("keyvalue");
+        const KeyValue kv_pair{silkworm::byte_view_of_string(*storage).substr(0, 3), silkworm::byte_view_of_string(*storage).substr(3), storage};
+        const auto copy = kv_pair;
+        storage.reset();
+        CHECK(copy.key.data() == kv_pair.key.data());
+        CHECK(copy.value.data() == kv_pair.value.data());
+        CHECK(copy.key == silkworm::byte_view_of_string("key"));
+        CHECK(copy.value == silkworm::byte_view_of_string("value"));
+    }
+}
+
 } // namespace silkrpc
 
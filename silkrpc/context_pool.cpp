@@ -34,7 +34,8 @@ std::ostream& operator<<(std::ostream& out, const Context& c) {
     return out;
 }
 
-ContextPool::ContextPool(std::size_t pool_size, ChannelFactory create_channel) : next_index_{0} {
+ContextPool::ContextPool(std::size_t pool_size, ChannelFactory create_channel, const ethdb::TransactionPoolSettings& tx_pool_settings,
+    DatabaseFactory create_database) : next_index_{0} {
     if (pool_size == 0) {
         throw std::logic_error("ContextPool::ContextPool pool_size is 0");
     }
@@ -46,7 +47,14 @@ ContextPool::ContextPool(std::size_t pool_size, ChannelFactory create_channel) :
         auto grpc_channel = create_channel();
         auto grpc_queue = std::make_unique<grpc::CompletionQueue>();
         auto grpc_runner = std::make_unique<CompletionRunner>(*grpc_queue, *io_context);
-        auto database = std::make_unique<ethdb::kv::RemoteDatabase>(*io_context, grpc_channel, grpc_queue.get()); // TODO(canepat): move elsewhere
+        std::unique_ptr<ethdb::Database> database;
+        if (create_database) {
+            // Local transactions are cheap to begin, so there is no point in pooling them
+            database = create_database(*io_context);
+        } else {
+            auto remote_database = std::make_unique<ethdb::kv::RemoteDatabase>(*io_context, grpc_channel, grpc_queue.get()); // TODO(canepat): move elsewhere
+            database = std::make_unique<ethdb::PooledDatabase>(std::move(remote_database), *io_context, tx_pool_settings);
+        }
         auto backend = std::make_unique<ethbackend::BackEnd>(*io_context, grpc_channel, grpc_queue.get()); // TODO(canepat): move elsewhere
         contexts_.push_back({io_context, std::move(grpc_queue), std::move(grpc_runner), std::move(database), std::move(backend)});
         SILKRPC_DEBUG << "ContextPool::ContextPool context[" << i << "] " << contexts_[i] << "\n";
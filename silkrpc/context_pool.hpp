@@ -29,6 +29,7 @@
 
 #include <silkrpc/ethbackend/backend.hpp>
 #include <silkrpc/ethdb/database.hpp>
+#include <silkrpc/ethdb/pooled_database.hpp>
 #include <silkrpc/grpc/completion_runner.hpp>
 
 namespace silkrpc {
@@ -45,9 +46,13 @@ std::ostream& operator<<(std::ostream& out, const Context& c);
 
 using ChannelFactory = std::function<std::shared_ptr<grpc::Channel>()>;
 
+using DatabaseFactory = std::function<std::unique_ptr<ethdb::Database>(asio::io_context&)>;
+
 class ContextPool {
 public:
-    explicit ContextPool(std::size_t pool_size, ChannelFactory create_channel);
+    /// The database is the remote KV one if no factory is given, otherwise the one created by the factory (e.g. the local chain data)
+    explicit ContextPool(std::size_t pool_size, ChannelFactory create_channel, const ethdb::TransactionPoolSettings& tx_pool_settings = {},
+        DatabaseFactory create_database = {});
 
     ContextPool(const ContextPool&) = delete;
     ContextPool& operator=(const ContextPool&) = delete;
@@ -58,6 +63,10 @@ public:
 
     Context& get_context();
 
+    Context& get_context(std::size_t index) { return contexts_.at(index); }
+
+    std::size_t num_contexts() const { return contexts_.size(); }
+
     asio::io_context& get_io_context();
 
 private:
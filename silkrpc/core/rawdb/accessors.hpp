@@ -31,7 +31,8 @@
 
 namespace silkrpc::core::rawdb {
 
-using Walker = std::function<bool(silkworm::Bytes&, silkworm::Bytes&)>;
+// The key and value are views valid only during the call: copy them to keep them
+using Walker = std::function<bool(const silkworm::ByteView&, const silkworm::ByteView&)>;
 using ChangeSetWalker = std::function<silkworm::Bytes(uint64_t, silkworm::Bytes&)>;
 
 class DatabaseReader {
@@ -19,6 +19,7 @@
 #include <iterator>
 #include <iostream>
 #include <iomanip>
+#include <string_view>
 #include <utility>
 
 #include <boost/endian/conversion.hpp>
@@ -41,7 +42,7 @@
 // TODO(canepat): move to db/types/log_cbor.*,receipt_cbor.*
 namespace silkrpc::core {
 
-void cbor_decode(const silkworm::Bytes& bytes, std::vector<Log>& logs) {
+void cbor_decode(const silkworm::ByteView& bytes, std::vector<Log>& logs) {
     if (bytes.size() == 0) {
         return;
     }
@@ -52,7 +53,7 @@ void cbor_decode(const silkworm::Bytes& bytes, std::vector<Log>& logs) {
     }
 }
 
-void cbor_decode(const silkworm::Bytes& bytes, std::vector<Receipt>& receipts) {
+void cbor_decode(const silkworm::ByteView& bytes, std::vector<Receipt>& receipts) {
     if (bytes.size() == 0) {
         return;
     }
@@ -86,8 +87,9 @@ asio::awaitable<ChainConfig> read_chain_config(const DatabaseReader& reader) {
     if (data.empty()) {
         throw std::invalid_argument{"empty chain config data in read_chain_config"};
     }
-    SILKRPC_DEBUG << "rawdb::read_chain_config chain config data: " << data.c_str() << "\n";
-    const auto json_config = nlohmann::json::parse(data.c_str());
+    const std::string_view json_data{reinterpret_cast<const char*>(data.data()), data.size()};
+    SILKRPC_DEBUG << "rawdb::read_chain_config chain config data: " << json_data << "\n";
+    const auto json_config = nlohmann::json::parse(json_data);
     SILKRPC_TRACE << "rawdb::read_chain_config chain config JSON: " << json_config.dump() << "\n";
     co_return ChainConfig{genesis_block_hash, json_config};
 }
@@ -166,7 +168,10 @@ asio::awaitable<silkworm::BlockHeader> read_header_by_number(const DatabaseReade
 }
 
 asio::awaitable<silkworm::BlockHeader> read_header(const DatabaseReader& reader, const evmc::bytes32& block_hash, uint64_t block_number) {
-    auto data = co_await read_header_rlp(reader, block_hash, block_number);
+    // Decode directly the value viewed by the row, without copying the RLP
+    const auto block_key = silkworm::db::block_key(block_number, block_hash.bytes);
+    const auto kv_pair = co_await reader.get(silkrpc::db::table::kHeaders, block_key);
+    const auto data = kv_pair.value;
     if (data.empty()) {
         throw std::runtime_error{"empty block header RLP in read_header"};
     }
@@ -181,7 +186,9 @@ asio::awaitable<silkworm::BlockHeader> read_header(const DatabaseReader& reader,
 }
 
 asio::awaitable<silkworm::BlockBody> read_body(const DatabaseReader& reader, const evmc::bytes32& block_hash, uint64_t block_number) {
-    const auto data = co_await read_body_rlp(reader, block_hash, block_number);
+    const auto block_key = silkworm::db::block_key(block_number, block_hash.bytes);
+    const auto kv_pair = co_await reader.get(silkrpc::db::table::kBlockBodies, block_key);
+    const auto data = kv_pair.value;
     if (data.empty()) {
         throw std::runtime_error{"empty block body RLP in read_body"};
     }
@@ -204,15 +211,13 @@ asio::awaitable<silkworm::BlockBody> read_body(const DatabaseReader& reader, con
 asio::awaitable<silkworm::Bytes> read_header_rlp(const DatabaseReader& reader, const evmc::bytes32& block_hash, uint64_t block_number) {
     const auto block_key = silkworm::db::block_key(block_number, block_hash.bytes);
     const auto kv_pair = co_await reader.get(silkrpc::db::table::kHeaders, block_key);
-    const auto data = kv_pair.value;
-    co_return data;
+    co_return silkworm::Bytes{kv_pair.value};
 }
 
 asio::awaitable<silkworm::Bytes> read_body_rlp(const DatabaseReader& reader, const evmc::bytes32& block_hash, uint64_t block_number) {
     const auto block_key = silkworm::db::block_key(block_number, block_hash.bytes);
     const auto kv_pair = co_await reader.get(silkrpc::db::table::kBlockBodies, block_key);
-    const auto data = kv_pair.value;
-    co_return data;
+    co_return silkworm::Bytes{kv_pair.value};
 }
 
 asio::awaitable<std::optional<silkrpc::Transaction>> read_transaction_by_hash(const DatabaseReader& reader, const evmc::bytes32& transaction_hash) {
@@ -265,7 +270,7 @@ asio::awaitable<Receipts> read_raw_receipts(const DatabaseReader& reader, const
 
     auto log_key = silkworm::db::log_key(block_number, 0);
     SILKRPC_DEBUG << "log_key: " << silkworm::to_hex(log_key) << "\n";
-    Walker walker = [&](const silkworm::Bytes& k, const silkworm::Bytes& v) {
+    Walker walker = [&](const silkworm::ByteView& k, const silkworm::ByteView& v) {
         auto tx_id = boost::endian::load_big_u32(&k[sizeof(uint64_t)]);
         cbor_decode(v, receipts[tx_id].logs);
         receipts[tx_id].bloom = bloom_from_logs(receipts[tx_id].logs);
@@ -342,7 +347,7 @@ asio::awaitable<Transactions> read_transactions(const DatabaseReader& reader, ui
     boost::endian::store_big_u64(&txn_id_key[0], base_txn_id); // tx_id_key.data()?
     SILKRPC_DEBUG << "txn_id_key: " << silkworm::to_hex(txn_id_key) << "\n";
     size_t i{0};
-    Walker walker = [&](const silkworm::Bytes&, const silkworm::Bytes& v) {
+    Walker walker = [&](const silkworm::ByteView&, const silkworm::ByteView& v) {
         SILKRPC_TRACE << "v: " << silkworm::to_hex(v) << "\n";
         silkworm::ByteView value{v};
         silkworm::Transaction tx{};
@@ -59,7 +59,7 @@ asio::awaitable<Roaring> get(core::rawdb::DatabaseReader& db_reader, const std::
     SILKRPC_DEBUG << "table: " << table << " key: " << key << " from_key: " << from_key << "\n";
 
     Roaring chunck{};
-    core::rawdb::Walker walker = [&](const silkworm::Bytes& k, const silkworm::Bytes& v) {
+    core::rawdb::Walker walker = [&](const silkworm::ByteView& k, const silkworm::ByteView& v) {
         SILKRPC_TRACE << "k: " << k << " v: " << v << "\n";
         auto chunck = std::make_unique<Roaring>(Roaring::readSafe(reinterpret_cast<const char*>(v.data()), v.size()));
         SILKRPC_TRACE << "chunck: " << chunck->toString() << "\n";
@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <asio/awaitable.hpp>
 
@@ -46,6 +47,9 @@ public:
 
     virtual asio::awaitable<KeyValue> next() = 0;
 
+    /// Same as count calls to next, but the implementation can read all the entries in a single round trip
+    virtual asio::awaitable<std::vector<KeyValue>> next_batch(std::size_t count) = 0;
+
     virtual asio::awaitable<void> close_cursor() = 0;
 };
 
@@ -20,10 +20,12 @@
 #include <silkrpc/config.hpp>
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <system_error>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <asio/async_result.hpp>
 #include <asio/detail/non_const_lvalue.hpp>
@@ -42,6 +44,10 @@
 
 namespace silkrpc::ethdb::kv {
 
+// The replies are passed along the completion chain by reference count, so the cursor rows can view their bytes without copies
+using PairPtr = std::shared_ptr<const remote::Pair>;
+using PairsPtr = std::shared_ptr<const std::vector<remote::Pair>>;
+
 template <typename Handler, typename IoExecutor>
 using async_start = async_noreply_operation<Handler, IoExecutor>;
 
@@ -49,10 +55,13 @@ template <typename Handler, typename IoExecutor>
 using async_open_cursor = async_reply_operation<Handler, IoExecutor, uint32_t>;
 
 template <typename Handler, typename IoExecutor>
-using async_next = async_reply_operation<Handler, IoExecutor, remote::Pair>;
+using async_next = async_reply_operation<Handler, IoExecutor, PairPtr>;
+
+template <typename Handler, typename IoExecutor>
+using async_seek = async_reply_operation<Handler, IoExecutor, PairPtr>;
 
 template <typename Handler, typename IoExecutor>
-using async_seek = async_reply_operation<Handler, IoExecutor, remote::Pair>;
+using async_next_batch = async_reply_operation<Handler, IoExecutor, PairsPtr>;
 
 template <typename Handler, typename IoExecutor>
 using async_close_cursor = async_reply_operation<Handler, IoExecutor, uint32_t>;
@@ -115,22 +124,15 @@ public:
         auto open_message = remote::Cursor{};
         open_message.set_op(remote::Op::OPEN);
         open_message.set_bucketname(table_name_);
-        self_->client_.write_start(open_message, [this](const grpc::Status& status) {
-            if (!status.ok()) {
-                auto open_cursor_op = static_cast<op*>(wrapper_);
+        self_->client_.request_start(open_message, [this](const grpc::Status& status, remote::Pair open_pair) {
+            auto cursor_id = open_pair.cursorid();
+
+            auto open_cursor_op = static_cast<op*>(wrapper_);
+            if (status.ok()) {
+                open_cursor_op->complete(this, {}, cursor_id);
+            } else {
                 open_cursor_op->complete(this, make_error_code(status.error_code(), status.error_message()), 0);
-                return;
             }
-            self_->client_.read_start([this](const grpc::Status& status, remote::Pair open_pair) {
-                auto cursor_id = open_pair.cursorid();
-
-                auto open_cursor_op = static_cast<op*>(wrapper_);
-                if (status.ok()) {
-                    open_cursor_op->complete(this, {}, cursor_id);
-                } else {
-                    open_cursor_op->complete(this, make_error_code(status.error_code(), status.error_message()), 0);
-                }
-            });
         });
     }
 
@@ -161,21 +163,14 @@ public:
         seek_message.set_op(exact_ ? remote::Op::SEEK_EXACT : remote::Op::SEEK);
         seek_message.set_cursor(cursor_id_);
         seek_message.set_k(key_.data(), key_.length());
-        self_->client_.write_start(seek_message, [this](const grpc::Status& status) {
-            if (!status.ok()) {
-                auto seek_op = static_cast<op*>(wrapper_);
+        self_->client_.request_start(seek_message, [this](const grpc::Status& status, remote::Pair seek_pair) {
+            typedef silkrpc::ethdb::kv::async_seek<WaitHandler, Executor> op;
+            auto seek_op = static_cast<op*>(wrapper_);
+            if (status.ok()) {
+                seek_op->complete(this, {}, std::make_shared<const remote::Pair>(std::move(seek_pair)));
+            } else {
                 seek_op->complete(this, make_error_code(status.error_code(), status.error_message()), {});
-                return;
             }
-            self_->client_.read_start([this](const grpc::Status& status, remote::Pair seek_pair) {
-                typedef silkrpc::ethdb::kv::async_seek<WaitHandler, Executor> op;
-                auto seek_op = static_cast<op*>(wrapper_);
-                if (status.ok()) {
-                    seek_op->complete(this, {}, seek_pair);
-                } else {
-                    seek_op->complete(this, make_error_code(status.error_code(), status.error_message()), {});
-                }
-            });
         });
     }
 
@@ -209,20 +204,13 @@ public:
         seek_message.set_cursor(cursor_id_);
         seek_message.set_k(key_.data(), key_.length());
         seek_message.set_v(value_.data(), value_.length());
-        self_->client_.write_start(seek_message, [this](const grpc::Status& status) {
-            if (!status.ok()) {
-                auto seek_op = static_cast<op*>(wrapper_);
+        self_->client_.request_start(seek_message, [this](const grpc::Status& status, remote::Pair seek_pair) {
+            auto seek_op = static_cast<op*>(wrapper_);
+            if (status.ok()) {
+                seek_op->complete(this, {}, std::make_shared<const remote::Pair>(std::move(seek_pair)));
+            } else {
                 seek_op->complete(this, make_error_code(status.error_code(), status.error_message()), {});
-                return;
             }
-            self_->client_.read_start([this](const grpc::Status& status, remote::Pair seek_pair) {
-                auto seek_op = static_cast<op*>(wrapper_);
-                if (status.ok()) {
-                    seek_op->complete(this, {}, seek_pair);
-                } else {
-                    seek_op->complete(this, make_error_code(status.error_code(), status.error_message()), {});
-                }
-            });
         });
     }
 
@@ -255,27 +243,73 @@ public:
         auto next_message = remote::Cursor{};
         next_message.set_op(remote::Op::NEXT);
         next_message.set_cursor(cursor_id_);
-        self_->client_.write_start(next_message, [this](const grpc::Status& status) {
-            if (!status.ok()) {
-                auto next_op = static_cast<op*>(wrapper_);
+        self_->client_.request_start(next_message, [this](const grpc::Status& status, remote::Pair next_pair) {
+            auto next_op = static_cast<op*>(wrapper_);
+            if (status.ok()) {
+                next_op->complete(this, {}, std::make_shared<const remote::Pair>(std::move(next_pair)));
+            } else {
                 next_op->complete(this, make_error_code(status.error_code(), status.error_message()), {});
-                return;
             }
-            self_->client_.read_start([this](const grpc::Status& status, remote::Pair next_pair) {
-                auto next_op = static_cast<op*>(wrapper_);
+        });
+    }
+
+private:
+    KvAsioAwaitable<Executor>* self_;
+    uint32_t cursor_id_;
+    const silkworm::Bytes next_key_bytes_;
+    void* wrapper_;
+};
+
+template<typename Executor>
+class initiate_async_next_batch {
+public:
+    typedef Executor executor_type;
+
+    explicit initiate_async_next_batch(KvAsioAwaitable<Executor>* self, uint32_t cursor_id, std::size_t count)
+    : self_(self), cursor_id_(cursor_id), count_(count) {}
+
+    executor_type get_executor() const noexcept { return self_->get_executor(); }
+
+    template <typename WaitHandler>
+    void operator()(WaitHandler&& handler) {
+        asio::detail::non_const_lvalue<WaitHandler> handler2(handler);
+        using op = async_next_batch<WaitHandler, Executor>;
+        typename op::ptr p = {asio::detail::addressof(handler2.value), op::ptr::allocate(handler2.value), 0};
+        wrapper_ = new op(handler2.value, self_->context_.get_executor());
+
+        // All the NEXT requests are pipelined: the operation completes when the reply to the last one arrives
+        next_pairs_ = std::make_shared<std::vector<remote::Pair>>();
+        next_pairs_->reserve(count_);
+        auto next_message = remote::Cursor{};
+        next_message.set_op(remote::Op::NEXT);
+        next_message.set_cursor(cursor_id_);
+        for (std::size_t i{0}; i < count_; ++i) {
+            self_->client_.request_start(next_message, [this](const grpc::Status& status, remote::Pair next_pair) {
                 if (status.ok()) {
-                    next_op->complete(this, {}, next_pair);
+                    next_pairs_->push_back(std::move(next_pair));
+                } else if (status_.ok()) {
+                    status_ = status;
+                }
+                if (++replies_ < count_) {
+                    return;
+                }
+                auto next_batch_op = static_cast<op*>(wrapper_);
+                if (status_.ok()) {
+                    next_batch_op->complete(this, {}, std::move(next_pairs_));
                 } else {
-                    next_op->complete(this, make_error_code(status.error_code(), status.error_message()), {});
+                    next_batch_op->complete(this, make_error_code(status_.error_code(), status_.error_message()), {});
                 }
             });
-        });
+        }
     }
 
 private:
     KvAsioAwaitable<Executor>* self_;
     uint32_t cursor_id_;
-    const silkworm::Bytes next_key_bytes_;
+    std::size_t count_;
+    std::size_t replies_{0};
+    std::shared_ptr<std::vector<remote::Pair>> next_pairs_;
+    grpc::Status status_;
     void* wrapper_;
 };
 
@@ -299,22 +333,15 @@ public:
         auto close_message = remote::Cursor{};
         close_message.set_op(remote::Op::CLOSE);
         close_message.set_cursor(cursor_id_);
-        self_->client_.write_start(close_message, [this](const grpc::Status& status) {
-            if (!status.ok()) {
-                auto close_cursor_op = static_cast<op*>(wrapper_);
+        self_->client_.request_start(close_message, [this](const grpc::Status& status, remote::Pair close_pair) {
+            auto cursor_id = close_pair.cursorid();
+
+            auto close_cursor_op = static_cast<op*>(wrapper_);
+            if (status.ok()) {
+                close_cursor_op->complete(this, {}, cursor_id);
+            } else {
                 close_cursor_op->complete(this, make_error_code(status.error_code(), status.error_message()), 0);
-                return;
             }
-            self_->client_.read_start([this](const grpc::Status& status, remote::Pair close_pair) {
-                auto cursor_id = close_pair.cursorid();
-
-                auto close_cursor_op = static_cast<op*>(wrapper_);
-                if (status.ok()) {
-                    close_cursor_op->complete(this, {}, cursor_id);
-                } else {
-                    close_cursor_op->complete(this, make_error_code(status.error_code(), status.error_message()), 0);
-                }
-            });
         });
     }
 
@@ -375,27 +402,32 @@ struct KvAsioAwaitable {
 
     template<typename WaitHandler>
     auto async_seek(uint32_t cursor_id, const silkworm::ByteView& key, WaitHandler&& handler) {
-        return asio::async_initiate<WaitHandler, void(asio::error_code, remote::Pair)>(initiate_async_seek{this, cursor_id, key, false}, handler);
+        return asio::async_initiate<WaitHandler, void(asio::error_code, PairPtr)>(initiate_async_seek{this, cursor_id, key, false}, handler);
     }
 
     template<typename WaitHandler>
     auto async_seek_exact(uint32_t cursor_id, const silkworm::ByteView& key, WaitHandler&& handler) {
-        return asio::async_initiate<WaitHandler, void(asio::error_code, remote::Pair)>(initiate_async_seek{this, cursor_id, key, true}, handler);
+        return asio::async_initiate<WaitHandler, void(asio::error_code, PairPtr)>(initiate_async_seek{this, cursor_id, key, true}, handler);
     }
 
     template<typename WaitHandler>
     auto async_seek_both(uint32_t cursor_id, const silkworm::ByteView& key, const silkworm::ByteView& value, WaitHandler&& handler) {
-        return asio::async_initiate<WaitHandler, void(asio::error_code, remote::Pair)>(initiate_async_seek_both{this, cursor_id, key, value, false}, handler);
+        return asio::async_initiate<WaitHandler, void(asio::error_code, PairPtr)>(initiate_async_seek_both{this, cursor_id, key, value, false}, handler);
     }
 
     template<typename WaitHandler>
     auto async_seek_both_exact(uint32_t cursor_id, const silkworm::ByteView& key, const silkworm::ByteView& value, WaitHandler&& handler) {
-        return asio::async_initiate<WaitHandler, void(asio::error_code, remote::Pair)>(initiate_async_seek_both{this, cursor_id, key, value, true}, handler);
+        return asio::async_initiate<WaitHandler, void(asio::error_code, PairPtr)>(initiate_async_seek_both{this, cursor_id, key, value, true}, handler);
     }
 
     template<typename WaitHandler>
     auto async_next(uint32_t cursor_id, WaitHandler&& handler) {
-        return asio::async_initiate<WaitHandler, void(asio::error_code, remote::Pair)>(initiate_async_next{this, cursor_id}, handler);
+        return asio::async_initiate<WaitHandler, void(asio::error_code, PairPtr)>(initiate_async_next{this, cursor_id}, handler);
+    }
+
+    template<typename WaitHandler>
+    auto async_next_batch(uint32_t cursor_id, std::size_t count, WaitHandler&& handler) {
+        return asio::async_initiate<WaitHandler, void(asio::error_code, PairsPtr)>(initiate_async_next_batch{this, cursor_id, count}, handler);
     }
 
     template<typename WaitHandler>
@@ -20,6 +20,11 @@
 
 namespace silkrpc::ethdb::kv {
 
+// The row views the key and value of the reply, which lives as long as the row
+static KeyValue key_value_of(const PairPtr& pair) {
+    return KeyValue{silkworm::byte_view_of_string(pair->k()), silkworm::byte_view_of_string(pair->v()), pair};
+}
+
 asio::awaitable<void> RemoteCursor::open_cursor(const std::string& table_name) {
     const auto start_time = clock_time::now();
     if (cursor_id_ == 0) {
@@ -35,49 +40,59 @@ asio::awaitable<KeyValue> RemoteCursor::seek(const silkworm::ByteView& key) {
     const auto start_time = clock_time::now();
     SILKRPC_DEBUG << "RemoteCursor::seek cursor: " << cursor_id_ << " key: " << key << "\n";
     auto seek_pair = co_await kv_awaitable_.async_seek(cursor_id_, key, asio::use_awaitable);
-    const auto k = silkworm::bytes_of_string(seek_pair.k());
-    const auto v = silkworm::bytes_of_string(seek_pair.v());
-    SILKRPC_DEBUG << "RemoteCursor::seek k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
-    co_return KeyValue{k, v};
+    const auto kv_pair = key_value_of(seek_pair);
+    SILKRPC_DEBUG << "RemoteCursor::seek k: " << kv_pair.key << " v: " << kv_pair.value << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
+    co_return kv_pair;
 }
 
 asio::awaitable<KeyValue> RemoteCursor::seek_exact(const silkworm::ByteView& key) {
     const auto start_time = clock_time::now();
     SILKRPC_DEBUG << "RemoteCursor::seek_exact cursor: " << cursor_id_ << " key: " << key << "\n";
     auto seek_pair = co_await kv_awaitable_.async_seek_exact(cursor_id_, key, asio::use_awaitable);
-    const auto k = silkworm::bytes_of_string(seek_pair.k());
-    const auto v = silkworm::bytes_of_string(seek_pair.v());
-    SILKRPC_DEBUG << "RemoteCursor::seek_exact k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
-    co_return KeyValue{k, v};
+    const auto kv_pair = key_value_of(seek_pair);
+    SILKRPC_DEBUG << "RemoteCursor::seek_exact k: " << kv_pair.key << " v: " << kv_pair.value << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
+    co_return kv_pair;
 }
 
 asio::awaitable<KeyValue> RemoteCursor::next() {
     const auto start_time = clock_time::now();
     auto next_pair = co_await kv_awaitable_.async_next(cursor_id_, asio::use_awaitable);
-    const auto k = silkworm::bytes_of_string(next_pair.k());
-    const auto v = silkworm::bytes_of_string(next_pair.v());
     SILKRPC_DEBUG << "RemoteCursor::next c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
-    co_return KeyValue{k, v};
+    co_return key_value_of(next_pair);
+}
+
+asio::awaitable<std::vector<KeyValue>> RemoteCursor::next_batch(std::size_t count) {
+    if (count == 0) {
+        co_return std::vector<KeyValue>{};
+    }
+    const auto start_time = clock_time::now();
+    auto next_pairs = co_await kv_awaitable_.async_next_batch(cursor_id_, count, asio::use_awaitable);
+    std::vector<KeyValue> kv_pairs;
+    kv_pairs.reserve(next_pairs->size());
+    // All the rows share the batch of replies: no allocation per row
+    for (const auto& next_pair : *next_pairs) {
+        kv_pairs.emplace_back(silkworm::byte_view_of_string(next_pair.k()), silkworm::byte_view_of_string(next_pair.v()), next_pairs);
+    }
+    SILKRPC_DEBUG << "RemoteCursor::next_batch count: " << count << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
+    co_return kv_pairs;
 }
 
 asio::awaitable<silkworm::Bytes> RemoteCursor::seek_both(const silkworm::ByteView& key, const silkworm::ByteView& value) {
     const auto start_time = clock_time::now();
     SILKRPC_DEBUG << "RemoteCursor::seek_both cursor: " << cursor_id_ << " key: " << key << " subkey: " << value << "\n";
     auto seek_pair = co_await kv_awaitable_.async_seek_both(cursor_id_, key, value, asio::use_awaitable);
-    const auto k = silkworm::bytes_of_string(seek_pair.k());
-    const auto v = silkworm::bytes_of_string(seek_pair.v());
-    SILKRPC_DEBUG << "RemoteCursor::seek_both k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
-    co_return v;
+    const auto kv_pair = key_value_of(seek_pair);
+    SILKRPC_DEBUG << "RemoteCursor::seek_both k: " << kv_pair.key << " v: " << kv_pair.value << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
+    co_return silkworm::Bytes{kv_pair.value};
 }
 
 asio::awaitable<KeyValue> RemoteCursor::seek_both_exact(const silkworm::ByteView& key, const silkworm::ByteView& value) {
     const auto start_time = clock_time::now();
     SILKRPC_DEBUG << "RemoteCursor::seek_both_exact cursor: " << cursor_id_ << " key: " << key << " subkey: " << value << "\n";
     auto seek_pair = co_await kv_awaitable_.async_seek_both_exact(cursor_id_, key, value, asio::use_awaitable);
-    const auto k = silkworm::bytes_of_string(seek_pair.k());
-    const auto v = silkworm::bytes_of_string(seek_pair.v());
-    SILKRPC_DEBUG << "RemoteCursor::seek_both_exact k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
-    co_return KeyValue{k, v};
+    const auto kv_pair = key_value_of(seek_pair);
+    SILKRPC_DEBUG << "RemoteCursor::seek_both_exact k: " << kv_pair.key << " v: " << kv_pair.value << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
+    co_return kv_pair;
 }
 
 asio::awaitable<void> RemoteCursor::close_cursor() {
@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <asio/awaitable.hpp>
 #include <asio/io_context.hpp>
@@ -52,6 +53,8 @@ public:
 
     asio::awaitable<KeyValue> next() override;
 
+    asio::awaitable<std::vector<KeyValue>> next_batch(std::size_t count) override;
+
     asio::awaitable<void> close_cursor() override;
 
     asio::awaitable<silkworm::Bytes> seek_both(const silkworm::ByteView& key, const silkworm::ByteView& value) override;
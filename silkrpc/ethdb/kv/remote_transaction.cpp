@@ -16,6 +16,8 @@
 
 #include "remote_transaction.hpp"
 
+#include <iterator>
+
 #include <silkrpc/ethdb/kv/remote_cursor.hpp>
 
 namespace silkrpc::ethdb::kv {
@@ -33,9 +35,31 @@ asio::awaitable<std::shared_ptr<CursorDupSort>> RemoteTransaction::cursor_dup_so
     co_return co_await get_cursor(table);
 }
 
+asio::awaitable<std::shared_ptr<CursorDupSort>> RemoteTransaction::new_cursor(const std::string& table) {
+    auto cursor = std::make_shared<RemoteCursor>(kv_awaitable_);
+    co_await cursor->open_cursor(table);
+    co_return cursor;
+}
+
 asio::awaitable<void> RemoteTransaction::close() {
-    for (const auto& [table, cursor] : cursors_) {
-        co_await cursor->close_cursor();
+    // Close requests are pipelined on the stream and replies come back in order, so waiting for the last one is enough:
+    // the failures of the others are recorded, so that this transaction is not reused as if cleanly closed
+    for (auto cursor_it = cursors_.begin(); cursor_it != cursors_.end(); ++cursor_it) {
+        const auto& cursor = cursor_it->second;
+        if (std::next(cursor_it) == cursors_.end()) {
+            co_await cursor->close_cursor();
+        } else if (cursor->cursor_id() != 0) {
+            auto close_message = remote::Cursor{};
+            close_message.set_op(remote::Op::CLOSE);
+            close_message.set_cursor(cursor->cursor_id());
+            client_.request_start(close_message, [this, cursor_id = cursor->cursor_id()](const grpc::Status& status, remote::Pair /*close_pair*/) {
+                SILKRPC_DEBUG << "RemoteTransaction::close cursor: " << cursor_id << " closed: " << status.ok() << "\n";
+                if (!status.ok()) {
+                    SILKRPC_ERROR << "RemoteTransaction::close cursor: " << cursor_id << " error: " << status.error_message() << "\n";
+                    close_failed_ = true;
+                }
+            });
+        }
     }
     cursors_.clear();
     co_await kv_awaitable_.async_end(asio::use_awaitable);
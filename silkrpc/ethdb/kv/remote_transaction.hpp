@@ -52,8 +52,12 @@ public:
 
     asio::awaitable<std::shared_ptr<CursorDupSort>> cursor_dup_sort(const std::string& table) override;
 
+    asio::awaitable<std::shared_ptr<CursorDupSort>> new_cursor(const std::string& table) override;
+
     asio::awaitable<void> close() override;
 
+    bool reusable() const override { return !close_failed_ && !client_.broken() && client_.outstanding_requests() == 0; }
+
 private:
     asio::awaitable<std::shared_ptr<CursorDupSort>> get_cursor(const std::string& table);
 
@@ -61,6 +65,9 @@ private:
     StreamingClient client_;
     KvAsioAwaitable<asio::io_context::executor_type> kv_awaitable_;
     std::map<std::string, std::shared_ptr<CursorDupSort>> cursors_;
+
+    /// Flag indicating if any cursor failed to close, whose reply is not awaited.
+    bool close_failed_{false};
 };
 
 } // namespace silkrpc::ethdb::kv
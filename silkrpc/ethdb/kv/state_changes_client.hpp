@@ -0,0 +1,116 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_ETHDB_KV_STATE_CHANGES_CLIENT_HPP_
+#define SILKRPC_ETHDB_KV_STATE_CHANGES_CLIENT_HPP_
+
+#include <functional>
+#include <memory>
+
+#include <google/protobuf/empty.pb.h>
+#include <grpcpp/grpcpp.h>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/grpc/async_completion_handler.hpp>
+#include <silkrpc/interfaces/remote/kv.grpc.pb.h>
+
+namespace silkrpc::ethdb::kv {
+
+typedef std::unique_ptr<grpc::ClientAsyncReaderInterface<::remote::StateChange>> ClientAsyncReaderPtr;
+
+/// Client of the KV server-side stream notifying the changes of state at each new block.
+class StateChangesClient final : public AsyncCompletionHandler {
+    enum CallStatus { CALL_IDLE, CALL_STARTED, READ_STARTED, CALL_ENDED };
+
+public:
+    explicit StateChangesClient(std::shared_ptr<grpc::Channel> channel, grpc::CompletionQueue* queue)
+    : stub_{remote::KV::NewStub(channel)}, reader_{stub_->PrepareAsyncReceiveStateChanges(&context_, google::protobuf::Empty{}, queue)} {
+        SILKRPC_TRACE << "StateChangesClient::ctor " << this << " status: " << status_ << "\n";
+    }
+
+    ~StateChangesClient() {
+        SILKRPC_TRACE << "StateChangesClient::dtor " << this << " status: " << status_ << "\n";
+    }
+
+    void start_call(std::function<void(const grpc::Status&)> start_completed) {
+        SILKRPC_TRACE << "StateChangesClient::start_call " << this << " status: " << status_ << " start\n";
+        start_completed_ = start_completed;
+        status_ = CALL_STARTED;
+        reader_->StartCall(AsyncCompletionHandler::tag(this));
+        SILKRPC_TRACE << "StateChangesClient::start_call " << this << " status: " << status_ << " end\n";
+    }
+
+    void read_start(std::function<void(const grpc::Status&, ::remote::StateChange)> read_completed) {
+        SILKRPC_TRACE << "StateChangesClient::read_start " << this << " status: " << status_ << " start\n";
+        read_completed_ = read_completed;
+        status_ = READ_STARTED;
+        reader_->Read(&state_change_, AsyncCompletionHandler::tag(this));
+        SILKRPC_TRACE << "StateChangesClient::read_start " << this << " status: " << status_ << " end\n";
+    }
+
+    /// Cancel the call: any pending operation completes with an error.
+    void cancel() {
+        SILKRPC_TRACE << "StateChangesClient::cancel " << this << " status: " << status_ << "\n";
+        context_.TryCancel();
+    }
+
+    void completed(bool ok) override {
+        SILKRPC_TRACE << "StateChangesClient::completed " << this << " status: " << status_ << " ok: " << ok << " start\n";
+        if (!ok && !finishing_) {
+            finishing_ = true;
+            reader_->Finish(&result_, AsyncCompletionHandler::tag(this));
+            return;
+        }
+        if (finishing_ && result_.ok()) {
+            // The server has closed the stream gracefully, anyway no more state changes will be notified
+            result_ = grpc::Status{grpc::StatusCode::UNAVAILABLE, "state changes stream closed by server"};
+        }
+        if (!result_.ok()) {
+            SILKRPC_ERROR << "StateChangesClient::completed error_code: " << result_.error_code() << "\n";
+            SILKRPC_ERROR << "StateChangesClient::completed error_message: " << result_.error_message() << "\n";
+        }
+        switch (status_) {
+            case CALL_STARTED:
+                start_completed_(result_);
+            break;
+            case READ_STARTED:
+                SILKRPC_TRACE << "StateChangesClient::completed state_change blockheight: " << state_change_.blockheight() << "\n";
+                read_completed_(result_, state_change_);
+            break;
+            default:
+            break;
+        }
+        if (finishing_) {
+            status_ = CALL_ENDED;
+        }
+        SILKRPC_TRACE << "StateChangesClient::completed " << this << " status: " << status_ << " end\n";
+    }
+
+private:
+    std::unique_ptr<remote::KV::Stub> stub_;
+    grpc::ClientContext context_;
+    ClientAsyncReaderPtr reader_;
+    ::remote::StateChange state_change_;
+    grpc::Status result_;
+    CallStatus status_{CALL_IDLE};
+    bool finishing_{false};
+    std::function<void(const grpc::Status&)> start_completed_;
+    std::function<void(const grpc::Status&, ::remote::StateChange)> read_completed_;
+};
+
+} // namespace silkrpc::ethdb::kv
+
+#endif // SILKRPC_ETHDB_KV_STATE_CHANGES_CLIENT_HPP_
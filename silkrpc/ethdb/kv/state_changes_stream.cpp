@@ -0,0 +1,86 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "state_changes_stream.hpp"
+
+#include <exception>
+#include <system_error>
+
+#include <asio/co_spawn.hpp>
+#include <asio/post.hpp>
+#include <asio/redirect_error.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <silkrpc/common/log.hpp>
+
+namespace silkrpc::ethdb::kv {
+
+void StateChangesStream::open(StateChangeHandler handler, StreamStatusHandler status_handler) {
+    asio::co_spawn(*context_.io_context, run(handler, status_handler), [&](std::exception_ptr eptr) {
+        if (eptr) std::rethrow_exception(eptr);
+    });
+}
+
+void StateChangesStream::close() {
+    asio::post(*context_.io_context, [&]() {
+        SILKRPC_DEBUG << "StateChangesStream::close closing stream\n";
+        closed_ = true;
+        retry_timer_.cancel();
+        if (client_) {
+            client_->cancel();
+        }
+    });
+}
+
+asio::awaitable<void> StateChangesStream::run(StateChangeHandler handler, StreamStatusHandler status_handler) {
+    while (!closed_) {
+        client_ = std::make_unique<StateChangesClient>(create_channel_(), context_.grpc_queue.get());
+        StateChangesAwaitable state_changes_awaitable{*context_.io_context, *client_};
+        try {
+            co_await state_changes_awaitable.async_start(asio::use_awaitable);
+            SILKRPC_INFO << "StateChangesStream::run state changes stream opened\n";
+            if (status_handler) {
+                status_handler(true);
+            }
+            while (!closed_) {
+                const auto state_change = co_await state_changes_awaitable.async_read(asio::use_awaitable);
+                SILKRPC_DEBUG << "StateChangesStream::run blockheight: " << state_change.blockheight() << " direction: " << state_change.direction() << "\n";
+                try {
+                    co_await handler(state_change);
+                } catch (const std::exception& e) {
+                    SILKRPC_ERROR << "StateChangesStream::run handler exception: " << e.what() << "\n";
+                }
+            }
+        } catch (const std::system_error& se) {
+            if (!closed_) {
+                SILKRPC_WARN << "StateChangesStream::run stream broken: " << se.what() << ", reopening\n";
+            }
+        }
+        if (status_handler) {
+            status_handler(false);
+        }
+        client_.reset();
+
+        if (!closed_) {
+            asio::error_code error;
+            retry_timer_.expires_after(kRetryInterval);
+            co_await retry_timer_.async_wait(asio::redirect_error(asio::use_awaitable, error));
+        }
+    }
+    SILKRPC_DEBUG << "StateChangesStream::run stream closed\n";
+}
+
+} // namespace silkrpc::ethdb::kv
@@ -0,0 +1,177 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_ETHDB_KV_STATE_CHANGES_STREAM_HPP_
+#define SILKRPC_ETHDB_KV_STATE_CHANGES_STREAM_HPP_
+
+#include <silkrpc/config.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include <asio/async_result.hpp>
+#include <asio/awaitable.hpp>
+#include <asio/detail/non_const_lvalue.hpp>
+#include <asio/io_context.hpp>
+#include <asio/steady_timer.hpp>
+
+#include <silkrpc/context_pool.hpp>
+#include <silkrpc/ethdb/kv/state_changes_client.hpp>
+#include <silkrpc/grpc/async_operation.hpp>
+#include <silkrpc/grpc/error.hpp>
+#include <silkrpc/interfaces/remote/kv.grpc.pb.h>
+
+namespace silkrpc::ethdb::kv {
+
+template <typename Handler, typename IoExecutor>
+using async_start_changes = async_noreply_operation<Handler, IoExecutor>;
+
+template <typename Handler, typename IoExecutor>
+using async_read_change = async_reply_operation<Handler, IoExecutor, remote::StateChange>;
+
+struct StateChangesAwaitable;
+
+class initiate_async_start_changes {
+public:
+    typedef asio::io_context::executor_type executor_type;
+
+    explicit initiate_async_start_changes(StateChangesAwaitable* self) : self_(self) {}
+
+    executor_type get_executor() const noexcept;
+
+    template <typename WaitHandler>
+    void operator()(WaitHandler&& handler);
+
+private:
+    StateChangesAwaitable* self_;
+    void* wrapper_;
+};
+
+class initiate_async_read_change {
+public:
+    typedef asio::io_context::executor_type executor_type;
+
+    explicit initiate_async_read_change(StateChangesAwaitable* self) : self_(self) {}
+
+    executor_type get_executor() const noexcept;
+
+    template <typename WaitHandler>
+    void operator()(WaitHandler&& handler);
+
+private:
+    StateChangesAwaitable* self_;
+    void* wrapper_;
+};
+
+struct StateChangesAwaitable {
+    typedef asio::io_context::executor_type executor_type;
+
+    explicit StateChangesAwaitable(asio::io_context& context, StateChangesClient& client)
+    : context_(context), client_(client) {}
+
+    template<typename WaitHandler>
+    auto async_start(WaitHandler&& handler) {
+        return asio::async_initiate<WaitHandler, void(asio::error_code)>(initiate_async_start_changes{this}, handler);
+    }
+
+    template<typename WaitHandler>
+    auto async_read(WaitHandler&& handler) {
+        return asio::async_initiate<WaitHandler, void(asio::error_code, remote::StateChange)>(initiate_async_read_change{this}, handler);
+    }
+
+    asio::io_context& context_;
+    StateChangesClient& client_;
+};
+
+inline initiate_async_start_changes::executor_type initiate_async_start_changes::get_executor() const noexcept {
+    return self_->context_.get_executor();
+}
+
+template <typename WaitHandler>
+void initiate_async_start_changes::operator()(WaitHandler&& handler) {
+    asio::detail::non_const_lvalue<WaitHandler> handler2(handler);
+    using op = async_start_changes<WaitHandler, executor_type>;
+    typename op::ptr p = {asio::detail::addressof(handler2.value), op::ptr::allocate(handler2.value), 0};
+    wrapper_ = new op(handler2.value, self_->context_.get_executor());
+
+    self_->client_.start_call([this](const grpc::Status& status) {
+        auto start_op = static_cast<op*>(wrapper_);
+        if (status.ok()) {
+            start_op->complete(this, {});
+        } else {
+            start_op->complete(this, make_error_code(status.error_code(), status.error_message()));
+        }
+    });
+}
+
+inline initiate_async_read_change::executor_type initiate_async_read_change::get_executor() const noexcept {
+    return self_->context_.get_executor();
+}
+
+template <typename WaitHandler>
+void initiate_async_read_change::operator()(WaitHandler&& handler) {
+    asio::detail::non_const_lvalue<WaitHandler> handler2(handler);
+    using op = async_read_change<WaitHandler, executor_type>;
+    typename op::ptr p = {asio::detail::addressof(handler2.value), op::ptr::allocate(handler2.value), 0};
+    wrapper_ = new op(handler2.value, self_->context_.get_executor());
+
+    self_->client_.read_start([this](const grpc::Status& status, remote::StateChange state_change) {
+        auto read_op = static_cast<op*>(wrapper_);
+        if (status.ok()) {
+            read_op->complete(this, {}, state_change);
+        } else {
+            read_op->complete(this, make_error_code(status.error_code(), status.error_message()), {});
+        }
+    });
+}
+
+using StateChangeHandler = std::function<asio::awaitable<void>(const remote::StateChange&)>;
+
+/// Called with true when the stream is opened and with false when it gets broken or closed.
+using StreamStatusHandler = std::function<void(bool)>;
+
+/// The single consumer of the KV state changes stream, which is reopened if broken.
+class StateChangesStream {
+public:
+    static constexpr std::chrono::milliseconds kRetryInterval{1000};
+
+    explicit StateChangesStream(Context& context, ChannelFactory create_channel)
+    : context_(context), create_channel_(create_channel), retry_timer_{*context.io_context} {}
+
+    StateChangesStream(const StateChangesStream&) = delete;
+    StateChangesStream& operator=(const StateChangesStream&) = delete;
+
+    /// Start consuming the stream on the context, the handler is called for each state change in order.
+    void open(StateChangeHandler handler, StreamStatusHandler status_handler = {});
+
+    /// Stop consuming the stream, can be called from any thread.
+    void close();
+
+    /// Consume the stream until closed.
+    asio::awaitable<void> run(StateChangeHandler handler, StreamStatusHandler status_handler = {});
+
+private:
+    Context& context_;
+    ChannelFactory create_channel_;
+    std::unique_ptr<StateChangesClient> client_;
+    asio::steady_timer retry_timer_;
+    bool closed_{false};
+};
+
+} // namespace silkrpc::ethdb::kv
+
+#endif // SILKRPC_ETHDB_KV_STATE_CHANGES_STREAM_HPP_
@@ -0,0 +1,109 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "state_changes_stream.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio/co_spawn.hpp>
+#include <asio/executor_work_guard.hpp>
+#include <catch2/catch.hpp>
+#include <google/protobuf/empty.pb.h>
+#include <grpcpp/grpcpp.h>
+
+#include <silkrpc/grpc/completion_runner.hpp>
+
+namespace silkrpc::ethdb::kv {
+
+using Catch::Matchers::Message;
+
+// Stand-in for the KV server notifying the given block heights at each stream opening
+class StandInKvService : public remote::KV::Service {
+public:
+    explicit StandInKvService(std::vector<uint64_t> block_heights) : block_heights_(block_heights) {}
+
+    grpc::Status ReceiveStateChanges(grpc::ServerContext* /*context*/, const google::protobuf::Empty* /*request*/,
+        grpc::ServerWriter<remote::StateChange>* writer) override {
+        ++num_calls_;
+        for (const auto block_height : block_heights_) {
+            remote::StateChange state_change;
+            state_change.set_direction(remote::Direction::FORWARD);
+            state_change.set_blockheight(block_height);
+            writer->Write(state_change);
+        }
+        return grpc::Status::OK;
+    }
+
+    int num_calls() const { return num_calls_; }
+
+private:
+    std::vector<uint64_t> block_heights_;
+    std::atomic_int num_calls_{0};
+};
+
+// Receive the state changes from the stand-in server until the expected number of changes
+static std::vector<uint64_t> receive_state_changes(StandInKvService& service, std::size_t expected_changes) {
+    int port{0};
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(&service);
+    auto server = builder.BuildAndStart();
+    ChannelFactory create_channel = [&]() {
+        return grpc::CreateChannel("localhost:" + std::to_string(port), grpc::InsecureChannelCredentials());
+    };
+
+    Context context{std::make_shared<asio::io_context>(), std::make_unique<grpc::CompletionQueue>()};
+    context.grpc_runner = std::make_unique<CompletionRunner>(*context.grpc_queue, *context.io_context);
+    std::thread completion_thread{[&]() { context.grpc_runner->run(); }};
+
+    std::vector<uint64_t> block_heights;
+    StateChangesStream stream{context, create_channel};
+    auto handler = [&](const remote::StateChange& state_change) -> asio::awaitable<void> {
+        block_heights.push_back(state_change.blockheight());
+        if (block_heights.size() == expected_changes) {
+            stream.close();
+        }
+        co_return;
+    };
+    auto work = asio::make_work_guard(*context.io_context);
+    asio::co_spawn(*context.io_context, stream.run(handler), [&](std::exception_ptr) { work.reset(); });
+    context.io_context->run();
+
+    context.grpc_runner->stop();
+    completion_thread.join();
+    server->Shutdown();
+    return block_heights;
+}
+
+TEST_CASE("StateChangesStream::run", "[silkrpc][ethdb][kv][state_changes_stream]") {
+    SECTION("changes are received in order") {
+        StandInKvService service{{1, 2, 3, 4, 5}};
+        CHECK(receive_state_changes(service, 5) == std::vector<uint64_t>{1, 2, 3, 4, 5});
+        CHECK(service.num_calls() == 1);
+    }
+
+    SECTION("stream is reopened when closed by server") {
+        StandInKvService service{{7}};
+        CHECK(receive_state_changes(service, 2) == std::vector<uint64_t>{7, 7});
+        CHECK(service.num_calls() == 2);
+    }
+}
+
+} // namespace silkrpc::ethdb::kv
@@ -17,6 +17,7 @@
 #ifndef SILKRPC_ETHDB_KV_STREAMING_CLIENT_HPP_
 #define SILKRPC_ETHDB_KV_STREAMING_CLIENT_HPP_
 
+#include <deque>
 #include <functional>
 #include <memory>
 
@@ -30,10 +31,27 @@ namespace silkrpc::ethdb::kv {
 
 typedef std::unique_ptr<grpc::ClientAsyncReaderWriterInterface<::remote::Cursor, ::remote::Pair>> ClientAsyncReaderWriterPtr;
 
+/// Client of one KV Tx stream. Cursor requests are pipelined: any number of them can be outstanding, they are written
+/// one after the other as soon as the previous write completes and their replies are matched in FIFO order.
 class StreamingClient final : public AsyncCompletionHandler {
-    enum CallStatus { CALL_IDLE, CALL_STARTED, READ_STARTED, WRITE_STARTED, DONE_STARTED, CALL_ENDED };
+    enum CallStatus { CALL_IDLE, CALL_STARTED, CALL_FAILED, DONE_STARTED, CALL_ENDED };
+
+    // The read and write sides of the stream can be in flight at the same time, so each one has its own tag
+    class SideCompletionHandler : public AsyncCompletionHandler {
+    public:
+        SideCompletionHandler(StreamingClient* client, void (StreamingClient::*side_completed)(bool))
+        : client_{client}, side_completed_{side_completed} {}
+
+        void completed(bool ok) override { (client_->*side_completed_)(ok); }
+
+    private:
+        StreamingClient* client_;
+        void (StreamingClient::*side_completed_)(bool);
+    };
 
 public:
+    typedef std::function<void(const grpc::Status&, ::remote::Pair)> ReplyCompleted;
+
     explicit StreamingClient(std::shared_ptr<grpc::Channel> channel, grpc::CompletionQueue* queue)
     : stub_{remote::KV::NewStub(channel)}, stream_{stub_->PrepareAsyncTx(&context_, queue)} {
         SILKRPC_TRACE << "StreamingClient::ctor " << this << " start\n";
@@ -55,29 +73,55 @@ public:
 
     void end_call(std::function<void(const grpc::Status&)> end_completed) {
         SILKRPC_TRACE << "StreamingClient::end_call " << this << " status: " << status_ << " start\n";
+        if (broken_) {
+            // The stream is already being finished because of a failure, end with its final status
+            if (finished_) {
+                end_completed(result_);
+            } else {
+                end_completed_ = end_completed;
+            }
+            return;
+        }
         end_completed_ = end_completed;
         status_ = DONE_STARTED;
-        stream_->WritesDone(this);
+        if (writing_) {
+            // Only one write operation can be in flight, so half-close after the last request has been written
+            writes_done_pending_ = true;
+        } else {
+            stream_->WritesDone(this);
+        }
         SILKRPC_TRACE << "StreamingClient::end_call " << this << " status: " << status_ << " end\n";
     }
 
-    void read_start(std::function<void(const grpc::Status&, ::remote::Pair)> read_completed) {
-        SILKRPC_TRACE << "StreamingClient::read_start " << this << " status: " << status_ << " start\n";
-        read_completed_ = read_completed;
-        status_ = READ_STARTED;
-        SILKRPC_TRACE << "StreamingClient::read_start " << this << " stream: " << stream_.get() << " BEFORE Read\n";
-        stream_->Read(&pair_, AsyncCompletionHandler::tag(this));
-        SILKRPC_TRACE << "StreamingClient::read_start " << this << " AFTER Read\n";
-        SILKRPC_TRACE << "StreamingClient::read_start " << this << " status: " << status_ << " end\n";
+    /// Send the cursor request: its reply is given to reply_completed after the replies of all the previous requests.
+    void request_start(const ::remote::Cursor& request, ReplyCompleted reply_completed) {
+        SILKRPC_TRACE << "StreamingClient::request_start " << this << " op: " << request.op() << " outstanding: " << pending_replies_.size() << "\n";
+        if (finished_) {
+            reply_completed(failure_status(), {});
+            return;
+        }
+        pending_replies_.push_back(std::move(reply_completed));
+        if (broken_) {
+            // Never written, it fails with the others when the stream is finished
+            return;
+        }
+        // The request in flight stays at the front of the queue until its write completes
+        pending_requests_.push_back(request);
+        if (!writing_) {
+            writing_ = true;
+            stream_->Write(pending_requests_.front(), AsyncCompletionHandler::tag(&write_handler_));
+        }
+        if (!reading_) {
+            reading_ = true;
+            stream_->Read(&pair_, AsyncCompletionHandler::tag(&read_handler_));
+        }
     }
 
-    void write_start(const ::remote::Cursor& cursor, std::function<void(const grpc::Status&)> write_completed) {
-        SILKRPC_TRACE << "StreamingClient::write_start " << this << " stream: " << stream_.get() << " status: " << status_ << " start\n";
-        write_completed_ = write_completed;
-        status_ = WRITE_STARTED;
-        stream_->Write(cursor, AsyncCompletionHandler::tag(this));
-        SILKRPC_TRACE << "StreamingClient::write_start " << this << " status: " << status_ << " end\n";
-    }
+    /// The number of requests whose reply has not been received yet.
+    std::size_t outstanding_requests() const { return pending_replies_.size(); }
+
+    /// Whether the stream has failed or is being finished, so no more requests can succeed.
+    bool broken() const { return broken_ || finishing_; }
 
     void completed(bool ok) override {
         SILKRPC_TRACE << "StreamingClient::completed " << this << " status: " << status_ << " ok: " << ok << " start\n";
@@ -92,16 +136,19 @@ public:
             SILKRPC_ERROR << "StreamingClient::completed error_message: " << result_.error_message() << "\n";
             SILKRPC_ERROR << "StreamingClient::completed error_details: " << result_.error_details() << "\n";
         }
+        if (finishing_) {
+            finished_ = true;
+            broken_ = true;
+            fail_pending_replies();
+        }
         switch (status_) {
             case CALL_STARTED:
                 start_completed_(result_);
             break;
-            case WRITE_STARTED:
-                write_completed_(result_);
-            break;
-            case READ_STARTED:
-                SILKRPC_TRACE << "StreamingClient::completed pair cursorid: " << pair_.cursorid() << "\n";
-                read_completed_(result_, pair_);
+            case CALL_FAILED:
+                if (end_completed_) {
+                    end_completed_(result_);
+                }
             break;
             case DONE_STARTED:
                 status_ = CALL_ENDED;
@@ -122,6 +169,67 @@ public:
     }
 
 private:
+    void write_completed(bool ok) {
+        SILKRPC_TRACE << "StreamingClient::write_completed " << this << " ok: " << ok << " queued: " << pending_requests_.size() << "\n";
+        if (!ok) {
+            // The read side fails as well because at least the reply to this write is pending, so finish from there
+            writing_ = false;
+            writes_done_pending_ = false;
+            broken_ = true;
+            pending_requests_.clear();
+            return;
+        }
+        pending_requests_.pop_front();
+        if (!pending_requests_.empty()) {
+            stream_->Write(pending_requests_.front(), AsyncCompletionHandler::tag(&write_handler_));
+            return;
+        }
+        writing_ = false;
+        if (writes_done_pending_) {
+            writes_done_pending_ = false;
+            stream_->WritesDone(this);
+        }
+    }
+
+    void read_completed(bool ok) {
+        SILKRPC_TRACE << "StreamingClient::read_completed " << this << " ok: " << ok << " outstanding: " << pending_replies_.size() << "\n";
+        if (!ok) {
+            reading_ = false;
+            broken_ = true;
+            if (!finishing_) {
+                finishing_ = true;
+                status_ = CALL_FAILED;
+                stream_->Finish(&result_, AsyncCompletionHandler::tag(this));
+            } else if (finished_) {
+                fail_pending_replies();
+            }
+            return;
+        }
+        SILKRPC_TRACE << "StreamingClient::read_completed pair cursorid: " << pair_.cursorid() << "\n";
+        auto reply_completed = std::move(pending_replies_.front());
+        pending_replies_.pop_front();
+        auto pair = std::move(pair_);
+        if (pending_replies_.empty()) {
+            reading_ = false;
+        } else {
+            stream_->Read(&pair_, AsyncCompletionHandler::tag(&read_handler_));
+        }
+        reply_completed(grpc::Status::OK, std::move(pair));
+    }
+
+    grpc::Status failure_status() const {
+        return result_.ok() ? grpc::Status{grpc::StatusCode::ABORTED, "KV Tx stream closed with outstanding requests"} : result_;
+    }
+
+    void fail_pending_replies() {
+        const auto status = failure_status();
+        while (!pending_replies_.empty()) {
+            auto reply_completed = std::move(pending_replies_.front());
+            pending_replies_.pop_front();
+            reply_completed(status, {});
+        }
+    }
+
     std::unique_ptr<remote::KV::Stub> stub_;
     grpc::ClientContext context_;
     ClientAsyncReaderWriterPtr stream_;
@@ -129,9 +237,16 @@ private:
     grpc::Status result_;
     CallStatus status_;
     bool finishing_{false};
+    bool finished_{false};
+    bool broken_{false};
+    bool reading_{false};
+    bool writing_{false};
+    bool writes_done_pending_{false};
+    SideCompletionHandler read_handler_{this, &StreamingClient::read_completed};
+    SideCompletionHandler write_handler_{this, &StreamingClient::write_completed};
+    std::deque<::remote::Cursor> pending_requests_;
+    std::deque<ReplyCompleted> pending_replies_;
     std::function<void(const grpc::Status&)> start_completed_;
-    std::function<void(const grpc::Status&, remote::Pair)> read_completed_;
-    std::function<void(const grpc::Status&)> write_completed_;
     std::function<void(const grpc::Status&)> end_completed_;
 };
 
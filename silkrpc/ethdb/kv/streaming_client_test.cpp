@@ -0,0 +1,203 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "streaming_client.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio/executor_work_guard.hpp>
+#include <asio/io_context.hpp>
+#include <asio/post.hpp>
+#include <catch2/catch.hpp>
+#include <grpcpp/grpcpp.h>
+
+#include <silkrpc/grpc/completion_runner.hpp>
+
+namespace silkrpc::ethdb::kv {
+
+using Catch::Matchers::Message;
+
+// Stand-in for the KV server replying to each cursor request with its cursor id, failing the stream at the given request if any
+class StandInTxService : public remote::KV::Service {
+public:
+    explicit StandInTxService(std::size_t failing_request = 0) : failing_request_{failing_request} {}
+
+    grpc::Status Tx(grpc::ServerContext* /*context*/, grpc::ServerReaderWriter<remote::Pair, remote::Cursor>* stream) override {
+        remote::Cursor request;
+        while (stream->Read(&request)) {
+            if (++num_requests_ == failing_request_) {
+                return grpc::Status{grpc::StatusCode::UNAVAILABLE, "kv unavailable"};
+            }
+            remote::Pair reply;
+            reply.set_cursorid(request.cursor());
+            stream->Write(reply);
+        }
+        return grpc::Status::OK;
+    }
+
+    std::size_t num_requests() const { return num_requests_; }
+
+private:
+    std::size_t failing_request_;
+    std::atomic_size_t num_requests_{0};
+};
+
+// The client completions are dispatched on the io_context run by the test thread, as the remote transactions do
+class StreamingClientTest {
+public:
+    explicit StreamingClientTest(StandInTxService& service) {
+        grpc::ServerBuilder builder;
+        builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(), &port);
+        builder.RegisterService(&service);
+        server = builder.BuildAndStart();
+        channel = grpc::CreateChannel("localhost:" + std::to_string(port), grpc::InsecureChannelCredentials());
+        completion_thread = std::thread{[&]() { runner.run(); }};
+    }
+
+    ~StreamingClientTest() {
+        runner.stop();
+        completion_thread.join();
+        server->Shutdown();
+    }
+
+    // Run the test body on the io_context until it calls the given completion
+    void run(std::function<void(std::function<void()>)> body) {
+        auto work = asio::make_work_guard(io_context);
+        asio::post(io_context, [&]() { body([&]() { work.reset(); }); });
+        io_context.run();
+    }
+
+    int port{0};
+    std::unique_ptr<grpc::Server> server;
+    std::shared_ptr<grpc::Channel> channel;
+    asio::io_context io_context;
+    grpc::CompletionQueue queue;
+    CompletionRunner runner{queue, io_context};
+    std::thread completion_thread;
+};
+
+static remote::Cursor make_request(uint32_t cursor_id) {
+    remote::Cursor request;
+    request.set_op(remote::Op::NEXT);
+    request.set_cursor(cursor_id);
+    return request;
+}
+
+TEST_CASE("StreamingClient::request_start", "[silkrpc][ethdb][kv][streaming_client]") {
+    SECTION("outstanding requests matched in FIFO order") {
+        StandInTxService service;
+        StreamingClientTest test{service};
+        StreamingClient client{test.channel, &test.queue};
+        std::size_t outstanding_requests{0};
+        std::vector<uint32_t> cursor_ids;
+        grpc::Status end_status{grpc::StatusCode::UNKNOWN, ""};
+        test.run([&](std::function<void()> done) {
+            client.start_call([&, done](const grpc::Status& start_status) {
+                CHECK(start_status.ok());
+                for (uint32_t cursor_id{1}; cursor_id <= 3; ++cursor_id) {
+                    client.request_start(make_request(cursor_id), [&, done](const grpc::Status& status, remote::Pair pair) {
+                        CHECK(status.ok());
+                        cursor_ids.push_back(pair.cursorid());
+                        if (cursor_ids.size() == 3) {
+                            client.end_call([&, done](const grpc::Status& status) { end_status = status; done(); });
+                        }
+                    });
+                }
+                outstanding_requests = client.outstanding_requests();
+            });
+        });
+        CHECK(outstanding_requests == 3);
+        CHECK(cursor_ids == std::vector<uint32_t>{1, 2, 3});
+        CHECK(client.outstanding_requests() == 0);
+        CHECK(end_status.ok());
+        CHECK(service.num_requests() == 3);
+    }
+
+    SECTION("stream broken with requests queued") {
+        StandInTxService service{1};
+        StreamingClientTest test{service};
+        StreamingClient client{test.channel, &test.queue};
+        std::vector<grpc::StatusCode> reply_codes;
+        grpc::StatusCode late_reply_code{grpc::StatusCode::OK};
+        grpc::Status end_status;
+        test.run([&](std::function<void()> done) {
+            client.start_call([&, done](const grpc::Status& start_status) {
+                CHECK(start_status.ok());
+                for (uint32_t cursor_id{1}; cursor_id <= 3; ++cursor_id) {
+                    client.request_start(make_request(cursor_id), [&, done](const grpc::Status& status, remote::Pair /*pair*/) {
+                        reply_codes.push_back(status.error_code());
+                        if (reply_codes.size() < 3) {
+                            return;
+                        }
+                        // The stream is finished, so any further request fails right away
+                        CHECK(client.broken());
+                        client.request_start(make_request(4), [&](const grpc::Status& status, remote::Pair /*pair*/) {
+                            late_reply_code = status.error_code();
+                        });
+                        client.end_call([&, done](const grpc::Status& status) { end_status = status; done(); });
+                    });
+                }
+            });
+        });
+        CHECK(reply_codes == std::vector<grpc::StatusCode>(3, grpc::StatusCode::UNAVAILABLE));
+        CHECK(late_reply_code == grpc::StatusCode::UNAVAILABLE);
+        CHECK(end_status.error_code() == grpc::StatusCode::UNAVAILABLE);
+        CHECK(end_status.error_message() == "kv unavailable");
+        CHECK(client.outstanding_requests() == 0);
+    }
+}
+
+TEST_CASE("StreamingClient::end_call", "[silkrpc][ethdb][kv][streaming_client]") {
+    SECTION("while a write is in flight") {
+        StandInTxService service;
+        StreamingClientTest test{service};
+        StreamingClient client{test.channel, &test.queue};
+        grpc::Status reply_status{grpc::StatusCode::UNKNOWN, ""};
+        uint32_t reply_cursor_id{0};
+        grpc::Status end_status{grpc::StatusCode::UNKNOWN, ""};
+        int completions{0};
+        test.run([&](std::function<void()> done) {
+            client.start_call([&, done](const grpc::Status& start_status) {
+                CHECK(start_status.ok());
+                client.request_start(make_request(7), [&, done](const grpc::Status& status, remote::Pair pair) {
+                    reply_status = status;
+                    reply_cursor_id = pair.cursorid();
+                    if (++completions == 2) {
+                        done();
+                    }
+                });
+                // The write just started is still in flight, so the half-close must wait for its completion
+                client.end_call([&, done](const grpc::Status& status) {
+                    end_status = status;
+                    if (++completions == 2) {
+                        done();
+                    }
+                });
+            });
+        });
+        CHECK(reply_status.ok());
+        CHECK(reply_cursor_id == 7);
+        CHECK(end_status.ok());
+        CHECK(service.num_requests() == 1);
+    }
+}
+
+} // namespace silkrpc::ethdb::kv
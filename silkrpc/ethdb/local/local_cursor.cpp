@@ -0,0 +1,103 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "local_cursor.hpp"
+
+#include <silkrpc/common/clock_time.hpp>
+#include <silkrpc/common/log.hpp>
+
+namespace silkrpc::ethdb::local {
+
+LocalCursor::~LocalCursor() {
+    if (cursor_ != nullptr) {
+        mdbx_cursor_close(cursor_);
+    }
+}
+
+asio::awaitable<void> LocalCursor::open_cursor(const std::string& table_name) {
+    const auto start_time = clock_time::now();
+    if (cursor_ == nullptr) {
+        // Opening the table reads the main database, so it may block as well
+        cursor_ = co_await run_on_workers(io_context_, workers_, [&]() {
+            MDBX_dbi dbi{0};
+            throw_on_error(mdbx_dbi_open(txn_, table_name.c_str(), MDBX_DB_ACCEDE, &dbi), "mdbx_dbi_open");
+            MDBX_cursor* cursor{nullptr};
+            throw_on_error(mdbx_cursor_open(txn_, dbi, &cursor), "mdbx_cursor_open");
+            return cursor;
+        });
+    }
+    SILKRPC_DEBUG << "LocalCursor::open_cursor [" << table_name << "] c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
+    co_return;
+}
+
+asio::awaitable<KeyValue> LocalCursor::seek(const silkworm::ByteView& key) {
+    SILKRPC_DEBUG << "LocalCursor::seek cursor: " << cursor_id_ << " key: " << key << "\n";
+    co_return co_await run_on_workers(io_context_, workers_, [&]() {
+        return key.empty() ? get({}, {}, MDBX_FIRST) : get(to_mdbx_val(key), {}, MDBX_SET_RANGE);
+    });
+}
+
+asio::awaitable<KeyValue> LocalCursor::seek_exact(const silkworm::ByteView& key) {
+    SILKRPC_DEBUG << "LocalCursor::seek_exact cursor: " << cursor_id_ << " key: " << key << "\n";
+    co_return co_await run_on_workers(io_context_, workers_, [&]() { return get(to_mdbx_val(key), {}, MDBX_SET_KEY); });
+}
+
+asio::awaitable<KeyValue> LocalCursor::next() {
+    co_return co_await run_on_workers(io_context_, workers_, [&]() { return get({}, {}, MDBX_NEXT); });
+}
+
+asio::awaitable<std::vector<KeyValue>> LocalCursor::next_batch(std::size_t count) {
+    co_return co_await run_on_workers(io_context_, workers_, [&]() {
+        std::vector<KeyValue> kv_pairs;
+        kv_pairs.reserve(count);
+        for (std::size_t i{0}; i < count; ++i) {
+            kv_pairs.push_back(get({}, {}, MDBX_NEXT));
+        }
+        return kv_pairs;
+    });
+}
+
+asio::awaitable<void> LocalCursor::close_cursor() {
+    if (cursor_ != nullptr) {
+        mdbx_cursor_close(cursor_);
+        cursor_ = nullptr;
+    }
+    SILKRPC_DEBUG << "LocalCursor::close_cursor c=" << cursor_id_ << "\n";
+    co_return;
+}
+
+asio::awaitable<silkworm::Bytes> LocalCursor::seek_both(const silkworm::ByteView& key, const silkworm::ByteView& value) {
+    SILKRPC_DEBUG << "LocalCursor::seek_both cursor: " << cursor_id_ << " key: " << key << " subkey: " << value << "\n";
+    co_return co_await run_on_workers(io_context_, workers_, [&]() {
+        return silkworm::Bytes{get(to_mdbx_val(key), to_mdbx_val(value), MDBX_GET_BOTH_RANGE).value};
+    });
+}
+
+asio::awaitable<KeyValue> LocalCursor::seek_both_exact(const silkworm::ByteView& key, const silkworm::ByteView& value) {
+    SILKRPC_DEBUG << "LocalCursor::seek_both_exact cursor: " << cursor_id_ << " key: " << key << " subkey: " << value << "\n";
+    co_return co_await run_on_workers(io_context_, workers_, [&]() { return get(to_mdbx_val(key), to_mdbx_val(value), MDBX_GET_BOTH); });
+}
+
+KeyValue LocalCursor::get(MDBX_val key, MDBX_val value, MDBX_cursor_op operation) {
+    const auto result_code = mdbx_cursor_get(cursor_, &key, &value, operation);
+    if (result_code == MDBX_NOTFOUND) {
+        return KeyValue{};
+    }
+    throw_on_error(result_code, "mdbx_cursor_get");
+    return KeyValue{silkworm::Bytes{to_byte_view(key)}, silkworm::Bytes{to_byte_view(value)}};
+}
+
+} // namespace silkrpc::ethdb::local
@@ -0,0 +1,78 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_ETHDB_LOCAL_LOCAL_CURSOR_HPP_
+#define SILKRPC_ETHDB_LOCAL_LOCAL_CURSOR_HPP_
+
+#include <silkrpc/config.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <asio/awaitable.hpp>
+#include <asio/io_context.hpp>
+#include <asio/thread_pool.hpp>
+
+#include <silkworm/common/util.hpp>
+#include <silkrpc/common/util.hpp>
+#include <silkrpc/ethdb/cursor.hpp>
+#include <silkrpc/ethdb/local/mdbx.hpp>
+
+namespace silkrpc::ethdb::local {
+
+class LocalCursor : public CursorDupSort {
+public:
+    explicit LocalCursor(asio::io_context& io_context, asio::thread_pool& workers, MDBX_txn* txn, uint32_t cursor_id)
+    : io_context_(io_context), workers_(workers), txn_(txn), cursor_id_{cursor_id} {}
+
+    ~LocalCursor();
+
+    LocalCursor(const LocalCursor&) = delete;
+    LocalCursor& operator=(const LocalCursor&) = delete;
+
+    uint32_t cursor_id() const override { return cursor_id_; };
+
+    asio::awaitable<void> open_cursor(const std::string& table_name) override;
+
+    asio::awaitable<KeyValue> seek(const silkworm::ByteView& key) override;
+
+    asio::awaitable<KeyValue> seek_exact(const silkworm::ByteView& key) override;
+
+    asio::awaitable<KeyValue> next() override;
+
+    asio::awaitable<std::vector<KeyValue>> next_batch(std::size_t count) override;
+
+    asio::awaitable<void> close_cursor() override;
+
+    asio::awaitable<silkworm::Bytes> seek_both(const silkworm::ByteView& key, const silkworm::ByteView& value) override;
+
+    asio::awaitable<KeyValue> seek_both_exact(const silkworm::ByteView& key, const silkworm::ByteView& value) override;
+
+private:
+    /// Position the cursor as requested by the operation: an empty pair means not found, as in the remote KV interface
+    KeyValue get(MDBX_val key, MDBX_val value, MDBX_cursor_op operation);
+
+    asio::io_context& io_context_;
+    asio::thread_pool& workers_;
+    MDBX_txn* txn_;
+    MDBX_cursor* cursor_{nullptr};
+    uint32_t cursor_id_;
+};
+
+} // namespace silkrpc::ethdb::local
+
+#endif  // SILKRPC_ETHDB_LOCAL_LOCAL_CURSOR_HPP_
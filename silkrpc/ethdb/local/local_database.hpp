@@ -0,0 +1,62 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_ETHDB_LOCAL_LOCAL_DATABASE_HPP_
+#define SILKRPC_ETHDB_LOCAL_LOCAL_DATABASE_HPP_
+
+#include <memory>
+
+#include <asio/io_context.hpp>
+#include <asio/thread_pool.hpp>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/ethdb/database.hpp>
+#include <silkrpc/ethdb/local/local_transaction.hpp>
+#include <silkrpc/ethdb/local/mdbx.hpp>
+
+namespace silkrpc::ethdb::local {
+
+/// Database reading the chain data directly from the MDBX environment, when running on the same host as Erigon.
+class LocalDatabase: public Database {
+public:
+    LocalDatabase(asio::io_context& io_context, std::shared_ptr<Environment> env, asio::thread_pool& workers)
+    : io_context_(io_context), env_(env), workers_(workers) {
+        SILKRPC_TRACE << "LocalDatabase::ctor " << this << "\n";
+    }
+
+    ~LocalDatabase() {
+        SILKRPC_TRACE << "LocalDatabase::dtor " << this << "\n";
+    }
+
+    LocalDatabase(const LocalDatabase&) = delete;
+    LocalDatabase& operator=(const LocalDatabase&) = delete;
+
+    asio::awaitable<std::unique_ptr<Transaction>> begin() override {
+        auto txn = std::make_unique<LocalTransaction>(io_context_, env_, workers_);
+        co_await txn->open();
+        SILKRPC_TRACE << "LocalDatabase::begin " << this << " txn: " << txn.get() << "\n";
+        co_return txn;
+    }
+
+private:
+    asio::io_context& io_context_;
+    std::shared_ptr<Environment> env_;
+    asio::thread_pool& workers_;
+};
+
+} // namespace silkrpc::ethdb::local
+
+#endif  // SILKRPC_ETHDB_LOCAL_LOCAL_DATABASE_HPP_
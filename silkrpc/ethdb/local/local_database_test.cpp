@@ -0,0 +1,125 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "local_database.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <asio/co_spawn.hpp>
+#include <asio/io_context.hpp>
+#include <asio/thread_pool.hpp>
+#include <asio/use_future.hpp>
+#include <catch2/catch.hpp>
+
+namespace silkrpc::ethdb::local {
+
+// Chain data fixture with one plain table and one dupsort table, removed at the end
+class ChainDataFixture {
+public:
+    ChainDataFixture() : path_{std::filesystem::temp_directory_path() / ("silkrpc_local_database_test_" + std::to_string(::getpid()))} {
+        std::filesystem::create_directories(path_);
+        MDBX_env* env{nullptr};
+        throw_on_error(mdbx_env_create(&env), "mdbx_env_create");
+        throw_on_error(mdbx_env_set_maxdbs(env, 2), "mdbx_env_set_maxdbs");
+        throw_on_error(mdbx_env_open(env, path_.c_str(), MDBX_ENV_DEFAULTS, 0644), "mdbx_env_open");
+        MDBX_txn* txn{nullptr};
+        throw_on_error(mdbx_txn_begin(env, nullptr, MDBX_TXN_READWRITE, &txn), "mdbx_txn_begin");
+        put(txn, "Table", MDBX_DB_DEFAULTS, {{{0x01}, {0x0A}}, {{0x02}, {0x0B}}, {{0x04}, {0x0D}}});
+        put(txn, "DupTable", MDBX_DUPSORT, {{{0x01}, {0x10, 0xAA}}, {{0x01}, {0x20, 0xBB}}, {{0x02}, {0x10, 0xCC}}});
+        throw_on_error(mdbx_txn_commit(txn), "mdbx_txn_commit");
+        mdbx_env_close(env);
+    }
+
+    ~ChainDataFixture() {
+        std::filesystem::remove_all(path_);
+    }
+
+    std::string path() const { return path_.string(); }
+
+private:
+    static void put(MDBX_txn* txn, const char* table, MDBX_db_flags_t flags, const std::vector<KeyValue>& kv_pairs) {
+        MDBX_dbi dbi{0};
+        throw_on_error(mdbx_dbi_open(txn, table, MDBX_CREATE | flags, &dbi), "mdbx_dbi_open");
+        for (const auto& kv_pair : kv_pairs) {
+            auto key = to_mdbx_val(kv_pair.key);
+            auto value = to_mdbx_val(kv_pair.value);
+            throw_on_error(mdbx_put(txn, dbi, &key, &value, MDBX_UPSERT), "mdbx_put");
+        }
+    }
+
+    std::filesystem::path path_;
+};
+
+template <typename T>
+static T run(asio::io_context& io_context, asio::awaitable<T> awaitable) {
+    auto result = asio::co_spawn(io_context, std::move(awaitable), asio::use_future);
+    io_context.run();
+    io_context.restart();
+    return result.get();
+}
+
+TEST_CASE("LocalDatabase", "[silkrpc][ethdb][local][local_database]") {
+    ChainDataFixture fixture;
+    asio::io_context io_context;
+    asio::thread_pool workers{1};
+    LocalDatabase database{io_context, std::make_shared<Environment>(fixture.path()), workers};
+    auto tx = run(io_context, database.begin());
+
+    SECTION("seek and next") {
+        auto cursor = run(io_context, tx->cursor("Table"));
+        auto kv_pair = run(io_context, cursor->seek(silkworm::Bytes{0x03}));
+        CHECK(kv_pair.key == silkworm::Bytes{0x04});
+        CHECK(kv_pair.value == silkworm::Bytes{0x0D});
+        kv_pair = run(io_context, cursor->seek(silkworm::Bytes{}));
+        CHECK(kv_pair.key == silkworm::Bytes{0x01});
+        kv_pair = run(io_context, cursor->next());
+        CHECK(kv_pair.key == silkworm::Bytes{0x02});
+        const auto kv_pairs = run(io_context, cursor->next_batch(2));
+        REQUIRE(kv_pairs.size() == 2);
+        CHECK(kv_pairs[0].key == silkworm::Bytes{0x04});
+        CHECK(kv_pairs[1].key.empty());
+        CHECK(run(io_context, cursor->seek(silkworm::Bytes{0x05})).key.empty());
+    }
+
+    SECTION("seek exact") {
+        auto cursor = run(io_context, tx->cursor("Table"));
+        CHECK(run(io_context, cursor->seek_exact(silkworm::Bytes{0x02})).value == silkworm::Bytes{0x0B});
+        CHECK(run(io_context, cursor->seek_exact(silkworm::Bytes{0x03})).key.empty());
+    }
+
+    SECTION("seek both") {
+        auto cursor = run(io_context, tx->cursor_dup_sort("DupTable"));
+        CHECK(run(io_context, cursor->seek_both(silkworm::Bytes{0x01}, silkworm::Bytes{0x15})) == silkworm::Bytes{0x20, 0xBB});
+        CHECK(run(io_context, cursor->seek_both(silkworm::Bytes{0x02}, silkworm::Bytes{0x15})).empty());
+        const auto kv_pair = run(io_context, cursor->seek_both_exact(silkworm::Bytes{0x01}, silkworm::Bytes{0x10, 0xAA}));
+        CHECK(kv_pair.key == silkworm::Bytes{0x01});
+        CHECK(kv_pair.value == silkworm::Bytes{0x10, 0xAA});
+        CHECK(run(io_context, cursor->next()).value == silkworm::Bytes{0x20, 0xBB});
+    }
+
+    SECTION("unknown table") {
+        CHECK_THROWS(run(io_context, tx->cursor("UnknownTable")));
+    }
+
+    run(io_context, tx->close());
+}
+
+} // namespace silkrpc::ethdb::local
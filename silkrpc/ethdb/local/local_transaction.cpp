@@ -0,0 +1,71 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "local_transaction.hpp"
+
+namespace silkrpc::ethdb::local {
+
+LocalTransaction::~LocalTransaction() {
+    SILKRPC_TRACE << "LocalTransaction::dtor " << this << "\n";
+    cursors_.clear();
+    if (txn_ != nullptr) {
+        mdbx_txn_abort(txn_);
+    }
+}
+
+asio::awaitable<void> LocalTransaction::open() {
+    // Starting a read-only transaction just registers a reader slot, it does not touch the data pages
+    throw_on_error(mdbx_txn_begin(env_->handle(), nullptr, MDBX_TXN_RDONLY, &txn_), "mdbx_txn_begin");
+    co_return;
+}
+
+asio::awaitable<std::shared_ptr<Cursor>> LocalTransaction::cursor(const std::string& table) {
+    co_return co_await get_cursor(table);
+}
+
+asio::awaitable<std::shared_ptr<CursorDupSort>> LocalTransaction::cursor_dup_sort(const std::string& table) {
+    co_return co_await get_cursor(table);
+}
+
+asio::awaitable<std::shared_ptr<CursorDupSort>> LocalTransaction::new_cursor(const std::string& table) {
+    auto cursor = std::make_shared<LocalCursor>(io_context_, workers_, txn_, ++last_cursor_id_);
+    co_await cursor->open_cursor(table);
+    co_return cursor;
+}
+
+asio::awaitable<void> LocalTransaction::close() {
+    for (const auto& [table, cursor] : cursors_) {
+        co_await cursor->close_cursor();
+    }
+    cursors_.clear();
+    if (txn_ != nullptr) {
+        mdbx_txn_abort(txn_);
+        txn_ = nullptr;
+    }
+    co_return;
+}
+
+asio::awaitable<std::shared_ptr<CursorDupSort>> LocalTransaction::get_cursor(const std::string& table) {
+    auto cursor_it = cursors_.find(table);
+    if (cursor_it != cursors_.end()) {
+        co_return cursor_it->second;
+    }
+    auto cursor = co_await new_cursor(table);
+    cursors_[table] = cursor;
+    co_return cursor;
+}
+
+} // namespace silkrpc::ethdb::local
@@ -0,0 +1,70 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_ETHDB_LOCAL_LOCAL_TRANSACTION_HPP_
+#define SILKRPC_ETHDB_LOCAL_LOCAL_TRANSACTION_HPP_
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <silkrpc/config.hpp>
+
+#include <asio/io_context.hpp>
+#include <asio/thread_pool.hpp>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/ethdb/cursor.hpp>
+#include <silkrpc/ethdb/local/local_cursor.hpp>
+#include <silkrpc/ethdb/local/mdbx.hpp>
+#include <silkrpc/ethdb/transaction.hpp>
+
+namespace silkrpc::ethdb::local {
+
+/// Read-only transaction on the local chain data: the cursor operations complete without any network hop.
+class LocalTransaction : public Transaction {
+public:
+    explicit LocalTransaction(asio::io_context& io_context, std::shared_ptr<Environment> env, asio::thread_pool& workers)
+    : io_context_(io_context), env_(env), workers_(workers) {
+        SILKRPC_TRACE << "LocalTransaction::ctor " << this << "\n";
+    }
+
+    ~LocalTransaction();
+
+    asio::awaitable<void> open() override;
+
+    asio::awaitable<std::shared_ptr<Cursor>> cursor(const std::string& table) override;
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> cursor_dup_sort(const std::string& table) override;
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> new_cursor(const std::string& table) override;
+
+    asio::awaitable<void> close() override;
+
+private:
+    asio::awaitable<std::shared_ptr<CursorDupSort>> get_cursor(const std::string& table);
+
+    asio::io_context& io_context_;
+    std::shared_ptr<Environment> env_;
+    asio::thread_pool& workers_;
+    MDBX_txn* txn_{nullptr};
+    uint32_t last_cursor_id_{0};
+    std::map<std::string, std::shared_ptr<CursorDupSort>> cursors_;
+};
+
+} // namespace silkrpc::ethdb::local
+
+#endif  // SILKRPC_ETHDB_LOCAL_LOCAL_TRANSACTION_HPP_
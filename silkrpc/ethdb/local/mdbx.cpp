@@ -0,0 +1,50 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "mdbx.hpp"
+
+#include <stdexcept>
+
+#include <silkrpc/common/log.hpp>
+
+namespace silkrpc::ethdb::local {
+
+void throw_on_error(int result_code, const char* operation) {
+    if (result_code != MDBX_SUCCESS) {
+        throw std::runtime_error{std::string{operation} + " failed: " + mdbx_strerror(result_code)};
+    }
+}
+
+Environment::Environment(const std::string& path, unsigned int max_readers) {
+    throw_on_error(mdbx_env_create(&env_), "mdbx_env_create");
+    try {
+        throw_on_error(mdbx_env_set_maxdbs(env_, kDefaultMaxTables), "mdbx_env_set_maxdbs");
+        throw_on_error(mdbx_env_set_maxreaders(env_, max_readers), "mdbx_env_set_maxreaders");
+        // Accede to the mode of the environment, which is usually opened in read-write mode by Erigon at the same time
+        const MDBX_env_flags_t flags = MDBX_RDONLY | MDBX_NOTLS | MDBX_ACCEDE;
+        throw_on_error(mdbx_env_open(env_, path.c_str(), flags, 0644), "mdbx_env_open");
+    } catch (...) {
+        mdbx_env_close(env_);
+        throw;
+    }
+    SILKRPC_INFO << "Environment::ctor chaindata opened: " << path << "\n";
+}
+
+Environment::~Environment() {
+    mdbx_env_close(env_);
+}
+
+} // namespace silkrpc::ethdb::local
@@ -0,0 +1,97 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_ETHDB_LOCAL_MDBX_HPP_
+#define SILKRPC_ETHDB_LOCAL_MDBX_HPP_
+
+#include <silkrpc/config.hpp>
+
+#include <exception>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <asio/async_result.hpp>
+#include <asio/awaitable.hpp>
+#include <asio/io_context.hpp>
+#include <asio/post.hpp>
+#include <asio/thread_pool.hpp>
+#include <asio/use_awaitable.hpp>
+#include <mdbx.h>
+
+#include <silkworm/common/util.hpp>
+
+namespace silkrpc::ethdb::local {
+
+constexpr unsigned int kDefaultMaxTables{256};
+constexpr unsigned int kDefaultMaxReaders{4096};
+
+/// Throw std::runtime_error describing the MDBX error code, if the operation has failed.
+void throw_on_error(int result_code, const char* operation);
+
+inline silkworm::ByteView to_byte_view(const MDBX_val& value) {
+    return {static_cast<const uint8_t*>(value.iov_base), value.iov_len};
+}
+
+inline MDBX_val to_mdbx_val(const silkworm::ByteView& bytes) {
+    return {const_cast<uint8_t*>(bytes.data()), bytes.length()};
+}
+
+/// Read-only MDBX environment of the chain data, shared by all the contexts.
+/// Transactions are not bound to the thread that started them, so their operations can run on any worker.
+class Environment {
+public:
+    explicit Environment(const std::string& path, unsigned int max_readers = kDefaultMaxReaders);
+    ~Environment();
+
+    Environment(const Environment&) = delete;
+    Environment& operator=(const Environment&) = delete;
+
+    MDBX_env* handle() const { return env_; }
+
+private:
+    MDBX_env* env_{nullptr};
+};
+
+/// Run the blocking operation on the workers, so that page faults do not stall the other requests on the context,
+/// then resume on the io_context with its result or exception.
+template <typename Operation>
+asio::awaitable<std::invoke_result_t<Operation>> run_on_workers(asio::io_context& io_context, asio::thread_pool& workers, Operation operation) {
+    std::invoke_result_t<Operation> result{};
+    std::exception_ptr eptr;
+    co_await asio::async_compose<decltype(asio::use_awaitable), void()>(
+        [&](auto&& self) {
+            asio::post(workers, [&, self = std::move(self)]() mutable {
+                try {
+                    result = operation();
+                } catch (...) {
+                    eptr = std::current_exception();
+                }
+                asio::post(io_context, [self = std::move(self)]() mutable {
+                    self.complete();
+                });
+            });
+        },
+        asio::use_awaitable);
+    if (eptr) {
+        std::rethrow_exception(eptr);
+    }
+    co_return result;
+}
+
+} // namespace silkrpc::ethdb::local
+
+#endif  // SILKRPC_ETHDB_LOCAL_MDBX_HPP_
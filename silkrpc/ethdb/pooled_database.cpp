@@ -0,0 +1,97 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "pooled_database.hpp"
+
+#include <exception>
+#include <utility>
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+
+#include <silkrpc/common/log.hpp>
+
+namespace silkrpc::ethdb {
+
+asio::awaitable<std::unique_ptr<Transaction>> PooledDatabase::begin() {
+    if (!pooling()) {
+        co_return co_await database_->begin();
+    }
+    // The most recently released transactions are the most likely to be still fresh
+    while (!idle_transactions_.empty()) {
+        auto lease = std::move(idle_transactions_.back());
+        idle_transactions_.pop_back();
+        if (fresh(lease)) {
+            SILKRPC_TRACE << "PooledDatabase::begin " << this << " reused tx: " << lease.tx.get() << "\n";
+            co_return std::make_unique<PooledTransaction>(*this, std::move(lease));
+        }
+        retire(std::move(lease.tx));
+    }
+    // Take the version before opening: if the head moves meanwhile the new transaction is not reused
+    const auto version = settings_.head_version->current();
+    const auto opened_at = std::chrono::steady_clock::now();
+    auto tx = co_await database_->begin();
+    SILKRPC_TRACE << "PooledDatabase::begin " << this << " opened tx: " << tx.get() << "\n";
+    co_return std::make_unique<PooledTransaction>(*this, Lease{std::move(tx), version, opened_at});
+}
+
+bool PooledDatabase::fresh(const Lease& lease) const {
+    const auto& head_version = *settings_.head_version;
+    return head_version.tracked() && lease.version == head_version.current() &&
+        std::chrono::steady_clock::now() - lease.opened_at < settings_.max_transaction_age;
+}
+
+void PooledDatabase::release(Lease lease) {
+    if (lease.tx->reusable() && fresh(lease) && idle_transactions_.size() < settings_.max_idle_transactions) {
+        idle_transactions_.push_back(std::move(lease));
+        return;
+    }
+    retire(std::move(lease.tx));
+}
+
+void PooledDatabase::retire(std::unique_ptr<Transaction> tx) {
+    // Nobody is waiting for the closure, so do not make the current request pay for it
+    auto close = [](std::unique_ptr<Transaction> tx) -> asio::awaitable<void> {
+        try {
+            co_await tx->close();
+        } catch (const std::exception& e) {
+            SILKRPC_WARN << "PooledDatabase::retire closing tx: " << tx.get() << " exception: " << e.what() << "\n";
+        }
+    };
+    asio::co_spawn(io_context_, close(std::move(tx)), asio::detached);
+}
+
+asio::awaitable<std::shared_ptr<Cursor>> PooledTransaction::cursor(const std::string& table) {
+    co_return co_await lease_.tx->cursor(table);
+}
+
+asio::awaitable<std::shared_ptr<CursorDupSort>> PooledTransaction::cursor_dup_sort(const std::string& table) {
+    co_return co_await lease_.tx->cursor_dup_sort(table);
+}
+
+asio::awaitable<std::shared_ptr<CursorDupSort>> PooledTransaction::new_cursor(const std::string& table) {
+    co_return co_await lease_.tx->new_cursor(table);
+}
+
+asio::awaitable<void> PooledTransaction::close() {
+    if (lease_.tx) {
+        database_.release(std::move(lease_));
+        lease_.tx.reset();
+    }
+    co_return;
+}
+
+} // namespace silkrpc::ethdb
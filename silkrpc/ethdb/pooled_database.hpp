@@ -0,0 +1,134 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_ETHDB_POOLED_DATABASE_HPP_
+#define SILKRPC_ETHDB_POOLED_DATABASE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <silkrpc/config.hpp>
+
+#include <asio/awaitable.hpp>
+#include <asio/io_context.hpp>
+
+#include <silkrpc/common/constants.hpp>
+#include <silkrpc/ethdb/cursor.hpp>
+#include <silkrpc/ethdb/database.hpp>
+#include <silkrpc/ethdb/transaction.hpp>
+
+namespace silkrpc::ethdb {
+
+/// Version of the chain state shared by all the contexts, advanced by the state changes stream at each new block.
+/// A transaction opened at an older version is a stale snapshot, so it must not be handed out again.
+class ChainHeadVersion {
+public:
+    uint64_t current() const { return version_.load(std::memory_order_acquire); }
+
+    /// Whether the state changes are being received: if not, nothing guarantees that the version is up to date
+    bool tracked() const { return tracked_.load(std::memory_order_acquire); }
+
+    void advance() { version_.fetch_add(1, std::memory_order_acq_rel); }
+
+    void set_tracked(bool tracked) {
+        // Changes may have been missed while not tracked, so any transaction opened before is stale anyway
+        tracked_.store(tracked, std::memory_order_release);
+        advance();
+    }
+
+private:
+    std::atomic_uint64_t version_{0};
+    std::atomic_bool tracked_{false};
+};
+
+struct TransactionPoolSettings {
+    std::size_t max_idle_transactions{common::kDefaultTxPoolSize};
+    std::chrono::milliseconds max_transaction_age{common::kDefaultTxMaxAge};
+    std::shared_ptr<const ChainHeadVersion> head_version;
+};
+
+/// Database keeping a pool of open transactions of the underlying database (with their cursors) to reuse among its users.
+/// A transaction is reused only while the chain head version it was opened at is still the current one and it is not
+/// older than the maximum age, otherwise it is closed in background. Pooling is disabled when no head version is given.
+/// Not thread-safe: all the operations must be executed on the given io_context.
+class PooledDatabase : public Database {
+public:
+    explicit PooledDatabase(std::unique_ptr<Database> database, asio::io_context& io_context, const TransactionPoolSettings& settings = {})
+    : database_(std::move(database)), io_context_(io_context), settings_(settings) {}
+
+    PooledDatabase(const PooledDatabase&) = delete;
+    PooledDatabase& operator=(const PooledDatabase&) = delete;
+
+    asio::awaitable<std::unique_ptr<Transaction>> begin() override;
+
+    std::size_t num_idle_transactions() const { return idle_transactions_.size(); }
+
+private:
+    friend class PooledTransaction;
+
+    struct Lease {
+        std::unique_ptr<Transaction> tx;
+        uint64_t version;
+        std::chrono::steady_clock::time_point opened_at;
+    };
+
+    bool pooling() const { return settings_.head_version && settings_.max_idle_transactions > 0; }
+
+    bool fresh(const Lease& lease) const;
+
+    void release(Lease lease);
+
+    void retire(std::unique_ptr<Transaction> tx);
+
+    std::unique_ptr<Database> database_;
+    asio::io_context& io_context_;
+    TransactionPoolSettings settings_;
+    std::vector<Lease> idle_transactions_;
+};
+
+class PooledTransaction : public Transaction {
+public:
+    explicit PooledTransaction(PooledDatabase& database, PooledDatabase::Lease lease) : database_(database), lease_(std::move(lease)) {}
+
+    PooledTransaction(const PooledTransaction&) = delete;
+    PooledTransaction& operator=(const PooledTransaction&) = delete;
+
+    /// The leased transaction is already open
+    asio::awaitable<void> open() override { co_return; }
+
+    asio::awaitable<std::shared_ptr<Cursor>> cursor(const std::string& table) override;
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> cursor_dup_sort(const std::string& table) override;
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> new_cursor(const std::string& table) override;
+
+    /// Give the leased transaction back to the pool, which closes it if it cannot be reused
+    asio::awaitable<void> close() override;
+
+    bool reusable() const override { return lease_.tx && lease_.tx->reusable(); }
+
+private:
+    PooledDatabase& database_;
+    PooledDatabase::Lease lease_;
+};
+
+} // namespace silkrpc::ethdb
+
+#endif  // SILKRPC_ETHDB_POOLED_DATABASE_HPP_
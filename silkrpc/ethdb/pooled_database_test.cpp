@@ -0,0 +1,194 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "pooled_database.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <asio/co_spawn.hpp>
+#include <asio/io_context.hpp>
+#include <asio/use_future.hpp>
+#include <catch2/catch.hpp>
+
+namespace silkrpc::ethdb {
+
+using Catch::Matchers::Message;
+
+struct TransactionCounters {
+    int opened{0};
+    int closed{0};
+};
+
+class MockTransaction : public Transaction {
+public:
+    explicit MockTransaction(TransactionCounters& counters) : counters_(counters) {}
+
+    asio::awaitable<void> open() override { ++counters_.opened; co_return; }
+
+    asio::awaitable<std::shared_ptr<Cursor>> cursor(const std::string& /*table*/) override { co_return nullptr; }
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> cursor_dup_sort(const std::string& /*table*/) override { co_return nullptr; }
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> new_cursor(const std::string& /*table*/) override { co_return nullptr; }
+
+    asio::awaitable<void> close() override { ++counters_.closed; co_return; }
+
+    bool reusable() const override { return !broken; }
+
+    bool broken{false};
+
+private:
+    TransactionCounters& counters_;
+};
+
+class MockDatabase : public Database {
+public:
+    asio::awaitable<std::unique_ptr<Transaction>> begin() override {
+        auto tx = std::make_unique<MockTransaction>(counters);
+        last_transaction = tx.get();
+        co_await tx->open();
+        co_return tx;
+    }
+
+    TransactionCounters counters;
+    MockTransaction* last_transaction{nullptr};
+};
+
+class PooledDatabaseTest {
+public:
+    explicit PooledDatabaseTest(std::size_t max_idle_transactions, std::chrono::milliseconds max_transaction_age = std::chrono::seconds{60})
+    : head_version{std::make_shared<ChainHeadVersion>()} {
+        auto database_ptr = std::make_unique<MockDatabase>();
+        mock_database = database_ptr.get();
+        counters = &mock_database->counters;
+        database = std::make_unique<PooledDatabase>(std::move(database_ptr), io_context, TransactionPoolSettings{max_idle_transactions, max_transaction_age, head_version});
+        head_version->set_tracked(true);
+    }
+
+    std::unique_ptr<Transaction> begin() {
+        auto result = asio::co_spawn(io_context, database->begin(), asio::use_future);
+        io_context.run();
+        io_context.restart();
+        return result.get();
+    }
+
+    void close(std::unique_ptr<Transaction>& tx) {
+        auto result = asio::co_spawn(io_context, tx->close(), asio::use_future);
+        io_context.run();
+        io_context.restart();
+        result.get();
+        tx.reset();
+    }
+
+    asio::io_context io_context;
+    std::shared_ptr<ChainHeadVersion> head_version;
+    std::unique_ptr<PooledDatabase> database;
+    MockDatabase* mock_database;
+    TransactionCounters* counters;
+};
+
+TEST_CASE("PooledDatabase::begin", "[silkrpc][ethdb][pooled_database]") {
+    SECTION("transaction is reused") {
+        PooledDatabaseTest test{1};
+        auto tx1 = test.begin();
+        test.close(tx1);
+        CHECK(test.database->num_idle_transactions() == 1);
+        auto tx2 = test.begin();
+        test.close(tx2);
+        CHECK(test.counters->opened == 1);
+        CHECK(test.counters->closed == 0);
+    }
+
+    SECTION("transaction is not reused after head has moved") {
+        PooledDatabaseTest test{1};
+        auto tx1 = test.begin();
+        test.close(tx1);
+        test.head_version->advance();
+        auto tx2 = test.begin();
+        CHECK(test.counters->opened == 2);
+        CHECK(test.counters->closed == 1);
+        test.close(tx2);
+        CHECK(test.database->num_idle_transactions() == 1);
+    }
+
+    SECTION("transaction opened before head has moved is not pooled") {
+        PooledDatabaseTest test{1};
+        auto tx1 = test.begin();
+        test.head_version->advance();
+        test.close(tx1);
+        CHECK(test.database->num_idle_transactions() == 0);
+        CHECK(test.counters->closed == 1);
+    }
+
+    SECTION("transaction is not pooled when head is not tracked") {
+        PooledDatabaseTest test{1};
+        test.head_version->set_tracked(false);
+        auto tx1 = test.begin();
+        test.close(tx1);
+        auto tx2 = test.begin();
+        test.close(tx2);
+        CHECK(test.counters->opened == 2);
+        CHECK(test.counters->closed == 2);
+    }
+
+    SECTION("transaction is not reused after max age") {
+        PooledDatabaseTest test{1, std::chrono::milliseconds{0}};
+        auto tx1 = test.begin();
+        test.close(tx1);
+        auto tx2 = test.begin();
+        test.close(tx2);
+        CHECK(test.counters->opened == 2);
+        CHECK(test.counters->closed == 2);
+    }
+
+    SECTION("broken transaction is not pooled") {
+        PooledDatabaseTest test{1};
+        auto tx = test.begin();
+        CHECK(tx->reusable());
+        test.mock_database->last_transaction->broken = true;
+        CHECK(!tx->reusable());
+        test.close(tx);
+        CHECK(test.database->num_idle_transactions() == 0);
+        CHECK(test.counters->closed == 1);
+    }
+
+    SECTION("idle transactions are limited") {
+        PooledDatabaseTest test{2};
+        auto tx1 = test.begin();
+        auto tx2 = test.begin();
+        auto tx3 = test.begin();
+        test.close(tx1);
+        test.close(tx2);
+        test.close(tx3);
+        CHECK(test.database->num_idle_transactions() == 2);
+        CHECK(test.counters->opened == 3);
+        CHECK(test.counters->closed == 1);
+    }
+
+    SECTION("pooling disabled") {
+        PooledDatabaseTest test{0};
+        auto tx1 = test.begin();
+        test.close(tx1);
+        auto tx2 = test.begin();
+        test.close(tx2);
+        CHECK(test.counters->opened == 2);
+        CHECK(test.counters->closed == 2);
+    }
+}
+
+} // namespace silkrpc::ethdb
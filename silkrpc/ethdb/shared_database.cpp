@@ -0,0 +1,147 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "shared_database.hpp"
+
+#include <utility>
+
+#include <asio/redirect_error.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <silkrpc/common/log.hpp>
+
+namespace silkrpc::ethdb {
+
+asio::awaitable<std::unique_ptr<Transaction>> SharedDatabase::begin() {
+    {
+        const auto guard = co_await lock();
+        if (!tx_) {
+            tx_ = co_await database_.begin();
+            SILKRPC_TRACE << "SharedDatabase::begin " << this << " shared tx: " << tx_.get() << "\n";
+        }
+    }
+    co_return std::make_unique<SharedTransaction>(*this);
+}
+
+asio::awaitable<void> SharedDatabase::close() {
+    if (tx_) {
+        co_await tx_->close();
+        tx_.reset();
+    }
+    co_return;
+}
+
+asio::awaitable<SharedDatabase::LockGuard> SharedDatabase::lock() {
+    if (!locked_) {
+        locked_ = true;
+        co_return LockGuard{this};
+    }
+    // Wait until unlock hands over the ownership by cancelling the never-expiring timer
+    auto waiter = std::make_shared<asio::steady_timer>(io_context_, asio::steady_timer::time_point::max());
+    waiters_.push_back(waiter);
+    asio::error_code error;
+    co_await waiter->async_wait(asio::redirect_error(asio::use_awaitable, error));
+    co_return LockGuard{this};
+}
+
+void SharedDatabase::unlock() {
+    if (waiters_.empty()) {
+        locked_ = false;
+        return;
+    }
+    auto waiter = waiters_.front();
+    waiters_.pop_front();
+    waiter->cancel();
+}
+
+asio::awaitable<void> SharedCursor::open_cursor(const std::string& table_name) {
+    const auto guard = co_await database_.lock();
+    co_await cursor_->open_cursor(table_name);
+}
+
+asio::awaitable<KeyValue> SharedCursor::seek(const silkworm::ByteView& key) {
+    const auto guard = co_await database_.lock();
+    co_return co_await cursor_->seek(key);
+}
+
+asio::awaitable<KeyValue> SharedCursor::seek_exact(const silkworm::ByteView& key) {
+    const auto guard = co_await database_.lock();
+    co_return co_await cursor_->seek_exact(key);
+}
+
+asio::awaitable<KeyValue> SharedCursor::next() {
+    const auto guard = co_await database_.lock();
+    co_return co_await cursor_->next();
+}
+
+asio::awaitable<std::vector<KeyValue>> SharedCursor::next_batch(std::size_t count) {
+    const auto guard = co_await database_.lock();
+    co_return co_await cursor_->next_batch(count);
+}
+
+asio::awaitable<void> SharedCursor::close_cursor() {
+    const auto guard = co_await database_.lock();
+    co_await cursor_->close_cursor();
+}
+
+asio::awaitable<silkworm::Bytes> SharedCursor::seek_both(const silkworm::ByteView& key, const silkworm::ByteView& value) {
+    const auto guard = co_await database_.lock();
+    co_return co_await cursor_->seek_both(key, value);
+}
+
+asio::awaitable<KeyValue> SharedCursor::seek_both_exact(const silkworm::ByteView& key, const silkworm::ByteView& value) {
+    const auto guard = co_await database_.lock();
+    co_return co_await cursor_->seek_both_exact(key, value);
+}
+
+asio::awaitable<void> SharedTransaction::open() {
+    // The shared transaction has been already opened by SharedDatabase::begin
+    co_return;
+}
+
+asio::awaitable<std::shared_ptr<Cursor>> SharedTransaction::cursor(const std::string& table) {
+    co_return co_await get_cursor(table);
+}
+
+asio::awaitable<std::shared_ptr<CursorDupSort>> SharedTransaction::cursor_dup_sort(const std::string& table) {
+    co_return co_await get_cursor(table);
+}
+
+asio::awaitable<std::shared_ptr<CursorDupSort>> SharedTransaction::new_cursor(const std::string& table) {
+    const auto guard = co_await database_.lock();
+    auto cursor = co_await database_.tx_->new_cursor(table);
+    co_return std::make_shared<SharedCursor>(database_, cursor);
+}
+
+asio::awaitable<void> SharedTransaction::close() {
+    for (const auto& [table, cursor] : cursors_) {
+        co_await cursor->close_cursor();
+    }
+    cursors_.clear();
+    co_return;
+}
+
+asio::awaitable<std::shared_ptr<CursorDupSort>> SharedTransaction::get_cursor(const std::string& table) {
+    auto cursor_it = cursors_.find(table);
+    if (cursor_it != cursors_.end()) {
+        co_return cursor_it->second;
+    }
+    auto cursor = co_await new_cursor(table);
+    cursors_[table] = cursor;
+    co_return cursor;
+}
+
+} // namespace silkrpc::ethdb
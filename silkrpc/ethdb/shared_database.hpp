@@ -0,0 +1,141 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKRPC_ETHDB_SHARED_DATABASE_HPP_
+#define SILKRPC_ETHDB_SHARED_DATABASE_HPP_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <silkrpc/config.hpp>
+
+#include <asio/awaitable.hpp>
+#include <asio/io_context.hpp>
+#include <asio/steady_timer.hpp>
+
+#include <silkworm/common/util.hpp>
+#include <silkrpc/common/util.hpp>
+#include <silkrpc/ethdb/cursor.hpp>
+#include <silkrpc/ethdb/database.hpp>
+#include <silkrpc/ethdb/transaction.hpp>
+
+namespace silkrpc::ethdb {
+
+/// Database view sharing one transaction of the underlying database among all its users (e.g. the entries of a JSON-RPC batch).
+/// Each user gets its own cursors, while the operations on the shared transaction are serialized to one at a time: even if
+/// the remote transactions pipeline the cursor requests, the local ones run them on the workers and an MDBX transaction
+/// must not be used by many threads at once.
+class SharedDatabase : public Database {
+public:
+    explicit SharedDatabase(Database& database, asio::io_context& io_context) : database_(database), io_context_(io_context) {}
+
+    SharedDatabase(const SharedDatabase&) = delete;
+    SharedDatabase& operator=(const SharedDatabase&) = delete;
+
+    asio::awaitable<std::unique_ptr<Transaction>> begin() override;
+
+    /// Close the shared transaction, if any: all the transactions returned by begin must have been closed before
+    asio::awaitable<void> close();
+
+private:
+    friend class SharedTransaction;
+    friend class SharedCursor;
+
+    /// Ownership of the shared transaction, given back when destroyed.
+    class [[nodiscard]] LockGuard {
+    public:
+        explicit LockGuard(SharedDatabase* database) : database_(database) {}
+        LockGuard(LockGuard&& other) noexcept : database_(std::exchange(other.database_, nullptr)) {}
+        ~LockGuard() { if (database_) database_->unlock(); }
+
+        LockGuard(const LockGuard&) = delete;
+        LockGuard& operator=(const LockGuard&) = delete;
+
+    private:
+        SharedDatabase* database_;
+    };
+
+    asio::awaitable<LockGuard> lock();
+    void unlock();
+
+    Database& database_;
+    asio::io_context& io_context_;
+    std::unique_ptr<Transaction> tx_;
+    bool locked_{false};
+    std::deque<std::shared_ptr<asio::steady_timer>> waiters_;
+};
+
+class SharedCursor : public CursorDupSort {
+public:
+    explicit SharedCursor(SharedDatabase& database, std::shared_ptr<CursorDupSort> cursor) : database_(database), cursor_(cursor) {}
+
+    SharedCursor(const SharedCursor&) = delete;
+    SharedCursor& operator=(const SharedCursor&) = delete;
+
+    uint32_t cursor_id() const override { return cursor_->cursor_id(); }
+
+    asio::awaitable<void> open_cursor(const std::string& table_name) override;
+
+    asio::awaitable<KeyValue> seek(const silkworm::ByteView& key) override;
+
+    asio::awaitable<KeyValue> seek_exact(const silkworm::ByteView& key) override;
+
+    asio::awaitable<KeyValue> next() override;
+
+    asio::awaitable<std::vector<KeyValue>> next_batch(std::size_t count) override;
+
+    asio::awaitable<void> close_cursor() override;
+
+    asio::awaitable<silkworm::Bytes> seek_both(const silkworm::ByteView& key, const silkworm::ByteView& value) override;
+
+    asio::awaitable<KeyValue> seek_both_exact(const silkworm::ByteView& key, const silkworm::ByteView& value) override;
+
+private:
+    SharedDatabase& database_;
+    std::shared_ptr<CursorDupSort> cursor_;
+};
+
+class SharedTransaction : public Transaction {
+public:
+    explicit SharedTransaction(SharedDatabase& database) : database_(database) {}
+
+    SharedTransaction(const SharedTransaction&) = delete;
+    SharedTransaction& operator=(const SharedTransaction&) = delete;
+
+    asio::awaitable<void> open() override;
+
+    asio::awaitable<std::shared_ptr<Cursor>> cursor(const std::string& table) override;
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> cursor_dup_sort(const std::string& table) override;
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> new_cursor(const std::string& table) override;
+
+    asio::awaitable<void> close() override;
+
+private:
+    asio::awaitable<std::shared_ptr<CursorDupSort>> get_cursor(const std::string& table);
+
+    SharedDatabase& database_;
+    std::map<std::string, std::shared_ptr<CursorDupSort>> cursors_;
+};
+
+} // namespace silkrpc::ethdb
+
+#endif  // SILKRPC_ETHDB_SHARED_DATABASE_HPP_
@@ -0,0 +1,217 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "shared_database.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/steady_timer.hpp>
+#include <asio/this_coro.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asio/use_future.hpp>
+#include <catch2/catch.hpp>
+
+namespace silkrpc::ethdb {
+
+using Catch::Matchers::Message;
+
+/// The operations seen by the underlying database, shared by all its transactions and cursors.
+struct OperationLog {
+    int opened{0};
+    int closed{0};
+    int cursors{0};
+    int in_flight{0};
+    int max_in_flight{0};
+    std::vector<std::string> keys;
+};
+
+/// Cursor whose seek takes some time, so that the callers overlap unless serialized.
+class MockCursor : public CursorDupSort {
+public:
+    explicit MockCursor(OperationLog& log) : log_(log) {}
+
+    uint32_t cursor_id() const override { return 1; }
+
+    asio::awaitable<void> open_cursor(const std::string& /*table_name*/) override { co_return; }
+
+    asio::awaitable<KeyValue> seek(const silkworm::ByteView& key) override {
+        ++log_.in_flight;
+        log_.max_in_flight = std::max(log_.max_in_flight, log_.in_flight);
+        log_.keys.emplace_back(key.begin(), key.end());
+        asio::steady_timer timer{co_await asio::this_coro::executor, std::chrono::milliseconds{1}};
+        co_await timer.async_wait(asio::use_awaitable);
+        --log_.in_flight;
+        if (key == silkworm::ByteView{reinterpret_cast<const uint8_t*>("error"), 5}) {
+            throw std::runtime_error{"seek failed"};
+        }
+        co_return KeyValue{silkworm::Bytes{key}, silkworm::Bytes{}};
+    }
+
+    asio::awaitable<KeyValue> seek_exact(const silkworm::ByteView& key) override { co_return co_await seek(key); }
+
+    asio::awaitable<KeyValue> next() override { co_return KeyValue{}; }
+
+    asio::awaitable<std::vector<KeyValue>> next_batch(std::size_t /*count*/) override { co_return std::vector<KeyValue>{}; }
+
+    asio::awaitable<void> close_cursor() override { co_return; }
+
+    asio::awaitable<silkworm::Bytes> seek_both(const silkworm::ByteView& /*key*/, const silkworm::ByteView& /*value*/) override {
+        co_return silkworm::Bytes{};
+    }
+
+    asio::awaitable<KeyValue> seek_both_exact(const silkworm::ByteView& /*key*/, const silkworm::ByteView& /*value*/) override {
+        co_return KeyValue{};
+    }
+
+private:
+    OperationLog& log_;
+};
+
+class MockTransaction : public Transaction {
+public:
+    explicit MockTransaction(OperationLog& log) : log_(log) {}
+
+    asio::awaitable<void> open() override { ++log_.opened; co_return; }
+
+    asio::awaitable<std::shared_ptr<Cursor>> cursor(const std::string& table) override { co_return co_await new_cursor(table); }
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> cursor_dup_sort(const std::string& table) override { co_return co_await new_cursor(table); }
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> new_cursor(const std::string& /*table*/) override {
+        ++log_.cursors;
+        co_return std::make_shared<MockCursor>(log_);
+    }
+
+    asio::awaitable<void> close() override { ++log_.closed; co_return; }
+
+private:
+    OperationLog& log_;
+};
+
+class MockDatabase : public Database {
+public:
+    asio::awaitable<std::unique_ptr<Transaction>> begin() override {
+        auto tx = std::make_unique<MockTransaction>(log);
+        co_await tx->open();
+        co_return tx;
+    }
+
+    OperationLog log;
+};
+
+class SharedDatabaseTest {
+public:
+    SharedDatabaseTest() : database{mock_database, io_context} {}
+
+    template <typename T>
+    T run(asio::awaitable<T> awaitable) {
+        auto result = asio::co_spawn(io_context, std::move(awaitable), asio::use_future);
+        io_context.run();
+        io_context.restart();
+        return result.get();
+    }
+
+    /// Seek the keys concurrently on the cursor of the table, each one from its own coroutine spawned in key order.
+    std::vector<std::string> seek_concurrently(Transaction& tx, const std::vector<std::string>& keys) {
+        std::vector<std::string> results(keys.size());
+        for (std::size_t i{0}; i < keys.size(); ++i) {
+            asio::co_spawn(io_context, [&, i]() -> asio::awaitable<void> {
+                auto cursor = co_await tx.cursor("Table");
+                try {
+                    const auto kv_pair = co_await cursor->seek(silkworm::ByteView{reinterpret_cast<const uint8_t*>(keys[i].data()), keys[i].size()});
+                    results[i] = std::string{kv_pair.key.begin(), kv_pair.key.end()};
+                } catch (const std::runtime_error& e) {
+                    results[i] = e.what();
+                }
+            }, asio::detached);
+        }
+        io_context.run();
+        io_context.restart();
+        return results;
+    }
+
+    asio::io_context io_context;
+    MockDatabase mock_database;
+    SharedDatabase database;
+};
+
+TEST_CASE("SharedDatabase::begin", "[silkrpc][ethdb][shared_database]") {
+    SharedDatabaseTest test;
+
+    SECTION("transaction is shared") {
+        auto tx1 = test.run(test.database.begin());
+        auto tx2 = test.run(test.database.begin());
+        CHECK(test.mock_database.log.opened == 1);
+        test.run(tx1->close());
+        test.run(tx2->close());
+        CHECK(test.mock_database.log.closed == 0);
+        test.run(test.database.close());
+        CHECK(test.mock_database.log.closed == 1);
+    }
+
+    SECTION("cursor is shared within one transaction") {
+        auto tx1 = test.run(test.database.begin());
+        auto tx2 = test.run(test.database.begin());
+        auto cursor1 = test.run(tx1->cursor("Table"));
+        CHECK(test.run(tx1->cursor("Table")) == cursor1);
+        CHECK(test.run(tx2->cursor("Table")) != cursor1);
+        CHECK(test.mock_database.log.cursors == 2);
+        test.run(tx1->close());
+        test.run(tx2->close());
+        test.run(test.database.close());
+    }
+
+    SECTION("close without transaction") {
+        CHECK_NOTHROW(test.run(test.database.close()));
+        CHECK(test.mock_database.log.closed == 0);
+    }
+}
+
+TEST_CASE("SharedDatabase serializes the operations", "[silkrpc][ethdb][shared_database]") {
+    SharedDatabaseTest test;
+    auto tx = test.run(test.database.begin());
+
+    SECTION("one operation at a time") {
+        const auto results = test.seek_concurrently(*tx, {"a", "b", "c", "d"});
+        CHECK(results == std::vector<std::string>{"a", "b", "c", "d"});
+        CHECK(test.mock_database.log.max_in_flight == 1);
+    }
+
+    SECTION("waiters served in FIFO order") {
+        test.seek_concurrently(*tx, {"1", "2", "3", "4", "5"});
+        CHECK(test.mock_database.log.keys == std::vector<std::string>{"1", "2", "3", "4", "5"});
+    }
+
+    SECTION("failed operation releases the lock") {
+        const auto results = test.seek_concurrently(*tx, {"a", "error", "c"});
+        CHECK(results == std::vector<std::string>{"a", "seek failed", "c"});
+        CHECK(test.mock_database.log.keys == std::vector<std::string>{"a", "error", "c"});
+        CHECK(test.mock_database.log.max_in_flight == 1);
+    }
+
+    test.run(tx->close());
+    test.run(test.database.close());
+}
+
+} // namespace silkrpc::ethdb
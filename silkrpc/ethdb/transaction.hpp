@@ -45,7 +45,13 @@ public:
 
     virtual asio::awaitable<std::shared_ptr<CursorDupSort>> cursor_dup_sort(const std::string& table) = 0;
 
+    /// Open a new cursor on the table not shared with other users of this transaction, the caller must close it
+    virtual asio::awaitable<std::shared_ptr<CursorDupSort>> new_cursor(const std::string& table) = 0;
+
     virtual asio::awaitable<void> close() = 0;
+
+    /// Whether the transaction can be kept open and handed out again after use (e.g. its stream is not broken)
+    virtual bool reusable() const { return true; }
 };
 
 } // namespace silkrpc::ethdb
@@ -16,8 +16,11 @@
 
 #include "transaction_database.hpp"
 
+#include <algorithm>
 #include <climits>
 #include <exception>
+#include <utility>
+#include <vector>
 
 #include <silkrpc/common/log.hpp>
 #include <silkrpc/common/util.hpp>
@@ -35,7 +38,7 @@ asio::awaitable<silkworm::Bytes> TransactionDatabase::get_one(const std::string&
     const auto cursor = co_await tx_.cursor(table);
     SILKRPC_TRACE << "TransactionDatabase::get_one cursor_id: " << cursor->cursor_id() << "\n";
     const auto kv_pair = co_await cursor->seek_exact(key);
-    co_return kv_pair.value;
+    co_return silkworm::Bytes{kv_pair.value};
 }
 
 asio::awaitable<std::optional<silkworm::Bytes>> TransactionDatabase::get_both_range(const std::string& table, const silkworm::ByteView& key, const silkworm::ByteView& subkey) const {
@@ -63,22 +66,33 @@ asio::awaitable<void> TransactionDatabase::walk(const std::string& table, const
 
     const auto cursor = co_await tx_.cursor(table);
     SILKRPC_TRACE << "TransactionDatabase::walk cursor_id: " << cursor->cursor_id() << "\n";
+    // The current row keeps alive the reply its key and value are viewing, so the walker decodes them in place
     auto kv_pair = co_await cursor->seek(start_key);
-    auto k = kv_pair.key;
-    auto v = kv_pair.value;
-    SILKRPC_TRACE << "k: " << k << " v: " << v << "\n";
+    SILKRPC_TRACE << "k: " << kv_pair.key << " v: " << kv_pair.value << "\n";
+    // Start with a small batch because many walks stop after few rows (e.g. bitmap chunks), stop reading as soon as the prefix changes
+    std::vector<KeyValue> read_ahead;
+    std::size_t read_ahead_index{0};
+    std::size_t batch_size{1};
     while (
-        !k.empty() &&
-        k.size() >= fixed_bytes &&
-        (fixed_bits == 0 || k.compare(0, fixed_bytes-1, start_key, 0, fixed_bytes-1) == 0 && (k[fixed_bytes-1]&mask) == (start_key[fixed_bytes-1]&mask))
+        !kv_pair.key.empty() &&
+        kv_pair.key.size() >= fixed_bytes &&
+        (fixed_bits == 0 || kv_pair.key.compare(0, fixed_bytes-1, start_key, 0, fixed_bytes-1) == 0 &&
+            (kv_pair.key[fixed_bytes-1]&mask) == (start_key[fixed_bytes-1]&mask))
     ) {
-        const auto go_on = w(k, v);
+        const auto go_on = w(kv_pair.key, kv_pair.value);
         if (!go_on) {
             break;
         }
-        kv_pair = co_await cursor->next();
-        k = kv_pair.key;
-        v = kv_pair.value;
+        if (read_ahead_index == read_ahead.size()) {
+            read_ahead = co_await cursor->next_batch(batch_size);
+            read_ahead_index = 0;
+            batch_size = std::min(batch_size * 2, std::max(max_read_ahead_, std::size_t{1}));
+            if (read_ahead.empty()) {
+                break;
+            }
+        }
+        kv_pair = std::move(read_ahead[read_ahead_index]);
+        ++read_ahead_index;
     }
 
     co_return;
@@ -21,6 +21,7 @@
 #include <string>
 
 #include <silkworm/common/util.hpp>
+#include <silkrpc/common/constants.hpp>
 #include <silkrpc/core/rawdb/accessors.hpp>
 #include <silkrpc/ethdb/transaction.hpp>
 
@@ -28,7 +29,7 @@ namespace silkrpc::ethdb {
 
 class TransactionDatabase : public core::rawdb::DatabaseReader {
 public:
-    explicit TransactionDatabase(Transaction& tx) : tx_(tx) {}
+    explicit TransactionDatabase(Transaction& tx, std::size_t max_read_ahead = common::kDefaultWalkReadAhead) : tx_(tx), max_read_ahead_(max_read_ahead) {}
 
     TransactionDatabase(const TransactionDatabase&) = delete;
     TransactionDatabase& operator=(const TransactionDatabase&) = delete;
@@ -39,11 +40,13 @@ public:
 
     asio::awaitable<std::optional<silkworm::Bytes>> get_both_range(const std::string& table, const silkworm::ByteView& key, const silkworm::ByteView& subkey) const override;
 
+    /// Rows after the first one are read ahead in batches, doubling the batch size up to max_read_ahead rows
     asio::awaitable<void> walk(const std::string& table, const silkworm::ByteView& start_key, uint32_t fixed_bits, core::rawdb::Walker w) const override;
 
     void close();
 private:
     Transaction& tx_;
+    std::size_t max_read_ahead_;
 };
 
 } // namespace silkrpc::ethdb
@@ -16,11 +16,152 @@
 
 #include "transaction_database.hpp"
 
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <asio/co_spawn.hpp>
+#include <asio/io_context.hpp>
+#include <asio/use_future.hpp>
 #include <catch2/catch.hpp>
 
-namespace silkrpc {
+namespace silkrpc::ethdb {
 
 using Catch::Matchers::Message;
 
-} // namespace silkrpc
+// In-memory cursor over a sorted table, an empty key marks the end of the table as in the remote KV interface
+class MockCursor : public CursorDupSort {
+public:
+    explicit MockCursor(const std::map<silkworm::Bytes, silkworm::Bytes>& table) : table_(table), position_{table_.end()} {}
+
+    uint32_t cursor_id() const override { return 1; }
+
+    asio::awaitable<void> open_cursor(const std::string& /*table_name*/) override { co_return; }
+
+    asio::awaitable<KeyValue> seek(const silkworm::ByteView& key) override {
+        position_ = table_.lower_bound(silkworm::Bytes{key});
+        co_return current();
+    }
+
+    asio::awaitable<KeyValue> seek_exact(const silkworm::ByteView& key) override {
+        position_ = table_.find(silkworm::Bytes{key});
+        co_return current();
+    }
+
+    asio::awaitable<KeyValue> next() override {
+        co_return advance();
+    }
+
+    asio::awaitable<std::vector<KeyValue>> next_batch(std::size_t count) override {
+        batch_sizes.push_back(count);
+        std::vector<KeyValue> kv_pairs;
+        for (std::size_t i{0}; i < count; ++i) {
+            kv_pairs.push_back(advance());
+        }
+        co_return kv_pairs;
+    }
+
+    asio::awaitable<void> close_cursor() override { co_return; }
+
+    asio::awaitable<silkworm::Bytes> seek_both(const silkworm::ByteView& /*key*/, const silkworm::ByteView& /*value*/) override {
+        co_return silkworm::Bytes{};
+    }
+
+    asio::awaitable<KeyValue> seek_both_exact(const silkworm::ByteView& /*key*/, const silkworm::ByteView& /*value*/) override {
+        co_return KeyValue{};
+    }
+
+    std::vector<std::size_t> batch_sizes;
+
+private:
+    KeyValue current() const { return position_ == table_.end() ? KeyValue{} : KeyValue{position_->first, position_->second}; }
+
+    KeyValue advance() {
+        if (position_ != table_.end()) {
+            ++position_;
+        }
+        return current();
+    }
+
+    const std::map<silkworm::Bytes, silkworm::Bytes>& table_;
+    std::map<silkworm::Bytes, silkworm::Bytes>::const_iterator position_;
+};
+
+class MockTransaction : public Transaction {
+public:
+    explicit MockTransaction(std::shared_ptr<MockCursor> cursor) : cursor_(cursor) {}
+
+    asio::awaitable<void> open() override { co_return; }
+
+    asio::awaitable<std::shared_ptr<Cursor>> cursor(const std::string& /*table*/) override { co_return cursor_; }
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> cursor_dup_sort(const std::string& /*table*/) override { co_return cursor_; }
+
+    asio::awaitable<std::shared_ptr<CursorDupSort>> new_cursor(const std::string& /*table*/) override { co_return cursor_; }
+
+    asio::awaitable<void> close() override { co_return; }
+
+private:
+    std::shared_ptr<MockCursor> cursor_;
+};
+
+static std::vector<silkworm::Bytes> walk_keys(TransactionDatabase& tx_database, const silkworm::Bytes& start_key, uint32_t fixed_bits, std::size_t max_rows) {
+    asio::io_context io_context;
+    std::vector<silkworm::Bytes> keys;
+    auto walker = [&](const silkworm::ByteView& k, const silkworm::ByteView& /*v*/) {
+        keys.emplace_back(k);
+        return keys.size() < max_rows;
+    };
+    auto result = asio::co_spawn(io_context, tx_database.walk("table", start_key, fixed_bits, walker), asio::use_future);
+    io_context.run();
+    result.get();
+    return keys;
+}
+
+TEST_CASE("walk reads ahead in growing batches", "[silkrpc][ethdb][transaction_database]") {
+    // 300 rows with prefix 0x01 followed by rows with prefix 0x02
+    std::map<silkworm::Bytes, silkworm::Bytes> table;
+    for (uint16_t i{0}; i < 300; ++i) {
+        table[silkworm::Bytes{0x01, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)}] = silkworm::Bytes{0xAA};
+    }
+    for (uint8_t i{0}; i < 100; ++i) {
+        table[silkworm::Bytes{0x02, 0x00, i}] = silkworm::Bytes{0xBB};
+    }
+    auto cursor = std::make_shared<MockCursor>(table);
+    MockTransaction tx{cursor};
+
+    SECTION("stop at prefix change") {
+        TransactionDatabase tx_database{tx, 64};
+        const auto keys = walk_keys(tx_database, silkworm::Bytes{0x01}, 8, 1000);
+        CHECK(keys.size() == 300);
+        CHECK(keys.front() == silkworm::Bytes{0x01, 0x00, 0x00});
+        CHECK(keys.back() == silkworm::Bytes{0x01, 0x01, 0x2B});
+        CHECK(cursor->batch_sizes == std::vector<std::size_t>{1, 2, 4, 8, 16, 32, 64, 64, 64, 64});
+    }
+
+    SECTION("stop when walker returns false") {
+        TransactionDatabase tx_database{tx, 64};
+        const auto keys = walk_keys(tx_database, silkworm::Bytes{0x01}, 8, 2);
+        CHECK(keys.size() == 2);
+        CHECK(cursor->batch_sizes == std::vector<std::size_t>{1});
+    }
+
+    SECTION("stop at end of table") {
+        TransactionDatabase tx_database{tx, 16};
+        const auto keys = walk_keys(tx_database, silkworm::Bytes{0x02}, 0, 1000);
+        CHECK(keys.size() == 100);
+        CHECK(keys.back() == silkworm::Bytes{0x02, 0x00, 0x63});
+        CHECK(cursor->batch_sizes == std::vector<std::size_t>{1, 2, 4, 8, 16, 16, 16, 16, 16, 16});
+    }
+
+    SECTION("no read ahead") {
+        TransactionDatabase tx_database{tx, 0};
+        const auto keys = walk_keys(tx_database, silkworm::Bytes{0x02}, 8, 1000);
+        CHECK(keys.size() == 100);
+        CHECK(cursor->batch_sizes == std::vector<std::size_t>(100, 1));
+    }
+}
 
+} // namespace silkrpc::ethdb
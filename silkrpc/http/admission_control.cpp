@@ -0,0 +1,186 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "admission_control.hpp"
+
+#include <algorithm>
+
+#include <asio/post.hpp>
+#include <asio/redirect_error.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <silkrpc/common/log.hpp>
+
+namespace silkrpc::http {
+
+bool GlobalAdmission::try_acquire() {
+    auto in_flight = in_flight_.load(std::memory_order_relaxed);
+    do {
+        if (limits_.max_in_flight > 0 && in_flight >= limits_.max_in_flight) {
+            return false;
+        }
+    } while (!in_flight_.compare_exchange_weak(in_flight, in_flight + 1, std::memory_order_relaxed));
+    return true;
+}
+
+void GlobalAdmission::release() {
+    in_flight_.fetch_sub(1, std::memory_order_relaxed);
+    // The requests waiting for a global slot may be on any context
+    if (limits_.max_in_flight > 0 && queued_.load(std::memory_order_relaxed) > 0) {
+        for (auto* control : controls_) {
+            control->notify();
+        }
+    }
+}
+
+bool GlobalAdmission::try_enqueue() {
+    auto queued = queued_.load(std::memory_order_relaxed);
+    do {
+        if (limits_.max_queue_depth > 0 && queued >= limits_.max_queue_depth) {
+            return false;
+        }
+    } while (!queued_.compare_exchange_weak(queued, queued + 1, std::memory_order_relaxed));
+    return true;
+}
+
+void GlobalAdmission::dequeue() {
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+AdmissionControl::AdmissionControl(asio::io_context& io_context, const AdmissionLimits& limits, GlobalAdmission& global)
+: io_context_(io_context), limits_{limits}, global_(global) {
+    global_.add(this);
+}
+
+asio::awaitable<bool> AdmissionControl::acquire(CostClass cost_class) {
+    // The fast lane: cheap requests are never delayed by the others
+    if (cost_class == CostClass::cheap) {
+        ++class_in_flight_[index(cost_class)];
+        ++global_.counters_.admitted;
+        ++global_.counters_.fast_lane;
+        co_return true;
+    }
+
+    // The requests already waiting on this context go first
+    if (queued_ == 0 && try_acquire(cost_class)) {
+        ++global_.counters_.admitted;
+        co_return true;
+    }
+
+    if ((limits_.max_queue_depth > 0 && queued_ >= limits_.max_queue_depth) || !global_.try_enqueue()) {
+        ++shed_;
+        ++global_.counters_.shed;
+        SILKRPC_DEBUG << "AdmissionControl::acquire request shed in_flight: " << in_flight_ << " queued: " << queued_ << "\n";
+        co_return false;
+    }
+
+    Waiter waiter{asio::steady_timer{io_context_, asio::steady_timer::time_point::max()}};
+    waiters_[index(cost_class)].push_back(&waiter);
+    ++queued_;
+    // The slot may be already free for this class, e.g. when the waiting requests are all heavy ones
+    dispatch();
+    while (!waiter.granted) {
+        asio::error_code error;
+        co_await waiter.timer.async_wait(asio::redirect_error(asio::use_awaitable, error));
+    }
+
+    ++global_.counters_.admitted;
+    ++global_.counters_.delayed;
+    co_return true;
+}
+
+void AdmissionControl::release(CostClass cost_class) {
+    --class_in_flight_[index(cost_class)];
+    if (cost_class == CostClass::cheap) {
+        return;
+    }
+    --in_flight_;
+    global_.release();
+    dispatch();
+}
+
+void AdmissionControl::notify() {
+    asio::post(io_context_, [&]() { dispatch(); });
+}
+
+bool AdmissionControl::has_local_slot(CostClass cost_class) const {
+    if (limits_.max_in_flight > 0 && in_flight_ >= limits_.max_in_flight) {
+        return false;
+    }
+    if (cost_class == CostClass::heavy && limits_.max_heavy_in_flight > 0 && class_in_flight_[index(cost_class)] >= limits_.max_heavy_in_flight) {
+        return false;
+    }
+    return true;
+}
+
+std::size_t AdmissionControl::weight_of(CostClass cost_class) const {
+    return std::max<std::size_t>(cost_class == CostClass::heavy ? limits_.heavy_weight : limits_.standard_weight, 1);
+}
+
+bool AdmissionControl::try_acquire(CostClass cost_class) {
+    if (!has_local_slot(cost_class) || !global_.try_acquire()) {
+        return false;
+    }
+    ++in_flight_;
+    ++class_in_flight_[index(cost_class)];
+    return true;
+}
+
+void AdmissionControl::dispatch() {
+    constexpr std::array<CostClass, 2> kQueuedClasses{CostClass::standard, CostClass::heavy};
+    while (queued_ > 0) {
+        // Smooth weighted round-robin among the classes whose first waiting request fits the local limits
+        std::size_t total_weight{0};
+        std::size_t chosen{kNumCostClasses};
+        for (const auto cost_class : kQueuedClasses) {
+            const auto i = index(cost_class);
+            if (waiters_[i].empty() || !has_local_slot(cost_class)) {
+                continue;
+            }
+            const auto weight = weight_of(cost_class);
+            current_weights_[i] += static_cast<int64_t>(weight);
+            total_weight += weight;
+            if (chosen == kNumCostClasses || current_weights_[i] > current_weights_[chosen]) {
+                chosen = i;
+            }
+        }
+        if (chosen == kNumCostClasses) {
+            break;
+        }
+        if (!global_.try_acquire()) {
+            // No global slot: undo this round, the waiting requests will be notified when one is freed
+            for (const auto cost_class : kQueuedClasses) {
+                const auto i = index(cost_class);
+                if (!waiters_[i].empty() && has_local_slot(cost_class)) {
+                    current_weights_[i] -= static_cast<int64_t>(weight_of(cost_class));
+                }
+            }
+            break;
+        }
+        current_weights_[chosen] -= static_cast<int64_t>(total_weight);
+        ++in_flight_;
+        ++class_in_flight_[chosen];
+
+        auto* waiter = waiters_[chosen].front();
+        waiters_[chosen].pop_front();
+        --queued_;
+        global_.dequeue();
+        waiter->granted = true;
+        waiter->timer.cancel();
+    }
+}
+
+} // namespace silkrpc::http
@@ -0,0 +1,200 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_ADMISSION_CONTROL_HPP_
+#define SILKRPC_HTTP_ADMISSION_CONTROL_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <silkrpc/config.hpp>
+
+#include <asio/awaitable.hpp>
+#include <asio/io_context.hpp>
+#include <asio/steady_timer.hpp>
+
+namespace silkrpc::http {
+
+/// The cost classes of the requests, depending on the amount of work required by their methods.
+enum class CostClass : std::size_t {
+    cheap,      // answered from memory or with a few reads, served in a fast lane bypassing the limits
+    standard,   // reading a bounded amount of chain data
+    heavy       // scanning ranges of chain data or executing transactions, with its own concurrency budget
+};
+
+/// The number of cost classes.
+constexpr std::size_t kNumCostClasses{3};
+
+/// The limits on the requests handled concurrently, zero meaning unlimited.
+struct AdmissionLimits {
+    /// The maximum number of standard and heavy requests being handled
+    std::size_t max_in_flight{0};
+
+    /// The maximum number of requests waiting to be handled, beyond which new requests are shed
+    std::size_t max_queue_depth{0};
+
+    /// The maximum number of heavy requests being handled, a share of the in-flight ones
+    std::size_t max_heavy_in_flight{0};
+
+    /// The relative shares of the freed slots given to the waiting standard and heavy requests
+    std::size_t standard_weight{4};
+    std::size_t heavy_weight{1};
+};
+
+/// The counters of the admission decisions, which can be read from any thread.
+struct AdmissionCounters {
+    /// The number of requests admitted, either immediately or after waiting
+    std::atomic<uint64_t> admitted{0};
+
+    /// The number of cheap requests admitted in the fast lane, included in the admitted ones
+    std::atomic<uint64_t> fast_lane{0};
+
+    /// The number of requests admitted after waiting for a free slot
+    std::atomic<uint64_t> delayed{0};
+
+    /// The number of requests rejected because the queues were full
+    std::atomic<uint64_t> shed{0};
+};
+
+class AdmissionControl;
+
+/// The admission state shared by all the contexts, enforcing the global limits.
+class GlobalAdmission {
+public:
+    GlobalAdmission(const GlobalAdmission&) = delete;
+    GlobalAdmission& operator=(const GlobalAdmission&) = delete;
+
+    explicit GlobalAdmission(const AdmissionLimits& limits) : limits_{limits} {}
+
+    const AdmissionCounters& counters() const { return counters_; }
+
+    std::size_t in_flight() const { return in_flight_; }
+
+    std::size_t queued() const { return queued_; }
+
+private:
+    friend class AdmissionControl;
+
+    bool try_acquire();
+    void release();
+
+    bool try_enqueue();
+    void dequeue();
+
+    void add(AdmissionControl* control) { controls_.push_back(control); }
+
+    AdmissionLimits limits_;
+    std::atomic<std::size_t> in_flight_{0};
+    std::atomic<std::size_t> queued_{0};
+    AdmissionCounters counters_;
+
+    // The per-context controls notified when a slot is freed while requests are waiting, registered before starting
+    std::vector<AdmissionControl*> controls_;
+};
+
+/// The admission control of one context: cheap requests are always admitted, the others are admitted up to the
+/// in-flight limits, then they wait up to the queue-depth limits and beyond that they are shed. The freed slots are
+/// handed over to the waiting requests in weighted-fair order between cost classes, FIFO within each class.
+/// All the methods except notify must be called from the thread running the context io_context.
+class AdmissionControl {
+public:
+    AdmissionControl(const AdmissionControl&) = delete;
+    AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+    explicit AdmissionControl(asio::io_context& io_context, const AdmissionLimits& limits, GlobalAdmission& global);
+
+    /// Acquire one slot for handling a request of the given cost class, waiting if necessary. Return false if the
+    /// request must be shed.
+    asio::awaitable<bool> acquire(CostClass cost_class = CostClass::standard);
+
+    /// Release the slot acquired by a request of the given cost class when it has been handled.
+    void release(CostClass cost_class = CostClass::standard);
+
+    /// Hand over the slots freed on any context to the waiting requests, callable from any thread.
+    void notify();
+
+    std::size_t in_flight() const { return in_flight_; }
+
+    std::size_t in_flight(CostClass cost_class) const { return class_in_flight_[index(cost_class)]; }
+
+    std::size_t queued() const { return queued_; }
+
+    std::size_t queued(CostClass cost_class) const { return waiters_[index(cost_class)].size(); }
+
+    uint64_t shed() const { return shed_; }
+
+    /// Check if any request may be shed, i.e. if the waiting requests are bounded by a queue depth.
+    bool may_shed() const { return limits_.max_queue_depth > 0 || global_.limits_.max_queue_depth > 0; }
+
+private:
+    // A request waiting for a slot, woken up by cancelling its timer once the slot has been acquired on its behalf
+    struct Waiter {
+        asio::steady_timer timer;
+        bool granted{false};
+    };
+
+    static constexpr std::size_t index(CostClass cost_class) { return static_cast<std::size_t>(cost_class); }
+
+    bool has_local_slot(CostClass cost_class) const;
+
+    std::size_t weight_of(CostClass cost_class) const;
+
+    bool try_acquire(CostClass cost_class);
+
+    // Grant the free slots to the waiting requests
+    void dispatch();
+
+    asio::io_context& io_context_;
+    AdmissionLimits limits_;
+    GlobalAdmission& global_;
+    std::size_t in_flight_{0};
+    std::size_t queued_{0};
+    uint64_t shed_{0};
+
+    std::array<std::size_t, kNumCostClasses> class_in_flight_{};
+    std::array<std::deque<Waiter*>, kNumCostClasses> waiters_;
+
+    // The current weights of the smooth weighted round-robin among the cost classes having waiting requests
+    std::array<int64_t, kNumCostClasses> current_weights_{};
+};
+
+/// The slot acquired by one request, released on destruction.
+class AdmissionSlot {
+public:
+    AdmissionSlot(const AdmissionSlot&) = delete;
+    AdmissionSlot& operator=(const AdmissionSlot&) = delete;
+
+    explicit AdmissionSlot(AdmissionControl* control = nullptr, CostClass cost_class = CostClass::standard)
+    : control_{control}, cost_class_{cost_class} {}
+
+    ~AdmissionSlot() {
+        if (control_ != nullptr) {
+            control_->release(cost_class_);
+        }
+    }
+
+private:
+    AdmissionControl* control_;
+    CostClass cost_class_;
+};
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_ADMISSION_CONTROL_HPP_
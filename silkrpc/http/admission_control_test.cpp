@@ -0,0 +1,215 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "admission_control.hpp"
+
+#include <chrono>
+#include <future>
+#include <vector>
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/use_future.hpp>
+#include <catch2/catch.hpp>
+
+namespace silkrpc::http {
+
+using namespace std::chrono_literals;
+
+TEST_CASE("AdmissionControl::acquire unlimited", "[silkrpc][http][admission_control]") {
+    asio::io_context io_context;
+    GlobalAdmission global{AdmissionLimits{}};
+    AdmissionControl control{io_context, AdmissionLimits{}, global};
+
+    auto result1 = asio::co_spawn(io_context, control.acquire(), asio::use_future);
+    auto result2 = asio::co_spawn(io_context, control.acquire(), asio::use_future);
+    io_context.poll();
+    CHECK(result1.get());
+    CHECK(result2.get());
+    CHECK(!control.may_shed());
+    CHECK(control.in_flight() == 2);
+    CHECK(global.in_flight() == 2);
+    CHECK(global.counters().admitted == 2);
+    control.release();
+    control.release();
+    CHECK(control.in_flight() == 0);
+    CHECK(global.in_flight() == 0);
+}
+
+TEST_CASE("AdmissionControl::acquire context limits", "[silkrpc][http][admission_control]") {
+    asio::io_context io_context;
+    GlobalAdmission global{AdmissionLimits{}};
+    AdmissionControl control{io_context, AdmissionLimits{2, 1}, global};
+
+    auto result1 = asio::co_spawn(io_context, control.acquire(), asio::use_future);
+    auto result2 = asio::co_spawn(io_context, control.acquire(), asio::use_future);
+    auto result3 = asio::co_spawn(io_context, control.acquire(), asio::use_future);
+    auto result4 = asio::co_spawn(io_context, control.acquire(), asio::use_future);
+    io_context.poll();
+    CHECK(result1.get());
+    CHECK(result2.get());
+    CHECK(result3.wait_for(0s) == std::future_status::timeout);
+    CHECK(!result4.get());
+    CHECK(control.may_shed());
+    CHECK(control.in_flight() == 2);
+    CHECK(control.queued() == 1);
+    CHECK(control.shed() == 1);
+    CHECK(global.counters().shed == 1);
+
+    control.release();
+    io_context.poll();
+    CHECK(result3.get());
+    CHECK(control.in_flight() == 2);
+    CHECK(control.queued() == 0);
+    CHECK(global.queued() == 0);
+    CHECK(global.counters().admitted == 3);
+    CHECK(global.counters().delayed == 1);
+    control.release();
+    control.release();
+}
+
+TEST_CASE("AdmissionControl::acquire global limits", "[silkrpc][http][admission_control]") {
+    asio::io_context io_context;
+    GlobalAdmission global{AdmissionLimits{1, 1}};
+    AdmissionControl control1{io_context, AdmissionLimits{}, global};
+    AdmissionControl control2{io_context, AdmissionLimits{}, global};
+
+    auto result1 = asio::co_spawn(io_context, control1.acquire(), asio::use_future);
+    auto result2 = asio::co_spawn(io_context, control2.acquire(), asio::use_future);
+    auto result3 = asio::co_spawn(io_context, control2.acquire(), asio::use_future);
+    io_context.poll();
+    CHECK(result1.get());
+    CHECK(result2.wait_for(0s) == std::future_status::timeout);
+    CHECK(!result3.get());
+    CHECK(control1.may_shed());
+    CHECK(global.in_flight() == 1);
+    CHECK(global.queued() == 1);
+
+    // The slot freed on one context is taken by the request waiting on the other one
+    control1.release();
+    io_context.poll();
+    CHECK(result2.get());
+    CHECK(control1.in_flight() == 0);
+    CHECK(control2.in_flight() == 1);
+    CHECK(global.queued() == 0);
+    control2.release();
+}
+
+TEST_CASE("AdmissionControl::acquire cheap requests in fast lane", "[silkrpc][http][admission_control]") {
+    asio::io_context io_context;
+    GlobalAdmission global{AdmissionLimits{}};
+    AdmissionControl control{io_context, AdmissionLimits{1, 1}, global};
+
+    auto result1 = asio::co_spawn(io_context, control.acquire(CostClass::standard), asio::use_future);
+    auto result2 = asio::co_spawn(io_context, control.acquire(CostClass::standard), asio::use_future);
+    auto result3 = asio::co_spawn(io_context, control.acquire(CostClass::cheap), asio::use_future);
+    io_context.poll();
+    CHECK(result1.get());
+    CHECK(result2.wait_for(0s) == std::future_status::timeout);
+    CHECK(result3.get());
+    CHECK(control.in_flight() == 1);
+    CHECK(control.in_flight(CostClass::cheap) == 1);
+    CHECK(global.counters().fast_lane == 1);
+
+    control.release(CostClass::cheap);
+    io_context.poll();
+    CHECK(result2.wait_for(0s) == std::future_status::timeout);
+    control.release(CostClass::standard);
+    io_context.poll();
+    CHECK(result2.get());
+    control.release(CostClass::standard);
+}
+
+TEST_CASE("AdmissionControl::acquire heavy requests within budget", "[silkrpc][http][admission_control]") {
+    asio::io_context io_context;
+    GlobalAdmission global{AdmissionLimits{}};
+    AdmissionControl control{io_context, AdmissionLimits{2, 0, 1}, global};
+
+    auto result1 = asio::co_spawn(io_context, control.acquire(CostClass::heavy), asio::use_future);
+    auto result2 = asio::co_spawn(io_context, control.acquire(CostClass::heavy), asio::use_future);
+    auto result3 = asio::co_spawn(io_context, control.acquire(CostClass::standard), asio::use_future);
+    io_context.poll();
+    CHECK(result1.get());
+    CHECK(result2.wait_for(0s) == std::future_status::timeout);
+    // The waiting heavy request does not hold back the standard one
+    CHECK(result3.get());
+    CHECK(control.in_flight(CostClass::heavy) == 1);
+    CHECK(control.queued(CostClass::heavy) == 1);
+
+    control.release(CostClass::standard);
+    io_context.poll();
+    CHECK(result2.wait_for(0s) == std::future_status::timeout);
+    control.release(CostClass::heavy);
+    io_context.poll();
+    CHECK(result2.get());
+    control.release(CostClass::heavy);
+}
+
+TEST_CASE("AdmissionControl::acquire weighted-fair between classes", "[silkrpc][http][admission_control]") {
+    asio::io_context io_context;
+    GlobalAdmission global{AdmissionLimits{}};
+    AdmissionLimits limits{1};
+    limits.standard_weight = 2;
+    limits.heavy_weight = 1;
+    AdmissionControl control{io_context, limits, global};
+
+    auto first = asio::co_spawn(io_context, control.acquire(CostClass::standard), asio::use_future);
+    io_context.poll();
+    CHECK(first.get());
+    // The io_context has run out of work, so it must be restarted before polling it again
+    io_context.restart();
+
+    std::vector<CostClass> granted;
+    for (const auto cost_class : {CostClass::standard, CostClass::standard, CostClass::standard, CostClass::heavy, CostClass::heavy}) {
+        asio::co_spawn(io_context, [&, cost_class]() -> asio::awaitable<void> {
+            if (co_await control.acquire(cost_class)) {
+                granted.push_back(cost_class);
+            }
+        }, asio::detached);
+    }
+    io_context.poll();
+    CHECK(granted.empty());
+    CHECK(control.queued() == 5);
+
+    control.release(CostClass::standard);
+    for (std::size_t i{0}; i < 5; ++i) {
+        io_context.poll();
+        REQUIRE(granted.size() == i + 1);
+        control.release(granted.back());
+    }
+    io_context.poll();
+    CHECK(granted == std::vector<CostClass>{CostClass::standard, CostClass::heavy, CostClass::standard, CostClass::standard, CostClass::heavy});
+    CHECK(control.in_flight() == 0);
+    CHECK(global.counters().delayed == 5);
+}
+
+TEST_CASE("AdmissionSlot releases on destruction", "[silkrpc][http][admission_control]") {
+    asio::io_context io_context;
+    GlobalAdmission global{AdmissionLimits{}};
+    AdmissionControl control{io_context, AdmissionLimits{}, global};
+
+    auto result = asio::co_spawn(io_context, control.acquire(), asio::use_future);
+    io_context.poll();
+    CHECK(result.get());
+    {
+        AdmissionSlot slot{&control};
+        CHECK(control.in_flight() == 1);
+    }
+    CHECK(control.in_flight() == 0);
+    CHECK_NOTHROW(AdmissionSlot{});
+}
+
+} // namespace silkrpc::http
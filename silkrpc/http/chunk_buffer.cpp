@@ -0,0 +1,128 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "chunk_buffer.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace silkrpc::http {
+
+std::unique_ptr<char[]> ChunkPool::acquire() {
+    if (free_chunks_.empty()) {
+        return std::unique_ptr<char[]>{new char[kChunkSize]};
+    }
+    auto chunk = std::move(free_chunks_.back());
+    free_chunks_.pop_back();
+    return chunk;
+}
+
+void ChunkPool::release(std::unique_ptr<char[]> chunk) {
+    if (free_chunks_.size() < max_free_chunks_) {
+        free_chunks_.push_back(std::move(chunk));
+    }
+}
+
+/// Adapter letting the JSON serializer write directly into the chunks.
+class ChunkOutputAdapter : public nlohmann::detail::output_adapter_protocol<char> {
+public:
+    explicit ChunkOutputAdapter(ChunkBuffer& buffer) : buffer_(buffer) {}
+
+    void write_character(char c) override { buffer_.append(c); }
+
+    void write_characters(const char* s, std::size_t length) override { buffer_.append(s, length); }
+
+private:
+    ChunkBuffer& buffer_;
+};
+
+ChunkBuffer::ChunkBuffer(ChunkBuffer&& other) noexcept
+: pool_{other.pool_}, chunks_{std::move(other.chunks_)}, size_{std::exchange(other.size_, 0)} {
+}
+
+ChunkBuffer& ChunkBuffer::operator=(ChunkBuffer&& other) noexcept {
+    if (this != &other) {
+        clear();
+        pool_ = other.pool_;
+        chunks_ = std::move(other.chunks_);
+        size_ = std::exchange(other.size_, 0);
+        other.chunks_.clear();
+    }
+    return *this;
+}
+
+void ChunkBuffer::append(const char* data, std::size_t length) {
+    while (length > 0) {
+        if (size_ == chunks_.size() * ChunkPool::kChunkSize) {
+            chunks_.push_back(acquire_chunk());
+        }
+        const auto offset = size_ % ChunkPool::kChunkSize;
+        const auto count = std::min(length, ChunkPool::kChunkSize - offset);
+        std::copy_n(data, count, chunks_.back().get() + offset);
+        data += count;
+        length -= count;
+        size_ += count;
+    }
+}
+
+void ChunkBuffer::append(char c) {
+    append(&c, 1);
+}
+
+void ChunkBuffer::append_json(const nlohmann::json& json) {
+    nlohmann::detail::serializer<nlohmann::json> serializer{std::make_shared<ChunkOutputAdapter>(*this), ' '};
+    serializer.dump(json, /*pretty_print=*/false, /*ensure_ascii=*/false, /*indent_step=*/0);
+}
+
+void ChunkBuffer::clear() {
+    for (auto& chunk : chunks_) {
+        if (pool_ != nullptr) {
+            pool_->release(std::move(chunk));
+        }
+    }
+    chunks_.clear();
+    size_ = 0;
+}
+
+void ChunkBuffer::append_to(std::vector<asio::const_buffer>& buffers) const {
+    auto remaining = size_;
+    for (const auto& chunk : chunks_) {
+        const auto count = std::min(remaining, ChunkPool::kChunkSize);
+        buffers.emplace_back(chunk.get(), count);
+        remaining -= count;
+    }
+}
+
+std::string ChunkBuffer::to_string() const {
+    std::string content;
+    content.reserve(size_);
+    auto remaining = size_;
+    for (const auto& chunk : chunks_) {
+        const auto count = std::min(remaining, ChunkPool::kChunkSize);
+        content.append(chunk.get(), count);
+        remaining -= count;
+    }
+    return content;
+}
+
+std::unique_ptr<char[]> ChunkBuffer::acquire_chunk() {
+    if (pool_ != nullptr) {
+        return pool_->acquire();
+    }
+    return std::unique_ptr<char[]>{new char[ChunkPool::kChunkSize]};
+}
+
+} // namespace silkrpc::http
@@ -0,0 +1,97 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_CHUNK_BUFFER_HPP_
+#define SILKRPC_HTTP_CHUNK_BUFFER_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <asio/buffer.hpp>
+#include <nlohmann/json.hpp>
+
+namespace silkrpc::http {
+
+/// Free list of fixed-size memory chunks, owned by one context so that it is never accessed concurrently. The chunks
+/// of the replies written are recycled among all the connections of the context, so idle connections hold none.
+class ChunkPool {
+public:
+    static constexpr std::size_t kChunkSize{16 * 1024};
+    static constexpr std::size_t kDefaultMaxFreeChunks{256};
+
+    explicit ChunkPool(std::size_t max_free_chunks = kDefaultMaxFreeChunks) : max_free_chunks_{max_free_chunks} {}
+
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    /// Get a chunk from the free list or allocate a new one if none is available.
+    std::unique_ptr<char[]> acquire();
+
+    /// Give back the chunk to the free list, the chunk is deallocated if the free list is full.
+    void release(std::unique_ptr<char[]> chunk);
+
+    std::size_t free_chunks() const { return free_chunks_.size(); }
+
+private:
+    std::size_t max_free_chunks_;
+    std::vector<std::unique_ptr<char[]>> free_chunks_;
+};
+
+/// Output buffer made of pooled chunks, whose content is written without any intermediate contiguous copy.
+class ChunkBuffer {
+public:
+    explicit ChunkBuffer(ChunkPool* pool = nullptr) : pool_{pool} {}
+    ~ChunkBuffer() { clear(); }
+
+    ChunkBuffer(const ChunkBuffer&) = delete;
+    ChunkBuffer& operator=(const ChunkBuffer&) = delete;
+
+    ChunkBuffer(ChunkBuffer&& other) noexcept;
+    ChunkBuffer& operator=(ChunkBuffer&& other) noexcept;
+
+    void append(const char* data, std::size_t length);
+
+    void append(char c);
+
+    /// Serialize the JSON value directly into the chunks.
+    void append_json(const nlohmann::json& json);
+
+    std::size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    /// Release all the chunks to the pool.
+    void clear();
+
+    /// Add the buffers pointing to the used part of the chunks, which must not change until the write operation has completed.
+    void append_to(std::vector<asio::const_buffer>& buffers) const;
+
+    /// Copy the content into a string, just for logging and testing.
+    std::string to_string() const;
+
+private:
+    std::unique_ptr<char[]> acquire_chunk();
+
+    ChunkPool* pool_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    std::size_t size_{0};
+};
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_CHUNK_BUFFER_HPP_
@@ -0,0 +1,107 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "chunk_buffer.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc {
+
+using Catch::Matchers::Message;
+
+TEST_CASE("chunk pool recycles chunks", "[silkrpc][http][chunk_buffer]") {
+    http::ChunkPool pool{1};
+    auto chunk1 = pool.acquire();
+    auto chunk2 = pool.acquire();
+    const auto* chunk1_ptr = chunk1.get();
+    pool.release(std::move(chunk1));
+    pool.release(std::move(chunk2));
+    CHECK(pool.free_chunks() == 1);
+    CHECK(pool.acquire().get() == chunk1_ptr);
+    CHECK(pool.free_chunks() == 0);
+}
+
+TEST_CASE("append to chunk buffer", "[silkrpc][http][chunk_buffer]") {
+    http::ChunkPool pool;
+
+    SECTION("empty") {
+        http::ChunkBuffer buffer{&pool};
+        std::vector<asio::const_buffer> buffers;
+        buffer.append_to(buffers);
+        CHECK(buffer.empty());
+        CHECK(buffers.empty());
+    }
+
+    SECTION("across chunk boundaries") {
+        const std::string data(http::ChunkPool::kChunkSize * 2 + 10, 'x');
+        {
+            http::ChunkBuffer buffer{&pool};
+            buffer.append(data.data(), 5);
+            buffer.append(data.data() + 5, data.size() - 5);
+            CHECK(buffer.size() == data.size());
+            CHECK(buffer.to_string() == data);
+
+            std::vector<asio::const_buffer> buffers;
+            buffer.append_to(buffers);
+            CHECK(buffers.size() == 3);
+            CHECK(buffers[0].size() == http::ChunkPool::kChunkSize);
+            CHECK(buffers[2].size() == 10);
+        }
+        CHECK(pool.free_chunks() == 3);
+    }
+
+    SECTION("without pool") {
+        http::ChunkBuffer buffer;
+        buffer.append('a');
+        buffer.append('b');
+        CHECK(buffer.to_string() == "ab");
+    }
+}
+
+TEST_CASE("append JSON to chunk buffer", "[silkrpc][http][chunk_buffer]") {
+    http::ChunkPool pool;
+    http::ChunkBuffer buffer{&pool};
+    const auto json = R"({"jsonrpc":"2.0","id":1,"result":["0x01","0x02"]})"_json;
+    buffer.append_json(json);
+    CHECK(buffer.to_string() == json.dump());
+
+    nlohmann::json large_json = nlohmann::json::array();
+    for (int i{0}; i < 10000; ++i) {
+        large_json.push_back({{"blockNumber", i}, {"data", "0x0123456789abcdef"}});
+    }
+    buffer.clear();
+    buffer.append_json(large_json);
+    CHECK(buffer.size() > http::ChunkPool::kChunkSize);
+    CHECK(buffer.to_string() == large_json.dump());
+}
+
+TEST_CASE("move chunk buffer", "[silkrpc][http][chunk_buffer]") {
+    http::ChunkPool pool;
+    http::ChunkBuffer buffer1{&pool};
+    buffer1.append("abc", 3);
+    http::ChunkBuffer buffer2{std::move(buffer1)};
+    CHECK(buffer1.empty()); // NOLINT(bugprone-use-after-move)
+    CHECK(buffer2.to_string() == "abc");
+    http::ChunkBuffer buffer3;
+    buffer3 = std::move(buffer2);
+    CHECK(buffer3.to_string() == "abc");
+}
+
+} // namespace silkrpc
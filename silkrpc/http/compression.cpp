@@ -0,0 +1,197 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "compression.hpp"
+
+#include <array>
+#include <charconv>
+#include <stdexcept>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/match.h>
+#include <absl/strings/str_split.h>
+#include <zlib.h>
+#ifdef SILKRPC_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace silkrpc::http {
+
+const char* to_string(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::gzip: return "gzip";
+        case ContentEncoding::deflate: return "deflate";
+        case ContentEncoding::zstd: return "zstd";
+        default: return "identity";
+    }
+}
+
+bool is_supported(ContentEncoding encoding) {
+    if (encoding == ContentEncoding::zstd) {
+#ifdef SILKRPC_HAS_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return true;
+}
+
+// Parse the quality value of one Accept-Encoding element, e.g. "gzip;q=0.5" [RFC 7231 5.3.1]
+static double parse_quality(absl::string_view parameters) {
+    for (auto parameter : absl::StrSplit(parameters, ';')) {
+        parameter = absl::StripAsciiWhitespace(parameter);
+        if (absl::StartsWithIgnoreCase(parameter, "q=")) {
+            parameter.remove_prefix(2);
+            // Quality values have at most 3 decimal digits: parse them as thousandths to avoid locale-dependent conversions
+            int integer_part{0}, thousandths{0};
+            const auto [ptr, ec] = std::from_chars(parameter.data(), parameter.data() + parameter.size(), integer_part);
+            if (ec != std::errc{}) {
+                return 0;
+            }
+            if (ptr != parameter.data() + parameter.size() && *ptr == '.') {
+                int scale{100};
+                for (auto it = ptr + 1; it != parameter.data() + parameter.size() && scale > 0 && absl::ascii_isdigit(*it); ++it, scale /= 10) {
+                    thousandths += (*it - '0') * scale;
+                }
+            }
+            return integer_part + thousandths / 1000.0;
+        }
+    }
+    return 1;
+}
+
+ContentEncoding negotiate_encoding(absl::string_view accept_encoding) {
+    // The candidates in order of preference on equal quality
+    constexpr std::array<ContentEncoding, 3> kCandidates{ContentEncoding::zstd, ContentEncoding::gzip, ContentEncoding::deflate};
+    std::array<double, kCandidates.size()> qualities{-1, -1, -1};
+    double wildcard_quality{-1};
+
+    for (const auto element : absl::StrSplit(accept_encoding, ',', absl::SkipWhitespace())) {
+        const auto separator = element.find(';');
+        const auto coding = absl::StripAsciiWhitespace(element.substr(0, separator));
+        const auto quality = separator == absl::string_view::npos ? 1 : parse_quality(element.substr(separator + 1));
+        if (coding == "*") {
+            wildcard_quality = quality;
+            continue;
+        }
+        for (std::size_t i{0}; i < kCandidates.size(); ++i) {
+            if (absl::EqualsIgnoreCase(coding, to_string(kCandidates[i])) || (kCandidates[i] == ContentEncoding::gzip && absl::EqualsIgnoreCase(coding, "x-gzip"))) {
+                qualities[i] = quality;
+            }
+        }
+    }
+
+    ContentEncoding chosen{ContentEncoding::identity};
+    double best_quality{0};
+    for (std::size_t i{0}; i < kCandidates.size(); ++i) {
+        // The wildcard matches any coding not explicitly listed
+        const auto quality = qualities[i] < 0 ? wildcard_quality : qualities[i];
+        if (is_supported(kCandidates[i]) && quality > best_quality) {
+            chosen = kCandidates[i];
+            best_quality = quality;
+        }
+    }
+    return chosen;
+}
+
+static void compress_zlib(ContentEncoding encoding, const std::vector<asio::const_buffer>& input, std::string& output) {
+    // The gzip wrapper is selected by adding 16 to the window bits, the zlib one is the default
+    const int window_bits = encoding == ContentEncoding::gzip ? 15 + 16 : 15;
+    z_stream stream{};
+    if (deflateInit2(&stream, kCompressionLevel, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error{"deflateInit2 failed"};
+    }
+
+    uLong input_size{0};
+    for (const auto& buffer : input) {
+        input_size += buffer.size();
+    }
+    const auto offset = output.size();
+    output.resize(offset + deflateBound(&stream, input_size));
+    stream.next_out = reinterpret_cast<Bytef*>(output.data() + offset);
+    stream.avail_out = static_cast<uInt>(output.size() - offset);
+
+    int result{Z_OK};
+    for (std::size_t i{0}; i < input.size(); ++i) {
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<void*>(input[i].data()));
+        stream.avail_in = static_cast<uInt>(input[i].size());
+        result = deflate(&stream, i + 1 == input.size() ? Z_FINISH : Z_NO_FLUSH);
+        if (result == Z_STREAM_ERROR) {
+            break;
+        }
+    }
+    if (input.empty()) {
+        result = deflate(&stream, Z_FINISH);
+    }
+    const auto total_out = stream.total_out;
+    deflateEnd(&stream);
+    // The output buffer is large enough for the whole stream, so deflate must have finished in one go
+    if (result != Z_STREAM_END) {
+        throw std::runtime_error{"deflate failed: " + std::to_string(result)};
+    }
+    output.resize(offset + total_out);
+}
+
+#ifdef SILKRPC_HAS_ZSTD
+static void compress_zstd(const std::vector<asio::const_buffer>& input, std::string& output) {
+    std::size_t input_size{0};
+    for (const auto& buffer : input) {
+        input_size += buffer.size();
+    }
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    if (context == nullptr) {
+        throw std::runtime_error{"ZSTD_createCCtx failed"};
+    }
+    ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, kCompressionLevel);
+    ZSTD_CCtx_setPledgedSrcSize(context, input_size);
+
+    const auto offset = output.size();
+    output.resize(offset + ZSTD_compressBound(input_size));
+    ZSTD_outBuffer out{output.data() + offset, output.size() - offset, 0};
+    std::size_t result{0};
+    for (std::size_t i{0}; i <= input.size() && !ZSTD_isError(result); ++i) {
+        const bool last = i == input.size();
+        ZSTD_inBuffer in{last ? nullptr : input[i].data(), last ? 0 : input[i].size(), 0};
+        do {
+            result = ZSTD_compressStream2(context, &out, &in, last ? ZSTD_e_end : ZSTD_e_continue);
+        } while (!ZSTD_isError(result) && (in.pos < in.size || (last && result != 0)));
+    }
+    ZSTD_freeCCtx(context);
+    if (ZSTD_isError(result)) {
+        throw std::runtime_error{std::string{"ZSTD_compressStream2 failed: "} + ZSTD_getErrorName(result)};
+    }
+    output.resize(offset + out.pos);
+}
+#endif
+
+void compress(ContentEncoding encoding, const std::vector<asio::const_buffer>& input, std::string& output) {
+    switch (encoding) {
+        case ContentEncoding::gzip:
+        case ContentEncoding::deflate:
+            compress_zlib(encoding, input, output);
+            break;
+#ifdef SILKRPC_HAS_ZSTD
+        case ContentEncoding::zstd:
+            compress_zstd(input, output);
+            break;
+#endif
+        default:
+            throw std::runtime_error{std::string{"unsupported content encoding: "} + to_string(encoding)};
+    }
+}
+
+} // namespace silkrpc::http
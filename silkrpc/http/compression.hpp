@@ -0,0 +1,55 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_COMPRESSION_HPP_
+#define SILKRPC_HTTP_COMPRESSION_HPP_
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/string_view.h>
+#include <asio/buffer.hpp>
+
+namespace silkrpc::http {
+
+/// The content codings supported for the replies [RFC 7231 3.1.2.1].
+enum class ContentEncoding {
+    identity,
+    gzip,
+    deflate,
+    zstd
+};
+
+/// The compression level: speed is preferred over ratio, hex-heavy JSON content compresses well anyway.
+constexpr int kCompressionLevel{1};
+
+/// Get the name of the content coding as used in Accept-Encoding and Content-Encoding headers.
+const char* to_string(ContentEncoding encoding);
+
+/// Check if the content coding is available in this build.
+bool is_supported(ContentEncoding encoding);
+
+/// Choose the supported content coding with the highest quality value in the Accept-Encoding header value,
+/// identity if none is acceptable. On equal quality zstd is preferred to gzip, gzip to deflate.
+ContentEncoding negotiate_encoding(absl::string_view accept_encoding);
+
+/// Compress the data contained in the buffers as a single stream, appending it to the output.
+/// Throws std::runtime_error if the compression fails or the content coding is not supported.
+void compress(ContentEncoding encoding, const std::vector<asio::const_buffer>& input, std::string& output);
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_COMPRESSION_HPP_
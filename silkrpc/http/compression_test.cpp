@@ -0,0 +1,120 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "compression.hpp"
+
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <zlib.h>
+#ifdef SILKRPC_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace silkrpc::http {
+
+using Catch::Matchers::Message;
+
+static std::string inflate_all(const std::string& compressed, int window_bits) {
+    z_stream stream{};
+    REQUIRE(inflateInit2(&stream, window_bits) == Z_OK);
+    std::string output(1024 * 1024, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+    CHECK(inflate(&stream, Z_FINISH) == Z_STREAM_END);
+    output.resize(stream.total_out);
+    inflateEnd(&stream);
+    return output;
+}
+
+TEST_CASE("negotiate_encoding", "[silkrpc][http][compression]") {
+    CHECK(negotiate_encoding("") == ContentEncoding::identity);
+    CHECK(negotiate_encoding("identity") == ContentEncoding::identity);
+    CHECK(negotiate_encoding("br") == ContentEncoding::identity);
+    CHECK(negotiate_encoding("gzip") == ContentEncoding::gzip);
+    CHECK(negotiate_encoding("x-gzip") == ContentEncoding::gzip);
+    CHECK(negotiate_encoding("GZIP") == ContentEncoding::gzip);
+    CHECK(negotiate_encoding("deflate") == ContentEncoding::deflate);
+    CHECK(negotiate_encoding("deflate, gzip") == ContentEncoding::gzip);
+    CHECK(negotiate_encoding("gzip;q=0.5, deflate") == ContentEncoding::deflate);
+    CHECK(negotiate_encoding("gzip;q=0, deflate;q=0.1") == ContentEncoding::deflate);
+    CHECK(negotiate_encoding("gzip; q=0.000") == ContentEncoding::identity);
+    CHECK(negotiate_encoding("br;q=1.0, gzip;q=0.8, *;q=0.1") == ContentEncoding::gzip);
+    CHECK(negotiate_encoding("*;q=0") == ContentEncoding::identity);
+    if (is_supported(ContentEncoding::zstd)) {
+        CHECK(negotiate_encoding("gzip, deflate, zstd") == ContentEncoding::zstd);
+        CHECK(negotiate_encoding("*") == ContentEncoding::zstd);
+    } else {
+        CHECK(negotiate_encoding("zstd") == ContentEncoding::identity);
+        CHECK(negotiate_encoding("*") == ContentEncoding::gzip);
+    }
+}
+
+TEST_CASE("compress", "[silkrpc][http][compression]") {
+    std::string content{R"({"jsonrpc":"2.0","id":1,"result":[)"};
+    for (int i{0}; i < 1000; ++i) {
+        content += R"({"address":"0x0715a7794a1dc8e42615f059dd6e406a6594651a","topics":["0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c"]},)";
+    }
+    content += "{}]}";
+    // Split the content in many buffers, as for the reply content and body chunks
+    std::vector<asio::const_buffer> input;
+    for (std::size_t offset{0}; offset < content.size(); offset += 16384) {
+        input.emplace_back(content.data() + offset, std::min<std::size_t>(16384, content.size() - offset));
+    }
+
+    SECTION("gzip") {
+        std::string output;
+        compress(ContentEncoding::gzip, input, output);
+        CHECK(output.size() < content.size() / 5);
+        CHECK(static_cast<uint8_t>(output[0]) == 0x1f);
+        CHECK(static_cast<uint8_t>(output[1]) == 0x8b);
+        CHECK(inflate_all(output, 15 + 16) == content);
+    }
+
+    SECTION("deflate") {
+        std::string output{"prefix"};
+        compress(ContentEncoding::deflate, input, output);
+        CHECK(output.substr(0, 6) == "prefix");
+        CHECK(inflate_all(output.substr(6), 15) == content);
+    }
+
+    SECTION("empty input") {
+        std::string output;
+        compress(ContentEncoding::gzip, {}, output);
+        CHECK(inflate_all(output, 15 + 16).empty());
+    }
+
+    SECTION("identity") {
+        std::string output;
+        CHECK_THROWS_AS(compress(ContentEncoding::identity, input, output), std::runtime_error);
+    }
+
+#ifdef SILKRPC_HAS_ZSTD
+    SECTION("zstd") {
+        std::string output;
+        compress(ContentEncoding::zstd, input, output);
+        CHECK(output.size() < content.size() / 5);
+        std::string decompressed(content.size(), '\0');
+        CHECK(ZSTD_decompress(decompressed.data(), decompressed.size(), output.data(), output.size()) == content.size());
+        CHECK(decompressed == content);
+    }
+#endif
+}
+
+} // namespace silkrpc::http
@@ -22,23 +22,44 @@
 
 #include "connection.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
+#include <iterator>
+#include <string>
 #include <system_error>
 #include <string_view>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include <asio/compose.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/post.hpp>
+#include <asio/redirect_error.hpp>
 #include <asio/write.hpp>
 #include <asio/use_awaitable.hpp>
 
 #include <silkrpc/common/log.hpp>
 #include <silkrpc/common/util.hpp>
 #include <silkrpc/ethdb/database.hpp>
+#include "compression.hpp"
+#include "http2.hpp"
+#include "http2_connection.hpp"
 #include "request_handler.hpp"
+#include "websocket.hpp"
+#include "websocket_connection.hpp"
 
 namespace silkrpc::http {
 
-Connection::Connection(Context& context, asio::thread_pool& workers) : socket_{*context.io_context}, request_handler_{context, workers} {
+Connection::Connection(Context& context, asio::thread_pool& workers, const ServerSettings& settings, subscription::Broker* broker,
+    AdmissionControl* admission_control, ConnectionRegistry* registry, ReadBufferPool* read_buffer_pool, ChunkPool* chunk_pool, SingleFlight* single_flight)
+: context_(context), workers_(workers), settings_(settings), broker_(broker), admission_control_{admission_control}, single_flight_{single_flight},
+  socket_{*context.io_context}, chunk_pool_{chunk_pool}, request_handler_{context, workers, settings.max_batch_size, admission_control, settings.retry_after, single_flight, settings.api_namespaces},
+  read_buffer_pool_{read_buffer_pool},
+  request_parser_{settings.max_body_size}, write_done_{*context.io_context, asio::steady_timer::time_point::max()},
+  registry_{registry}, watchdog_{*context.io_context, asio::steady_timer::time_point::max()} {
     request_.content.reserve(1024);
     request_.headers.reserve(8);
     request_.method.reserve(64);
@@ -47,32 +68,184 @@ Connection::Connection(Context& context, asio::thread_pool& workers) : socket_{*
 }
 
 Connection::~Connection() {
+    if (registry_ != nullptr) {
+        registry_->remove(this);
+    }
+    if (read_buffer_pool_ != nullptr) {
+        read_buffer_pool_->release(std::move(buffer_));
+    }
     socket_.close();
     SILKRPC_DEBUG << "Connection::~Connection socket " << &socket_ << " deleted\n";
 }
 
+void Connection::reap() {
+    // Called from any thread: the socket is closed on its own executor, unless the connection is already gone
+    asio::post(socket_.get_executor(), [weak_self = weak_from_this()]() {
+        if (auto self = weak_self.lock()) {
+            SILKRPC_DEBUG << "Connection::reap closing idle socket: " << &self->socket_ << "\n";
+            std::error_code ec;
+            self->socket_.close(ec);
+        }
+    });
+}
+
 asio::awaitable<void> Connection::start() {
+    reading_ = true;
+    const bool timeouts_enabled = settings_.header_read_timeout.count() > 0 || settings_.body_read_timeout.count() > 0 ||
+        settings_.idle_timeout.count() > 0 || settings_.write_timeout.count() > 0;
+    if (timeouts_enabled) {
+        // The watchdog keeps this connection alive until both reading and writing are over
+        asio::co_spawn(socket_.get_executor(), [self = shared_from_this()]() { return self->watchdog(); }, asio::detached);
+    }
     co_await do_read();
+    reading_ = false;
+    watchdog_.cancel();
+}
+
+asio::awaitable<void> Connection::watchdog() {
+    while (reading_ || writing_) {
+        const auto deadline = std::min(read_deadline_, write_deadline_);
+        if (deadline <= asio::steady_timer::clock_type::now()) {
+            // Closing the socket cancels the pending read and write, so that the connection is released
+            SILKRPC_DEBUG << "Connection::watchdog timeout expired, closing socket: " << &socket_ << "\n";
+            std::error_code ec;
+            socket_.close(ec);
+            co_return;
+        }
+        watchdog_.expires_at(deadline);
+        asio::error_code error;
+        co_await watchdog_.async_wait(asio::redirect_error(asio::use_awaitable, error));
+    }
+}
+
+void Connection::arm_read_deadline() {
+    const auto phase = request_parser_.phase();
+    // The connection is not idle until its replies have been written, the write timeout applies meanwhile
+    if (phase == RequestParser::idle && (writing_ || !replies_.empty())) {
+        read_phase_ = phase;
+        phase_deadline_ = asio::steady_timer::time_point::max();
+        read_deadline_ = phase_deadline_;
+        return;
+    }
+    // The headers and content deadlines are not extended by each read, so that slow clients cannot hold the connection
+    if (phase == RequestParser::idle || phase != read_phase_) {
+        read_phase_ = phase;
+        const auto timeout = phase == RequestParser::idle ? settings_.idle_timeout :
+            phase == RequestParser::headers ? settings_.header_read_timeout : settings_.body_read_timeout;
+        phase_deadline_ = timeout.count() > 0 ? asio::steady_timer::clock_type::now() + timeout : asio::steady_timer::time_point::max();
+    }
+    read_deadline_ = phase_deadline_;
+    update_watchdog(read_deadline_);
+}
+
+void Connection::prepare_read_buffer() {
+    // Large content is read in large chunks, while idle connections give back their large buffer
+    std::size_t read_size{ReadBufferPool::kMinBufferSize};
+    const auto phase = request_parser_.phase();
+    if (phase == RequestParser::content) {
+        read_size = request_.content_length - request_.content.size();
+    } else if (phase == RequestParser::idle && buffer_.size() > ReadBufferPool::kMinBufferSize) {
+        if (read_buffer_pool_ != nullptr) {
+            read_buffer_pool_->release(std::move(buffer_));
+        }
+        buffer_ = {};
+    }
+    if (buffer_.size() >= ReadBufferPool::buffer_size(read_size)) {
+        return;
+    }
+    if (read_buffer_pool_ != nullptr) {
+        read_buffer_pool_->release(std::move(buffer_));
+        buffer_ = read_buffer_pool_->acquire(read_size);
+    } else {
+        buffer_ = std::vector<char>(ReadBufferPool::buffer_size(read_size));
+    }
+}
+
+void Connection::update_watchdog(asio::steady_timer::time_point deadline) {
+    if (deadline < watchdog_.expiry()) {
+        watchdog_.cancel();
+    }
 }
 
 asio::awaitable<void> Connection::do_read() {
     try {
-        SILKRPC_DEBUG << "Connection::do_read going to read...\n" << std::flush;
-        std::size_t bytes_read = co_await socket_.async_read_some(asio::buffer(buffer_), asio::use_awaitable);
-        SILKRPC_DEBUG << "Connection::do_read bytes_read: " << bytes_read << "\n";
-        SILKRPC_TRACE << "Connection::do_read buffer: " << std::string_view{static_cast<const char*>(buffer_.data()), bytes_read} << "\n";
-        RequestParser::ResultType result = request_parser_.parse(request_, buffer_.data(), buffer_.data() + bytes_read);
-
-        if (result == RequestParser::good) {
-            co_await request_handler_.handle_request(request_, reply_);
-            co_await do_write();
-        } else if (result == RequestParser::bad) {
-            reply_ = Reply::stock_reply(Reply::bad_request);
-            co_await do_write();
-        }
+        bool keep_alive{true};
+        while (keep_alive) {
+            SILKRPC_DEBUG << "Connection::do_read going to read...\n" << std::flush;
+            arm_read_deadline();
+            prepare_read_buffer();
+            waiting_request_ = request_parser_.phase() == RequestParser::idle;
+            const bool track_idle = registry_ != nullptr && settings_.max_connections > 0;
+            if (track_idle && waiting_request_ && replies_.empty() && !writing_) {
+                registry_->mark_idle(this);
+            }
+            std::size_t bytes_read = co_await socket_.async_read_some(asio::buffer(buffer_), asio::use_awaitable);
+            read_deadline_ = asio::steady_timer::time_point::max();
+            waiting_request_ = false;
+            if (track_idle) {
+                registry_->mark_busy(this);
+            }
+            SILKRPC_DEBUG << "Connection::do_read bytes_read: " << bytes_read << "\n";
+            SILKRPC_TRACE << "Connection::do_read buffer: " << std::string_view{static_cast<const char*>(buffer_.data()), bytes_read} << "\n";
+
+            // The buffer may contain many pipelined requests: handle all the complete ones, keep parsing state for the last one
+            const char* begin = buffer_.data();
+            const char* end = buffer_.data() + bytes_read;
+            if (settings_.http2 && !preface_checked_) {
+                preface_checked_ = true;
+                if (http2::is_connection_preface(begin, end)) {
+                    co_await start_http2(begin, end);
+                    co_return;
+                }
+            }
+            while (begin != end && keep_alive) {
+                RequestParser::ResultType result;
+                std::tie(result, begin) = request_parser_.parse(request_, begin, end);
 
-        // Read next chunck (result == RequestParser::indeterminate) or next request
-        co_await do_read();
+                if (result == RequestParser::good) {
+                    // The upgrade is accepted only when no reply is pending, because then the socket is handed over
+                    if (broker_ != nullptr && websocket::is_upgrade_request(request_) && replies_.empty() && !writing_) {
+                        co_await upgrade(begin, end);
+                        co_return;
+                    }
+                    keep_alive = request_.keep_alive();
+                    Reply reply;
+                    reply.body = ChunkBuffer{chunk_pool_};
+                    // Chunked transfer coding is not available before HTTP/1.1
+                    const bool streaming = settings_.stream_buffer_size > 0 && (request_.http_version_major > 1 || request_.http_version_minor >= 1);
+                    ChunkedStreamWriter stream_writer{*this, keep_alive};
+                    co_await request_handler_.handle_request(request_, reply, streaming ? &stream_writer : nullptr);
+                    if (stream_writer.started()) {
+                        keep_alive = stream_writer.finish();
+                        request_.reset();
+                        request_parser_.reset();
+                        read_phase_ = RequestParser::idle;
+                        continue;
+                    }
+                    auto stream_content = stream_writer.release();
+                    if (!stream_content.empty()) {
+                        reply.body = std::move(stream_content);
+                    }
+                    if (settings_.compression_threshold > 0 && reply.content.size() + reply.body.size() >= settings_.compression_threshold) {
+                        co_await compress_reply(reply);
+                    }
+                    if (request_.http_version_major == 1 && request_.http_version_minor == 0 && keep_alive) {
+                        reply.headers.emplace_back(Header{"Connection", "keep-alive"});
+                    }
+                    enqueue_reply(std::move(reply), keep_alive);
+                    request_.reset();
+                    request_parser_.reset();
+                    read_phase_ = RequestParser::idle;
+                } else if (result == RequestParser::bad) {
+                    keep_alive = false;
+                    enqueue_reply(Reply::stock_reply(Reply::bad_request), keep_alive);
+                } else if (result == RequestParser::too_large) {
+                    SILKRPC_DEBUG << "Connection::do_read content length " << request_.content_length << " exceeds limit\n";
+                    keep_alive = false;
+                    enqueue_reply(Reply::stock_reply(Reply::payload_too_large), keep_alive);
+                }
+            }
+        }
     } catch (const std::system_error& se) {
         if (se.code() == asio::error::eof || se.code() == asio::error::connection_reset || se.code() == asio::error::broken_pipe) {
             SILKRPC_DEBUG << "Connection::do_read close from client with code: " << se.code() << "\n" << std::flush;
@@ -88,15 +261,198 @@ asio::awaitable<void> Connection::do_read() {
     }
 }
 
+asio::awaitable<void> Connection::wait_for_writer() {
+    // The writer takes all the queued replies together, so the queue is empty while they are being written
+    while (writing_ && !replies_.empty()) {
+        asio::error_code error;
+        co_await write_done_.async_wait(asio::redirect_error(asio::use_awaitable, error));
+    }
+}
+
+Connection::ChunkedStreamWriter::ChunkedStreamWriter(Connection& connection, bool keep_alive)
+: connection_(connection), keep_alive_{keep_alive}, buffer_{connection.chunk_pool_} {
+}
+
+asio::awaitable<void> Connection::ChunkedStreamWriter::write(std::string_view content) {
+    if (aborted_ || !connection_.socket_.is_open()) {
+        throw std::system_error{asio::error::broken_pipe};
+    }
+    buffer_.append(content.data(), content.size());
+    if (buffer_.size() < connection_.settings_.stream_buffer_size) {
+        co_return;
+    }
+
+    if (!started_) {
+        started_ = true;
+        Reply head;
+        head.status = Reply::ok;
+        head.framing = Reply::chunked_head;
+        if (!keep_alive_) {
+            head.headers.emplace_back(Header{"Connection", "close"});
+        }
+        connection_.enqueue_reply(std::move(head), /*keep_alive=*/true);
+    }
+    Reply chunk;
+    chunk.framing = Reply::chunk;
+    chunk.body = std::move(buffer_);
+    buffer_ = ChunkBuffer{connection_.chunk_pool_};
+    connection_.enqueue_reply(std::move(chunk), /*keep_alive=*/true);
+
+    // Backpressure: the content production is paused until the previous chunk has been written
+    co_await connection_.wait_for_writer();
+}
+
+bool Connection::ChunkedStreamWriter::discard() {
+    buffer_.clear();
+    if (started_) {
+        aborted_ = true;
+    }
+    return !started_;
+}
+
+bool Connection::ChunkedStreamWriter::finish() {
+    if (aborted_) {
+        // Closing without the last chunk lets the client detect the truncated reply
+        SILKRPC_DEBUG << "Connection::ChunkedStreamWriter::finish aborted, closing socket: " << &connection_.socket_ << "\n";
+        connection_.close_after_write_ = true;
+        if (!connection_.writing_) {
+            std::error_code ec;
+            connection_.socket_.close(ec);
+        }
+        return false;
+    }
+    if (!buffer_.empty()) {
+        Reply chunk;
+        chunk.framing = Reply::chunk;
+        chunk.body = std::move(buffer_);
+        connection_.enqueue_reply(std::move(chunk), /*keep_alive=*/true);
+    }
+    Reply last_chunk;
+    last_chunk.framing = Reply::chunk;
+    connection_.enqueue_reply(std::move(last_chunk), keep_alive_);
+    return keep_alive_;
+}
+
+asio::awaitable<void> Connection::compress_reply(Reply& reply) {
+    const auto encoding = negotiate_encoding(request_.header_value("Accept-Encoding"));
+    if (encoding == ContentEncoding::identity) {
+        co_return;
+    }
+
+    // Compression is CPU-bound, so it runs on the workers not to stall the other connections on this context
+    std::string compressed;
+    const auto compressed_ok = co_await asio::async_compose<decltype(asio::use_awaitable), void(bool)>(
+        [&](auto&& self) {
+            asio::post(workers_, [&, self = std::move(self)]() mutable {
+                bool ok{true};
+                try {
+                    std::vector<asio::const_buffer> input;
+                    if (!reply.content.empty()) {
+                        input.push_back(asio::buffer(reply.content));
+                    }
+                    reply.body.append_to(input);
+                    compress(encoding, input, compressed);
+                } catch (const std::exception& e) {
+                    SILKRPC_ERROR << "Connection::compress_reply exception: " << e.what() << "\n";
+                    ok = false;
+                }
+                asio::post(*context_.io_context, [ok, self = std::move(self)]() mutable {
+                    self.complete(ok);
+                });
+            });
+        },
+        asio::use_awaitable);
+
+    if (compressed_ok) {
+        SILKRPC_DEBUG << "Connection::compress_reply " << to_string(encoding) << " size: " << reply.content.size() + reply.body.size() << " -> " << compressed.size() << "\n";
+        reply.body.clear();
+        reply.content = std::move(compressed);
+        reply.headers.emplace_back(Header{"Content-Encoding", to_string(encoding)});
+        reply.headers.emplace_back(Header{"Vary", "Accept-Encoding"});
+    }
+}
+
+asio::awaitable<void> Connection::upgrade(const char* begin, const char* end) {
+    SILKRPC_DEBUG << "Connection::upgrade socket " << &socket_ << " upgrading to WebSocket\n";
+    auto websocket_connection = std::make_shared<WebSocketConnection>(std::move(socket_), context_, workers_, settings_, *broker_, admission_control_, single_flight_, chunk_pool_);
+    co_await websocket_connection->start(request_, begin, end);
+}
+
+asio::awaitable<void> Connection::start_http2(const char* begin, const char* end) {
+    SILKRPC_DEBUG << "Connection::start_http2 socket " << &socket_ << " switching to HTTP/2\n";
+    auto http2_connection = std::make_shared<Http2Connection>(std::move(socket_), context_, workers_, settings_, admission_control_, single_flight_, chunk_pool_);
+    co_await http2_connection->start(begin, end);
+}
+
+void Connection::enqueue_reply(Reply&& reply, bool keep_alive) {
+    if (!keep_alive) {
+        if (reply.framing != Reply::chunk) {
+            reply.headers.emplace_back(Header{"Connection", "close"});
+        }
+        close_after_write_ = true;
+    }
+    replies_.push_back(std::move(reply));
+
+    if (!writing_) {
+        writing_ = true;
+        // The writer keeps this connection alive until all queued replies have been written
+        asio::co_spawn(socket_.get_executor(), [self = shared_from_this()]() { return self->do_write(); }, asio::detached);
+    }
+}
+
 asio::awaitable<void> Connection::do_write() {
     try {
-        SILKRPC_DEBUG << "Connection::do_write reply: " << reply_.content << "\n" << std::flush;
-        const auto bytes_transferred = co_await asio::async_write(socket_, reply_.to_buffers(), asio::use_awaitable);
-        SILKRPC_TRACE << "Connection::do_write bytes_transferred: " << bytes_transferred << "\n" << std::flush;
+        std::vector<Reply> replies;
+        std::vector<asio::const_buffer> buffers;
+        while (!replies_.empty()) {
+            // Replies queued while the previous write was in flight are sent together in one gathered write
+            replies.clear();
+            replies.reserve(replies_.size());
+            std::move(replies_.begin(), replies_.end(), std::back_inserter(replies));
+            replies_.clear();
+
+            buffers.clear();
+            for (auto& reply : replies) {
+                SILKRPC_DEBUG << "Connection::do_write reply status: " << reply.status << " size: " << reply.content.size() + reply.body.size() << "\n" << std::flush;
+                reply.append_to(buffers);
+            }
+            if (settings_.write_timeout.count() > 0) {
+                write_deadline_ = asio::steady_timer::clock_type::now() + settings_.write_timeout;
+                update_watchdog(write_deadline_);
+            }
+            const auto bytes_transferred = co_await asio::async_write(socket_, buffers, asio::use_awaitable);
+            write_deadline_ = asio::steady_timer::time_point::max();
+            SILKRPC_TRACE << "Connection::do_write replies: " << replies.size() << " bytes_transferred: " << bytes_transferred << "\n" << std::flush;
+            write_done_.cancel();
+        }
+        writing_ = false;
+        if (!reading_) {
+            watchdog_.cancel();
+        } else if (waiting_request_) {
+            // The connection gets idle just now, so the idle timeout starts
+            arm_read_deadline();
+            if (registry_ != nullptr && settings_.max_connections > 0) {
+                registry_->mark_idle(this);
+            }
+        }
+
+        if (close_after_write_) {
+            SILKRPC_DEBUG << "Connection::do_write closing socket: " << &socket_ << "\n" << std::flush;
+            std::error_code ec;
+            socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+            socket_.close(ec);
+        }
     } catch (const std::system_error& se) {
-        std::rethrow_exception(std::make_exception_ptr(se));
-    } catch (const std::exception& e) {
-        std::rethrow_exception(std::make_exception_ptr(e));
+        writing_ = false;
+        write_deadline_ = asio::steady_timer::time_point::max();
+        write_done_.cancel();
+        watchdog_.cancel();
+        if (se.code() != asio::error::operation_aborted) {
+            SILKRPC_DEBUG << "Connection::do_write system_error: " << se.what() << "\n" << std::flush;
+        }
+        // Closing the socket cancels any pending read, so that the connection is released
+        std::error_code ec;
+        socket_.close(ec);
     }
 }
 
@@ -23,56 +23,149 @@
 #ifndef SILKRPC_HTTP_CONNECTION_HPP_
 #define SILKRPC_HTTP_CONNECTION_HPP_
 
-#include <array>
+#include <deque>
 #include <memory>
+#include <string_view>
+#include <vector>
 
 #include <silkrpc/config.hpp>
 
 #include <asio/awaitable.hpp>
 #include <asio/ip/tcp.hpp>
+#include <asio/steady_timer.hpp>
 #include <asio/thread_pool.hpp>
 
 #include <silkrpc/context_pool.hpp>
+#include <silkrpc/json/stream_writer.hpp>
+#include <silkrpc/subscription/broker.hpp>
+#include "admission_control.hpp"
+#include "chunk_buffer.hpp"
+#include "connection_registry.hpp"
+#include "read_buffer_pool.hpp"
 #include "reply.hpp"
 #include "request.hpp"
 #include "request_handler.hpp"
 #include "request_parser.hpp"
+#include "server_settings.hpp"
+#include "single_flight.hpp"
 
 namespace silkrpc::http {
 
 class ConnectionManager;
 
 /// Represents a single connection from a client.
-class Connection : public std::enable_shared_from_this<Connection> {
+class Connection : public std::enable_shared_from_this<Connection>, public Reapable {
 public:
     Connection(const Connection&) = delete;
     Connection& operator=(const Connection&) = delete;
 
-    /// Construct a connection running within the given execution context.
-    explicit Connection(Context& context, asio::thread_pool& workers);
+    /// Construct a connection running within the given execution context, upgradable to WebSocket if a broker is given.
+    /// The requests are subject to the admission control of the context, if any. The connection is tracked by the
+    /// registry, if any, which may reap it when idle. The read buffers and the reply chunks are taken from the pools of
+    /// the context, if any. The identical calls in flight on the context share one execution if the single-flight group is given.
+    explicit Connection(Context& context, asio::thread_pool& workers, const ServerSettings& settings, subscription::Broker* broker = nullptr,
+        AdmissionControl* admission_control = nullptr, ConnectionRegistry* registry = nullptr, ReadBufferPool* read_buffer_pool = nullptr,
+        ChunkPool* chunk_pool = nullptr, SingleFlight* single_flight = nullptr);
 
     ~Connection();
 
+    void reap() override;
+
     asio::ip::tcp::socket& socket() { return socket_; }
 
     /// Start the first asynchronous operation for the connection.
     asio::awaitable<void> start();
 
 private:
-    /// Perform an asynchronous read operation.
+    /// Writer of the reply content streamed using chunked transfer coding. Streaming starts only when the content
+    /// exceeds the stream buffer size, otherwise the content is sent as usual.
+    class ChunkedStreamWriter : public StreamWriter {
+    public:
+        explicit ChunkedStreamWriter(Connection& connection, bool keep_alive);
+
+        asio::awaitable<void> write(std::string_view content) override;
+
+        bool discard() override;
+
+        /// Check if the content is being streamed, i.e. some content has been sent.
+        bool started() const { return started_; }
+
+        /// Terminate the streamed reply, returning false if the connection must be closed.
+        bool finish();
+
+        /// Get the content written but not sent yet.
+        ChunkBuffer release() { return std::move(buffer_); }
+
+    private:
+        Connection& connection_;
+        bool keep_alive_;
+        ChunkBuffer buffer_;
+        bool started_{false};
+        bool aborted_{false};
+    };
+
+    /// Perform asynchronous read operations until the client or the server closes the connection.
     asio::awaitable<void> do_read();
 
-    /// Perform an asynchronous write operation.
+    /// Perform asynchronous gathered write operations until the queued replies are exhausted.
     asio::awaitable<void> do_write();
 
+    /// Queue the reply for writing and start the writer if idle, replies are written in the same order as requests.
+    void enqueue_reply(Reply&& reply, bool keep_alive);
+
+    /// Close the socket when the read or write deadline expires, until both reading and writing are over.
+    asio::awaitable<void> watchdog();
+
+    /// Set the read deadline according to the phase of the request being received.
+    void arm_read_deadline();
+
+    /// Wake up the watchdog if the deadline is earlier than the one it is waiting for.
+    void update_watchdog(asio::steady_timer::time_point deadline);
+
+    /// Get a read buffer suitable for the phase of the request being received.
+    void prepare_read_buffer();
+
+    /// Wait until the queued replies have been taken by the writer.
+    asio::awaitable<void> wait_for_writer();
+
+    /// Compress the reply on the workers using the content coding preferred by the client, if any.
+    asio::awaitable<void> compress_reply(Reply& reply);
+
+    /// Hand over the socket to a WebSocket connection serving the upgrade request and the data following it.
+    asio::awaitable<void> upgrade(const char* begin, const char* end);
+
+    /// Hand over the socket to an HTTP/2 connection serving the client which started with the connection preface.
+    asio::awaitable<void> start_http2(const char* begin, const char* end);
+
+    Context& context_;
+
+    asio::thread_pool& workers_;
+
+    const ServerSettings& settings_;
+
+    /// The broker of eth_subscribe subscriptions, WebSocket upgrade is not supported if null.
+    subscription::Broker* broker_;
+
+    /// The admission control of the context, if any
+    AdmissionControl* admission_control_;
+
+    /// The group of the calls in flight on the context, if any
+    SingleFlight* single_flight_;
+
     /// Socket for the connection.
     asio::ip::tcp::socket socket_;
 
+    /// The pool of chunks of the context used to serialize the replies, if any, it must outlive them.
+    ChunkPool* chunk_pool_;
+
     /// The handler used to process the incoming request.
     RequestHandler request_handler_;
 
-    /// Buffer for incoming data.
-    std::array<char, 8192> buffer_;
+    /// The pool of read buffers of the context, if any.
+    ReadBufferPool* read_buffer_pool_;
+
+    /// Buffer for incoming data, grown up to the size of the content being received.
+    std::vector<char> buffer_;
 
     /// The incoming request.
     Request request_;
@@ -80,8 +173,40 @@ private:
     /// The parser for the incoming request.
     RequestParser request_parser_;
 
-    /// The reply to be sent back to the client.
-    Reply reply_;
+    /// The replies to be sent back to the client, in request order.
+    std::deque<Reply> replies_;
+
+    /// Flag indicating if the writer is active.
+    bool writing_{false};
+
+    /// Timer cancelled each time the writer completes a write, used to signal waiting streamed replies.
+    asio::steady_timer write_done_;
+
+    /// Flag indicating if the connection must be closed after the queued replies have been written.
+    bool close_after_write_{false};
+
+    /// The registry of all the connections, if any.
+    ConnectionRegistry* registry_;
+
+    /// Timer waking up the watchdog at the earliest deadline.
+    asio::steady_timer watchdog_;
+
+    /// The deadlines of the pending read and write, if any.
+    asio::steady_timer::time_point read_deadline_{asio::steady_timer::time_point::max()};
+    asio::steady_timer::time_point write_deadline_{asio::steady_timer::time_point::max()};
+
+    /// The phase of the request reception when the read deadline was set and the deadline of such phase.
+    RequestParser::Phase read_phase_{RequestParser::idle};
+    asio::steady_timer::time_point phase_deadline_{asio::steady_timer::time_point::max()};
+
+    /// Flag indicating if the reader is active.
+    bool reading_{false};
+
+    /// Flag indicating if the reader is waiting for a new request.
+    bool waiting_request_{false};
+
+    /// Flag indicating if the first data received has been checked for the HTTP/2 connection preface.
+    bool preface_checked_{false};
 };
 
 } // namespace silkrpc::http
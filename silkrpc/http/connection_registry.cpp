@@ -0,0 +1,91 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "connection_registry.hpp"
+
+namespace silkrpc::http {
+
+bool ConnectionRegistry::add(Reapable* connection) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (max_connections_ > 0 && connections_.size() >= max_connections_) {
+        if (idle_connections_.empty()) {
+            ++rejected_;
+            return false;
+        }
+        // The reaped connection is no more counted, its later removal is ignored
+        auto* oldest_idle = idle_connections_.front();
+        idle_connections_.pop_front();
+        connections_.erase(oldest_idle);
+        oldest_idle->reap();
+        ++reaped_;
+    }
+    connections_.emplace(connection, Entry{});
+    return true;
+}
+
+void ConnectionRegistry::remove(Reapable* connection) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    const auto it = connections_.find(connection);
+    if (it == connections_.end()) {
+        return;
+    }
+    if (it->second.idle) {
+        idle_connections_.erase(it->second.idle_position);
+    }
+    connections_.erase(it);
+}
+
+void ConnectionRegistry::mark_idle(Reapable* connection) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    const auto it = connections_.find(connection);
+    if (it == connections_.end() || it->second.idle) {
+        return;
+    }
+    it->second.idle = true;
+    it->second.idle_position = idle_connections_.insert(idle_connections_.end(), connection);
+}
+
+void ConnectionRegistry::mark_busy(Reapable* connection) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    const auto it = connections_.find(connection);
+    if (it == connections_.end() || !it->second.idle) {
+        return;
+    }
+    it->second.idle = false;
+    idle_connections_.erase(it->second.idle_position);
+}
+
+std::size_t ConnectionRegistry::size() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return connections_.size();
+}
+
+std::size_t ConnectionRegistry::idle_size() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return idle_connections_.size();
+}
+
+std::size_t ConnectionRegistry::reaped() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return reaped_;
+}
+
+std::size_t ConnectionRegistry::rejected() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return rejected_;
+}
+
+} // namespace silkrpc::http
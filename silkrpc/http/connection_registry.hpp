@@ -0,0 +1,89 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_CONNECTION_REGISTRY_HPP_
+#define SILKRPC_HTTP_CONNECTION_REGISTRY_HPP_
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace silkrpc::http {
+
+/// A connection which can be closed from any thread to make room for a new one.
+class Reapable {
+public:
+    virtual ~Reapable() = default;
+
+    /// Close the connection asynchronously, without blocking nor accessing it from the calling thread.
+    virtual void reap() = 0;
+};
+
+/// The registry of the open connections of all contexts, enforcing the global connection cap: when the cap is
+/// reached, the connection idle for the longest time is reaped to make room for the new one.
+class ConnectionRegistry {
+public:
+    ConnectionRegistry(const ConnectionRegistry&) = delete;
+    ConnectionRegistry& operator=(const ConnectionRegistry&) = delete;
+
+    /// Construct the registry allowing up to max_connections open connections, zero means unlimited.
+    explicit ConnectionRegistry(std::size_t max_connections = 0) : max_connections_{max_connections} {}
+
+    /// Add the new busy connection, reaping the oldest idle one if the cap has been reached. Return false if the
+    /// cap has been reached and no connection is idle: the new connection must be closed.
+    bool add(Reapable* connection);
+
+    /// Remove the connection, if still registered.
+    void remove(Reapable* connection);
+
+    /// Mark the connection as idle, i.e. waiting for a new request with no reply pending.
+    void mark_idle(Reapable* connection);
+
+    /// Mark the connection as busy, i.e. receiving or handling a request.
+    void mark_busy(Reapable* connection);
+
+    std::size_t size() const;
+
+    std::size_t idle_size() const;
+
+    /// The number of idle connections reaped to make room for new ones.
+    std::size_t reaped() const;
+
+    /// The number of new connections rejected because no connection was idle.
+    std::size_t rejected() const;
+
+private:
+    struct Entry {
+        bool idle{false};
+        std::list<Reapable*>::iterator idle_position;
+    };
+
+    std::size_t max_connections_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<Reapable*, Entry> connections_;
+
+    // The idle connections from the least to the most recently idle
+    std::list<Reapable*> idle_connections_;
+
+    std::size_t reaped_{0};
+    std::size_t rejected_{0};
+};
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_CONNECTION_REGISTRY_HPP_
@@ -0,0 +1,83 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "connection_registry.hpp"
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc::http {
+
+class MockConnection : public Reapable {
+public:
+    void reap() override { ++reaps; }
+
+    int reaps{0};
+};
+
+TEST_CASE("ConnectionRegistry unlimited", "[silkrpc][http][connection_registry]") {
+    ConnectionRegistry registry;
+    MockConnection connection1, connection2;
+    CHECK(registry.add(&connection1));
+    CHECK(registry.add(&connection2));
+    CHECK(registry.size() == 2);
+    registry.mark_idle(&connection1);
+    CHECK(registry.idle_size() == 1);
+    registry.remove(&connection1);
+    registry.remove(&connection2);
+    CHECK(registry.size() == 0);
+    CHECK(registry.idle_size() == 0);
+    CHECK(connection1.reaps == 0);
+}
+
+TEST_CASE("ConnectionRegistry reaps oldest idle connection", "[silkrpc][http][connection_registry]") {
+    ConnectionRegistry registry{2};
+    MockConnection connection1, connection2, connection3, connection4;
+    CHECK(registry.add(&connection1));
+    CHECK(registry.add(&connection2));
+
+    SECTION("no idle connection") {
+        CHECK(!registry.add(&connection3));
+        CHECK(registry.rejected() == 1);
+        CHECK(registry.size() == 2);
+    }
+
+    SECTION("oldest idle first") {
+        registry.mark_idle(&connection2);
+        registry.mark_idle(&connection1);
+        CHECK(registry.add(&connection3));
+        CHECK(connection2.reaps == 1);
+        CHECK(connection1.reaps == 0);
+        CHECK(registry.size() == 2);
+        CHECK(registry.reaped() == 1);
+
+        // The removal of the reaped connection does not affect the count
+        registry.remove(&connection2);
+        CHECK(registry.size() == 2);
+
+        CHECK(registry.add(&connection4));
+        CHECK(connection1.reaps == 1);
+        CHECK(registry.idle_size() == 0);
+    }
+
+    SECTION("busy again is not reaped") {
+        registry.mark_idle(&connection1);
+        registry.mark_busy(&connection1);
+        CHECK(!registry.add(&connection3));
+        CHECK(connection1.reaps == 0);
+    }
+}
+
+} // namespace silkrpc::http
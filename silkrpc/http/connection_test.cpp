@@ -16,11 +16,212 @@
 
 #include "connection.hpp"
 
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <asio/buffer.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/executor_work_guard.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/address_v4.hpp>
+#include <asio/read.hpp>
+#include <asio/read_until.hpp>
+#include <asio/thread_pool.hpp>
+#include <asio/write.hpp>
 #include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+#include <silkrpc/common/log.hpp>
 
 namespace silkrpc {
 
 using Catch::Matchers::Message;
+using namespace std::chrono_literals;
 
-} // namespace silkrpc
+/// The connections under test run on one io_context driven by its own thread, the clients are blocking sockets.
+class ConnectionTest {
+public:
+    explicit ConnectionTest(const http::ServerSettings& server_settings) : settings{server_settings}, registry{settings.max_connections} {
+        context.io_context = std::make_shared<asio::io_context>();
+        acceptor = std::make_unique<asio::ip::tcp::acceptor>(*context.io_context, asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), 0});
+        work = std::make_unique<asio::executor_work_guard<asio::io_context::executor_type>>(context.io_context->get_executor());
+        io_thread = std::thread{[&]() { context.io_context->run(); }};
+    }
+
+    ~ConnectionTest() {
+        work.reset();
+        context.io_context->stop();
+        io_thread.join();
+    }
+
+    /// Connect a new client to a new connection, optionally shrinking the socket buffers so that big replies fill them up.
+    asio::ip::tcp::socket connect(bool small_buffers = false) {
+        asio::ip::tcp::socket client{*context.io_context};
+        client.open(asio::ip::tcp::v4());
+        if (small_buffers) {
+            client.set_option(asio::socket_base::receive_buffer_size(4096));
+        }
+        client.connect(acceptor->local_endpoint());
+        auto connection = std::make_shared<http::Connection>(context, workers, settings, nullptr, nullptr, &registry);
+        acceptor->accept(connection->socket());
+        if (small_buffers) {
+            connection->socket().set_option(asio::socket_base::send_buffer_size(4096));
+        }
+        REQUIRE(registry.add(connection.get()));
+        asio::co_spawn(*context.io_context, [connection]() { return connection->start(); }, asio::detached);
+        return client;
+    }
+
+    /// Wait until the registry counts the given number of idle connections, for at most one second.
+    bool wait_idle(std::size_t idle_size) const {
+        for (int i{0}; i < 100 && registry.idle_size() != idle_size; ++i) {
+            std::this_thread::sleep_for(10ms);
+        }
+        return registry.idle_size() == idle_size;
+    }
+
+    // Declared first, so that they outlive the connections destroyed together with the io_context
+    http::ServerSettings settings;
+    http::ConnectionRegistry registry;
+    asio::thread_pool workers{1};
+    Context context;
+    std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
+    std::unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>> work;
+    std::thread io_thread;
+};
+
+static std::string make_request(const std::string& content) {
+    return "POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: " + std::to_string(content.size()) + "\r\n\r\n" + content;
+}
+
+/// Read one whole reply, returning its content.
+static std::string read_reply(asio::ip::tcp::socket& client) {
+    std::string data;
+    const auto head_size = asio::read_until(client, asio::dynamic_buffer(data), "\r\n\r\n");
+    const auto length_position = data.find("Content-Length: ");
+    REQUIRE(length_position < head_size);
+    const auto content_length = std::stoul(data.substr(length_position + 16));
+    if (data.size() < head_size + content_length) {
+        asio::read(client, asio::dynamic_buffer(data), asio::transfer_exactly(head_size + content_length - data.size()));
+    }
+    return data.substr(head_size, content_length);
+}
+
+/// Wait for the server to close the connection, returning the time elapsed.
+static std::chrono::steady_clock::duration wait_for_close(asio::ip::tcp::socket& client) {
+    const auto start = std::chrono::steady_clock::now();
+    std::array<char, 1> byte{};
+    std::error_code ec;
+    const auto bytes_read = asio::read(client, asio::buffer(byte), ec);
+    CHECK(bytes_read == 0);
+    CHECK((ec == asio::error::eof || ec == asio::error::connection_reset));
+    return std::chrono::steady_clock::now() - start;
+}
+
+const std::string kNetListeningRequest{R"({"jsonrpc":"2.0","id":1,"method":"net_listening","params":[]})"};
+
+TEST_CASE("Connection read timeouts", "[silkrpc][http][connection]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    http::ServerSettings settings;
+    settings.header_read_timeout = 100ms;
+    settings.body_read_timeout = 100ms;
+    settings.idle_timeout = 200ms;
+
+    SECTION("slow headers") {
+        ConnectionTest test{settings};
+        auto client = test.connect();
+        asio::write(client, asio::buffer(std::string{"POST / HTTP/1.1\r\nHost: loc"}));
+        const auto elapsed = wait_for_close(client);
+        CHECK(elapsed >= 90ms);
+        CHECK(elapsed < 2s);
+    }
 
+    SECTION("slow headers sent byte by byte") {
+        // Each byte arriving in time does not extend the deadline of the headers
+        ConnectionTest test{settings};
+        auto client = test.connect();
+        const std::string partial_request{"POST / HTTP/1.1\r\nHost: localhost\r\n"};
+        const auto start = std::chrono::steady_clock::now();
+        std::error_code ec;
+        for (std::size_t i{0}; i < partial_request.size() && !ec; ++i) {
+            asio::write(client, asio::buffer(&partial_request[i], 1), ec);
+            std::this_thread::sleep_for(20ms);
+        }
+        wait_for_close(client);
+        CHECK(std::chrono::steady_clock::now() - start < 1s);
+    }
+
+    SECTION("slow content") {
+        ConnectionTest test{settings};
+        auto client = test.connect();
+        const auto request = make_request(kNetListeningRequest);
+        asio::write(client, asio::buffer(request.substr(0, request.size() - 10)));
+        const auto elapsed = wait_for_close(client);
+        CHECK(elapsed >= 90ms);
+        CHECK(elapsed < 2s);
+    }
+
+    SECTION("idle keep-alive connection") {
+        ConnectionTest test{settings};
+        auto client = test.connect();
+        asio::write(client, asio::buffer(make_request(kNetListeningRequest)));
+        CHECK(nlohmann::json::parse(read_reply(client)) == R"({"jsonrpc":"2.0","id":1,"result":true})"_json);
+        const auto elapsed = wait_for_close(client);
+        CHECK(elapsed >= 150ms);
+        CHECK(elapsed < 2s);
+    }
+}
+
+TEST_CASE("Connection reaped when idle", "[silkrpc][http][connection]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    http::ServerSettings settings;
+    settings.max_connections = 1;
+    ConnectionTest test{settings};
+
+    auto client1 = test.connect();
+    asio::write(client1, asio::buffer(make_request(kNetListeningRequest)));
+    read_reply(client1);
+    REQUIRE(test.wait_idle(1));
+
+    // The idle keep-alive connection makes room for the new one
+    auto client2 = test.connect();
+    wait_for_close(client1);
+    CHECK(test.registry.reaped() == 1);
+    asio::write(client2, asio::buffer(make_request(kNetListeningRequest)));
+    CHECK(nlohmann::json::parse(read_reply(client2)) == R"({"jsonrpc":"2.0","id":1,"result":true})"_json);
+}
+
+TEST_CASE("Connection busy while writing", "[silkrpc][http][connection]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    http::ServerSettings settings;
+    settings.idle_timeout = 100ms;
+    settings.max_connections = 1;
+    ConnectionTest test{settings};
+
+    // The invalid params are echoed back in the error message, so the reply is too big for the socket buffers
+    const std::string big_param(1024 * 1024, 'a');
+    const std::string content{R"({"jsonrpc":"2.0","id":1,"method":"web3_sha3","params":["0x00",")" + big_param + R"("]})"};
+    auto client = test.connect(/*small_buffers=*/true);
+    asio::write(client, asio::buffer(make_request(content)));
+
+    // Not reading the reply for longer than the idle timeout, the connection is neither closed nor reapable
+    std::this_thread::sleep_for(500ms);
+    CHECK(test.registry.idle_size() == 0);
+
+    const auto reply_json = nlohmann::json::parse(read_reply(client));
+    CHECK(reply_json["id"] == 1);
+    CHECK(reply_json["error"]["message"].get<std::string>().find(big_param) != std::string::npos);
+
+    // Once the reply has been written, the connection is idle again
+    CHECK(test.wait_idle(1));
+    wait_for_close(client);
+}
+
+} // namespace silkrpc
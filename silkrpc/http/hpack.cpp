@@ -0,0 +1,350 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hpack.hpp"
+
+#include <array>
+#include <utility>
+
+namespace silkrpc::http::hpack {
+
+namespace {
+
+// The Huffman code length of each symbol, EOS last [RFC 7541 Appendix B]: the code is canonical, so the lengths define it
+constexpr std::array<uint8_t, 257> kHuffmanCodeLengths{
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30,
+};
+// The static table [RFC 7541 Appendix A], whose entries are indexed starting from 1
+
+const std::array<std::pair<const char*, const char*>, 61> kStaticTable{{
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},
+}};
+
+// The size of each table entry includes an overhead of 32 bytes [RFC 7541 4.1]
+constexpr std::size_t kEntryOverhead{32};
+
+constexpr std::size_t kHuffmanMaxCodeLength{30};
+
+constexpr uint16_t kHuffmanEos{256};
+
+// The decoding tables of the canonical Huffman code: for each code length, the first code, the number of codes and
+// the position of its first symbol in the symbols sorted by code
+struct HuffmanTables {
+    std::array<uint32_t, kHuffmanMaxCodeLength + 1> first_code{};
+    std::array<uint32_t, kHuffmanMaxCodeLength + 1> count{};
+    std::array<uint32_t, kHuffmanMaxCodeLength + 1> first_index{};
+    std::array<uint16_t, 257> symbols{};
+
+    HuffmanTables() {
+        for (const auto length : kHuffmanCodeLengths) {
+            ++count[length];
+        }
+        uint32_t code{0}, index{0};
+        for (std::size_t length{1}; length <= kHuffmanMaxCodeLength; ++length) {
+            code = (code + count[length - 1]) << 1;
+            first_code[length] = code;
+            first_index[length] = index;
+            index += count[length];
+        }
+        // Within the same length the codes are assigned in symbol order
+        std::array<uint32_t, kHuffmanMaxCodeLength + 1> next_index{first_index};
+        for (uint16_t symbol{0}; symbol < kHuffmanCodeLengths.size(); ++symbol) {
+            symbols[next_index[kHuffmanCodeLengths[symbol]]++] = symbol;
+        }
+    }
+};
+
+const HuffmanTables& huffman_tables() {
+    static const HuffmanTables tables;
+    return tables;
+}
+
+} // namespace
+
+bool decode_integer(const uint8_t*& pos, const uint8_t* end, uint8_t prefix_bits, uint64_t& value) {
+    if (pos == end) {
+        return false;
+    }
+    const uint8_t prefix_max = static_cast<uint8_t>((1 << prefix_bits) - 1);
+    value = *pos++ & prefix_max;
+    if (value < prefix_max) {
+        return true;
+    }
+    // Reject the continuation bytes which could overflow, no legitimate value needs more than 8 of them
+    for (unsigned shift{0}; pos != end && shift <= 56; shift += 7) {
+        const uint8_t byte = *pos++;
+        value += static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void encode_integer(std::string& out, uint8_t first_byte, uint8_t prefix_bits, uint64_t value) {
+    const uint8_t prefix_max = static_cast<uint8_t>((1 << prefix_bits) - 1);
+    if (value < prefix_max) {
+        out.push_back(static_cast<char>(first_byte | value));
+        return;
+    }
+    out.push_back(static_cast<char>(first_byte | prefix_max));
+    value -= prefix_max;
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool huffman_decode(const uint8_t* data, std::size_t size, std::string& out) {
+    const auto& tables = huffman_tables();
+    uint32_t code{0};
+    std::size_t length{0};
+    for (std::size_t i{0}; i < size; ++i) {
+        for (int bit{7}; bit >= 0; --bit) {
+            code = (code << 1) | ((data[i] >> bit) & 1);
+            ++length;
+            const uint32_t offset = code - tables.first_code[length];
+            if (code >= tables.first_code[length] && offset < tables.count[length]) {
+                const auto symbol = tables.symbols[tables.first_index[length] + offset];
+                if (symbol == kHuffmanEos) {
+                    return false;
+                }
+                out.push_back(static_cast<char>(symbol));
+                code = 0;
+                length = 0;
+            } else if (length == kHuffmanMaxCodeLength) {
+                return false;
+            }
+        }
+    }
+    // The padding is made of less than 8 most significant bits of EOS, i.e. all ones
+    return length < 8 && code == (1u << length) - 1;
+}
+
+std::string encode_headers(const std::vector<Header>& headers) {
+    std::string block;
+    for (const auto& header : headers) {
+        // Prefer the fully matching static entry, otherwise the first one having the same name
+        std::size_t name_index{0};
+        std::size_t full_index{0};
+        for (std::size_t i{0}; i < kStaticTable.size() && full_index == 0; ++i) {
+            if (header.name == kStaticTable[i].first) {
+                if (name_index == 0) {
+                    name_index = i + 1;
+                }
+                if (header.value == kStaticTable[i].second) {
+                    full_index = i + 1;
+                }
+            }
+        }
+        if (full_index != 0) {
+            encode_integer(block, 0x80, 7, full_index);
+            continue;
+        }
+        encode_integer(block, 0x00, 4, name_index);
+        if (name_index == 0) {
+            encode_integer(block, 0x00, 7, header.name.size());
+            block.append(header.name);
+        }
+        encode_integer(block, 0x00, 7, header.value.size());
+        block.append(header.value);
+    }
+    return block;
+}
+
+bool Decoder::decode(absl::string_view block, std::vector<Header>& headers) {
+    const auto* pos = reinterpret_cast<const uint8_t*>(block.data());
+    const auto* end = pos + block.size();
+    bool fields_started{false};
+    while (pos != end) {
+        const uint8_t first_byte = *pos;
+        uint64_t index{0};
+        if (first_byte & 0x80) {
+            // Indexed header field [RFC 7541 6.1]
+            Header header;
+            if (!decode_integer(pos, end, 7, index) || index == 0 || !lookup(index, header)) {
+                return false;
+            }
+            headers.push_back(std::move(header));
+            fields_started = true;
+        } else if ((first_byte & 0xe0) == 0x20) {
+            // Dynamic table size update, allowed just at the beginning of the block [RFC 7541 6.3]
+            uint64_t capacity{0};
+            if (fields_started || !decode_integer(pos, end, 5, capacity) || capacity > max_table_size_) {
+                return false;
+            }
+            table_capacity_ = capacity;
+            evict(table_capacity_);
+        } else {
+            // Literal header field with incremental indexing, without indexing or never indexed [RFC 7541 6.2]
+            const bool indexing = (first_byte & 0xc0) == 0x40;
+            if (!decode_integer(pos, end, indexing ? 6 : 4, index)) {
+                return false;
+            }
+            Header header;
+            if (index != 0) {
+                if (!lookup(index, header)) {
+                    return false;
+                }
+            } else if (!decode_string(pos, end, header.name)) {
+                return false;
+            }
+            header.value.clear();
+            if (!decode_string(pos, end, header.value)) {
+                return false;
+            }
+            if (indexing) {
+                insert(header);
+            }
+            headers.push_back(std::move(header));
+            fields_started = true;
+        }
+    }
+    return true;
+}
+
+bool Decoder::decode_string(const uint8_t*& pos, const uint8_t* end, std::string& out) {
+    if (pos == end) {
+        return false;
+    }
+    const bool huffman = (*pos & 0x80) != 0;
+    uint64_t length{0};
+    if (!decode_integer(pos, end, 7, length) || length > static_cast<uint64_t>(end - pos)) {
+        return false;
+    }
+    if (huffman) {
+        if (!huffman_decode(pos, length, out)) {
+            return false;
+        }
+    } else {
+        out.append(reinterpret_cast<const char*>(pos), length);
+    }
+    pos += length;
+    return true;
+}
+
+bool Decoder::lookup(uint64_t index, Header& header) const {
+    if (index <= kStaticTableSize) {
+        header.name = kStaticTable[index - 1].first;
+        header.value = kStaticTable[index - 1].second;
+        return true;
+    }
+    const auto dynamic_index = index - kStaticTableSize - 1;
+    if (dynamic_index >= dynamic_table_.size()) {
+        return false;
+    }
+    header = dynamic_table_[dynamic_index];
+    return true;
+}
+
+void Decoder::insert(const Header& header) {
+    // An entry larger than the table just empties it [RFC 7541 4.4]
+    const auto entry_size = header.name.size() + header.value.size() + kEntryOverhead;
+    if (entry_size > table_capacity_) {
+        evict(0);
+        return;
+    }
+    evict(table_capacity_ - entry_size);
+    dynamic_table_.push_front(header);
+    table_size_ += entry_size;
+}
+
+void Decoder::evict(std::size_t capacity) {
+    while (table_size_ > capacity) {
+        const auto& entry = dynamic_table_.back();
+        table_size_ -= entry.name.size() + entry.value.size() + kEntryOverhead;
+        dynamic_table_.pop_back();
+    }
+}
+
+} // namespace silkrpc::http::hpack
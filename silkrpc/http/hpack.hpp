@@ -0,0 +1,84 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_HPACK_HPP_
+#define SILKRPC_HTTP_HPACK_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <absl/strings/string_view.h>
+
+#include "header.hpp"
+
+namespace silkrpc::http::hpack {
+
+/// The default maximum size of the dynamic table [RFC 7540 6.5.2].
+constexpr std::size_t kDefaultHeaderTableSize{4096};
+
+/// The number of entries in the static table.
+constexpr std::size_t kStaticTableSize{61};
+
+/// Decode an integer having the given prefix size starting at pos, which is moved past it [RFC 7541 5.1].
+bool decode_integer(const uint8_t*& pos, const uint8_t* end, uint8_t prefix_bits, uint64_t& value);
+
+/// Encode an integer having the given prefix size, the first byte carrying the representation bits [RFC 7541 5.1].
+void encode_integer(std::string& out, uint8_t first_byte, uint8_t prefix_bits, uint64_t value);
+
+/// Decode the Huffman-encoded string, failing if the padding is invalid or EOS is found [RFC 7541 5.2].
+bool huffman_decode(const uint8_t* data, std::size_t size, std::string& out);
+
+/// Encode the header block of a response without using the dynamic table, i.e. using literals without indexing and
+/// the static table entries. The header names must be in lowercase.
+std::string encode_headers(const std::vector<Header>& headers);
+
+/// Decoder of the header blocks received on one connection, whose dynamic table persists across the blocks.
+class Decoder {
+public:
+    explicit Decoder(std::size_t max_table_size = kDefaultHeaderTableSize)
+    : max_table_size_{max_table_size}, table_capacity_{max_table_size} {}
+
+    /// Decode a complete header block appending its fields, failing on any compression error [RFC 7541 6].
+    bool decode(absl::string_view block, std::vector<Header>& headers);
+
+    /// Get the size of the dynamic table as defined in RFC 7541 4.1.
+    std::size_t table_size() const { return table_size_; }
+
+    std::size_t table_entries() const { return dynamic_table_.size(); }
+
+private:
+    bool decode_string(const uint8_t*& pos, const uint8_t* end, std::string& out);
+
+    bool lookup(uint64_t index, Header& header) const;
+
+    void insert(const Header& header);
+
+    void evict(std::size_t capacity);
+
+    std::size_t max_table_size_;
+    std::size_t table_capacity_;
+    std::size_t table_size_{0};
+
+    // The most recent entry is the first one
+    std::deque<Header> dynamic_table_;
+};
+
+} // namespace silkrpc::http::hpack
+
+#endif // SILKRPC_HTTP_HPACK_HPP_
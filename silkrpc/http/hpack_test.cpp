@@ -0,0 +1,169 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "hpack.hpp"
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/escaping.h>
+#include <catch2/catch.hpp>
+
+namespace silkrpc::http::hpack {
+
+static std::string from_hex(absl::string_view hex) {
+    return absl::HexStringToBytes(hex);
+}
+
+TEST_CASE("encode integer", "[silkrpc][http][hpack]") {
+    std::string out;
+    encode_integer(out, 0x00, 5, 10);
+    CHECK(out == from_hex("0a"));
+    out.clear();
+    encode_integer(out, 0x00, 5, 1337);
+    CHECK(out == from_hex("1f9a0a"));
+    out.clear();
+    encode_integer(out, 0x80, 7, 42);
+    CHECK(out == from_hex("aa"));
+}
+
+TEST_CASE("decode integer", "[silkrpc][http][hpack]") {
+    const auto data = from_hex("1f9a0a");
+    const auto* pos = reinterpret_cast<const uint8_t*>(data.data());
+    const auto* end = pos + data.size();
+    uint64_t value{0};
+    CHECK(decode_integer(pos, end, 5, value));
+    CHECK(value == 1337);
+    CHECK(pos == end);
+
+    const auto truncated = from_hex("1f9a");
+    pos = reinterpret_cast<const uint8_t*>(truncated.data());
+    CHECK(!decode_integer(pos, pos + truncated.size(), 5, value));
+
+    const auto overflowing = from_hex("1fffffffffffffffffffff01");
+    pos = reinterpret_cast<const uint8_t*>(overflowing.data());
+    CHECK(!decode_integer(pos, pos + overflowing.size(), 5, value));
+}
+
+TEST_CASE("huffman decode", "[silkrpc][http][hpack]") {
+    const auto data = from_hex("f1e3c2e5f23a6ba0ab90f4ff");
+    std::string out;
+    CHECK(huffman_decode(reinterpret_cast<const uint8_t*>(data.data()), data.size(), out));
+    CHECK(out == "www.example.com");
+
+    // Padding longer than 7 bits
+    const auto long_padding = from_hex("1fff");
+    out.clear();
+    CHECK(!huffman_decode(reinterpret_cast<const uint8_t*>(long_padding.data()), long_padding.size(), out));
+
+    // Padding not made of ones
+    const auto zero_padding = from_hex("f0");
+    out.clear();
+    CHECK(!huffman_decode(reinterpret_cast<const uint8_t*>(zero_padding.data()), zero_padding.size(), out));
+}
+
+TEST_CASE("decode request header blocks with huffman", "[silkrpc][http][hpack]") {
+    // RFC 7541 C.4
+    Decoder decoder;
+    std::vector<Header> headers;
+    CHECK(decoder.decode(from_hex("828684418cf1e3c2e5f23a6ba0ab90f4ff"), headers));
+    REQUIRE(headers.size() == 4);
+    CHECK(headers[0].name == ":method");
+    CHECK(headers[0].value == "GET");
+    CHECK(headers[1].name == ":scheme");
+    CHECK(headers[1].value == "http");
+    CHECK(headers[2].name == ":path");
+    CHECK(headers[2].value == "/");
+    CHECK(headers[3].name == ":authority");
+    CHECK(headers[3].value == "www.example.com");
+    CHECK(decoder.table_size() == 57);
+
+    headers.clear();
+    CHECK(decoder.decode(from_hex("828684be5886a8eb10649cbf"), headers));
+    REQUIRE(headers.size() == 5);
+    CHECK(headers[3].value == "www.example.com");
+    CHECK(headers[4].name == "cache-control");
+    CHECK(headers[4].value == "no-cache");
+    CHECK(decoder.table_size() == 110);
+
+    headers.clear();
+    CHECK(decoder.decode(from_hex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf"), headers));
+    REQUIRE(headers.size() == 5);
+    CHECK(headers[1].value == "https");
+    CHECK(headers[2].value == "/index.html");
+    CHECK(headers[3].value == "www.example.com");
+    CHECK(headers[4].name == "custom-key");
+    CHECK(headers[4].value == "custom-value");
+    CHECK(decoder.table_size() == 164);
+    CHECK(decoder.table_entries() == 3);
+}
+
+TEST_CASE("decode invalid header blocks", "[silkrpc][http][hpack]") {
+    std::vector<Header> headers;
+    SECTION("index zero") {
+        Decoder decoder;
+        CHECK(!decoder.decode(from_hex("80"), headers));
+    }
+    SECTION("index out of range") {
+        Decoder decoder;
+        CHECK(!decoder.decode(from_hex("be"), headers));
+    }
+    SECTION("table size update beyond the limit") {
+        Decoder decoder{256};
+        CHECK(!decoder.decode(from_hex("3fe201"), headers));
+    }
+    SECTION("table size update after a field") {
+        Decoder decoder;
+        CHECK(!decoder.decode(from_hex("8220"), headers));
+    }
+    SECTION("truncated string") {
+        Decoder decoder;
+        CHECK(!decoder.decode(from_hex("400a637573"), headers));
+    }
+}
+
+TEST_CASE("table size update evicts entries", "[silkrpc][http][hpack]") {
+    Decoder decoder;
+    std::vector<Header> headers;
+    CHECK(decoder.decode(from_hex("828684418cf1e3c2e5f23a6ba0ab90f4ff"), headers));
+    CHECK(decoder.table_entries() == 1);
+    CHECK(decoder.decode(from_hex("20"), headers));
+    CHECK(decoder.table_entries() == 0);
+    CHECK(decoder.table_size() == 0);
+}
+
+TEST_CASE("encode response headers", "[silkrpc][http][hpack]") {
+    const std::vector<Header> headers{
+        {":status", "200"},
+        {"content-type", "application/json"},
+        {"content-length", "42"},
+        {"x-custom", "value"},
+    };
+    const auto block = encode_headers(headers);
+    CHECK(block.substr(0, 1) == from_hex("88"));
+
+    Decoder decoder;
+    std::vector<Header> decoded;
+    CHECK(decoder.decode(block, decoded));
+    REQUIRE(decoded.size() == headers.size());
+    for (std::size_t i{0}; i < headers.size(); ++i) {
+        CHECK(decoded[i].name == headers[i].name);
+        CHECK(decoded[i].value == headers[i].value);
+    }
+    CHECK(decoder.table_entries() == 0);
+}
+
+} // namespace silkrpc::http::hpack
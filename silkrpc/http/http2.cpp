@@ -0,0 +1,172 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "http2.hpp"
+
+#include <algorithm>
+
+namespace silkrpc::http::http2 {
+
+static void append_uint32(std::string& out, uint32_t value) {
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+uint32_t read_uint32(const char* data) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    return uint32_t{bytes[0]} << 24 | uint32_t{bytes[1]} << 16 | uint32_t{bytes[2]} << 8 | uint32_t{bytes[3]};
+}
+
+bool is_connection_preface(const char* begin, const char* end) {
+    const auto size = static_cast<std::size_t>(end - begin);
+    if (size < 4) {
+        return false;
+    }
+    return kConnectionPreface.substr(0, std::min(size, kConnectionPreface.size())) == absl::string_view(begin, std::min(size, kConnectionPreface.size()));
+}
+
+void append_frame(std::string& out, FrameType type, uint8_t flags, uint32_t stream_id, absl::string_view payload) {
+    const auto length = static_cast<uint32_t>(payload.size());
+    out.push_back(static_cast<char>(length >> 16));
+    out.push_back(static_cast<char>(length >> 8));
+    out.push_back(static_cast<char>(length));
+    out.push_back(static_cast<char>(type));
+    out.push_back(static_cast<char>(flags));
+    append_uint32(out, stream_id & 0x7fffffff);
+    out.append(payload.data(), payload.size());
+}
+
+void append_settings(std::string& out, const std::vector<std::pair<SettingId, uint32_t>>& parameters) {
+    std::string payload;
+    for (const auto& [id, value] : parameters) {
+        payload.push_back(static_cast<char>(id >> 8));
+        payload.push_back(static_cast<char>(id));
+        append_uint32(payload, value);
+    }
+    append_frame(out, settings, 0, 0, payload);
+}
+
+void append_window_update(std::string& out, uint32_t stream_id, uint32_t increment) {
+    std::string payload;
+    append_uint32(payload, increment & 0x7fffffff);
+    append_frame(out, window_update, 0, stream_id, payload);
+}
+
+void append_rst_stream(std::string& out, uint32_t stream_id, ErrorCode error_code) {
+    std::string payload;
+    append_uint32(payload, error_code);
+    append_frame(out, rst_stream, 0, stream_id, payload);
+}
+
+void append_goaway(std::string& out, uint32_t last_stream_id, ErrorCode error_code) {
+    std::string payload;
+    append_uint32(payload, last_stream_id & 0x7fffffff);
+    append_uint32(payload, error_code);
+    append_frame(out, goaway, 0, 0, payload);
+}
+
+bool Frame::content(absl::string_view& content) const {
+    content = payload;
+    std::size_t padding{0};
+    if (has_flag(kFlagPadded)) {
+        if (content.empty()) {
+            return false;
+        }
+        padding = static_cast<uint8_t>(content[0]);
+        content.remove_prefix(1);
+    }
+    if (type == headers && has_flag(kFlagPriority)) {
+        if (content.size() < 5) {
+            return false;
+        }
+        content.remove_prefix(5);
+    }
+    if (padding > content.size()) {
+        return false;
+    }
+    content.remove_suffix(padding);
+    return true;
+}
+
+FrameParser::FrameParser(uint32_t max_frame_size, bool expect_preface)
+: state_{expect_preface ? preface : header}, max_frame_size_{max_frame_size} {
+    bytes_needed_ = expect_preface ? kConnectionPreface.size() : kFrameHeaderSize;
+}
+
+std::tuple<FrameParser::ResultType, const char*> FrameParser::parse(Frame& frame, const char* begin, const char* end) {
+    while (begin != end) {
+        const auto count = std::min(static_cast<std::size_t>(end - begin), bytes_needed_);
+        switch (state_) {
+            case preface: {
+                // Compare the preface bytes as they arrive, so that a wrong one is detected early
+                const auto offset = kConnectionPreface.size() - bytes_needed_;
+                if (kConnectionPreface.substr(offset, count) != absl::string_view(begin, count)) {
+                    return std::make_tuple(bad, begin);
+                }
+                begin += count;
+                bytes_needed_ -= count;
+                if (bytes_needed_ == 0) {
+                    state_ = header;
+                    bytes_needed_ = kFrameHeaderSize;
+                }
+                break;
+            }
+            case header: {
+                header_.append(begin, count);
+                begin += count;
+                bytes_needed_ -= count;
+                if (bytes_needed_ > 0) {
+                    break;
+                }
+                const auto* bytes = reinterpret_cast<const uint8_t*>(header_.data());
+                const uint32_t length = uint32_t{bytes[0]} << 16 | uint32_t{bytes[1]} << 8 | uint32_t{bytes[2]};
+                frame.type = static_cast<FrameType>(bytes[3]);
+                frame.flags = bytes[4];
+                frame.stream_id = read_uint32(header_.data() + 5) & 0x7fffffff;
+                frame.payload.clear();
+                header_.clear();
+                if (length > max_frame_size_) {
+                    return std::make_tuple(oversized, begin);
+                }
+                frame.payload.reserve(length);
+                bytes_needed_ = length;
+                state_ = payload;
+                if (length == 0) {
+                    state_ = header;
+                    bytes_needed_ = kFrameHeaderSize;
+                    return std::make_tuple(good, begin);
+                }
+                break;
+            }
+            case payload: {
+                frame.payload.append(begin, count);
+                begin += count;
+                bytes_needed_ -= count;
+                if (bytes_needed_ == 0) {
+                    state_ = header;
+                    bytes_needed_ = kFrameHeaderSize;
+                    return std::make_tuple(good, begin);
+                }
+                break;
+            }
+        }
+    }
+    return std::make_tuple(indeterminate, begin);
+}
+
+} // namespace silkrpc::http::http2
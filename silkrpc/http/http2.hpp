@@ -0,0 +1,162 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_HTTP2_HPP_
+#define SILKRPC_HTTP_HTTP2_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/string_view.h>
+
+namespace silkrpc::http::http2 {
+
+/// The connection preface sent by the client when starting HTTP/2 with prior knowledge [RFC 7540 3.5].
+constexpr absl::string_view kConnectionPreface{"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"};
+
+/// The size of the frame header [RFC 7540 4.1].
+constexpr std::size_t kFrameHeaderSize{9};
+
+/// The initial values of the settings [RFC 7540 6.5.2].
+constexpr uint32_t kDefaultMaxFrameSize{16384};
+constexpr uint32_t kDefaultInitialWindowSize{65535};
+
+/// The maximum size of the flow-control windows [RFC 7540 6.9.1].
+constexpr int64_t kMaxWindowSize{0x7fffffff};
+
+/// The frame types [RFC 7540 6].
+enum FrameType : uint8_t {
+    data = 0x0,
+    headers = 0x1,
+    priority = 0x2,
+    rst_stream = 0x3,
+    settings = 0x4,
+    push_promise = 0x5,
+    ping = 0x6,
+    goaway = 0x7,
+    window_update = 0x8,
+    continuation = 0x9
+};
+
+/// The frame flags, whose meaning depends on the frame type [RFC 7540 6].
+constexpr uint8_t kFlagEndStream{0x1};
+constexpr uint8_t kFlagAck{0x1};
+constexpr uint8_t kFlagEndHeaders{0x4};
+constexpr uint8_t kFlagPadded{0x8};
+constexpr uint8_t kFlagPriority{0x20};
+
+/// The setting identifiers [RFC 7540 6.5.2].
+enum SettingId : uint16_t {
+    header_table_size = 0x1,
+    enable_push = 0x2,
+    max_concurrent_streams = 0x3,
+    initial_window_size = 0x4,
+    max_frame_size = 0x5,
+    max_header_list_size = 0x6
+};
+
+/// The error codes used in RST_STREAM and GOAWAY frames [RFC 7540 7].
+enum ErrorCode : uint32_t {
+    no_error = 0x0,
+    protocol_error = 0x1,
+    internal_error = 0x2,
+    flow_control_error = 0x3,
+    settings_timeout = 0x4,
+    stream_closed = 0x5,
+    frame_size_error = 0x6,
+    refused_stream = 0x7,
+    cancel = 0x8,
+    compression_error = 0x9,
+    connect_error = 0xa,
+    enhance_your_calm = 0xb
+};
+
+/// Check if the data received at the beginning of a connection can be the connection preface, which is told apart
+/// from an HTTP/1.x request line as soon as its first 4 bytes are available.
+bool is_connection_preface(const char* begin, const char* end);
+
+/// Read a 32-bit big-endian integer, e.g. a setting value or a window increment.
+uint32_t read_uint32(const char* data);
+
+/// Append the frame made of the given header fields and payload.
+void append_frame(std::string& out, FrameType type, uint8_t flags, uint32_t stream_id, absl::string_view payload = {});
+
+/// Append the SETTINGS frame carrying the given parameters.
+void append_settings(std::string& out, const std::vector<std::pair<SettingId, uint32_t>>& parameters);
+
+/// Append the WINDOW_UPDATE frame incrementing the window of the stream, or of the connection if the stream id is 0.
+void append_window_update(std::string& out, uint32_t stream_id, uint32_t increment);
+
+/// Append the RST_STREAM frame terminating the stream.
+void append_rst_stream(std::string& out, uint32_t stream_id, ErrorCode error_code);
+
+/// Append the GOAWAY frame closing the connection after the last stream processed.
+void append_goaway(std::string& out, uint32_t last_stream_id, ErrorCode error_code);
+
+/// A frame received from a client.
+struct Frame {
+    FrameType type{data};
+    uint8_t flags{0};
+    uint32_t stream_id{0};
+    std::string payload;
+
+    void reset() {
+        type = data;
+        flags = 0;
+        stream_id = 0;
+        payload.clear();
+    }
+
+    bool has_flag(uint8_t flag) const { return (flags & flag) != 0; }
+
+    /// Get the content of a DATA or HEADERS frame without padding and priority fields, false if they are malformed.
+    bool content(absl::string_view& content) const;
+};
+
+/// Incremental parser for the connection preface and the frames received from a client.
+class FrameParser {
+public:
+    /// Construct ready to parse the connection preface, if expected, and then the frames up to the given size.
+    explicit FrameParser(uint32_t max_frame_size = kDefaultMaxFrameSize, bool expect_preface = true);
+
+    /// Result of parse.
+    enum ResultType { good, bad, oversized, indeterminate };
+
+    /// Parse some data. The enum return value is good when a complete frame has been parsed, bad if the connection
+    /// preface is invalid, oversized if the frame exceeds the maximum size, indeterminate when more data is required.
+    /// The pointer return value indicates how much of the input has been consumed.
+    std::tuple<ResultType, const char*> parse(Frame& frame, const char* begin, const char* end);
+
+private:
+    /// The current state of the parser.
+    enum State {
+        preface,
+        header,
+        payload
+    } state_;
+
+    uint32_t max_frame_size_;
+    std::size_t bytes_needed_{0};
+    std::string header_;
+};
+
+} // namespace silkrpc::http::http2
+
+#endif // SILKRPC_HTTP_HTTP2_HPP_
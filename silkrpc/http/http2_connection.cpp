@@ -0,0 +1,505 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "http2_connection.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+#include <absl/strings/ascii.h>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asio/write.hpp>
+
+#include <silkrpc/common/log.hpp>
+#include "request.hpp"
+
+namespace silkrpc::http {
+
+/// The maximum size of the output gathered before writing it, so that control frames are not delayed too much.
+constexpr std::size_t kMaxOutputSize{256 * 1024};
+
+/// The increment of the receive windows: being replenished as soon as data arrives, the client is never blocked.
+constexpr uint32_t kReceiveWindowIncrement{1 << 20};
+
+Http2Connection::Http2Connection(asio::ip::tcp::socket&& socket, Context& context, asio::thread_pool& workers,
+    const ServerSettings& settings, AdmissionControl* admission_control, SingleFlight* single_flight,
+    ChunkPool* chunk_pool)
+: socket_{std::move(socket)}, chunk_pool_{chunk_pool}, request_handler_{context, workers, settings.max_batch_size, admission_control, settings.retry_after, single_flight, settings.api_namespaces},
+  max_body_size_{settings.max_body_size}, max_concurrent_streams_{settings.http2_max_concurrent_streams} {
+    SILKRPC_DEBUG << "Http2Connection::Http2Connection socket " << &socket_ << " created\n";
+}
+
+Http2Connection::~Http2Connection() {
+    std::error_code ec;
+    socket_.close(ec);
+    SILKRPC_DEBUG << "Http2Connection::~Http2Connection socket " << &socket_ << " deleted\n";
+}
+
+asio::awaitable<void> Http2Connection::start(const char* begin, const char* end) {
+    // The data following the preface start belongs to the HTTP connection buffer, so it must be saved first
+    const std::string initial_data{begin, end};
+    try {
+        http2::append_settings(output_, {
+            {http2::max_concurrent_streams, static_cast<uint32_t>(max_concurrent_streams_)},
+            {http2::enable_push, 0},
+        });
+        http2::append_window_update(output_, 0, kReceiveWindowIncrement);
+        flush();
+
+        if (handle_data(initial_data.data(), initial_data.data() + initial_data.size())) {
+            co_await do_read();
+        }
+    } catch (const std::system_error& se) {
+        if (se.code() == asio::error::eof || se.code() == asio::error::connection_reset || se.code() == asio::error::broken_pipe) {
+            SILKRPC_DEBUG << "Http2Connection::start close from client with code: " << se.code() << "\n" << std::flush;
+        } else if (se.code() != asio::error::operation_aborted) {
+            SILKRPC_ERROR << "Http2Connection::start system_error: " << se.what() << "\n" << std::flush;
+        }
+        close();
+        co_return;
+    }
+    // The streams being handled complete before closing, pending writes keep the connection alive
+    draining_ = true;
+    if (!writing_ && streams_.empty()) {
+        close();
+    }
+}
+
+asio::awaitable<void> Http2Connection::do_read() {
+    while (!closed_) {
+        SILKRPC_DEBUG << "Http2Connection::do_read going to read...\n" << std::flush;
+        std::size_t bytes_read = co_await socket_.async_read_some(asio::buffer(buffer_), asio::use_awaitable);
+        SILKRPC_DEBUG << "Http2Connection::do_read bytes_read: " << bytes_read << "\n";
+        if (!handle_data(buffer_.data(), buffer_.data() + bytes_read)) {
+            break;
+        }
+    }
+}
+
+bool Http2Connection::handle_data(const char* begin, const char* end) {
+    while (begin != end) {
+        http2::FrameParser::ResultType result;
+        std::tie(result, begin) = frame_parser_.parse(frame_, begin, end);
+        if (result == http2::FrameParser::indeterminate) {
+            break;
+        }
+        http2::ErrorCode error_code{http2::no_error};
+        if (result == http2::FrameParser::bad) {
+            error_code = http2::protocol_error;
+        } else if (result == http2::FrameParser::oversized) {
+            error_code = http2::frame_size_error;
+        } else {
+            error_code = handle_frame();
+        }
+        if (error_code != http2::no_error) {
+            SILKRPC_DEBUG << "Http2Connection::handle_data connection error: " << error_code << ", closing socket: " << &socket_ << "\n";
+            http2::append_goaway(output_, last_stream_id_, error_code);
+            close_after_write_ = true;
+            flush();
+            return false;
+        }
+        if (draining_) {
+            break;
+        }
+    }
+    flush();
+    return !draining_;
+}
+
+http2::ErrorCode Http2Connection::handle_frame() {
+    // The header block must be contiguous [RFC 7540 6.10]
+    if (header_block_stream_id_ != 0 && (frame_.type != http2::continuation || frame_.stream_id != header_block_stream_id_)) {
+        return http2::protocol_error;
+    }
+    switch (frame_.type) {
+        case http2::data:
+            return handle_data_frame();
+        case http2::headers:
+            return handle_headers();
+        case http2::continuation:
+            if (header_block_stream_id_ == 0) {
+                return http2::protocol_error;
+            }
+            header_block_.append(frame_.payload);
+            return frame_.has_flag(http2::kFlagEndHeaders) ? handle_header_block() : http2::no_error;
+        case http2::rst_stream: {
+            if (frame_.stream_id == 0 || frame_.payload.size() != 4) {
+                return frame_.stream_id == 0 ? http2::protocol_error : http2::frame_size_error;
+            }
+            const auto stream_it = streams_.find(frame_.stream_id);
+            if (stream_it != streams_.end()) {
+                // The stream being handled is removed when its reply is ready
+                if (stream_it->second.state == Stream::handling) {
+                    stream_it->second.reset = true;
+                } else {
+                    streams_.erase(stream_it);
+                }
+            }
+            return http2::no_error;
+        }
+        case http2::settings:
+            return handle_settings();
+        case http2::ping:
+            if (frame_.stream_id != 0) {
+                return http2::protocol_error;
+            }
+            if (frame_.payload.size() != 8) {
+                return http2::frame_size_error;
+            }
+            if (!frame_.has_flag(http2::kFlagAck)) {
+                http2::append_frame(output_, http2::ping, http2::kFlagAck, 0, frame_.payload);
+            }
+            return http2::no_error;
+        case http2::goaway:
+            SILKRPC_DEBUG << "Http2Connection::handle_frame GOAWAY received for socket " << &socket_ << "\n";
+            draining_ = true;
+            return http2::no_error;
+        case http2::window_update:
+            return handle_window_update();
+        case http2::push_promise:
+            // Clients cannot push [RFC 7540 8.2]
+            return http2::protocol_error;
+        default:
+            // PRIORITY frames and unknown frame types are ignored [RFC 7540 4.1, 5.3]
+            return http2::no_error;
+    }
+}
+
+http2::ErrorCode Http2Connection::handle_headers() {
+    // The streams initiated by the client have odd identifiers [RFC 7540 5.1.1]
+    if (frame_.stream_id == 0 || frame_.stream_id % 2 == 0) {
+        return http2::protocol_error;
+    }
+    const auto stream_it = streams_.find(frame_.stream_id);
+    const bool trailers = stream_it != streams_.end() && stream_it->second.state == Stream::receiving;
+    if (!trailers && frame_.stream_id <= last_stream_id_) {
+        return http2::protocol_error;
+    }
+    if (trailers && !frame_.has_flag(http2::kFlagEndStream)) {
+        return http2::protocol_error;
+    }
+    absl::string_view content;
+    if (!frame_.content(content)) {
+        return http2::protocol_error;
+    }
+    header_block_.assign(content.data(), content.size());
+    header_block_stream_id_ = frame_.stream_id;
+    header_block_end_stream_ = frame_.has_flag(http2::kFlagEndStream);
+    return frame_.has_flag(http2::kFlagEndHeaders) ? handle_header_block() : http2::no_error;
+}
+
+http2::ErrorCode Http2Connection::handle_header_block() {
+    const auto stream_id = header_block_stream_id_;
+    header_block_stream_id_ = 0;
+
+    // The block is decoded even if the stream is refused, because the decoder state is shared by the connection
+    std::vector<Header> headers;
+    if (!hpack_decoder_.decode(header_block_, headers)) {
+        return http2::compression_error;
+    }
+    header_block_.clear();
+
+    const auto stream_it = streams_.find(stream_id);
+    if (stream_it != streams_.end()) {
+        // The trailers carry nothing useful for a JSON-RPC request
+        dispatch(stream_id);
+        return http2::no_error;
+    }
+    last_stream_id_ = stream_id;
+    if (streams_.size() >= max_concurrent_streams_) {
+        http2::append_rst_stream(output_, stream_id, http2::refused_stream);
+        return http2::no_error;
+    }
+    auto& stream = streams_[stream_id];
+    stream.headers = std::move(headers);
+    stream.send_window = initial_window_size_;
+    if (header_block_end_stream_) {
+        dispatch(stream_id);
+    }
+    return http2::no_error;
+}
+
+http2::ErrorCode Http2Connection::handle_data_frame() {
+    if (frame_.stream_id == 0) {
+        return http2::protocol_error;
+    }
+    // The whole payload counts against the receive window, which is replenished right away
+    if (!frame_.payload.empty()) {
+        http2::append_window_update(output_, 0, static_cast<uint32_t>(frame_.payload.size()));
+    }
+    absl::string_view content;
+    if (!frame_.content(content)) {
+        return http2::protocol_error;
+    }
+    const auto stream_it = streams_.find(frame_.stream_id);
+    if (stream_it == streams_.end() || stream_it->second.state != Stream::receiving) {
+        if (frame_.stream_id > last_stream_id_) {
+            return http2::protocol_error;
+        }
+        http2::append_rst_stream(output_, frame_.stream_id, http2::stream_closed);
+        return http2::no_error;
+    }
+    auto& stream = stream_it->second;
+    if (max_body_size_ > 0 && stream.content.size() + content.size() > max_body_size_) {
+        stream.too_large = true;
+        stream.content.clear();
+    }
+    if (!stream.too_large) {
+        stream.content.append(content.data(), content.size());
+    }
+    if (frame_.has_flag(http2::kFlagEndStream)) {
+        dispatch(frame_.stream_id);
+    } else if (!frame_.payload.empty()) {
+        http2::append_window_update(output_, frame_.stream_id, static_cast<uint32_t>(frame_.payload.size()));
+    }
+    return http2::no_error;
+}
+
+http2::ErrorCode Http2Connection::handle_settings() {
+    if (frame_.stream_id != 0) {
+        return http2::protocol_error;
+    }
+    if (frame_.has_flag(http2::kFlagAck)) {
+        return frame_.payload.empty() ? http2::no_error : http2::frame_size_error;
+    }
+    if (frame_.payload.size() % 6 != 0) {
+        return http2::frame_size_error;
+    }
+    for (std::size_t offset{0}; offset < frame_.payload.size(); offset += 6) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(frame_.payload.data() + offset);
+        const uint16_t id = static_cast<uint16_t>(bytes[0] << 8 | bytes[1]);
+        const uint32_t value = http2::read_uint32(frame_.payload.data() + offset + 2);
+        if (id == http2::initial_window_size) {
+            if (value > http2::kMaxWindowSize) {
+                return http2::flow_control_error;
+            }
+            // The change applies to the windows of all the open streams [RFC 7540 6.9.2]
+            const int64_t delta = static_cast<int64_t>(value) - initial_window_size_;
+            for (auto& [_, stream] : streams_) {
+                stream.send_window += delta;
+            }
+            initial_window_size_ = value;
+        } else if (id == http2::max_frame_size) {
+            if (value < http2::kDefaultMaxFrameSize || value > 0xffffff) {
+                return http2::protocol_error;
+            }
+            max_frame_size_ = value;
+        }
+    }
+    http2::append_frame(output_, http2::settings, http2::kFlagAck, 0);
+    return http2::no_error;
+}
+
+http2::ErrorCode Http2Connection::handle_window_update() {
+    if (frame_.payload.size() != 4) {
+        return http2::frame_size_error;
+    }
+    const auto increment = http2::read_uint32(frame_.payload.data()) & 0x7fffffff;
+    if (frame_.stream_id == 0) {
+        if (increment == 0) {
+            return http2::protocol_error;
+        }
+        send_window_ += increment;
+        return send_window_ > http2::kMaxWindowSize ? http2::flow_control_error : http2::no_error;
+    }
+    const auto stream_it = streams_.find(frame_.stream_id);
+    if (stream_it == streams_.end()) {
+        return http2::no_error;
+    }
+    auto& stream = stream_it->second;
+    stream.send_window += increment;
+    if (increment == 0 || stream.send_window > http2::kMaxWindowSize) {
+        http2::append_rst_stream(output_, frame_.stream_id, increment == 0 ? http2::protocol_error : http2::flow_control_error);
+        if (stream.state == Stream::handling) {
+            stream.reset = true;
+        } else {
+            streams_.erase(stream_it);
+        }
+    }
+    return http2::no_error;
+}
+
+void Http2Connection::dispatch(uint32_t stream_id) {
+    streams_.at(stream_id).state = Stream::handling;
+    // Each stream is handled concurrently, the coroutine keeps this connection alive until the reply is queued
+    asio::co_spawn(socket_.get_executor(), [self = shared_from_this(), stream_id]() { return self->handle_stream(stream_id); }, asio::detached);
+}
+
+asio::awaitable<void> Http2Connection::handle_stream(uint32_t stream_id) {
+    if (closed_ || streams_.find(stream_id) == streams_.end()) {
+        co_return;
+    }
+    Reply reply;
+    {
+        auto& stream = streams_.at(stream_id);
+        if (stream.too_large) {
+            reply = Reply::stock_reply(Reply::payload_too_large);
+        } else {
+            Request request;
+            request.http_version_major = 2;
+            request.http_version_minor = 0;
+            for (auto& header : stream.headers) {
+                if (header.name == ":method") {
+                    request.method = std::move(header.value);
+                } else if (header.name == ":path") {
+                    request.uri = std::move(header.value);
+                } else if (!header.name.empty() && header.name[0] != ':') {
+                    request.headers.push_back(std::move(header));
+                }
+            }
+            stream.headers.clear();
+            request.content = std::move(stream.content);
+            request.content_length = static_cast<uint32_t>(request.content.size());
+            reply.body = ChunkBuffer{chunk_pool_};
+            co_await request_handler_.handle_request(request, reply);
+        }
+    }
+    if (closed_) {
+        co_return;
+    }
+    // The stream may have been reset by the client in the meantime
+    const auto stream_it = streams_.find(stream_id);
+    if (stream_it == streams_.end()) {
+        co_return;
+    }
+    if (stream_it->second.reset) {
+        streams_.erase(stream_it);
+        flush();
+        co_return;
+    }
+    auto& stream = stream_it->second;
+    stream.reply = std::move(reply);
+    if (!stream.reply.content.empty()) {
+        stream.data.push_back(asio::buffer(stream.reply.content));
+    }
+    stream.reply.body.append_to(stream.data);
+    stream.data_remaining = stream.reply.content.size() + stream.reply.body.size();
+
+    std::vector<Header> headers{{":status", std::to_string(stream.reply.status)}};
+    if (stream.reply.status != Reply::no_content) {
+        headers.push_back(Header{"content-type", stream.reply.content_type == Reply::text_html ? "text/html" : "application/json"});
+        headers.push_back(Header{"content-length", std::to_string(stream.data_remaining)});
+    }
+    for (const auto& header : stream.reply.headers) {
+        headers.push_back(Header{absl::AsciiStrToLower(header.name), header.value});
+    }
+    const uint8_t flags = http2::kFlagEndHeaders | (stream.data_remaining == 0 ? http2::kFlagEndStream : 0);
+    http2::append_frame(output_, http2::headers, flags, stream_id, hpack::encode_headers(headers));
+    if (stream.data_remaining == 0) {
+        streams_.erase(stream_it);
+    } else {
+        stream.state = Stream::sending;
+    }
+    flush();
+}
+
+void Http2Connection::append_data_frames() {
+    auto stream_it = streams_.begin();
+    while (stream_it != streams_.end() && send_window_ > 0 && output_.size() < kMaxOutputSize) {
+        auto& stream = stream_it->second;
+        if (stream.state != Stream::sending) {
+            ++stream_it;
+            continue;
+        }
+        while (stream.data_remaining > 0 && stream.send_window > 0 && send_window_ > 0 && output_.size() < kMaxOutputSize) {
+            const auto size = static_cast<std::size_t>(std::min({
+                static_cast<int64_t>(stream.data_remaining), static_cast<int64_t>(max_frame_size_), stream.send_window, send_window_}));
+            stream.data_remaining -= size;
+            stream.send_window -= static_cast<int64_t>(size);
+            send_window_ -= static_cast<int64_t>(size);
+
+            const auto header_offset = output_.size();
+            http2::append_frame(output_, http2::data, stream.data_remaining == 0 ? http2::kFlagEndStream : 0, stream_it->first);
+            // The frame header has been written with empty payload, so its length is patched after copying the data
+            for (std::size_t copied{0}; copied < size;) {
+                const auto& buffer = stream.data[stream.data_index];
+                const auto count = std::min(size - copied, buffer.size() - stream.data_offset);
+                output_.append(static_cast<const char*>(buffer.data()) + stream.data_offset, count);
+                copied += count;
+                stream.data_offset += count;
+                if (stream.data_offset == buffer.size()) {
+                    ++stream.data_index;
+                    stream.data_offset = 0;
+                }
+            }
+            output_[header_offset] = static_cast<char>(size >> 16);
+            output_[header_offset + 1] = static_cast<char>(size >> 8);
+            output_[header_offset + 2] = static_cast<char>(size);
+        }
+        if (stream.data_remaining == 0) {
+            stream_it = streams_.erase(stream_it);
+        } else {
+            ++stream_it;
+        }
+    }
+}
+
+void Http2Connection::flush() {
+    if (!writing_ && !closed_) {
+        writing_ = true;
+        // The writer keeps this connection alive until all the output has been written
+        asio::co_spawn(socket_.get_executor(), [self = shared_from_this()]() { return self->do_write(); }, asio::detached);
+    }
+}
+
+asio::awaitable<void> Http2Connection::do_write() {
+    try {
+        std::string output;
+        while (!closed_) {
+            append_data_frames();
+            if (output_.empty()) {
+                break;
+            }
+            output.clear();
+            output.swap(output_);
+            const auto bytes_transferred = co_await asio::async_write(socket_, asio::buffer(output), asio::use_awaitable);
+            SILKRPC_TRACE << "Http2Connection::do_write bytes_transferred: " << bytes_transferred << "\n";
+        }
+        writing_ = false;
+
+        if (close_after_write_ || (draining_ && streams_.empty())) {
+            SILKRPC_DEBUG << "Http2Connection::do_write closing socket: " << &socket_ << "\n" << std::flush;
+            std::error_code ec;
+            socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+            close();
+        }
+    } catch (const std::system_error& se) {
+        writing_ = false;
+        if (se.code() != asio::error::operation_aborted) {
+            SILKRPC_DEBUG << "Http2Connection::do_write system_error: " << se.what() << "\n" << std::flush;
+        }
+        close();
+    }
+}
+
+void Http2Connection::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    output_.clear();
+    streams_.clear();
+    // Closing the socket cancels any pending read, so that the connection is released
+    std::error_code ec;
+    socket_.close(ec);
+}
+
+} // namespace silkrpc::http
@@ -0,0 +1,186 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_HTTP2_CONNECTION_HPP_
+#define SILKRPC_HTTP_HTTP2_CONNECTION_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <silkrpc/config.hpp>
+
+#include <asio/awaitable.hpp>
+#include <asio/buffer.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/thread_pool.hpp>
+
+#include <silkrpc/context_pool.hpp>
+#include "admission_control.hpp"
+#include "chunk_buffer.hpp"
+#include "header.hpp"
+#include "hpack.hpp"
+#include "http2.hpp"
+#include "reply.hpp"
+#include "request_handler.hpp"
+#include "server_settings.hpp"
+#include "single_flight.hpp"
+
+namespace silkrpc::http {
+
+/// Represents a connection from a client speaking HTTP/2 over cleartext TCP with prior knowledge: each stream carries
+/// one JSON-RPC request, handled in its own coroutine, so that many requests are multiplexed on the connection.
+class Http2Connection : public std::enable_shared_from_this<Http2Connection> {
+public:
+    Http2Connection(const Http2Connection&) = delete;
+    Http2Connection& operator=(const Http2Connection&) = delete;
+
+    /// Construct a connection taking over the socket of the HTTP connection which received the connection preface.
+    /// The reply chunks are taken from the pool of the context, if any.
+    explicit Http2Connection(asio::ip::tcp::socket&& socket, Context& context, asio::thread_pool& workers,
+        const ServerSettings& settings, AdmissionControl* admission_control = nullptr, SingleFlight* single_flight = nullptr,
+        ChunkPool* chunk_pool = nullptr);
+
+    ~Http2Connection();
+
+    /// Send the server settings, then handle the incoming frames starting from the data already received.
+    asio::awaitable<void> start(const char* begin, const char* end);
+
+    std::size_t num_streams() const { return streams_.size(); }
+
+private:
+    /// A stream opened by the client, whose request is received, then handled and finally replied.
+    struct Stream {
+        enum State {
+            receiving,
+            handling,
+            sending
+        } state{receiving};
+
+        std::vector<Header> headers;
+        std::string content;
+
+        /// Flag indicating if the content exceeds the maximum size, the excess being discarded.
+        bool too_large{false};
+
+        /// Flag indicating if the client has reset the stream while being handled.
+        bool reset{false};
+
+        /// The flow-control window for sending data on the stream.
+        int64_t send_window{0};
+
+        /// The reply whose content is sent in DATA frames as the windows allow, the buffers pointing into it.
+        Reply reply;
+        std::vector<asio::const_buffer> data;
+        std::size_t data_index{0};
+        std::size_t data_offset{0};
+        std::size_t data_remaining{0};
+    };
+
+    /// Handle the frames contained in the data, returning false when no more frames must be read.
+    bool handle_data(const char* begin, const char* end);
+
+    /// Handle one frame, returning the connection error if any.
+    http2::ErrorCode handle_frame();
+
+    http2::ErrorCode handle_headers();
+
+    http2::ErrorCode handle_header_block();
+
+    http2::ErrorCode handle_data_frame();
+
+    http2::ErrorCode handle_settings();
+
+    http2::ErrorCode handle_window_update();
+
+    /// Start handling the complete request received on the stream in its own coroutine.
+    void dispatch(uint32_t stream_id);
+
+    /// Handle the request received on the stream and queue its reply.
+    asio::awaitable<void> handle_stream(uint32_t stream_id);
+
+    /// Append the DATA frames allowed by the flow-control windows to the output.
+    void append_data_frames();
+
+    /// Start the writer if idle.
+    void flush();
+
+    /// Perform asynchronous write operations until the output and the sendable data are exhausted.
+    asio::awaitable<void> do_write();
+
+    /// Perform asynchronous read operations until the client or the server closes the connection.
+    asio::awaitable<void> do_read();
+
+    /// Close the connection cancelling any pending operation.
+    void close();
+
+    asio::ip::tcp::socket socket_;
+
+    ChunkPool* chunk_pool_;
+
+    RequestHandler request_handler_;
+
+    /// The maximum size of the request content, zero meaning unlimited.
+    std::size_t max_body_size_;
+
+    /// The maximum number of streams open at the same time, advertised to the client.
+    std::size_t max_concurrent_streams_;
+
+    std::array<char, 16384> buffer_;
+
+    http2::FrameParser frame_parser_;
+
+    http2::Frame frame_;
+
+    hpack::Decoder hpack_decoder_;
+
+    /// The header block being assembled from HEADERS and CONTINUATION frames, the stream id is zero if none.
+    std::string header_block_;
+    uint32_t header_block_stream_id_{0};
+    bool header_block_end_stream_{false};
+
+    /// The highest stream id opened by the client.
+    uint32_t last_stream_id_{0};
+
+    std::map<uint32_t, Stream> streams_;
+
+    /// The flow-control window for sending data on the connection.
+    int64_t send_window_{http2::kDefaultInitialWindowSize};
+
+    /// The settings of the client which apply to the data sent.
+    int64_t initial_window_size_{http2::kDefaultInitialWindowSize};
+    uint32_t max_frame_size_{http2::kDefaultMaxFrameSize};
+
+    /// The frames to be written, DATA ones are added just before writing.
+    std::string output_;
+
+    bool writing_{false};
+
+    bool close_after_write_{false};
+
+    /// Flag indicating if no more frames are read, the connection being closed when the last stream is done.
+    bool draining_{false};
+
+    bool closed_{false};
+};
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_HTTP2_CONNECTION_HPP_
@@ -0,0 +1,315 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "http2_connection.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <asio/buffer.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/executor_work_guard.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/address_v4.hpp>
+#include <asio/read.hpp>
+#include <asio/thread_pool.hpp>
+#include <asio/write.hpp>
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+#include <silkrpc/common/log.hpp>
+
+namespace silkrpc::http {
+
+using Catch::Matchers::Message;
+
+/// The connections under test run on one io_context driven by its own thread, the clients are blocking sockets.
+class Http2ConnectionTest {
+public:
+    explicit Http2ConnectionTest(const ServerSettings& server_settings) : settings{server_settings} {
+        context.io_context = std::make_shared<asio::io_context>();
+        acceptor = std::make_unique<asio::ip::tcp::acceptor>(*context.io_context, asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), 0});
+        work = std::make_unique<asio::executor_work_guard<asio::io_context::executor_type>>(context.io_context->get_executor());
+        io_thread = std::thread{[&]() { context.io_context->run(); }};
+    }
+
+    ~Http2ConnectionTest() {
+        work.reset();
+        context.io_context->stop();
+        io_thread.join();
+    }
+
+    /// Connect a new client with prior knowledge, i.e. sending the connection preface and its SETTINGS right away.
+    asio::ip::tcp::socket connect(const std::vector<std::pair<http2::SettingId, uint32_t>>& client_settings = {}) {
+        asio::ip::tcp::socket client{*context.io_context};
+        client.connect(acceptor->local_endpoint());
+        asio::ip::tcp::socket socket{*context.io_context};
+        acceptor->accept(socket);
+        auto connection = std::make_shared<Http2Connection>(std::move(socket), context, workers, settings);
+        asio::co_spawn(*context.io_context, [connection]() { return connection->start(nullptr, nullptr); }, asio::detached);
+
+        std::string output{http2::kConnectionPreface};
+        http2::append_settings(output, client_settings);
+        asio::write(client, asio::buffer(output));
+        return client;
+    }
+
+    // Declared first, so that they outlive the connections destroyed together with the io_context
+    ServerSettings settings;
+    asio::thread_pool workers{1};
+    Context context;
+    std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
+    std::unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>> work;
+    std::thread io_thread;
+};
+
+static void write_frame(asio::ip::tcp::socket& client, http2::FrameType type, uint8_t flags, uint32_t stream_id, const std::string& payload = {}) {
+    std::string output;
+    http2::append_frame(output, type, flags, stream_id, payload);
+    asio::write(client, asio::buffer(output));
+}
+
+/// Open the stream sending the headers of a JSON-RPC request, whose content follows in DATA frames.
+static void write_headers(asio::ip::tcp::socket& client, uint32_t stream_id, uint8_t flags = http2::kFlagEndHeaders) {
+    const auto header_block = hpack::encode_headers({
+        {":method", "POST"},
+        {":scheme", "http"},
+        {":path", "/"},
+        {":authority", "localhost"},
+        {"content-type", "application/json"},
+    });
+    write_frame(client, http2::headers, flags, stream_id, header_block);
+}
+
+/// Read the next frame sent by the server.
+static http2::Frame read_frame(asio::ip::tcp::socket& client) {
+    std::string header(http2::kFrameHeaderSize, '\0');
+    asio::read(client, asio::buffer(header));
+    http2::Frame frame;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(header.data());
+    frame.type = static_cast<http2::FrameType>(bytes[3]);
+    frame.flags = bytes[4];
+    frame.stream_id = http2::read_uint32(header.data() + 5) & 0x7fffffff;
+    frame.payload.resize(static_cast<std::size_t>(bytes[0] << 16 | bytes[1] << 8 | bytes[2]));
+    asio::read(client, asio::buffer(frame.payload));
+    return frame;
+}
+
+/// Read the frames sent by the server until the one of the given type on the given stream.
+static http2::Frame read_frame(asio::ip::tcp::socket& client, http2::FrameType type, uint32_t stream_id) {
+    while (true) {
+        auto frame = read_frame(client);
+        if (frame.type == type && frame.stream_id == stream_id) {
+            return frame;
+        }
+    }
+}
+
+/// A reply read by the client, i.e. its decoded headers and its content.
+struct ClientReply {
+    std::vector<Header> headers;
+    std::string content;
+};
+
+/// Read the given number of whole replies, received on any stream in any order, by stream id.
+static std::map<uint32_t, ClientReply> read_replies(asio::ip::tcp::socket& client, std::size_t count) {
+    std::map<uint32_t, ClientReply> replies;
+    for (std::size_t completed{0}; completed < count;) {
+        const auto frame = read_frame(client);
+        if (frame.type == http2::headers) {
+            hpack::Decoder decoder;
+            REQUIRE(decoder.decode(frame.payload, replies[frame.stream_id].headers));
+        } else if (frame.type == http2::data) {
+            replies[frame.stream_id].content.append(frame.payload);
+        } else {
+            continue;
+        }
+        if (frame.has_flag(http2::kFlagEndStream)) {
+            ++completed;
+        }
+    }
+    return replies;
+}
+
+/// Read the whole reply on the stream.
+static ClientReply read_reply(asio::ip::tcp::socket& client, uint32_t stream_id) {
+    auto replies = read_replies(client, 1);
+    REQUIRE(replies.size() == 1);
+    REQUIRE(replies.begin()->first == stream_id);
+    return replies.begin()->second;
+}
+
+/// Get the value of the setting carried by the SETTINGS frame, zero if missing.
+static uint32_t setting_of(const http2::Frame& frame, http2::SettingId id) {
+    for (std::size_t offset{0}; offset + 6 <= frame.payload.size(); offset += 6) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(frame.payload.data() + offset);
+        if (static_cast<uint16_t>(bytes[0] << 8 | bytes[1]) == id) {
+            return http2::read_uint32(frame.payload.data() + offset + 2);
+        }
+    }
+    return 0;
+}
+
+static std::string header_value(const std::vector<Header>& headers, const std::string& name) {
+    for (const auto& header : headers) {
+        if (header.name == name) {
+            return header.value;
+        }
+    }
+    return {};
+}
+
+const std::string kNetListeningRequest{R"({"jsonrpc":"2.0","id":1,"method":"net_listening","params":[]})"};
+
+TEST_CASE("Http2Connection with prior knowledge", "[silkrpc][http][http2_connection]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    ServerSettings settings;
+    settings.http2 = true;
+    settings.http2_max_concurrent_streams = 10;
+    Http2ConnectionTest test{settings};
+    auto client = test.connect();
+
+    const auto server_settings = read_frame(client);
+    CHECK(server_settings.type == http2::settings);
+    CHECK(!server_settings.has_flag(http2::kFlagAck));
+    CHECK(setting_of(server_settings, http2::max_concurrent_streams) == 10);
+    CHECK(read_frame(client, http2::settings, 0).has_flag(http2::kFlagAck));
+    write_frame(client, http2::settings, http2::kFlagAck, 0);
+
+    SECTION("request and reply") {
+        write_headers(client, 1);
+        write_frame(client, http2::data, http2::kFlagEndStream, 1, kNetListeningRequest);
+        const auto [headers, content] = read_reply(client, 1);
+        CHECK(header_value(headers, ":status") == "200");
+        CHECK(header_value(headers, "content-type") == "application/json");
+        CHECK(header_value(headers, "content-length") == std::to_string(content.size()));
+        CHECK(nlohmann::json::parse(content) == R"({"jsonrpc":"2.0","id":1,"result":true})"_json);
+    }
+
+    SECTION("multiplexed requests") {
+        write_headers(client, 1);
+        write_headers(client, 3);
+        write_frame(client, http2::data, http2::kFlagEndStream, 3, R"({"jsonrpc":"2.0","id":3,"method":"net_listening","params":[]})");
+        write_frame(client, http2::data, http2::kFlagEndStream, 1, kNetListeningRequest);
+        const auto replies = read_replies(client, 2);
+        REQUIRE(replies.size() == 2);
+        CHECK(nlohmann::json::parse(replies.at(1).content)["id"] == 1);
+        CHECK(nlohmann::json::parse(replies.at(3).content)["id"] == 3);
+    }
+
+    SECTION("ping") {
+        write_frame(client, http2::ping, 0, 0, "12345678");
+        const auto ping_ack = read_frame(client, http2::ping, 0);
+        CHECK(ping_ack.has_flag(http2::kFlagAck));
+        CHECK(ping_ack.payload == "12345678");
+    }
+}
+
+TEST_CASE("Http2Connection flow control", "[silkrpc][http][http2_connection]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    ServerSettings settings;
+    settings.http2 = true;
+
+    SECTION("stream window set by client settings") {
+        Http2ConnectionTest test{settings};
+        auto client = test.connect({{http2::initial_window_size, 16}});
+        CHECK(!read_frame(client, http2::settings, 0).has_flag(http2::kFlagAck));
+        CHECK(read_frame(client, http2::settings, 0).has_flag(http2::kFlagAck));
+
+        write_headers(client, 1);
+        write_frame(client, http2::data, http2::kFlagEndStream, 1, kNetListeningRequest);
+        read_frame(client, http2::headers, 1);
+        const auto first_data = read_frame(client, http2::data, 1);
+        CHECK(first_data.payload.size() == 16);
+        CHECK(!first_data.has_flag(http2::kFlagEndStream));
+
+        // The stream window is exhausted, so the PING acknowledgement is the next frame sent
+        write_frame(client, http2::ping, 0, 0, "12345678");
+        const auto ping_ack = read_frame(client);
+        CHECK(ping_ack.type == http2::ping);
+        CHECK(ping_ack.has_flag(http2::kFlagAck));
+
+        std::string increment(4, '\0');
+        increment[3] = static_cast<char>(100);
+        write_frame(client, http2::window_update, 0, 1, increment);
+        std::string content{first_data.payload};
+        for (bool end_stream{false}; !end_stream;) {
+            const auto data_frame = read_frame(client, http2::data, 1);
+            content.append(data_frame.payload);
+            end_stream = data_frame.has_flag(http2::kFlagEndStream);
+        }
+        CHECK(nlohmann::json::parse(content) == R"({"jsonrpc":"2.0","id":1,"result":true})"_json);
+    }
+
+    SECTION("receive windows replenished") {
+        Http2ConnectionTest test{settings};
+        auto client = test.connect();
+        write_headers(client, 1);
+        write_frame(client, http2::data, 0, 1, kNetListeningRequest.substr(0, 10));
+        // The first connection window update is sent by the server right after its settings
+        CHECK(http2::read_uint32(read_frame(client, http2::window_update, 0).payload.data()) == 1 << 20);
+        const auto connection_update = read_frame(client, http2::window_update, 0);
+        const auto stream_update = read_frame(client, http2::window_update, 1);
+        CHECK(http2::read_uint32(connection_update.payload.data()) == 10);
+        CHECK(http2::read_uint32(stream_update.payload.data()) == 10);
+        write_frame(client, http2::data, http2::kFlagEndStream, 1, kNetListeningRequest.substr(10));
+        const auto [headers, content] = read_reply(client, 1);
+        CHECK(header_value(headers, ":status") == "200");
+        CHECK(nlohmann::json::parse(content)["result"] == true);
+    }
+
+    SECTION("max concurrent streams") {
+        settings.http2_max_concurrent_streams = 1;
+        Http2ConnectionTest test{settings};
+        auto client = test.connect();
+        CHECK(setting_of(read_frame(client, http2::settings, 0), http2::max_concurrent_streams) == 1);
+
+        // The first stream is still receiving its request, so the second one is refused
+        write_headers(client, 1);
+        write_headers(client, 3);
+        const auto rst_stream = read_frame(client, http2::rst_stream, 3);
+        CHECK(http2::read_uint32(rst_stream.payload.data()) == http2::refused_stream);
+
+        write_frame(client, http2::data, http2::kFlagEndStream, 1, kNetListeningRequest);
+        const auto [headers, content] = read_reply(client, 1);
+        CHECK(header_value(headers, ":status") == "200");
+    }
+
+    SECTION("body limit on DATA") {
+        settings.max_body_size = 16;
+        Http2ConnectionTest test{settings};
+        auto client = test.connect();
+        write_headers(client, 1);
+        write_frame(client, http2::data, 0, 1, kNetListeningRequest.substr(0, 10));
+        write_frame(client, http2::data, http2::kFlagEndStream, 1, kNetListeningRequest.substr(10));
+        const auto [headers, content] = read_reply(client, 1);
+        CHECK(header_value(headers, ":status") == "413");
+
+        // The connection is still usable for requests within the limit
+        write_headers(client, 3, http2::kFlagEndHeaders | http2::kFlagEndStream);
+        const auto [headers3, content3] = read_reply(client, 3);
+        CHECK(header_value(headers3, ":status") != "413");
+    }
+}
+
+} // namespace silkrpc::http
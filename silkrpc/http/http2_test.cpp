@@ -0,0 +1,144 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "http2.hpp"
+
+#include <string>
+
+#include <absl/strings/escaping.h>
+#include <catch2/catch.hpp>
+
+namespace silkrpc::http::http2 {
+
+TEST_CASE("is connection preface", "[silkrpc][http][http2]") {
+    const std::string preface{kConnectionPreface};
+    CHECK(is_connection_preface(preface.data(), preface.data() + preface.size()));
+    CHECK(is_connection_preface(preface.data(), preface.data() + 4));
+    CHECK(!is_connection_preface(preface.data(), preface.data() + 3));
+    const std::string request{"POST / HTTP/1.1\r\n"};
+    CHECK(!is_connection_preface(request.data(), request.data() + request.size()));
+}
+
+TEST_CASE("append frames", "[silkrpc][http][http2]") {
+    std::string out;
+    append_frame(out, data, kFlagEndStream, 3, "{}");
+    CHECK(absl::BytesToHexString(out) == "0000020001000000037b7d");
+
+    out.clear();
+    append_settings(out, {{max_concurrent_streams, 100}});
+    CHECK(absl::BytesToHexString(out) == "000006040000000000000300000064");
+
+    out.clear();
+    append_window_update(out, 0, 1024);
+    CHECK(absl::BytesToHexString(out) == "00000408000000000000000400");
+
+    out.clear();
+    append_rst_stream(out, 5, refused_stream);
+    CHECK(absl::BytesToHexString(out) == "00000403000000000500000007");
+
+    out.clear();
+    append_goaway(out, 7, protocol_error);
+    CHECK(absl::BytesToHexString(out) == "0000080700000000000000000700000001");
+}
+
+TEST_CASE("parse preface and frames", "[silkrpc][http][http2]") {
+    std::string input{kConnectionPreface};
+    append_settings(input, {{initial_window_size, 1 << 20}});
+    append_frame(input, headers, kFlagEndHeaders, 1, "abc");
+    append_frame(input, data, kFlagEndStream, 1, "");
+
+    FrameParser parser;
+    Frame frame;
+    const char* begin = input.data();
+    const char* end = input.data() + input.size();
+
+    SECTION("in one chunk") {
+        auto [result, next] = parser.parse(frame, begin, end);
+        CHECK(result == FrameParser::good);
+        CHECK(frame.type == settings);
+        CHECK(frame.stream_id == 0);
+        CHECK(frame.payload.size() == 6);
+        CHECK(read_uint32(frame.payload.data() + 2) == 1 << 20);
+
+        std::tie(result, next) = parser.parse(frame, next, end);
+        CHECK(result == FrameParser::good);
+        CHECK(frame.type == headers);
+        CHECK(frame.has_flag(kFlagEndHeaders));
+        CHECK(frame.stream_id == 1);
+        CHECK(frame.payload == "abc");
+
+        std::tie(result, next) = parser.parse(frame, next, end);
+        CHECK(result == FrameParser::good);
+        CHECK(frame.type == data);
+        CHECK(frame.has_flag(kFlagEndStream));
+        CHECK(frame.payload.empty());
+        CHECK(next == end);
+    }
+
+    SECTION("byte by byte") {
+        int frames{0};
+        for (const char* p = begin; p != end; ++p) {
+            auto [result, next] = parser.parse(frame, p, p + 1);
+            CHECK(next == p + 1);
+            if (result == FrameParser::good) {
+                ++frames;
+            } else {
+                CHECK(result == FrameParser::indeterminate);
+            }
+        }
+        CHECK(frames == 3);
+        CHECK(frame.type == data);
+    }
+}
+
+TEST_CASE("parse invalid preface", "[silkrpc][http][http2]") {
+    const std::string input{"PRI * HTTP/2.0\r\n\r\nXX\r\n\r\n"};
+    FrameParser parser;
+    Frame frame;
+    auto [result, _] = parser.parse(frame, input.data(), input.data() + input.size());
+    CHECK(result == FrameParser::bad);
+}
+
+TEST_CASE("parse oversized frame", "[silkrpc][http][http2]") {
+    std::string input;
+    append_frame(input, data, 0, 1, std::string(100, 'x'));
+    FrameParser parser{64, false};
+    Frame frame;
+    auto [result, _] = parser.parse(frame, input.data(), input.data() + input.size());
+    CHECK(result == FrameParser::oversized);
+}
+
+TEST_CASE("frame content", "[silkrpc][http][http2]") {
+    Frame frame;
+    absl::string_view content;
+
+    frame.type = headers;
+    frame.flags = kFlagPadded | kFlagPriority;
+    frame.payload = std::string{"\x02"} + std::string{"\x00\x00\x00\x01\x10", 5} + "abc" + std::string(2, '\0');
+    CHECK(frame.content(content));
+    CHECK(content == "abc");
+
+    frame.type = data;
+    frame.flags = kFlagPadded;
+    frame.payload = std::string{"\x05"} + "abc";
+    CHECK(!frame.content(content));
+
+    frame.flags = 0;
+    CHECK(frame.content(content));
+    CHECK(content == "\x05" "abc");
+}
+
+} // namespace silkrpc::http::http2
@@ -0,0 +1,45 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "method_table.hpp"
+
+namespace silkrpc::http {
+
+std::optional<ApiNamespaces> parse_api_namespaces(std::string_view spec) {
+    ApiNamespaces api_namespaces{0};
+    while (!spec.empty()) {
+        const auto separator = spec.find(',');
+        const auto name = spec.substr(0, separator);
+        std::size_t i{0};
+        while (i < kApiNamespaceNames.size() && kApiNamespaceNames[i] != name) {
+            ++i;
+        }
+        if (i == kApiNamespaceNames.size()) {
+            return std::nullopt;
+        }
+        api_namespaces |= api_namespace_bit(static_cast<ApiNamespace>(i));
+        if (separator == std::string_view::npos) {
+            break;
+        }
+        spec.remove_prefix(separator + 1);
+        if (spec.empty()) {
+            return std::nullopt;
+        }
+    }
+    return api_namespaces;
+}
+
+} // namespace silkrpc::http
@@ -0,0 +1,141 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_METHOD_TABLE_HPP_
+#define SILKRPC_HTTP_METHOD_TABLE_HPP_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+namespace silkrpc::http {
+
+/// The namespaces grouping the JSON-RPC methods, named as the prefix of the method names.
+enum class ApiNamespace : uint8_t {
+    web3,
+    net,
+    eth,
+    debug,
+    trace,
+    tg,
+    parity
+};
+
+/// The names of the namespaces indexed by ApiNamespace.
+constexpr std::array<std::string_view, 7> kApiNamespaceNames{"web3", "net", "eth", "debug", "trace", "tg", "parity"};
+
+/// The set of namespaces as bit mask indexed by ApiNamespace.
+using ApiNamespaces = uint32_t;
+
+constexpr ApiNamespaces kAllApiNamespaces{(ApiNamespaces{1} << kApiNamespaceNames.size()) - 1};
+
+constexpr ApiNamespaces api_namespace_bit(ApiNamespace api_namespace) {
+    return ApiNamespaces{1} << static_cast<uint8_t>(api_namespace);
+}
+
+/// Get the namespace of the method from the prefix of its name, if any.
+constexpr std::optional<ApiNamespace> api_namespace_of(std::string_view method_name) {
+    const auto separator = method_name.find('_');
+    if (separator == std::string_view::npos) {
+        return std::nullopt;
+    }
+    const auto prefix = method_name.substr(0, separator);
+    for (std::size_t i{0}; i < kApiNamespaceNames.size(); ++i) {
+        if (kApiNamespaceNames[i] == prefix) {
+            return static_cast<ApiNamespace>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+/// Parse the comma-separated list of namespace names (e.g. "eth,net,web3"), nothing if any of them is unknown.
+std::optional<ApiNamespaces> parse_api_namespaces(std::string_view spec);
+
+/// The seeded FNV-1a hash of the method name.
+constexpr uint64_t method_hash(std::string_view name, uint64_t seed) {
+    uint64_t hash{0xcbf29ce484222325 ^ (seed * 0x9e3779b97f4a7c15)};
+    for (const char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash ^ (hash >> 29);
+}
+
+/// Read-only table of method metadata indexed by a perfect hash of the method names computed at compile time: each lookup
+/// costs one hash and one string comparison, without allocating. The Info type exposes the method name as string_view name.
+template <typename Info, std::size_t N>
+class MethodTable {
+public:
+    /// Sparse enough for a seed without collisions to be found within a few attempts
+    static constexpr std::size_t kNumSlots{std::bit_ceil(N) * 16};
+    static constexpr uint64_t kMaxSeeds{1024};
+
+    static_assert(N > 0 && N < UINT16_MAX, "MethodTable: unsupported number of methods");
+
+    constexpr explicit MethodTable(const std::array<Info, N>& infos) : infos_{infos} {
+        for (seed_ = 0; seed_ < kMaxSeeds; ++seed_) {
+            if (place_all()) {
+                return;
+            }
+        }
+        // Any duplicate name ends up here, failing the constant evaluation of the table
+        throw std::logic_error{"MethodTable: no perfect hash found"};
+    }
+
+    /// Get the metadata of the method, nullptr if unknown.
+    constexpr const Info* find(std::string_view name) const {
+        const auto slot = slots_[method_hash(name, seed_) & (kNumSlots - 1)];
+        if (slot == 0) {
+            return nullptr;
+        }
+        const auto& info = infos_[slot - 1];
+        return info.name == name ? &info : nullptr;
+    }
+
+    constexpr std::size_t size() const { return N; }
+
+    constexpr uint64_t seed() const { return seed_; }
+
+    constexpr const std::array<Info, N>& infos() const { return infos_; }
+
+private:
+    constexpr bool place_all() {
+        slots_.fill(0);
+        for (std::size_t i{0}; i < N; ++i) {
+            auto& slot = slots_[method_hash(infos_[i].name, seed_) & (kNumSlots - 1)];
+            if (slot != 0) {
+                return false;
+            }
+            slot = static_cast<uint16_t>(i + 1);
+        }
+        return true;
+    }
+
+    std::array<Info, N> infos_;
+
+    /// The index of the method in infos_ plus one, zero for the empty slots
+    std::array<uint16_t, kNumSlots> slots_{};
+
+    uint64_t seed_{0};
+};
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_METHOD_TABLE_HPP_
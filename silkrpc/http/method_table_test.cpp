@@ -0,0 +1,81 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "method_table.hpp"
+
+#include <array>
+#include <string_view>
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc {
+
+using Catch::Matchers::Message;
+
+namespace {
+struct TestInfo {
+    std::string_view name;
+    int value;
+};
+
+constexpr http::MethodTable kTestTable{std::to_array<TestInfo>({
+    {"eth_blockNumber", 1},
+    {"eth_getBalance", 2},
+    {"net_version", 3},
+    {"web3_clientVersion", 4},
+})};
+} // namespace
+
+TEST_CASE("MethodTable::find", "[silkrpc][http][method_table]") {
+    static_assert(kTestTable.find("eth_getBalance") != nullptr);
+    static_assert(kTestTable.find("eth_getBalance")->value == 2);
+    static_assert(kTestTable.find("eth_getbalance") == nullptr);
+
+    CHECK(kTestTable.size() == 4);
+    for (const auto& info : kTestTable.infos()) {
+        const auto* found = kTestTable.find(info.name);
+        CHECK(found == &info);
+    }
+    CHECK(kTestTable.find("") == nullptr);
+    CHECK(kTestTable.find("eth_") == nullptr);
+    CHECK(kTestTable.find("eth_blockNumbe") == nullptr);
+    CHECK(kTestTable.find("eth_blockNumberr") == nullptr);
+}
+
+TEST_CASE("api_namespace_of", "[silkrpc][http][method_table]") {
+    CHECK(http::api_namespace_of("eth_call") == http::ApiNamespace::eth);
+    CHECK(http::api_namespace_of("web3_sha3") == http::ApiNamespace::web3);
+    CHECK(http::api_namespace_of("parity_getBlockReceipts") == http::ApiNamespace::parity);
+    CHECK(!http::api_namespace_of("eth"));
+    CHECK(!http::api_namespace_of("admin_peers"));
+    CHECK(!http::api_namespace_of(""));
+}
+
+TEST_CASE("parse_api_namespaces", "[silkrpc][http][method_table]") {
+    using http::ApiNamespace;
+    using http::api_namespace_bit;
+
+    CHECK(http::parse_api_namespaces("eth") == api_namespace_bit(ApiNamespace::eth));
+    CHECK(http::parse_api_namespaces("eth,net,web3") ==
+        (api_namespace_bit(ApiNamespace::eth) | api_namespace_bit(ApiNamespace::net) | api_namespace_bit(ApiNamespace::web3)));
+    CHECK(http::parse_api_namespaces("web3,net,eth,debug,trace,tg,parity") == http::kAllApiNamespaces);
+    CHECK(http::parse_api_namespaces("") == 0);
+    CHECK(!http::parse_api_namespaces("eth,"));
+    CHECK(!http::parse_api_namespaces("eth,admin"));
+    CHECK(!http::parse_api_namespaces("eth net"));
+}
+
+} // namespace silkrpc
@@ -0,0 +1,57 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "read_buffer_pool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace silkrpc::http {
+
+static_assert(ReadBufferPool::kMaxBufferSize == ReadBufferPool::kMinBufferSize << 7);
+
+std::size_t ReadBufferPool::buffer_size(std::size_t size) {
+    return std::bit_ceil(std::clamp(size, kMinBufferSize, kMaxBufferSize));
+}
+
+std::size_t ReadBufferPool::size_class(std::size_t buffer_size) {
+    return std::countr_zero(buffer_size) - std::countr_zero(kMinBufferSize);
+}
+
+std::vector<char> ReadBufferPool::acquire(std::size_t size) {
+    const auto acquired_size = buffer_size(size);
+    auto& free_buffers = free_buffers_[size_class(acquired_size)];
+    if (free_buffers.empty()) {
+        return std::vector<char>(acquired_size);
+    }
+    auto buffer = std::move(free_buffers.back());
+    free_buffers.pop_back();
+    free_bytes_ -= buffer.size();
+    return buffer;
+}
+
+void ReadBufferPool::release(std::vector<char> buffer) {
+    // Just the buffers coming from acquire are kept
+    const auto size = buffer.size();
+    if (size < kMinBufferSize || size > kMaxBufferSize || !std::has_single_bit(size) || free_bytes_ + size > max_free_bytes_) {
+        return;
+    }
+    free_buffers_[size_class(size)].push_back(std::move(buffer));
+    free_bytes_ += size;
+}
+
+} // namespace silkrpc::http
@@ -0,0 +1,63 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_READ_BUFFER_POOL_HPP_
+#define SILKRPC_HTTP_READ_BUFFER_POOL_HPP_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace silkrpc::http {
+
+/// Free lists of read buffers having power-of-two sizes, owned by one context so that it is never accessed
+/// concurrently. The connections take buffers as large as the content they are receiving and give them back
+/// when idle, so that just the busy connections hold large buffers.
+class ReadBufferPool {
+public:
+    static constexpr std::size_t kMinBufferSize{8 * 1024};
+    static constexpr std::size_t kMaxBufferSize{1024 * 1024};
+    static constexpr std::size_t kDefaultMaxFreeBytes{16 * 1024 * 1024};
+
+    explicit ReadBufferPool(std::size_t max_free_bytes = kDefaultMaxFreeBytes) : max_free_bytes_{max_free_bytes} {}
+
+    ReadBufferPool(const ReadBufferPool&) = delete;
+    ReadBufferPool& operator=(const ReadBufferPool&) = delete;
+
+    /// Get a buffer at least as large as the given size rounded up to a power of two, within the size limits.
+    std::vector<char> acquire(std::size_t size);
+
+    /// Give back the buffer to the free list, the buffer is deallocated if the free lists are full.
+    void release(std::vector<char> buffer);
+
+    std::size_t free_bytes() const { return free_bytes_; }
+
+    /// Get the size of the buffers returned by acquire for the given size.
+    static std::size_t buffer_size(std::size_t size);
+
+private:
+    static constexpr std::size_t kNumSizeClasses{8};  // from kMinBufferSize to kMaxBufferSize
+
+    static std::size_t size_class(std::size_t buffer_size);
+
+    std::size_t max_free_bytes_;
+    std::size_t free_bytes_{0};
+    std::array<std::vector<std::vector<char>>, kNumSizeClasses> free_buffers_;
+};
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_READ_BUFFER_POOL_HPP_
@@ -0,0 +1,70 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "read_buffer_pool.hpp"
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc::http {
+
+TEST_CASE("ReadBufferPool::buffer_size", "[silkrpc][http][read_buffer_pool]") {
+    CHECK(ReadBufferPool::buffer_size(0) == ReadBufferPool::kMinBufferSize);
+    CHECK(ReadBufferPool::buffer_size(ReadBufferPool::kMinBufferSize) == ReadBufferPool::kMinBufferSize);
+    CHECK(ReadBufferPool::buffer_size(ReadBufferPool::kMinBufferSize + 1) == 2 * ReadBufferPool::kMinBufferSize);
+    CHECK(ReadBufferPool::buffer_size(100 * 1024) == 128 * 1024);
+    CHECK(ReadBufferPool::buffer_size(ReadBufferPool::kMaxBufferSize * 4) == ReadBufferPool::kMaxBufferSize);
+}
+
+TEST_CASE("ReadBufferPool::acquire and release", "[silkrpc][http][read_buffer_pool]") {
+    ReadBufferPool pool;
+
+    auto buffer = pool.acquire(20000);
+    CHECK(buffer.size() == 32 * 1024);
+    const auto* data = buffer.data();
+    pool.release(std::move(buffer));
+    CHECK(pool.free_bytes() == 32 * 1024);
+
+    SECTION("same size class is recycled") {
+        auto recycled = pool.acquire(30000);
+        CHECK(recycled.data() == data);
+        CHECK(pool.free_bytes() == 0);
+    }
+
+    SECTION("other size class is allocated") {
+        auto other = pool.acquire(1);
+        CHECK(other.size() == ReadBufferPool::kMinBufferSize);
+        CHECK(pool.free_bytes() == 32 * 1024);
+    }
+
+    SECTION("foreign buffers are dropped") {
+        pool.release(std::vector<char>(10000));
+        pool.release(std::vector<char>{});
+        CHECK(pool.free_bytes() == 32 * 1024);
+    }
+}
+
+TEST_CASE("ReadBufferPool bounded free bytes", "[silkrpc][http][read_buffer_pool]") {
+    ReadBufferPool pool{ReadBufferPool::kMinBufferSize};
+    auto buffer1 = pool.acquire(1);
+    auto buffer2 = pool.acquire(1);
+    pool.release(std::move(buffer1));
+    pool.release(std::move(buffer2));
+    CHECK(pool.free_bytes() == ReadBufferPool::kMinBufferSize);
+}
+
+} // namespace silkrpc::http
@@ -8,6 +8,7 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 
+#include <charconv>
 #include <string>
 
 #include <silkrpc/common/log.hpp>
@@ -19,22 +20,23 @@ namespace silkrpc::http {
 
 namespace status_strings {
 
-const std::string ok = "HTTP/1.0 200 OK\r\n";                                       // NOLINT(runtime/string)
-const std::string created = "HTTP/1.0 201 Created\r\n";                             // NOLINT(runtime/string)
-const std::string accepted = "HTTP/1.0 202 Accepted\r\n";                           // NOLINT(runtime/string)
-const std::string no_content = "HTTP/1.0 204 No Content\r\n";                       // NOLINT(runtime/string)
-const std::string multiple_choices = "HTTP/1.0 300 Multiple Choices\r\n";           // NOLINT(runtime/string)
-const std::string moved_permanently = "HTTP/1.0 301 Moved Permanently\r\n";         // NOLINT(runtime/string)
-const std::string moved_temporarily = "HTTP/1.0 302 Moved Temporarily\r\n";         // NOLINT(runtime/string)
-const std::string not_modified = "HTTP/1.0 304 Not Modified\r\n";                   // NOLINT(runtime/string)
-const std::string bad_request = "HTTP/1.0 400 Bad Request\r\n";                     // NOLINT(runtime/string)
-const std::string unauthorized = "HTTP/1.0 401 Unauthorized\r\n";                   // NOLINT(runtime/string)
-const std::string forbidden = "HTTP/1.0 403 Forbidden\r\n";                         // NOLINT(runtime/string)
-const std::string not_found = "HTTP/1.0 404 Not Found\r\n";                         // NOLINT(runtime/string)
-const std::string internal_server_error = "HTTP/1.0 500 Internal Server Error\r\n"; // NOLINT(runtime/string)
-const std::string not_implemented = "HTTP/1.0 501 Not Implemented\r\n";             // NOLINT(runtime/string)
-const std::string bad_gateway = "HTTP/1.0 502 Bad Gateway\r\n";                     // NOLINT(runtime/string)
-const std::string service_unavailable = "HTTP/1.0 503 Service Unavailable\r\n";     // NOLINT(runtime/string)
+const std::string ok = "HTTP/1.1 200 OK\r\n";                                       // NOLINT(runtime/string)
+const std::string created = "HTTP/1.1 201 Created\r\n";                             // NOLINT(runtime/string)
+const std::string accepted = "HTTP/1.1 202 Accepted\r\n";                           // NOLINT(runtime/string)
+const std::string no_content = "HTTP/1.1 204 No Content\r\n";                       // NOLINT(runtime/string)
+const std::string multiple_choices = "HTTP/1.1 300 Multiple Choices\r\n";           // NOLINT(runtime/string)
+const std::string moved_permanently = "HTTP/1.1 301 Moved Permanently\r\n";         // NOLINT(runtime/string)
+const std::string moved_temporarily = "HTTP/1.1 302 Moved Temporarily\r\n";         // NOLINT(runtime/string)
+const std::string not_modified = "HTTP/1.1 304 Not Modified\r\n";                   // NOLINT(runtime/string)
+const std::string bad_request = "HTTP/1.1 400 Bad Request\r\n";                     // NOLINT(runtime/string)
+const std::string unauthorized = "HTTP/1.1 401 Unauthorized\r\n";                   // NOLINT(runtime/string)
+const std::string forbidden = "HTTP/1.1 403 Forbidden\r\n";                         // NOLINT(runtime/string)
+const std::string not_found = "HTTP/1.1 404 Not Found\r\n";                         // NOLINT(runtime/string)
+const std::string payload_too_large = "HTTP/1.1 413 Payload Too Large\r\n";         // NOLINT(runtime/string)
+const std::string internal_server_error = "HTTP/1.1 500 Internal Server Error\r\n"; // NOLINT(runtime/string)
+const std::string not_implemented = "HTTP/1.1 501 Not Implemented\r\n";             // NOLINT(runtime/string)
+const std::string bad_gateway = "HTTP/1.1 502 Bad Gateway\r\n";                     // NOLINT(runtime/string)
+const std::string service_unavailable = "HTTP/1.1 503 Service Unavailable\r\n";     // NOLINT(runtime/string)
 
 asio::const_buffer to_buffer(Reply::StatusType status) {
     switch (status) {
@@ -62,6 +64,8 @@ asio::const_buffer to_buffer(Reply::StatusType status) {
             return asio::buffer(forbidden);
         case Reply::not_found:
             return asio::buffer(not_found);
+        case Reply::payload_too_large:
+            return asio::buffer(payload_too_large);
         case Reply::internal_server_error:
             return asio::buffer(internal_server_error);
         case Reply::not_implemented:
@@ -85,9 +89,59 @@ const char lf[] = { '\n' };
 
 } // namespace misc_strings
 
+namespace header_fragments {
+
+const char content_type_json[] = "Content-Type: application/json\r\n";
+const char content_type_html[] = "Content-Type: text/html\r\n";
+const char content_length[] = "Content-Length: ";
+const char transfer_encoding_chunked[] = "Transfer-Encoding: chunked\r\n";
+
+asio::const_buffer to_buffer(Reply::ContentType content_type) {
+    switch (content_type) {
+        case Reply::text_html:
+            return asio::buffer(content_type_html, sizeof(content_type_html) - 1);
+        case Reply::application_json:
+        default:
+            return asio::buffer(content_type_json, sizeof(content_type_json) - 1);
+    }
+}
+
+} // namespace header_fragments
+
 std::vector<asio::const_buffer> Reply::to_buffers() {
     std::vector<asio::const_buffer> buffers;
+    append_to(buffers);
+    return buffers;
+}
+
+void Reply::append_to(std::vector<asio::const_buffer>& buffers) {
+    const auto content_size = content.size() + body.size();
+
+    // The chunk size is in hex, the last chunk (i.e. size 0) is followed by the empty trailer [RFC 7230 4.1]
+    if (framing == chunk) {
+        const auto digits_end = std::to_chars(content_length_digits_.data(), content_length_digits_.data() + content_length_digits_.size(), content_size, 16).ptr;
+        buffers.reserve(buffers.size() + 4 + body.size() / ChunkPool::kChunkSize + 1);
+        buffers.push_back(asio::buffer(content_length_digits_.data(), digits_end - content_length_digits_.data()));
+        buffers.push_back(asio::buffer(misc_strings::crlf));
+        if (!content.empty()) {
+            buffers.push_back(asio::buffer(content));
+        }
+        body.append_to(buffers);
+        buffers.push_back(asio::buffer(misc_strings::crlf));
+        return;
+    }
+
+    buffers.reserve(buffers.size() + headers.size() * 4 + 8 + body.size() / ChunkPool::kChunkSize + 1);
     buffers.push_back(status_strings::to_buffer(status));
+    buffers.push_back(header_fragments::to_buffer(content_type));
+    if (framing == chunked_head) {
+        buffers.push_back(asio::buffer(header_fragments::transfer_encoding_chunked, sizeof(header_fragments::transfer_encoding_chunked) - 1));
+    } else {
+        const auto digits_end = std::to_chars(content_length_digits_.data(), content_length_digits_.data() + content_length_digits_.size(), content_size).ptr;
+        buffers.push_back(asio::buffer(header_fragments::content_length, sizeof(header_fragments::content_length) - 1));
+        buffers.push_back(asio::buffer(content_length_digits_.data(), digits_end - content_length_digits_.data()));
+        buffers.push_back(asio::buffer(misc_strings::crlf));
+    }
     for (std::size_t i = 0; i < headers.size(); ++i) {
         Header& h = headers[i];
         buffers.push_back(asio::buffer(h.name));
@@ -96,9 +150,13 @@ std::vector<asio::const_buffer> Reply::to_buffers() {
         buffers.push_back(asio::buffer(misc_strings::crlf));
     }
     buffers.push_back(asio::buffer(misc_strings::crlf));
-    buffers.push_back(asio::buffer(content));
-    SILKRPC_TRACE << "Reply::to_buffers buffers: " << buffers << "\n";
-    return buffers;
+    if (framing == whole) {
+        if (!content.empty()) {
+            buffers.push_back(asio::buffer(content));
+        }
+        body.append_to(buffers);
+    }
+    SILKRPC_TRACE << "Reply::append_to buffers: " << buffers << "\n";
 }
 
 namespace stock_replies {
@@ -159,6 +217,11 @@ const char not_found[] =
     "<head><title>Not Found</title></head>"
     "<body><h1>404 Not Found</h1></body>"
     "</html>";
+const char payload_too_large[] =
+    "<html>"
+    "<head><title>Payload Too Large</title></head>"
+    "<body><h1>413 Payload Too Large</h1></body>"
+    "</html>";
 const char internal_server_error[] =
     "<html>"
     "<head><title>Internal Server Error</title></head>"
@@ -206,6 +269,8 @@ std::string to_string(Reply::StatusType status) {
             return forbidden;
         case Reply::not_found:
             return not_found;
+        case Reply::payload_too_large:
+            return payload_too_large;
         case Reply::internal_server_error:
             return internal_server_error;
         case Reply::not_implemented:
@@ -224,10 +289,8 @@ std::string to_string(Reply::StatusType status) {
 Reply Reply::stock_reply(Reply::StatusType status) {
     Reply rep;
     rep.status = status;
+    rep.content_type = Reply::text_html;
     rep.content = stock_replies::to_string(status);
-    rep.headers.reserve(2);
-    rep.headers.emplace_back(Header{"Content-Length", std::to_string(rep.content.size())});
-    rep.headers.emplace_back(Header{"Content-Type", "text/html"});
     return rep;
 }
 
@@ -11,10 +11,12 @@
 #ifndef SILKRPC_HTTP_REPLY_HPP_
 #define SILKRPC_HTTP_REPLY_HPP_
 
+#include <array>
 #include <string>
 #include <vector>
 #include <asio/buffer.hpp>
 
+#include "chunk_buffer.hpp"
 #include "header.hpp"
 
 namespace silkrpc::http {
@@ -35,25 +37,50 @@ struct Reply {
         unauthorized = 401,
         forbidden = 403,
         not_found = 404,
+        payload_too_large = 413,
         internal_server_error = 500,
         not_implemented = 501,
         bad_gateway = 502,
         service_unavailable = 503
     } status;
 
-    /// The headers to be included in the reply.
+    /// The type of the content, rendered together with the content length from pre-rendered header fragments.
+    enum ContentType {
+        application_json,
+        text_html
+    } content_type{application_json};
+
+    /// The framing of the reply: whole content sized by Content-Length or, using chunked transfer coding, the head
+    /// followed by the content chunks. A chunk with empty content is the last one, which terminates the reply.
+    enum Framing {
+        whole,
+        chunked_head,
+        chunk
+    } framing{whole};
+
+    /// The additional headers to be included in the reply.
     std::vector<Header> headers;
 
     /// The content to be sent in the reply.
     std::string content;
 
+    /// The content serialized directly into pooled chunks, sent after content.
+    ChunkBuffer body;
+
     /// Convert the reply into a vector of buffers. The buffers do not own the
     /// underlying memory blocks, therefore the reply object must remain valid and
     /// not be changed until the write operation has completed.
     std::vector<asio::const_buffer> to_buffers();
 
+    /// Add the reply buffers to the given gather list, with the same validity constraints as to_buffers.
+    void append_to(std::vector<asio::const_buffer>& buffers);
+
     /// Get a stock reply.
     static Reply stock_reply(StatusType status);
+
+private:
+    /// The digits of the Content-Length header value.
+    std::array<char, 20> content_length_digits_;
 };
 
 } // namespace silkrpc::http
@@ -16,11 +16,78 @@
 
 #include "reply.hpp"
 
+#include <string>
+#include <vector>
+
 #include <catch2/catch.hpp>
 
 namespace silkrpc {
 
 using Catch::Matchers::Message;
 
+static std::string to_string(const std::vector<asio::const_buffer>& buffers) {
+    std::string data;
+    for (const auto& buffer : buffers) {
+        data.append(static_cast<const char*>(buffer.data()), buffer.size());
+    }
+    return data;
+}
+
+TEST_CASE("stock reply to buffers", "[silkrpc][http][reply]") {
+    auto reply = http::Reply::stock_reply(http::Reply::bad_request);
+    const auto data = to_string(reply.to_buffers());
+    CHECK(data.rfind("HTTP/1.1 400 Bad Request\r\nContent-Type: text/html\r\nContent-Length: " + std::to_string(reply.content.size()) + "\r\n\r\n", 0) == 0);
+    CHECK(data.size() > reply.content.size());
+    CHECK(data.substr(data.size() - reply.content.size()) == reply.content);
+}
+
+TEST_CASE("payload too large stock reply to buffers", "[silkrpc][http][reply]") {
+    auto reply = http::Reply::stock_reply(http::Reply::payload_too_large);
+    const auto data = to_string(reply.to_buffers());
+    CHECK(data.rfind("HTTP/1.1 413 Payload Too Large\r\n", 0) == 0);
+    CHECK(reply.content.find("413 Payload Too Large") != std::string::npos);
+}
+
+TEST_CASE("JSON reply to buffers", "[silkrpc][http][reply]") {
+    http::ChunkPool pool;
+    http::Reply reply;
+    reply.status = http::Reply::ok;
+    reply.body = http::ChunkBuffer{&pool};
+    reply.body.append_json(R"({"jsonrpc":"2.0","id":1,"result":"0x1"})"_json);
+    reply.body.append('\n');
+    reply.headers.emplace_back(http::Header{"Connection", "close"});
+    CHECK(to_string(reply.to_buffers()) ==
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: 40\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        "{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":\"0x1\"}\n");
+}
+
+TEST_CASE("chunked reply to buffers", "[silkrpc][http][reply]") {
+    http::ChunkPool pool;
+    http::Reply head;
+    head.status = http::Reply::ok;
+    head.framing = http::Reply::chunked_head;
+    head.content = "ignored";
+    CHECK(to_string(head.to_buffers()) ==
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n");
+
+    http::Reply chunk;
+    chunk.framing = http::Reply::chunk;
+    chunk.content = "{\"id\":1,";
+    chunk.body = http::ChunkBuffer{&pool};
+    chunk.body.append(std::string(24, 'x').data(), 24);
+    CHECK(to_string(chunk.to_buffers()) == "20\r\n{\"id\":1," + std::string(24, 'x') + "\r\n");
+
+    http::Reply last_chunk;
+    last_chunk.framing = http::Reply::chunk;
+    CHECK(to_string(last_chunk.to_buffers()) == "0\r\n\r\n");
+}
+
 } // namespace silkrpc
 
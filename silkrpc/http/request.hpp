@@ -26,6 +26,9 @@
 #include <string>
 #include <vector>
 
+#include <absl/strings/match.h>
+#include <absl/strings/string_view.h>
+
 #include "header.hpp"
 
 namespace silkrpc::http {
@@ -39,6 +42,41 @@ struct Request {
     std::vector<Header> headers;
     uint32_t content_length{0};
     std::string content;
+
+    /// Clear all the fields keeping the allocated capacity, so that the request can be reused on a persistent connection.
+    void reset() {
+        method.clear();
+        uri.clear();
+        http_version_major = 0;
+        http_version_minor = 0;
+        headers.clear();
+        content_length = 0;
+        content.clear();
+    }
+
+    /// Get the value of the named header (case-insensitive), empty if not present.
+    absl::string_view header_value(absl::string_view name) const {
+        for (const auto& header : headers) {
+            if (absl::EqualsIgnoreCase(header.name, name)) {
+                return header.value;
+            }
+        }
+        return {};
+    }
+
+    /// Check if the connection must be kept open after the reply: HTTP/1.1 default is persistent unless
+    /// "Connection: close" is present, HTTP/1.0 default is non-persistent unless "Connection: keep-alive" is present.
+    bool keep_alive() const {
+        for (const auto& header : headers) {
+            if (absl::EqualsIgnoreCase(header.name, "Connection")) {
+                if (http_version_major == 1 && http_version_minor == 0) {
+                    return absl::EqualsIgnoreCase(header.value, "keep-alive");
+                }
+                return !absl::EqualsIgnoreCase(header.value, "close");
+            }
+        }
+        return http_version_major > 1 || (http_version_major == 1 && http_version_minor >= 1);
+    }
 };
 
 } // namespace silkrpc::http
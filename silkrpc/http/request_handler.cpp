@@ -22,7 +22,19 @@
 
 #include "request_handler.hpp"
 
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <asio/co_spawn.hpp>
+#include <asio/redirect_error.hpp>
+#include <asio/steady_timer.hpp>
+#include <asio/this_coro.hpp>
+#include <asio/use_awaitable.hpp>
 
 #include "methods.hpp"
 #include "mime_types.hpp"
@@ -31,141 +43,351 @@
 
 #include <silkrpc/common/clock_time.hpp>
 #include <silkrpc/common/log.hpp>
+#include <silkrpc/ethdb/shared_database.hpp>
+#include <silkrpc/json/request_view.hpp>
+#include <silkrpc/types/error.hpp>
 
 namespace silkrpc::http {
 
-std::map<std::string, RequestHandler::HandleMethod> RequestHandler::handlers_ = {
-    {method::k_web3_clientVersion, &commands::RpcApi::handle_web3_client_version},
-    {method::k_web3_sha3, &commands::RpcApi::handle_web3_sha3},
-    {method::k_net_listening, &commands::RpcApi::handle_net_listening},
-    {method::k_net_peerCount, &commands::RpcApi::handle_net_peer_count},
-    {method::k_net_version, &commands::RpcApi::handle_net_version},
-    {method::k_eth_blockNumber, &commands::RpcApi::handle_eth_block_number},
-    {method::k_eth_chainId, &commands::RpcApi::handle_eth_chain_id},
-    {method::k_eth_protocolVersion, &commands::RpcApi::handle_eth_protocol_version},
-    {method::k_eth_syncing, &commands::RpcApi::handle_eth_syncing},
-    {method::k_eth_gasPrice, &commands::RpcApi::handle_eth_gas_price},
-    {method::k_eth_getBlockByHash, &commands::RpcApi::handle_eth_get_block_by_hash},
-    {method::k_eth_getBlockByNumber, &commands::RpcApi::handle_eth_get_block_by_number},
-    {method::k_eth_getBlockTransactionCountByHash, &commands::RpcApi::handle_eth_get_block_transaction_count_by_hash},
-    {method::k_eth_getBlockTransactionCountByNumber, &commands::RpcApi::handle_eth_get_block_transaction_count_by_number},
-    {method::k_eth_getUncleByBlockHashAndIndex, &commands::RpcApi::handle_eth_get_uncle_by_block_hash_and_index},
-    {method::k_eth_getUncleByBlockNumberAndIndex, &commands::RpcApi::handle_eth_get_uncle_by_block_number_and_index},
-    {method::k_eth_getUncleCountByBlockHash, &commands::RpcApi::handle_eth_get_uncle_count_by_block_hash},
-    {method::k_eth_getUncleCountByBlockNumber, &commands::RpcApi::handle_eth_get_uncle_count_by_block_number},
-    {method::k_eth_getTransactionByHash, &commands::RpcApi::handle_eth_get_transaction_by_hash},
-    {method::k_eth_getTransactionByBlockHashAndIndex, &commands::RpcApi::handle_eth_get_transaction_by_block_hash_and_index},
-    {method::k_eth_getTransactionByBlockNumberAndIndex, &commands::RpcApi::handle_eth_get_transaction_by_block_number_and_index},
-    {method::k_eth_getTransactionReceipt, &commands::RpcApi::handle_eth_get_transaction_receipt},
-    {method::k_eth_estimateGas, &commands::RpcApi::handle_eth_estimate_gas},
-    {method::k_eth_getBalance, &commands::RpcApi::handle_eth_get_balance},
-    {method::k_eth_getCode, &commands::RpcApi::handle_eth_get_code},
-    {method::k_eth_getTransactionCount, &commands::RpcApi::handle_eth_get_transaction_count},
-    {method::k_eth_getStorageAt, &commands::RpcApi::handle_eth_get_storage_at},
-    {method::k_eth_call, &commands::RpcApi::handle_eth_call},
-    {method::k_eth_newFilter, &commands::RpcApi::handle_eth_new_filter},
-    {method::k_eth_newBlockFilter, &commands::RpcApi::handle_eth_new_block_filter},
-    {method::k_eth_newPendingTransactionFilter, &commands::RpcApi::handle_eth_new_pending_transaction_filter},
-    {method::k_eth_getFilterChanges, &commands::RpcApi::handle_eth_get_filter_changes},
-    {method::k_eth_uninstallFilter, &commands::RpcApi::handle_eth_uninstall_filter},
-    {method::k_eth_getLogs, &commands::RpcApi::handle_eth_get_logs},
-    {method::k_eth_sendRawTransaction, &commands::RpcApi::handle_eth_send_raw_transaction},
-    {method::k_eth_sendTransaction, &commands::RpcApi::handle_eth_send_transaction},
-    {method::k_eth_signTransaction, &commands::RpcApi::handle_eth_sign_transaction},
-    {method::k_eth_getProof, &commands::RpcApi::handle_eth_get_proof},
-    {method::k_eth_mining, &commands::RpcApi::handle_eth_mining},
-    {method::k_eth_coinbase, &commands::RpcApi::handle_eth_coinbase},
-    {method::k_eth_hashrate, &commands::RpcApi::handle_eth_hashrate},
-    {method::k_eth_submitHashrate, &commands::RpcApi::handle_eth_submit_hashrate},
-    {method::k_eth_getWork, &commands::RpcApi::handle_eth_get_work},
-    {method::k_eth_submitWork, &commands::RpcApi::handle_eth_submit_work},
-    {method::k_eth_subscribe, &commands::RpcApi::handle_eth_subscribe},
-    {method::k_eth_unsubscribe, &commands::RpcApi::handle_eth_unsubscribe},
-    {method::k_eth_getBlockReceipts, &commands::RpcApi::handle_parity_get_block_receipts},
-    {method::k_debug_accountRange, &commands::RpcApi::handle_debug_account_range},
-    {method::k_debug_getModifiedAccountsByNumber, &commands::RpcApi::handle_debug_get_modified_accounts_by_number},
-    {method::k_debug_getModifiedAccountsByHash, &commands::RpcApi::handle_debug_get_modified_accounts_by_hash},
-    {method::k_debug_storageRangeAt, &commands::RpcApi::handle_debug_storage_range_at},
-    {method::k_debug_traceTransaction, &commands::RpcApi::handle_debug_trace_transaction},
-    {method::k_debug_traceCall, &commands::RpcApi::handle_debug_trace_call},
-    {method::k_trace_call, &commands::RpcApi::handle_trace_call},
-    {method::k_trace_callMany, &commands::RpcApi::handle_trace_call_many},
-    {method::k_trace_rawTransaction, &commands::RpcApi::handle_trace_raw_transaction},
-    {method::k_trace_replayBlockTransactions, &commands::RpcApi::handle_trace_replay_block_transactions},
-    {method::k_trace_replayTransaction, &commands::RpcApi::handle_trace_replay_transaction},
-    {method::k_trace_block, &commands::RpcApi::handle_trace_block},
-    {method::k_trace_filter, &commands::RpcApi::handle_trace_filter},
-    {method::k_trace_get, &commands::RpcApi::handle_trace_get},
-    {method::k_trace_transaction, &commands::RpcApi::handle_trace_transaction},
-    {method::k_tg_getHeaderByHash, &commands::RpcApi::handle_tg_get_header_by_hash},
-    {method::k_tg_getHeaderByNumber, &commands::RpcApi::handle_tg_get_header_by_number},
-    {method::k_tg_getLogsByHash, &commands::RpcApi::handle_tg_get_logs_by_hash},
-    {method::k_tg_forks, &commands::RpcApi::handle_tg_forks},
-    {method::k_tg_issuance, &commands::RpcApi::handle_tg_issuance},
-    {method::k_parity_getBlockReceipts, &commands::RpcApi::handle_parity_get_block_receipts},
-};
-
-asio::awaitable<void> RequestHandler::handle_request(const Request& request, Reply& reply) {
+// The id of the single request if it is an unsigned integer, zero otherwise (e.g. for a batch)
+static uint32_t id_of(const nlohmann::json& request_json) {
+    if (!request_json.is_object()) {
+        return 0;
+    }
+    const auto id_it = request_json.find("id");
+    return id_it != request_json.end() && id_it->is_number_unsigned() ? id_it->get<uint32_t>() : 0;
+}
+
+asio::awaitable<void> RequestHandler::handle_request(const Request& request, Reply& reply, StreamWriter* writer) {
     SILKRPC_DEBUG << "handle_request content: " << request.content << "\n";
     auto start = clock_time::now();
 
-    auto request_id{0};
     try {
         if (request.content.empty()) {
             reply.content = "";
             reply.status = Reply::no_content;
-            reply.headers.reserve(2);
-            reply.headers.emplace_back(Header{"Content-Length", std::to_string(reply.content.size())});
-            reply.headers.emplace_back(Header{"Content-Type", "application/json"});
-            SILKRPC_INFO << "handle_request t=" << clock_time::since(start) << "ns\n";
-            co_return;
+        } else {
+            // A single request is read in place just if that may spare its DOM, i.e. if it may join an identical call in flight
+            // or be shed when overloaded; then the DOM is built just to execute it. Otherwise the request is parsed only once
+            const bool read_in_place = single_flight_ != nullptr || (admission_control_ != nullptr && admission_control_->may_shed());
+            const auto request_view = read_in_place ? json::RequestView::parse(request.content) : std::nullopt;
+            nlohmann::json request_json;
+            if (!request_view) {
+                request_json = nlohmann::json::parse(request.content);
+            }
+            const auto* method_info = request_view ? find_method(request_view->method()) : nullptr;
+            // The identical calls in flight are joined without admission, adding no load
+            const bool coalescable = single_flight_ != nullptr && request_view && is_coalescable(*request_view);
+            const auto flight_key = coalescable ? SingleFlight::key_of(request_view->method(), request_view->params()) : std::string{};
+            const bool joining = coalescable && single_flight_->contains(flight_key);
+            // The batch entries are admitted one by one, so that a batch weighs as much as the same calls sent apart
+            const bool batch = !request_view && request_json.is_array();
+            // Shed the request instead of queueing it without bounds when overloaded
+            const auto cost_class = request_view ? cost_class_of(*request_view) : cost_class_of(request_json);
+            if (request_view && request_view->id() && (method_info == nullptr || !is_enabled(*method_info))) {
+                reply.content = make_json_error(*request_view->id(), -32601, "method not existent or not implemented").dump() + "\n";
+                reply.status = Reply::not_implemented;
+            } else if (!joining && !batch && admission_control_ != nullptr && !co_await admission_control_->acquire(cost_class)) {
+                const auto request_id = request_view ? request_view->id().value_or(0) : id_of(request_json);
+                reply.content = make_json_error(request_id, -32005, "server overloaded, retry later").dump() + "\n";
+                reply.status = Reply::service_unavailable;
+                reply.headers.emplace_back(Header{"Retry-After", std::to_string(retry_after_.count())});
+            } else {
+                AdmissionSlot admission_slot{joining || batch ? nullptr : admission_control_, cost_class};
+                if (coalescable) {
+                    const auto stream_method = writer != nullptr ? method_info->stream_method : nullptr;
+                    bool streamed{false};
+                    const auto result = co_await single_flight_->run(flight_key, [&](const SingleFlight::Unshare& unshare) -> asio::awaitable<SingleFlight::Result> {
+                        // A joining call is executed just if the result has not been shared, so it is admitted as any other
+                        std::optional<AdmissionSlot> unshared_slot;
+                        if (joining && admission_control_ != nullptr) {
+                            if (!co_await admission_control_->acquire(cost_class)) {
+                                auto error_json = make_json_error(0, -32005, "server overloaded, retry later");
+                                error_json.erase("id");
+                                co_return SingleFlight::Result{Reply::service_unavailable, error_json.dump()};
+                            }
+                            unshared_slot.emplace(admission_control_, cost_class);
+                        }
+                        request_json = nlohmann::json::parse(request.content);
+                        if (stream_method != nullptr) {
+                            // The executing call streams its own reply, the joining ones get the recorded content if not too large
+                            streamed = true;
+                            if (!unshare) {
+                                co_await (rpc_api_.*stream_method)(request_json, *writer);
+                                co_return SingleFlight::Result{Reply::ok, "{}"};
+                            }
+                            RecordingStreamWriter recording_writer{*writer, unshare};
+                            co_await (rpc_api_.*stream_method)(request_json, recording_writer);
+                            co_return recording_writer.result(*request_view->id());
+                        }
+                        nlohmann::json reply_json;
+                        const auto status = co_await handle_request(rpc_api_, request_json, reply_json);
+                        reply_json.erase("id");
+                        co_return SingleFlight::Result{status, reply_json.dump()};
+                    });
+                    if (streamed) {
+                        reply.status = Reply::ok;
+                    } else {
+                        reply.content = SingleFlight::make_reply(*request_view->id(), *result) + "\n";
+                        reply.status = result->status;
+                        if (reply.status == Reply::service_unavailable) {
+                            reply.headers.emplace_back(Header{"Retry-After", std::to_string(retry_after_.count())});
+                        }
+                    }
+                } else {
+                    if (request_view) {
+                        request_json = nlohmann::json::parse(request.content);
+                    }
+                    if (request_json.is_array()) {
+                        reply.status = co_await handle_batch_request(request_json, reply.body);
+                    } else if (const auto stream_method = find_stream_method(request_json); writer != nullptr && stream_method != nullptr) {
+                        co_await (rpc_api_.*stream_method)(request_json, *writer);
+                        reply.status = Reply::ok;
+                    } else {
+                        nlohmann::json reply_json;
+                        reply.status = co_await handle_request(rpc_api_, request_json, reply_json);
+                        reply.body.append_json(reply_json);
+                        reply.body.append('\n');
+                    }
+                }
+            }
         }
+    } catch (const std::exception& e) {
+        SILKRPC_ERROR << "exception: " << e.what() << "\n";
+        reply.body.clear();
+        reply.content = make_json_error(0, 100, e.what()).dump() + "\n";
+        reply.status = Reply::internal_server_error;
+    } catch (...) {
+        SILKRPC_ERROR << "unexpected exception\n";
+        reply.body.clear();
+        reply.content = make_json_error(0, 100, "unexpected exception").dump() + "\n";
+        reply.status = Reply::internal_server_error;
+    }
+    reply.content_type = Reply::application_json;
+
+    SILKRPC_INFO << "handle_request t=" << clock_time::since(start) << "ns\n";
+    co_return;
+}
+
+const RequestHandler::MethodInfo* RequestHandler::find_method(std::string_view method_name) {
+    // The methods not listed here are unknown, the cost class of each one is the amount of work needed to serve it
+    static constexpr MethodTable kMethods{std::to_array<MethodInfo>({
+        {method::k_web3_clientVersion, &commands::RpcApi::handle_web3_client_version, CostClass::cheap, kBackend},
+        {method::k_web3_sha3, &commands::RpcApi::handle_web3_sha3, CostClass::cheap},
+        {method::k_net_listening, &commands::RpcApi::handle_net_listening, CostClass::cheap},
+        {method::k_net_peerCount, &commands::RpcApi::handle_net_peer_count, CostClass::cheap},
+        {method::k_net_version, &commands::RpcApi::handle_net_version, CostClass::cheap, kBackend},
+        {method::k_eth_blockNumber, &commands::RpcApi::handle_eth_block_number, CostClass::cheap, kCoalesced},
+        {method::k_eth_chainId, &commands::RpcApi::handle_eth_chain_id, CostClass::cheap},
+        {method::k_eth_protocolVersion, &commands::RpcApi::handle_eth_protocol_version, CostClass::cheap, kBackend},
+        {method::k_eth_syncing, &commands::RpcApi::handle_eth_syncing, CostClass::cheap},
+        {method::k_eth_gasPrice, &commands::RpcApi::handle_eth_gas_price, CostClass::standard, kCoalesced},
+        {method::k_eth_getBlockByHash, &commands::RpcApi::handle_eth_get_block_by_hash, CostClass::standard, kCoalesced, &commands::RpcApi::handle_eth_get_block_by_hash_stream},
+        {method::k_eth_getBlockByNumber, &commands::RpcApi::handle_eth_get_block_by_number, CostClass::standard, kCoalesced, &commands::RpcApi::handle_eth_get_block_by_number_stream},
+        {method::k_eth_getBlockTransactionCountByHash, &commands::RpcApi::handle_eth_get_block_transaction_count_by_hash, CostClass::standard, kCoalesced},
+        {method::k_eth_getBlockTransactionCountByNumber, &commands::RpcApi::handle_eth_get_block_transaction_count_by_number, CostClass::standard, kCoalesced},
+        {method::k_eth_getUncleByBlockHashAndIndex, &commands::RpcApi::handle_eth_get_uncle_by_block_hash_and_index, CostClass::standard, kCoalesced},
+        {method::k_eth_getUncleByBlockNumberAndIndex, &commands::RpcApi::handle_eth_get_uncle_by_block_number_and_index, CostClass::standard, kCoalesced},
+        {method::k_eth_getUncleCountByBlockHash, &commands::RpcApi::handle_eth_get_uncle_count_by_block_hash, CostClass::standard, kCoalesced},
+        {method::k_eth_getUncleCountByBlockNumber, &commands::RpcApi::handle_eth_get_uncle_count_by_block_number, CostClass::standard, kCoalesced},
+        {method::k_eth_getTransactionByHash, &commands::RpcApi::handle_eth_get_transaction_by_hash, CostClass::standard, kCoalesced},
+        {method::k_eth_getTransactionByBlockHashAndIndex, &commands::RpcApi::handle_eth_get_transaction_by_block_hash_and_index, CostClass::standard, kCoalesced},
+        {method::k_eth_getTransactionByBlockNumberAndIndex, &commands::RpcApi::handle_eth_get_transaction_by_block_number_and_index, CostClass::standard, kCoalesced},
+        {method::k_eth_getTransactionReceipt, &commands::RpcApi::handle_eth_get_transaction_receipt, CostClass::standard, kCoalesced},
+        {method::k_eth_estimateGas, &commands::RpcApi::handle_eth_estimate_gas, CostClass::heavy, kCoalesced},
+        {method::k_eth_getBalance, &commands::RpcApi::handle_eth_get_balance, CostClass::standard, kCoalesced},
+        {method::k_eth_getCode, &commands::RpcApi::handle_eth_get_code, CostClass::standard, kCoalesced},
+        {method::k_eth_getTransactionCount, &commands::RpcApi::handle_eth_get_transaction_count, CostClass::standard, kCoalesced},
+        {method::k_eth_getStorageAt, &commands::RpcApi::handle_eth_get_storage_at, CostClass::standard, kCoalesced},
+        {method::k_eth_call, &commands::RpcApi::handle_eth_call, CostClass::heavy, kCoalesced},
+        {method::k_eth_newFilter, &commands::RpcApi::handle_eth_new_filter, CostClass::standard},
+        {method::k_eth_newBlockFilter, &commands::RpcApi::handle_eth_new_block_filter, CostClass::cheap},
+        {method::k_eth_newPendingTransactionFilter, &commands::RpcApi::handle_eth_new_pending_transaction_filter, CostClass::cheap},
+        {method::k_eth_getFilterChanges, &commands::RpcApi::handle_eth_get_filter_changes, CostClass::standard},
+        {method::k_eth_uninstallFilter, &commands::RpcApi::handle_eth_uninstall_filter, CostClass::cheap},
+        {method::k_eth_getLogs, &commands::RpcApi::handle_eth_get_logs, CostClass::heavy, kCoalesced, &commands::RpcApi::handle_eth_get_logs_stream},
+        {method::k_eth_sendRawTransaction, &commands::RpcApi::handle_eth_send_raw_transaction, CostClass::standard},
+        {method::k_eth_sendTransaction, &commands::RpcApi::handle_eth_send_transaction, CostClass::standard},
+        {method::k_eth_signTransaction, &commands::RpcApi::handle_eth_sign_transaction, CostClass::standard},
+        {method::k_eth_getProof, &commands::RpcApi::handle_eth_get_proof, CostClass::heavy},
+        {method::k_eth_mining, &commands::RpcApi::handle_eth_mining, CostClass::cheap},
+        {method::k_eth_coinbase, &commands::RpcApi::handle_eth_coinbase, CostClass::cheap, kBackend},
+        {method::k_eth_hashrate, &commands::RpcApi::handle_eth_hashrate, CostClass::cheap},
+        {method::k_eth_submitHashrate, &commands::RpcApi::handle_eth_submit_hashrate, CostClass::standard},
+        {method::k_eth_getWork, &commands::RpcApi::handle_eth_get_work, CostClass::standard},
+        {method::k_eth_submitWork, &commands::RpcApi::handle_eth_submit_work, CostClass::standard},
+        {method::k_eth_subscribe, &commands::RpcApi::handle_eth_subscribe, CostClass::cheap},
+        {method::k_eth_unsubscribe, &commands::RpcApi::handle_eth_unsubscribe, CostClass::cheap},
+        {method::k_eth_getBlockReceipts, &commands::RpcApi::handle_parity_get_block_receipts, CostClass::heavy, kCoalesced},
+        {method::k_debug_accountRange, &commands::RpcApi::handle_debug_account_range, CostClass::heavy},
+        {method::k_debug_getModifiedAccountsByNumber, &commands::RpcApi::handle_debug_get_modified_accounts_by_number, CostClass::heavy},
+        {method::k_debug_getModifiedAccountsByHash, &commands::RpcApi::handle_debug_get_modified_accounts_by_hash, CostClass::heavy},
+        {method::k_debug_storageRangeAt, &commands::RpcApi::handle_debug_storage_range_at, CostClass::heavy},
+        {method::k_debug_traceTransaction, &commands::RpcApi::handle_debug_trace_transaction, CostClass::heavy, kCoalesced},
+        {method::k_debug_traceCall, &commands::RpcApi::handle_debug_trace_call, CostClass::heavy},
+        {method::k_trace_call, &commands::RpcApi::handle_trace_call, CostClass::heavy},
+        {method::k_trace_callMany, &commands::RpcApi::handle_trace_call_many, CostClass::heavy},
+        {method::k_trace_rawTransaction, &commands::RpcApi::handle_trace_raw_transaction, CostClass::heavy},
+        {method::k_trace_replayBlockTransactions, &commands::RpcApi::handle_trace_replay_block_transactions, CostClass::heavy, kCoalesced},
+        {method::k_trace_replayTransaction, &commands::RpcApi::handle_trace_replay_transaction, CostClass::heavy, kCoalesced},
+        {method::k_trace_block, &commands::RpcApi::handle_trace_block, CostClass::heavy, kCoalesced},
+        {method::k_trace_filter, &commands::RpcApi::handle_trace_filter, CostClass::heavy},
+        {method::k_trace_get, &commands::RpcApi::handle_trace_get, CostClass::heavy},
+        {method::k_trace_transaction, &commands::RpcApi::handle_trace_transaction, CostClass::heavy, kCoalesced},
+        {method::k_tg_getHeaderByHash, &commands::RpcApi::handle_tg_get_header_by_hash, CostClass::standard, kCoalesced},
+        {method::k_tg_getHeaderByNumber, &commands::RpcApi::handle_tg_get_header_by_number, CostClass::standard, kCoalesced},
+        {method::k_tg_getLogsByHash, &commands::RpcApi::handle_tg_get_logs_by_hash, CostClass::heavy, kCoalesced},
+        {method::k_tg_forks, &commands::RpcApi::handle_tg_forks, CostClass::cheap},
+        {method::k_tg_issuance, &commands::RpcApi::handle_tg_issuance, CostClass::heavy},
+        {method::k_parity_getBlockReceipts, &commands::RpcApi::handle_parity_get_block_receipts, CostClass::heavy, kCoalesced},
+    })};
+    return kMethods.find(method_name);
+}
+
+const RequestHandler::MethodInfo* RequestHandler::find_method_of(const nlohmann::json& request_json) {
+    if (!request_json.is_object()) {
+        return nullptr;
+    }
+    const auto method_it = request_json.find("method");
+    if (method_it == request_json.end() || !method_it->is_string()) {
+        return nullptr;
+    }
+    return find_method(method_it->get_ref<const std::string&>());
+}
+
+CostClass RequestHandler::cost_class_of(const nlohmann::json& request_json) {
+    // A batch costs as much as its most expensive entry, the malformed requests are rejected cheaply
+    if (request_json.is_array()) {
+        auto cost_class{CostClass::cheap};
+        for (const auto& entry_json : request_json) {
+            cost_class = std::max(cost_class, cost_class_of(entry_json));
+        }
+        return cost_class;
+    }
+    const auto method_it = request_json.find("method");
+    if (method_it == request_json.end() || !method_it->is_string()) {
+        return CostClass::cheap;
+    }
+    const auto* method_info = find_method(method_it->get_ref<const std::string&>());
+    return method_info != nullptr ? method_info->cost_class : CostClass::standard;
+}
 
-        const auto request_json = nlohmann::json::parse(request.content);
+CostClass RequestHandler::cost_class_of(const json::RequestView& request_view) {
+    const auto* method_info = find_method(request_view.method());
+    return method_info != nullptr ? method_info->cost_class : CostClass::standard;
+}
+
+bool RequestHandler::is_coalescable(const json::RequestView& request_view) {
+    // The result is shared by patching the id, so just the requests having an unsigned integer one are eligible
+    if (!request_view.id()) {
+        return false;
+    }
+    const auto* method_info = find_method(request_view.method());
+    return method_info != nullptr && method_info->coalesced();
+}
+
+RequestHandler::StreamMethod RequestHandler::find_stream_method(const nlohmann::json& request_json) const {
+    if (!request_json.contains("id")) {
+        return nullptr;
+    }
+    const auto* method_info = find_method_of(request_json);
+    return method_info != nullptr && is_enabled(*method_info) ? method_info->stream_method : nullptr;
+}
+
+asio::awaitable<Reply::StatusType> RequestHandler::handle_request(commands::RpcApi& rpc_api, const nlohmann::json& request_json, nlohmann::json& reply_json) {
+    auto request_id{0};
+    try {
         request_id = request_json["id"].get<uint32_t>();
         if (!request_json.contains("method")) {
-            reply.content = make_json_error(request_id, -32600, "method missing").dump() + "\n";
-            reply.status = Reply::bad_request;
-            reply.headers.reserve(2);
-            reply.headers.emplace_back(Header{"Content-Length", std::to_string(reply.content.size())});
-            reply.headers.emplace_back(Header{"Content-Type", "application/json"});
-            SILKRPC_INFO << "handle_request t=" << clock_time::since(start) << "ns\n";
-            co_return;
+            reply_json = make_json_error(request_id, -32600, "method missing");
+            co_return Reply::bad_request;
         }
 
-        auto method = request_json["method"].get<std::string>();
-        if (RequestHandler::handlers_.find(method) == RequestHandler::handlers_.end()) {
-            reply.content = make_json_error(request_id, -32601, "method not existent or not implemented").dump() + "\n";
-            reply.status = Reply::not_implemented;
-            reply.headers.reserve(2);
-            reply.headers.emplace_back(Header{"Content-Length", std::to_string(reply.content.size())});
-            reply.headers.emplace_back(Header{"Content-Type", "application/json"});
-            SILKRPC_INFO << "handle_request t=" << clock_time::since(start) << "ns\n";
-            co_return;
+        const auto* method_info = find_method(request_json["method"].get_ref<const std::string&>());
+        if (method_info == nullptr || !is_enabled(*method_info)) {
+            reply_json = make_json_error(request_id, -32601, "method not existent or not implemented");
+            co_return Reply::not_implemented;
         }
 
-        nlohmann::json reply_json;
-        auto handle_method = RequestHandler::handlers_[method];
-        co_await (&rpc_api_->*handle_method)(request_json, reply_json);
-
-        reply.content = reply_json.dump() + "\n";
-        reply.status = Reply::ok;
+        const auto handle_method = method_info->handle_method;
+        co_await (&rpc_api->*handle_method)(request_json, reply_json);
+        co_return Reply::ok;
     } catch (const std::exception& e) {
         SILKRPC_ERROR << "exception: " << e.what() << "\n";
-        reply.content = make_json_error(request_id, 100, e.what()).dump() + "\n";
-        reply.status = Reply::internal_server_error;
+        reply_json = make_json_error(request_id, 100, e.what());
     } catch (...) {
         SILKRPC_ERROR << "unexpected exception\n";
-        reply.content = make_json_error(request_id, 100, "unexpected exception").dump() + "\n";
-        reply.status = Reply::internal_server_error;
+        reply_json = make_json_error(request_id, 100, "unexpected exception");
     }
+    co_return Reply::internal_server_error;
+}
 
-    reply.headers.reserve(2);
-    reply.headers.emplace_back(Header{"Content-Length", std::to_string(reply.content.size())});
-    reply.headers.emplace_back(Header{"Content-Type", "application/json"});
+asio::awaitable<Reply::StatusType> RequestHandler::handle_batch_request(const nlohmann::json& batch_json, ChunkBuffer& body) {
+    if (batch_json.empty()) {
+        body.append_json(make_json_error(0, -32600, "empty batch"));
+        body.append('\n');
+        co_return Reply::bad_request;
+    }
+    if (batch_json.size() > max_batch_size_) {
+        const auto error_msg = "batch size " + std::to_string(batch_json.size()) + " exceeds limit " + std::to_string(max_batch_size_);
+        body.append_json(make_json_error(0, -32600, error_msg));
+        body.append('\n');
+        co_return Reply::bad_request;
+    }
+    SILKRPC_DEBUG << "handle_batch_request batch size: " << batch_json.size() << "\n";
 
-    SILKRPC_INFO << "handle_request t=" << clock_time::since(start) << "ns\n";
-    co_return;
+    // The entries reading chain data share one transaction through a batch-scoped RPC API
+    auto shared_database = std::make_unique<ethdb::SharedDatabase>(*context_.database, *context_.io_context);
+    auto& batch_database = *shared_database;
+    Context batch_context{context_.io_context, nullptr, nullptr, std::move(shared_database), nullptr};
+    commands::RpcApi batch_rpc_api{batch_context, workers_};
+
+    // Run all the entries concurrently and wait for the last one to complete
+    auto executor = co_await asio::this_coro::executor;
+    std::vector<nlohmann::json> replies(batch_json.size());
+    std::size_t pending{batch_json.size()};
+    asio::steady_timer all_completed{executor, asio::steady_timer::time_point::max()};
+    for (std::size_t i{0}; i < batch_json.size(); ++i) {
+        const auto& entry_json = batch_json[i];
+        if (!entry_json.is_object()) {
+            replies[i] = {{"jsonrpc", "2.0"}, {"id", nullptr}, {"error", Error{-32600, "invalid request"}}};
+            --pending;
+            continue;
+        }
+        const auto* method_info = find_method_of(entry_json);
+        const bool backend_method = method_info != nullptr && method_info->backend();
+        auto* rpc_api = backend_method ? &rpc_api_ : &batch_rpc_api;
+        asio::co_spawn(executor, [&, i, rpc_api]() -> asio::awaitable<void> {
+            const auto cost_class = cost_class_of(batch_json[i]);
+            if (admission_control_ != nullptr && !co_await admission_control_->acquire(cost_class)) {
+                replies[i] = make_json_error(id_of(batch_json[i]), -32005, "server overloaded, retry later");
+                co_return;
+            }
+            AdmissionSlot admission_slot{admission_control_, cost_class};
+            co_await handle_request(*rpc_api, batch_json[i], replies[i]);
+        }, [&](std::exception_ptr) {
+            if (--pending == 0) {
+                all_completed.cancel();
+            }
+        });
+    }
+    if (pending > 0) {
+        asio::error_code error;
+        co_await all_completed.async_wait(asio::redirect_error(asio::use_awaitable, error));
+    }
+    co_await batch_database.close();
+
+    // Serialize the replies in order into the reply body
+    body.append('[');
+    for (std::size_t i{0}; i < replies.size(); ++i) {
+        if (i > 0) {
+            body.append(',');
+        }
+        body.append_json(replies[i]);
+    }
+    body.append("]\n", 2);
+
+    co_return Reply::ok;
 }
 
 } // namespace silkrpc::http
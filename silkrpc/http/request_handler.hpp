@@ -23,9 +23,12 @@
 #ifndef SILKRPC_HTTP_REQUEST_HANDLER_HPP_
 #define SILKRPC_HTTP_REQUEST_HANDLER_HPP_
 
-#include <map>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include <silkrpc/config.hpp>
 
@@ -33,29 +36,93 @@
 #include <asio/thread_pool.hpp>
 
 #include <silkrpc/commands/rpc_api.hpp>
+#include <silkrpc/common/constants.hpp>
 #include <silkrpc/context_pool.hpp>
+#include <silkrpc/json/request_view.hpp>
+#include <silkrpc/json/stream_writer.hpp>
+#include "admission_control.hpp"
+#include "chunk_buffer.hpp"
+#include "method_table.hpp"
+#include "reply.hpp"
+#include "single_flight.hpp"
 
 namespace silkrpc::http {
 
-struct Reply;
 struct Request;
 
 class RequestHandler {
 public:
+    typedef asio::awaitable<void> (commands::RpcApi::*HandleMethod)(const nlohmann::json&, nlohmann::json&);
+    typedef asio::awaitable<void> (commands::RpcApi::*StreamMethod)(const nlohmann::json&, StreamWriter&);
+
+    enum MethodFlags : uint8_t {
+        kCoalesced = 1,     // the identical calls in flight share one execution
+        kBackend = 2        // served just by the remote backend, i.e. not reading any chain data
+    };
+
+    /// The metadata of one method.
+    struct MethodInfo {
+        std::string_view name;
+        HandleMethod handle_method;
+        CostClass cost_class{CostClass::standard};
+        uint8_t flags{0};
+        StreamMethod stream_method{nullptr};
+        ApiNamespace api_namespace{api_namespace_of(name).value()};
+
+        constexpr bool coalesced() const { return (flags & kCoalesced) != 0; }
+        constexpr bool backend() const { return (flags & kBackend) != 0; }
+    };
+
     RequestHandler(const RequestHandler&) = delete;
     RequestHandler& operator=(const RequestHandler&) = delete;
 
-    explicit RequestHandler(Context& context, asio::thread_pool& workers) : rpc_api_{context, workers} {}
+    // Construct the handler applying the admission control and the coalescing of identical calls if any, which require
+    // the requests to run on the context io_context
+    explicit RequestHandler(Context& context, asio::thread_pool& workers, std::size_t max_batch_size,
+        AdmissionControl* admission_control = nullptr, std::chrono::seconds retry_after = common::kDefaultRetryAfter,
+        SingleFlight* single_flight = nullptr, ApiNamespaces api_namespaces = kAllApiNamespaces)
+    : context_(context), workers_(workers), max_batch_size_{max_batch_size}, rpc_api_{context, workers},
+      admission_control_{admission_control}, retry_after_{retry_after}, single_flight_{single_flight}, api_namespaces_{api_namespaces} {}
 
     virtual ~RequestHandler() {}
 
-    asio::awaitable<void> handle_request(const Request& request, Reply& reply);
+    /// Handle the request: when a writer is given, the methods supporting streaming write their reply content to it.
+    asio::awaitable<void> handle_request(const Request& request, Reply& reply, StreamWriter* writer = nullptr);
+
+    /// Get the cost class of the request, i.e. the one of its method or the highest one among the batch entries.
+    static CostClass cost_class_of(const nlohmann::json& request_json);
+
+    /// Get the cost class of the single request read in place.
+    static CostClass cost_class_of(const json::RequestView& request_view);
+
+    /// Check if the request can share the result of an identical one in flight, i.e. its method just reads chain data.
+    static bool is_coalescable(const json::RequestView& request_view);
+
+    /// Get the metadata of the method resolved by name without allocating, nullptr if unknown.
+    static const MethodInfo* find_method(std::string_view method_name);
+
+    /// Get the metadata of the method called by the request, nullptr if missing or unknown.
+    static const MethodInfo* find_method_of(const nlohmann::json& request_json);
+
+    /// Check if the method belongs to one of the namespaces enabled on this handler.
+    bool is_enabled(const MethodInfo& method_info) const { return (api_namespaces_ & api_namespace_bit(method_info.api_namespace)) != 0; }
 
 private:
+    asio::awaitable<Reply::StatusType> handle_request(commands::RpcApi& rpc_api, const nlohmann::json& request_json, nlohmann::json& reply_json);
+
+    /// Handle the batch entries concurrently, each one admitted on its own according to its cost class.
+    asio::awaitable<Reply::StatusType> handle_batch_request(const nlohmann::json& batch_json, ChunkBuffer& body);
+
+    Context& context_;
+    asio::thread_pool& workers_;
+    std::size_t max_batch_size_;
     commands::RpcApi rpc_api_;
+    AdmissionControl* admission_control_;
+    std::chrono::seconds retry_after_;
+    SingleFlight* single_flight_;
+    ApiNamespaces api_namespaces_;
 
-    typedef asio::awaitable<void> (commands::RpcApi::*HandleMethod)(const nlohmann::json&, nlohmann::json&);
-    static std::map<std::string, HandleMethod> handlers_;
+    StreamMethod find_stream_method(const nlohmann::json& request_json) const;
 };
 
 } // namespace silkrpc::http
@@ -16,11 +16,403 @@
 
 #include "request_handler.hpp"
 
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <asio/co_spawn.hpp>
+#include <asio/io_context.hpp>
+#include <asio/post.hpp>
+#include <asio/this_coro.hpp>
+#include <asio/thread_pool.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asio/use_future.hpp>
 #include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+#include <silkrpc/common/constants.hpp>
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/ethdb/database.hpp>
+#include <silkrpc/ethdb/transaction.hpp>
+#include <silkrpc/json/stream_writer.hpp>
+#include <silkrpc/json/request_view.hpp>
+#include "admission_control.hpp"
+#include "reply.hpp"
+#include "request.hpp"
+#include "single_flight.hpp"
 
 namespace silkrpc {
 
 using Catch::Matchers::Message;
 
-} // namespace silkrpc
+/// Database failing to begin any transaction, so that the methods reading chain data fail.
+class FailingDatabase : public ethdb::Database {
+public:
+    asio::awaitable<std::unique_ptr<ethdb::Transaction>> begin() override {
+        // Yield once as a remote database would, so that the concurrent requests interleave
+        co_await asio::post(co_await asio::this_coro::executor, asio::use_awaitable);
+        throw std::runtime_error{"database unavailable"};
+    }
+};
+
+/// Transaction failing to read any table, so that the methods fail after having begun it.
+class UnavailableTransaction : public ethdb::Transaction {
+public:
+    asio::awaitable<void> open() override { co_return; }
+
+    asio::awaitable<std::shared_ptr<ethdb::Cursor>> cursor(const std::string& /*table*/) override {
+        throw std::runtime_error{"data unavailable"};
+    }
+
+    asio::awaitable<std::shared_ptr<ethdb::CursorDupSort>> cursor_dup_sort(const std::string& /*table*/) override {
+        throw std::runtime_error{"data unavailable"};
+    }
+
+    asio::awaitable<std::shared_ptr<ethdb::CursorDupSort>> new_cursor(const std::string& /*table*/) override {
+        throw std::runtime_error{"data unavailable"};
+    }
+
+    asio::awaitable<void> close() override { co_return; }
+};
+
+/// Database beginning transactions whose tables cannot be read.
+class UnavailableDatabase : public ethdb::Database {
+public:
+    asio::awaitable<std::unique_ptr<ethdb::Transaction>> begin() override {
+        // Yield once as a remote database would, so that the identical requests are coalesced
+        co_await asio::post(co_await asio::this_coro::executor, asio::use_awaitable);
+        co_return std::make_unique<UnavailableTransaction>();
+    }
+};
+
+/// Writer keeping all the written content, nothing being sent until the end.
+class BufferStreamWriter : public StreamWriter {
+public:
+    asio::awaitable<void> write(std::string_view content) override {
+        content_.append(content);
+        co_return;
+    }
+
+    bool discard() override {
+        content_.clear();
+        return true;
+    }
+
+    const std::string& content() const { return content_; }
+
+private:
+    std::string content_;
+};
+
+class RequestHandlerTest {
+public:
+    explicit RequestHandlerTest(std::size_t max_batch_size = common::kDefaultMaxBatchSize, const http::AdmissionLimits& limits = {},
+        bool coalescing = false)
+    : context{make_context()}, global_admission{limits}, admission_control{*context.io_context, limits, global_admission},
+      single_flight{*context.io_context},
+      handler{context, workers, max_batch_size, &admission_control, common::kDefaultRetryAfter, coalescing ? &single_flight : nullptr} {}
+
+    /// Handle the request content, returning the status and the whole reply content.
+    std::pair<http::Reply::StatusType, std::string> handle(const std::string& content) {
+        const http::Request request{"POST", "/", 1, 1, {}, static_cast<uint32_t>(content.size()), content};
+        http::Reply reply;
+        auto result = asio::co_spawn(*context.io_context, handler.handle_request(request, reply), asio::use_future);
+        poll_until(result);
+        result.get();
+        return {reply.status, reply.content + reply.body.to_string()};
+    }
+
+    /// Run the ready handlers until the result is available, other requests may be still waiting (e.g. for a slot).
+    template <typename Future>
+    void poll_until(const Future& result) {
+        do {
+            context.io_context->restart();
+            context.io_context->poll();
+        } while (result.wait_for(std::chrono::seconds{0}) != std::future_status::ready);
+    }
+
+    static Context make_context() {
+        Context context;
+        context.io_context = std::make_shared<asio::io_context>();
+        context.database = std::make_unique<FailingDatabase>();
+        return context;
+    }
+
+    asio::thread_pool workers{1};
+    Context context;
+    http::GlobalAdmission global_admission;
+    http::AdmissionControl admission_control;
+    http::SingleFlight single_flight;
+    http::RequestHandler handler;
+};
+
+TEST_CASE("RequestHandler::cost_class_of", "[silkrpc][http][request_handler]") {
+    using http::CostClass;
+    using http::RequestHandler;
+
+    CHECK(RequestHandler::cost_class_of(R"({"jsonrpc":"2.0","id":1,"method":"eth_blockNumber","params":[]})"_json) == CostClass::cheap);
+    CHECK(RequestHandler::cost_class_of(R"({"jsonrpc":"2.0","id":1,"method":"eth_getBalance","params":[]})"_json) == CostClass::standard);
+    CHECK(RequestHandler::cost_class_of(R"({"jsonrpc":"2.0","id":1,"method":"eth_getLogs","params":[]})"_json) == CostClass::heavy);
+    CHECK(RequestHandler::cost_class_of(R"({"jsonrpc":"2.0","id":1,"method":"unknown_method","params":[]})"_json) == CostClass::standard);
+    CHECK(RequestHandler::cost_class_of(R"({"jsonrpc":"2.0","id":1})"_json) == CostClass::cheap);
+    CHECK(RequestHandler::cost_class_of(R"([])"_json) == CostClass::cheap);
+    CHECK(RequestHandler::cost_class_of(R"([
+        {"jsonrpc":"2.0","id":1,"method":"eth_chainId","params":[]},
+        {"jsonrpc":"2.0","id":2,"method":"eth_getBalance","params":[]}
+    ])"_json) == CostClass::standard);
+    CHECK(RequestHandler::cost_class_of(R"([
+        {"jsonrpc":"2.0","id":1,"method":"eth_call","params":[]},
+        1
+    ])"_json) == CostClass::heavy);
+}
+
+TEST_CASE("RequestHandler::cost_class_of request view", "[silkrpc][http][request_handler]") {
+    using http::CostClass;
+    using http::RequestHandler;
+
+    CHECK(RequestHandler::cost_class_of(*json::RequestView::parse(R"({"jsonrpc":"2.0","id":1,"method":"eth_blockNumber","params":[]})")) == CostClass::cheap);
+    CHECK(RequestHandler::cost_class_of(*json::RequestView::parse(R"({"jsonrpc":"2.0","id":1,"method":"eth_getBalance","params":[]})")) == CostClass::standard);
+    CHECK(RequestHandler::cost_class_of(*json::RequestView::parse(R"({"jsonrpc":"2.0","id":1,"method":"eth_getLogs","params":[]})")) == CostClass::heavy);
+    CHECK(RequestHandler::cost_class_of(*json::RequestView::parse(R"({"jsonrpc":"2.0","id":1,"method":"unknown_method"})")) == CostClass::standard);
+}
+
+TEST_CASE("RequestHandler::is_coalescable", "[silkrpc][http][request_handler]") {
+    using http::RequestHandler;
+
+    const auto is_coalescable = [](const std::string& content) {
+        const auto request_view = json::RequestView::parse(content);
+        return request_view && RequestHandler::is_coalescable(*request_view);
+    };
+    CHECK(is_coalescable(R"({"jsonrpc":"2.0","id":1,"method":"eth_getBlockByNumber","params":["latest",true]})"));
+    CHECK(is_coalescable(R"({"jsonrpc":"2.0","id":1,"method":"eth_getLogs","params":[{}]})"));
+    CHECK(!is_coalescable(R"({"jsonrpc":"2.0","id":1,"method":"eth_sendRawTransaction","params":["0x00"]})"));
+    CHECK(!is_coalescable(R"({"jsonrpc":"2.0","id":1,"method":"eth_newFilter","params":[{}]})"));
+    CHECK(!is_coalescable(R"({"jsonrpc":"2.0","id":"a","method":"eth_getLogs","params":[{}]})"));
+    CHECK(!is_coalescable(R"({"jsonrpc":"2.0","method":"eth_getLogs","params":[{}]})"));
+    CHECK(!is_coalescable(R"({"jsonrpc":"2.0","id":1})"));
+    CHECK(!is_coalescable(R"([{"jsonrpc":"2.0","id":1,"method":"eth_getLogs","params":[{}]}])"));
+}
+
+TEST_CASE("RequestHandler::find_method", "[silkrpc][http][request_handler]") {
+    using http::ApiNamespace;
+    using http::CostClass;
+    using http::RequestHandler;
+
+    const auto* eth_get_logs = RequestHandler::find_method("eth_getLogs");
+    REQUIRE(eth_get_logs != nullptr);
+    CHECK(eth_get_logs->name == "eth_getLogs");
+    CHECK(eth_get_logs->api_namespace == ApiNamespace::eth);
+    CHECK(eth_get_logs->cost_class == CostClass::heavy);
+    CHECK(eth_get_logs->coalesced());
+    CHECK(!eth_get_logs->backend());
+    CHECK(eth_get_logs->stream_method != nullptr);
 
+    const auto* eth_get_block_by_number = RequestHandler::find_method("eth_getBlockByNumber");
+    REQUIRE(eth_get_block_by_number != nullptr);
+    CHECK(eth_get_block_by_number->coalesced());
+    CHECK(eth_get_block_by_number->stream_method != nullptr);
+
+    const auto* net_version = RequestHandler::find_method("net_version");
+    REQUIRE(net_version != nullptr);
+    CHECK(net_version->api_namespace == ApiNamespace::net);
+    CHECK(net_version->backend());
+    CHECK(net_version->stream_method == nullptr);
+
+    CHECK(RequestHandler::find_method("eth_getlogs") == nullptr);
+    CHECK(RequestHandler::find_method("unknown_method") == nullptr);
+    CHECK(RequestHandler::find_method_of(R"({"jsonrpc":"2.0","id":1,"method":"debug_traceCall","params":[]})"_json)->api_namespace == ApiNamespace::debug);
+    CHECK(RequestHandler::find_method_of(R"({"jsonrpc":"2.0","id":1,"method":1,"params":[]})"_json) == nullptr);
+    CHECK(RequestHandler::find_method_of(R"([{"jsonrpc":"2.0","id":1,"method":"eth_call","params":[]}])"_json) == nullptr);
+}
+
+TEST_CASE("RequestHandler::handle_request batch", "[silkrpc][http][request_handler]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    SECTION("replies in request order") {
+        RequestHandlerTest test;
+        const auto [status, content] = test.handle(R"([
+            {"jsonrpc":"2.0","id":3,"method":"net_peerCount","params":[]},
+            {"jsonrpc":"2.0","id":1,"method":"web3_sha3","params":["0x"]},
+            {"jsonrpc":"2.0","id":2,"method":"net_listening","params":[]}
+        ])");
+        CHECK(status == http::Reply::ok);
+        CHECK(nlohmann::json::parse(content) == R"([
+            {"jsonrpc":"2.0","id":3,"result":"0x19"},
+            {"jsonrpc":"2.0","id":1,"result":"0xc5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470"},
+            {"jsonrpc":"2.0","id":2,"result":true}
+        ])"_json);
+    }
+
+    SECTION("batch size limit") {
+        RequestHandlerTest test{2};
+        const auto [status, content] = test.handle(R"([
+            {"jsonrpc":"2.0","id":1,"method":"net_listening","params":[]},
+            {"jsonrpc":"2.0","id":2,"method":"net_listening","params":[]},
+            {"jsonrpc":"2.0","id":3,"method":"net_listening","params":[]}
+        ])");
+        CHECK(status == http::Reply::bad_request);
+        CHECK(nlohmann::json::parse(content) == R"({"jsonrpc":"2.0","id":0,"error":{"code":-32600,"message":"batch size 3 exceeds limit 2"}})"_json);
+    }
+
+    SECTION("batch size at limit") {
+        RequestHandlerTest test{2};
+        const auto [status, content] = test.handle(R"([
+            {"jsonrpc":"2.0","id":1,"method":"net_listening","params":[]},
+            {"jsonrpc":"2.0","id":2,"method":"net_listening","params":[]}
+        ])");
+        CHECK(status == http::Reply::ok);
+        CHECK(nlohmann::json::parse(content).size() == 2);
+    }
+
+    SECTION("empty batch") {
+        RequestHandlerTest test;
+        const auto [status, content] = test.handle("[]");
+        CHECK(status == http::Reply::bad_request);
+        CHECK(nlohmann::json::parse(content) == R"({"jsonrpc":"2.0","id":0,"error":{"code":-32600,"message":"empty batch"}})"_json);
+    }
+
+    SECTION("non-object entries") {
+        RequestHandlerTest test;
+        const auto [status, content] = test.handle(R"([1,{"jsonrpc":"2.0","id":2,"method":"net_listening","params":[]},"x"])");
+        CHECK(status == http::Reply::ok);
+        CHECK(nlohmann::json::parse(content) == R"([
+            {"jsonrpc":"2.0","id":null,"error":{"code":-32600,"message":"invalid request"}},
+            {"jsonrpc":"2.0","id":2,"result":true},
+            {"jsonrpc":"2.0","id":null,"error":{"code":-32600,"message":"invalid request"}}
+        ])"_json);
+    }
+
+    SECTION("failing entries do not fail the others") {
+        RequestHandlerTest test;
+        const auto [status, content] = test.handle(R"([
+            {"jsonrpc":"2.0","id":1,"method":"eth_chainId","params":[]},
+            {"jsonrpc":"2.0","id":2,"method":"net_listening","params":[]},
+            {"jsonrpc":"2.0","id":3,"method":"unknown_method","params":[]}
+        ])");
+        CHECK(status == http::Reply::ok);
+        CHECK(nlohmann::json::parse(content) == R"([
+            {"jsonrpc":"2.0","id":1,"error":{"code":100,"message":"database unavailable"}},
+            {"jsonrpc":"2.0","id":2,"result":true},
+            {"jsonrpc":"2.0","id":3,"error":{"code":-32601,"message":"method not existent or not implemented"}}
+        ])"_json);
+    }
+}
+
+TEST_CASE("RequestHandler::handle_request shed", "[silkrpc][http][request_handler]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    // One request in flight and one waiting fill up the context, so that the next one is shed
+    RequestHandlerTest test{common::kDefaultMaxBatchSize, http::AdmissionLimits{1, 1}};
+    auto in_flight = asio::co_spawn(*test.context.io_context, test.admission_control.acquire(), asio::use_future);
+    auto queued = asio::co_spawn(*test.context.io_context, test.admission_control.acquire(), asio::use_future);
+    test.poll_until(in_flight);
+    REQUIRE(in_flight.get());
+
+    SECTION("with id") {
+        const auto [status, content] = test.handle(R"({"jsonrpc":"2.0","id":7,"method":"eth_getBalance","params":[]})");
+        CHECK(status == http::Reply::service_unavailable);
+        CHECK(nlohmann::json::parse(content) == R"({"jsonrpc":"2.0","id":7,"error":{"code":-32005,"message":"server overloaded, retry later"}})"_json);
+    }
+
+    SECTION("with id when not read in place") {
+        const auto [status, content] = test.handle(R"({"jsonrpc":"2.0","id":8,"method":"eth_getBalanc\u0065","params":[]})");
+        CHECK(status == http::Reply::service_unavailable);
+        CHECK(nlohmann::json::parse(content)["id"] == 8);
+    }
+
+    SECTION("batch entries") {
+        const auto [status, content] = test.handle(R"([
+            {"jsonrpc":"2.0","id":9,"method":"eth_getBalance","params":[]},
+            {"jsonrpc":"2.0","id":10,"method":"net_listening","params":[]}
+        ])");
+        CHECK(status == http::Reply::ok);
+        CHECK(nlohmann::json::parse(content) == R"([
+            {"jsonrpc":"2.0","id":9,"error":{"code":-32005,"message":"server overloaded, retry later"}},
+            {"jsonrpc":"2.0","id":10,"result":true}
+        ])"_json);
+    }
+
+    test.admission_control.release();
+    test.poll_until(queued);
+    REQUIRE(queued.get());
+    test.admission_control.release();
+}
+
+TEST_CASE("RequestHandler::handle_request batch admission", "[silkrpc][http][request_handler]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    // Each heavy entry takes its own slot: with room for one running and one waiting, the third one is shed
+    RequestHandlerTest test{common::kDefaultMaxBatchSize, http::AdmissionLimits{2, 1, 1}};
+    const auto [status, content] = test.handle(R"([
+        {"jsonrpc":"2.0","id":1,"method":"eth_call","params":[{},"latest"]},
+        {"jsonrpc":"2.0","id":2,"method":"eth_call","params":[{},"latest"]},
+        {"jsonrpc":"2.0","id":3,"method":"eth_call","params":[{},"latest"]}
+    ])");
+    CHECK(status == http::Reply::ok);
+    const auto replies = nlohmann::json::parse(content);
+    REQUIRE(replies.size() == 3);
+    CHECK(replies[0] == R"({"jsonrpc":"2.0","id":1,"error":{"code":100,"message":"database unavailable"}})"_json);
+    CHECK(replies[1] == R"({"jsonrpc":"2.0","id":2,"error":{"code":100,"message":"database unavailable"}})"_json);
+    CHECK(replies[2] == R"({"jsonrpc":"2.0","id":3,"error":{"code":-32005,"message":"server overloaded, retry later"}})"_json);
+    CHECK(test.admission_control.shed() == 1);
+    CHECK(test.admission_control.in_flight() == 0);
+}
+
+TEST_CASE("RequestHandler::handle_request coalesced stream", "[silkrpc][http][request_handler]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    RequestHandlerTest test{common::kDefaultMaxBatchSize, {}, /*coalescing=*/true};
+    test.context.database = std::make_unique<UnavailableDatabase>();
+
+    // Two identical calls streamed over HTTP/1.1: the first one writes its reply, the second one shares its content
+    const auto handle_concurrently = [&](const std::string& method, const std::string& params) {
+        const auto content1 = R"({"jsonrpc":"2.0","id":1,"method":")" + method + R"(","params":)" + params + "}";
+        const auto content2 = R"({"jsonrpc":"2.0","id":2,"method":")" + method + R"(","params":)" + params + "}";
+        const http::Request request1{"POST", "/", 1, 1, {}, static_cast<uint32_t>(content1.size()), content1};
+        const http::Request request2{"POST", "/", 1, 1, {}, static_cast<uint32_t>(content2.size()), content2};
+        http::Reply reply1, reply2;
+        BufferStreamWriter writer1, writer2;
+        auto result1 = asio::co_spawn(*test.context.io_context, test.handler.handle_request(request1, reply1, &writer1), asio::use_future);
+        auto result2 = asio::co_spawn(*test.context.io_context, test.handler.handle_request(request2, reply2, &writer2), asio::use_future);
+        test.poll_until(result1);
+        test.poll_until(result2);
+        result1.get();
+        result2.get();
+        CHECK(reply1.status == http::Reply::ok);
+        CHECK(reply1.content.empty());
+        CHECK(reply2.status == http::Reply::ok);
+        CHECK(writer2.content().empty());
+        auto reply1_json = nlohmann::json::parse(writer1.content());
+        auto reply2_json = nlohmann::json::parse(reply2.content);
+        CHECK(reply1_json["id"] == 1);
+        CHECK(reply2_json["id"] == 2);
+        CHECK(reply1_json["error"]["message"] == "data unavailable");
+        reply1_json.erase("id");
+        reply2_json.erase("id");
+        CHECK(reply1_json == reply2_json);
+    };
+
+    SECTION("eth_getLogs") {
+        handle_concurrently("eth_getLogs", R"([{"fromBlock":"0x1","toBlock":"0x2"}])");
+        CHECK(test.single_flight.counters().executed == 1);
+        CHECK(test.single_flight.counters().coalesced == 1);
+    }
+
+    SECTION("eth_getBlockByNumber") {
+        handle_concurrently("eth_getBlockByNumber", R"(["0x1",true])");
+        CHECK(test.single_flight.counters().executed == 1);
+        CHECK(test.single_flight.counters().coalesced == 1);
+    }
+
+    SECTION("eth_getBlockByHash") {
+        handle_concurrently("eth_getBlockByHash", R"(["0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c",false])");
+        CHECK(test.single_flight.counters().executed == 1);
+        CHECK(test.single_flight.counters().coalesced == 1);
+    }
+}
+
+} // namespace silkrpc
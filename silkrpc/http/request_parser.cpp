@@ -23,16 +23,72 @@
 #include "request_parser.hpp"
 
 #include <algorithm>
+#include <charconv>
+
+#include <absl/strings/match.h>
+
+#include "scanner.hpp"
 
 namespace silkrpc::http {
 
-RequestParser::RequestParser() : state_(method_start) {
+RequestParser::RequestParser(std::size_t max_content_length) : state_(method_start), max_content_length_{max_content_length} {
 }
 
 void RequestParser::reset() {
     state_ = method_start;
 }
 
+RequestParser::Phase RequestParser::phase() const {
+    switch (state_) {
+        case method_start:
+            return idle;
+        case content_start:
+            return content;
+        default:
+            return headers;
+    }
+}
+
+std::tuple<RequestParser::ResultType, const char*> RequestParser::parse(Request& req, const char* begin, const char* end) {
+    while (begin != end) {
+        // Skip in bulk the characters which would just be appended, then let the state machine handle the delimiter
+        const char* stop{begin};
+        switch (state_) {
+            case uri:
+                stop = scanner::find_ctl_or_space(begin, end);
+                req.uri.append(begin, stop);
+                break;
+            case header_name:
+                stop = scanner::find_non_token(begin, end);
+                req.headers.back().name.append(begin, stop);
+                break;
+            case header_value:
+                stop = scanner::find_ctl(begin, end);
+                req.headers.back().value.append(begin, stop);
+                break;
+            case content_start: {
+                const auto count = std::min(static_cast<std::size_t>(end - begin), req.content_length - req.content.size());
+                req.content.append(begin, count);
+                begin += count;
+                return std::make_tuple(req.content.size() < req.content_length ? indeterminate : good, begin);
+            }
+            default:
+                break;
+        }
+        begin = stop;
+        if (begin == end) {
+            break;
+        }
+
+        ResultType result = consume(req, *begin++);
+        if (result == good || result == bad || result == too_large) {
+            return std::make_tuple(result, begin);
+        }
+    }
+
+    return std::make_tuple(indeterminate, begin);
+}
+
 RequestParser::ResultType RequestParser::consume(Request& req, char input) {
     switch (state_) {
         case method_start:
@@ -208,26 +264,18 @@ RequestParser::ResultType RequestParser::consume(Request& req, char input) {
         case expecting_newline_3:
             if (input == '\n') {
                 state_ = content_start;
-                if (req.content_length == 0) {
-                    const auto it = std::find_if(req.headers.begin(), req.headers.end(), [&](const Header& h){
-                        return h.name == "Content-Length";
-                    });
-                    if (it == req.headers.end()) {
-                        return bad;
-                    }
-                    req.content_length = std::atoi((*it).value.c_str());
+                if (!parse_content_length(req)) {
+                    return bad;
+                }
+                // Reject the oversized content early, before allocating or reading it
+                if (max_content_length_ > 0 && req.content_length > max_content_length_) {
+                    return too_large;
                 }
+                req.content.reserve(req.content_length);
                 return req.content_length == 0 ? good : indeterminate;
             } else {
                 return bad;
             }
-        case content_start:
-            req.content.push_back(input);
-            if (req.content.length() < req.content_length) {
-                return indeterminate;
-            } else {
-                return good;
-            }
         default:
             return bad;
     }
@@ -257,4 +305,22 @@ inline bool RequestParser::is_digit(int c) {
     return c >= '0' && c <= '9';
 }
 
+bool RequestParser::has_body(const std::string& method) {
+    return method == "POST" || method == "PUT" || method == "PATCH";
+}
+
+bool RequestParser::parse_content_length(Request& req) {
+    const auto it = std::find_if(req.headers.begin(), req.headers.end(), [&](const Header& h){
+        return absl::EqualsIgnoreCase(h.name, "Content-Length");
+    });
+    if (it == req.headers.end()) {
+        // Body-less requests (e.g. the GET of a WebSocket upgrade) need no Content-Length: their content is empty
+        req.content_length = 0;
+        return !has_body(req.method);
+    }
+    const auto& value = it->value;
+    const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), req.content_length);
+    return ec == std::errc{} && ptr == value.data() + value.size();
+}
+
 } // namespace silkrpc::http
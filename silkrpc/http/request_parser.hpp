@@ -23,6 +23,7 @@
 #ifndef SILKRPC_HTTP_REQUEST_PARSER_HPP_
 #define SILKRPC_HTTP_REQUEST_PARSER_HPP_
 
+#include <cstddef>
 #include <tuple>
 
 #include "request.hpp"
@@ -32,30 +33,28 @@ namespace silkrpc::http {
 /// Parser for incoming requests.
 class RequestParser {
 public:
-    /// Construct ready to parse the request method.
-    RequestParser();
+    /// Construct ready to parse the request method, accepting request content up to the given length (zero means unlimited).
+    explicit RequestParser(std::size_t max_content_length = 0);
 
     /// Reset to initial parser state.
     void reset();
 
     /// Result of parse.
-    enum ResultType { good, bad, indeterminate };
+    enum ResultType { good, bad, indeterminate, too_large };
+
+    /// Phase of the request reception: idle until the first byte of the request, then reading headers and content.
+    enum Phase { idle, headers, content };
+
+    /// Get the current phase of the request reception.
+    Phase phase() const;
 
     /// Parse some data. The enum return value is good when a complete request has
-    /// been parsed, bad if the data is invalid, indeterminate when more data is
-    /// required. The InputIterator return value indicates how much of the input
-    /// has been consumed.
-    template <typename InputIterator>
-    ResultType parse(Request& req, InputIterator begin, InputIterator end) {
-        while (begin != end) {
-            ResultType result = consume(req, *begin++);
-            if (result == good || result == bad) {
-                return result;
-            }
-        }
-
-        return indeterminate;
-    }
+    /// been parsed, bad if the data is invalid, too_large if the Content-Length
+    /// exceeds the maximum (detected before any content), indeterminate when more data is
+    /// required. The pointer return value indicates how much of the input
+    /// has been consumed. URI, header names and values are scanned in bulk
+    /// using SIMD instructions if available, the content is copied in bulk.
+    std::tuple<ResultType, const char*> parse(Request& req, const char* begin, const char* end);
 
 private:
     /// Handle the next character of input.
@@ -73,6 +72,12 @@ private:
     /// Check if a byte is a digit.
     static bool is_digit(int c);
 
+    /// Check if the request method is expected to carry a body, so that Content-Length is mandatory.
+    static bool has_body(const std::string& method);
+
+    /// Parse the Content-Length header value at the end of headers, defaulting to zero on body-less requests.
+    static bool parse_content_length(Request& req);
+
     /// The current state of the parser.
     enum State {
         method_start,
@@ -97,6 +102,9 @@ private:
         expecting_newline_3,
         content_start
     } state_;
+
+    /// The maximum length of the request content, zero means unlimited.
+    std::size_t max_content_length_;
 };
 
 } // namespace silkrpc::http
@@ -16,11 +16,192 @@
 
 #include "request_parser.hpp"
 
+#include <string>
+
 #include <catch2/catch.hpp>
 
 namespace silkrpc {
 
 using Catch::Matchers::Message;
 
+TEST_CASE("parse single request", "[silkrpc][http][request_parser]") {
+    const std::string data{"POST / HTTP/1.1\r\nContent-Length: 2\r\n\r\n{}"};
+    http::RequestParser parser;
+    http::Request request;
+    const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+    CHECK(result == http::RequestParser::good);
+    CHECK(consumed == data.data() + data.size());
+    CHECK(request.method == "POST");
+    CHECK(request.http_version_major == 1);
+    CHECK(request.http_version_minor == 1);
+    CHECK(request.content == "{}");
+}
+
+TEST_CASE("parse pipelined requests", "[silkrpc][http][request_parser]") {
+    const std::string first{"POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\n[1]"};
+    const std::string second{"POST / HTTP/1.1\r\nContent-Length: 4\r\n\r\n[22]"};
+    const std::string data{first + second};
+    http::RequestParser parser;
+    http::Request request;
+
+    auto [result1, consumed1] = parser.parse(request, data.data(), data.data() + data.size());
+    CHECK(result1 == http::RequestParser::good);
+    CHECK(consumed1 == data.data() + first.size());
+    CHECK(request.content == "[1]");
+
+    request.reset();
+    parser.reset();
+    auto [result2, consumed2] = parser.parse(request, consumed1, data.data() + data.size());
+    CHECK(result2 == http::RequestParser::good);
+    CHECK(consumed2 == data.data() + data.size());
+    CHECK(request.content == "[22]");
+    CHECK(request.headers.size() == 1);
+}
+
+TEST_CASE("parse request split across buffers", "[silkrpc][http][request_parser]") {
+    const std::string data{"POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\n[333]"};
+    http::RequestParser parser;
+    http::Request request;
+
+    const auto* split = data.data() + 20;
+    auto [result1, consumed1] = parser.parse(request, data.data(), split);
+    CHECK(result1 == http::RequestParser::indeterminate);
+    CHECK(consumed1 == split);
+
+    auto [result2, consumed2] = parser.parse(request, split, data.data() + data.size());
+    CHECK(result2 == http::RequestParser::good);
+    CHECK(consumed2 == data.data() + data.size());
+    CHECK(request.content == "[333]");
+}
+
+TEST_CASE("parse phases", "[silkrpc][http][request_parser]") {
+    const std::string data{"POST / HTTP/1.1\r\nContent-Length: 2\r\n\r\n{}"};
+    http::RequestParser parser;
+    http::Request request;
+    CHECK(parser.phase() == http::RequestParser::idle);
+
+    const auto* headers_end = data.data() + data.size() - 2;
+    auto [result1, consumed1] = parser.parse(request, data.data(), data.data() + 4);
+    CHECK(result1 == http::RequestParser::indeterminate);
+    CHECK(parser.phase() == http::RequestParser::headers);
+
+    auto [result2, consumed2] = parser.parse(request, consumed1, headers_end);
+    CHECK(result2 == http::RequestParser::indeterminate);
+    CHECK(parser.phase() == http::RequestParser::content);
+
+    auto [result3, consumed3] = parser.parse(request, consumed2, data.data() + data.size());
+    CHECK(result3 == http::RequestParser::good);
+    parser.reset();
+    CHECK(parser.phase() == http::RequestParser::idle);
+}
+
+TEST_CASE("parse request exceeding max content length", "[silkrpc][http][request_parser]") {
+    const std::string data{"POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\n"};
+    http::Request request;
+
+    SECTION("too large") {
+        http::RequestParser parser{2};
+        const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+        CHECK(result == http::RequestParser::too_large);
+        CHECK(request.content.empty());
+    }
+
+    SECTION("within limit") {
+        http::RequestParser parser{3};
+        const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+        CHECK(result == http::RequestParser::indeterminate);
+        CHECK(parser.phase() == http::RequestParser::content);
+    }
+}
+
+TEST_CASE("parse request byte by byte", "[silkrpc][http][request_parser]") {
+    const std::string data{"POST /path HTTP/1.1\r\nHost: localhost\r\ncontent-length: 4\r\nX-Token: a|b~c\r\n\r\n[{}]"};
+    http::RequestParser parser;
+    http::Request request;
+    for (std::size_t i{0}; i < data.size(); ++i) {
+        const auto [result, consumed] = parser.parse(request, data.data() + i, data.data() + i + 1);
+        CHECK(consumed == data.data() + i + 1);
+        CHECK(result == (i + 1 < data.size() ? http::RequestParser::indeterminate : http::RequestParser::good));
+    }
+    CHECK(request.uri == "/path");
+    CHECK(request.headers.size() == 3);
+    CHECK(request.headers[0].name == "Host");
+    CHECK(request.headers[0].value == "localhost");
+    CHECK(request.headers[2].name == "X-Token");
+    CHECK(request.headers[2].value == "a|b~c");
+    CHECK(request.content_length == 4);
+    CHECK(request.content == "[{}]");
+}
+
+TEST_CASE("parse large content in bulk", "[silkrpc][http][request_parser]") {
+    const std::string content(100 * 1024, 'x');
+    const std::string data{"POST / HTTP/1.1\r\nContent-Length: " + std::to_string(content.size()) + "\r\n\r\n" + content};
+    http::RequestParser parser;
+    http::Request request;
+    const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+    CHECK(result == http::RequestParser::good);
+    CHECK(consumed == data.data() + data.size());
+    CHECK(request.content == content);
+}
+
+TEST_CASE("parse request with invalid content length", "[silkrpc][http][request_parser]") {
+    http::RequestParser parser;
+    http::Request request;
+
+    SECTION("missing") {
+        const std::string data{"POST / HTTP/1.1\r\nHost: localhost\r\n\r\n"};
+        const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+        CHECK(result == http::RequestParser::bad);
+    }
+
+    SECTION("missing on body-less request") {
+        const std::string data{"GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n\r\n"};
+        const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+        CHECK(result == http::RequestParser::good);
+        CHECK(consumed == data.data() + data.size());
+        CHECK(request.method == "GET");
+        CHECK(request.content_length == 0);
+        CHECK(request.content.empty());
+    }
+
+    SECTION("not a number") {
+        const std::string data{"POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n"};
+        const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+        CHECK(result == http::RequestParser::bad);
+    }
+}
+
+TEST_CASE("parse request with invalid characters", "[silkrpc][http][request_parser]") {
+    http::RequestParser parser;
+    http::Request request;
+
+    SECTION("control in uri") {
+        const std::string data{"POST /\x01 HTTP/1.1\r\n"};
+        const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+        CHECK(result == http::RequestParser::bad);
+    }
+
+    SECTION("tspecial in header name") {
+        const std::string data{"POST / HTTP/1.1\r\nContent(Length: 2\r\n"};
+        const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+        CHECK(result == http::RequestParser::bad);
+    }
+
+    SECTION("control in header value") {
+        const std::string data{"POST / HTTP/1.1\r\nContent-Length: 2\x7f\r\n"};
+        const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+        CHECK(result == http::RequestParser::bad);
+    }
+}
+
+TEST_CASE("parse bad request", "[silkrpc][http][request_parser]") {
+    const std::string data{"POST / HTTX/1.1\r\n\r\n"};
+    http::RequestParser parser;
+    http::Request request;
+    const auto [result, consumed] = parser.parse(request, data.data(), data.data() + data.size());
+    CHECK(result == http::RequestParser::bad);
+    CHECK(consumed != data.data() + data.size());
+}
+
 } // namespace silkrpc
 
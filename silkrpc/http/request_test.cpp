@@ -22,5 +22,37 @@ namespace silkrpc {
 
 using Catch::Matchers::Message;
 
+TEST_CASE("keep alive for HTTP/1.1", "[silkrpc][http][request]") {
+    http::Request request{"POST", "/", 1, 1, {}, 0, ""};
+    CHECK(request.keep_alive());
+    request.headers.emplace_back(http::Header{"Connection", "keep-alive"});
+    CHECK(request.keep_alive());
+    request.headers[0] = http::Header{"connection", "Close"};
+    CHECK(!request.keep_alive());
+}
+
+TEST_CASE("keep alive for HTTP/1.0", "[silkrpc][http][request]") {
+    http::Request request{"POST", "/", 1, 0, {}, 0, ""};
+    CHECK(!request.keep_alive());
+    request.headers.emplace_back(http::Header{"Connection", "Keep-Alive"});
+    CHECK(request.keep_alive());
+}
+
+TEST_CASE("header value", "[silkrpc][http][request]") {
+    http::Request request{"POST", "/", 1, 1, {http::Header{"Accept-Encoding", "gzip"}}, 0, ""};
+    CHECK(request.header_value("accept-encoding") == "gzip");
+    CHECK(request.header_value("Content-Type").empty());
+}
+
+TEST_CASE("reset request", "[silkrpc][http][request]") {
+    http::Request request{"POST", "/", 1, 1, {http::Header{"Content-Length", "2"}}, 2, "{}"};
+    request.reset();
+    CHECK(request.method.empty());
+    CHECK(request.uri.empty());
+    CHECK(request.headers.empty());
+    CHECK(request.content_length == 0);
+    CHECK(request.content.empty());
+}
+
 } // namespace silkrpc
 
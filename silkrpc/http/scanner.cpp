@@ -0,0 +1,251 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "scanner.hpp"
+
+#include <array>
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SILKRPC_HTTP_SCANNER_X86_64
+#include <immintrin.h>
+#endif
+
+namespace silkrpc::http::scanner {
+
+constexpr uint8_t kMaxCtl{0x1F};
+constexpr uint8_t kMaxCtlOrSpace{0x20};
+constexpr uint8_t kDel{0x7F};
+
+static constexpr std::array<bool, 256> make_token_table() {
+    std::array<bool, 256> table{};
+    for (int c{0x21}; c < 0x7F; ++c) {
+        table[c] = true;
+    }
+    for (const char c : {'(', ')', '<', '>', '@', ',', ';', ':', '\\', '"', '/', '[', ']', '?', '=', '{', '}'}) {
+        table[static_cast<uint8_t>(c)] = false;
+    }
+    return table;
+}
+
+static constexpr std::array<bool, 256> kTokenTable{make_token_table()};
+
+bool is_token(char c) {
+    return kTokenTable[static_cast<uint8_t>(c)];
+}
+
+static inline const char* find_le_or_del(const char* begin, const char* end, uint8_t max) {
+    for (; begin != end; ++begin) {
+        const auto c = static_cast<uint8_t>(*begin);
+        if (c <= max || c == kDel) {
+            break;
+        }
+    }
+    return begin;
+}
+
+namespace scalar {
+
+const char* find_ctl(const char* begin, const char* end) {
+    return find_le_or_del(begin, end, kMaxCtl);
+}
+
+const char* find_ctl_or_space(const char* begin, const char* end) {
+    return find_le_or_del(begin, end, kMaxCtlOrSpace);
+}
+
+const char* find_non_token(const char* begin, const char* end) {
+    for (; begin != end; ++begin) {
+        if (!is_token(*begin)) {
+            break;
+        }
+    }
+    return begin;
+}
+
+const char* find_quote_or_backslash(const char* begin, const char* end) {
+    for (; begin != end; ++begin) {
+        if (*begin == '"' || *begin == '\\') {
+            break;
+        }
+    }
+    return begin;
+}
+
+} // namespace scalar
+
+#ifdef SILKRPC_HTTP_SCANNER_X86_64
+
+// SSE2 is part of the x86-64 baseline, so this is always available
+static const char* find_le_or_del_sse2(const char* begin, const char* end, uint8_t max) {
+    const __m128i max_v = _mm_set1_epi8(static_cast<char>(max));
+    const __m128i del_v = _mm_set1_epi8(static_cast<char>(kDel));
+    while (end - begin >= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        const __m128i le = _mm_cmpeq_epi8(_mm_min_epu8(v, max_v), v);
+        const __m128i del = _mm_cmpeq_epi8(v, del_v);
+        const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(le, del)));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    return find_le_or_del(begin, end, max);
+}
+
+__attribute__((target("avx2")))
+static const char* find_le_or_del_avx2(const char* begin, const char* end, uint8_t max) {
+    const __m256i max_v = _mm256_set1_epi8(static_cast<char>(max));
+    const __m256i del_v = _mm256_set1_epi8(static_cast<char>(kDel));
+    while (end - begin >= 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        const __m256i le = _mm256_cmpeq_epi8(_mm256_min_epu8(v, max_v), v);
+        const __m256i del = _mm256_cmpeq_epi8(v, del_v);
+        const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(le, del)));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    return find_le_or_del_sse2(begin, end, max);
+}
+
+static const char* find_quote_or_backslash_sse2(const char* begin, const char* end) {
+    const __m128i quote_v = _mm_set1_epi8('"');
+    const __m128i backslash_v = _mm_set1_epi8('\\');
+    while (end - begin >= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        const __m128i match = _mm_or_si128(_mm_cmpeq_epi8(v, quote_v), _mm_cmpeq_epi8(v, backslash_v));
+        const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(match));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    return scalar::find_quote_or_backslash(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char* find_quote_or_backslash_avx2(const char* begin, const char* end) {
+    const __m256i quote_v = _mm256_set1_epi8('"');
+    const __m256i backslash_v = _mm256_set1_epi8('\\');
+    while (end - begin >= 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        const __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote_v), _mm256_cmpeq_epi8(v, backslash_v));
+        const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(match));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    return find_quote_or_backslash_sse2(begin, end);
+}
+
+// The byte ranges [0x00-0x20] '"' '(' ')' ',' '/' [':'-'@'] ['['-']'] ['{'-0xFF] contain all the non-token characters,
+// plus the token characters '|' and '~' which are false positives handled by the caller
+__attribute__((target("sse4.2")))
+static const char* find_non_token_candidate_sse42(const char* begin, const char* end) {
+    alignas(16) static const char ranges[16] = {
+        '\x00', ' ', '"', '"', '(', ')', ',', ',', '/', '/', ':', '@', '[', ']', '{', '\xFF'
+    };
+    const __m128i ranges_v = _mm_load_si128(reinterpret_cast<const __m128i*>(ranges));
+    while (end - begin >= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        const int index = _mm_cmpestri(ranges_v, 16, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (index != 16) {
+            return begin + index;
+        }
+        begin += 16;
+    }
+    return scalar::find_non_token(begin, end);
+}
+
+__attribute__((target("sse4.2")))
+static const char* find_non_token_sse42(const char* begin, const char* end) {
+    while (true) {
+        begin = find_non_token_candidate_sse42(begin, end);
+        if (begin == end || !is_token(*begin)) {
+            return begin;
+        }
+        ++begin;
+    }
+}
+
+enum class InstructionSet { scalar, sse2, sse42, avx2 };
+
+static InstructionSet detect_instruction_set() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2")) {
+        return InstructionSet::avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return InstructionSet::sse42;
+    }
+    return InstructionSet::sse2;
+}
+
+static const InstructionSet kInstructionSet{detect_instruction_set()};
+
+const char* find_ctl(const char* begin, const char* end) {
+    return kInstructionSet == InstructionSet::avx2 ? find_le_or_del_avx2(begin, end, kMaxCtl) : find_le_or_del_sse2(begin, end, kMaxCtl);
+}
+
+const char* find_ctl_or_space(const char* begin, const char* end) {
+    return kInstructionSet == InstructionSet::avx2 ? find_le_or_del_avx2(begin, end, kMaxCtlOrSpace) : find_le_or_del_sse2(begin, end, kMaxCtlOrSpace);
+}
+
+const char* find_non_token(const char* begin, const char* end) {
+    return kInstructionSet == InstructionSet::sse2 ? scalar::find_non_token(begin, end) : find_non_token_sse42(begin, end);
+}
+
+const char* find_quote_or_backslash(const char* begin, const char* end) {
+    return kInstructionSet == InstructionSet::avx2 ? find_quote_or_backslash_avx2(begin, end) : find_quote_or_backslash_sse2(begin, end);
+}
+
+const char* instruction_set() {
+    switch (kInstructionSet) {
+        case InstructionSet::avx2: return "avx2";
+        case InstructionSet::sse42: return "sse4.2";
+        case InstructionSet::sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+#else
+
+const char* find_ctl(const char* begin, const char* end) {
+    return scalar::find_ctl(begin, end);
+}
+
+const char* find_ctl_or_space(const char* begin, const char* end) {
+    return scalar::find_ctl_or_space(begin, end);
+}
+
+const char* find_non_token(const char* begin, const char* end) {
+    return scalar::find_non_token(begin, end);
+}
+
+const char* find_quote_or_backslash(const char* begin, const char* end) {
+    return scalar::find_quote_or_backslash(begin, end);
+}
+
+const char* instruction_set() {
+    return "scalar";
+}
+
+#endif // SILKRPC_HTTP_SCANNER_X86_64
+
+} // namespace silkrpc::http::scanner
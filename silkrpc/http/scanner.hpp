@@ -0,0 +1,55 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_SCANNER_HPP_
+#define SILKRPC_HTTP_SCANNER_HPP_
+
+namespace silkrpc::http::scanner {
+
+/// Find the first HTTP control character (i.e. 0-31 or 127) in [begin, end), return end if none.
+const char* find_ctl(const char* begin, const char* end);
+
+/// Find the first HTTP control character or space in [begin, end), return end if none.
+const char* find_ctl_or_space(const char* begin, const char* end);
+
+/// Find the first character which is not an HTTP token character (i.e. control, tspecial or non-ASCII) in [begin, end), return end if none.
+const char* find_non_token(const char* begin, const char* end);
+
+/// Find the first quote or backslash in [begin, end), i.e. the end of a JSON string or an escape within it, return end if none.
+const char* find_quote_or_backslash(const char* begin, const char* end);
+
+/// Check if a byte is an HTTP token character.
+bool is_token(char c);
+
+/// The SIMD instruction set used by the scanner, selected at startup from the CPU capabilities.
+const char* instruction_set();
+
+/// Reference scalar implementations, always available.
+namespace scalar {
+
+const char* find_ctl(const char* begin, const char* end);
+
+const char* find_ctl_or_space(const char* begin, const char* end);
+
+const char* find_non_token(const char* begin, const char* end);
+
+const char* find_quote_or_backslash(const char* begin, const char* end);
+
+} // namespace scalar
+
+} // namespace silkrpc::http::scanner
+
+#endif // SILKRPC_HTTP_SCANNER_HPP_
@@ -0,0 +1,78 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "scanner.hpp"
+
+#include <random>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc {
+
+using Catch::Matchers::Message;
+
+TEST_CASE("find control characters", "[silkrpc][http][scanner]") {
+    const std::string data{"application/json; charset=utf-8 with a long value\r\n"};
+    const auto* end = data.data() + data.size();
+    CHECK(http::scanner::find_ctl(data.data(), end) == data.data() + data.find('\r'));
+    CHECK(http::scanner::find_ctl_or_space(data.data(), end) == data.data() + data.find(' '));
+    CHECK(http::scanner::find_ctl(data.data(), data.data()) == data.data());
+
+    const std::string del{"0123456789abcdef0123456789abcdef0123\x7f"};
+    CHECK(http::scanner::find_ctl(del.data(), del.data() + del.size()) == del.data() + del.size() - 1);
+}
+
+TEST_CASE("find non-token characters", "[silkrpc][http][scanner]") {
+    const std::string data{"X-Very-Long-Header-Name|With~Tokens: value"};
+    const auto* end = data.data() + data.size();
+    CHECK(http::scanner::find_non_token(data.data(), end) == data.data() + data.find(':'));
+    CHECK(http::scanner::is_token('|'));
+    CHECK(!http::scanner::is_token('{'));
+    CHECK(!http::scanner::is_token('\x80'));
+}
+
+TEST_CASE("find JSON string delimiters", "[silkrpc][http][scanner]") {
+    const std::string data{R"(0x0000000000000000000000000000000000000000", "name\u0041")"};
+    const auto* end = data.data() + data.size();
+    CHECK(http::scanner::find_quote_or_backslash(data.data(), end) == data.data() + 42);
+    CHECK(http::scanner::find_quote_or_backslash(data.data() + 47, end) == data.data() + data.find('\\'));
+    CHECK(http::scanner::find_quote_or_backslash(data.data(), data.data() + 42) == data.data() + 42);
+}
+
+TEST_CASE("SIMD scanner matches scalar scanner", "[silkrpc][http][scanner]") {
+    INFO("instruction set: " << http::scanner::instruction_set());
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> byte{0, 255};
+    std::uniform_int_distribution<int> printable{0x21, 0x7E};
+    for (int i{0}; i < 1000; ++i) {
+        std::string data(static_cast<std::size_t>(i % 97), '\0');
+        for (auto& c : data) {
+            c = static_cast<char>(printable(generator));
+        }
+        if (!data.empty() && i % 2 == 0) {
+            data[static_cast<std::size_t>(byte(generator)) % data.size()] = static_cast<char>(byte(generator));
+        }
+        const auto* begin = data.data();
+        const auto* end = data.data() + data.size();
+        CHECK(http::scanner::find_ctl(begin, end) == http::scanner::scalar::find_ctl(begin, end));
+        CHECK(http::scanner::find_ctl_or_space(begin, end) == http::scanner::scalar::find_ctl_or_space(begin, end));
+        CHECK(http::scanner::find_non_token(begin, end) == http::scanner::scalar::find_non_token(begin, end));
+        CHECK(http::scanner::find_quote_or_backslash(begin, end) == http::scanner::scalar::find_quote_or_backslash(begin, end));
+    }
+}
+
+} // namespace silkrpc
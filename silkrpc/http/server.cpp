@@ -23,6 +23,7 @@
 #include "server.hpp"
 
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
 
@@ -35,51 +36,101 @@
 
 namespace silkrpc::http {
 
-Server::Server(const std::string& address, const std::string& port, ContextPool& context_pool, std::size_t num_workers)
-: context_pool_(context_pool), acceptor_{context_pool.get_io_context()}, workers_{num_workers} {
-    // Open the acceptor with the option to reuse the address (i.e. SO_REUSEADDR).
-    asio::ip::tcp::resolver resolver{acceptor_.get_executor()};
+#ifdef SO_REUSEPORT
+using reuse_port = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+Server::Server(const std::string& address, const std::string& port, ContextPool& context_pool, std::size_t num_workers,
+    const ServerSettings& settings, subscription::Broker* broker)
+: context_pool_(context_pool), workers_{num_workers}, settings_{settings}, broker_(broker),
+  global_admission_{AdmissionLimits{settings.max_in_flight, settings.max_queue_depth}}, connection_registry_{settings.max_connections} {
+    const AdmissionLimits context_limits{settings.max_context_in_flight, settings.max_context_queue_depth, settings.max_context_heavy_in_flight};
+    for (std::size_t i{0}; i < context_pool.num_contexts(); ++i) {
+        auto& context = context_pool.get_context(i);
+        context_states_.emplace(&context, ContextState{
+            std::make_unique<AdmissionControl>(*context.io_context, context_limits, global_admission_),
+            std::make_unique<ReadBufferPool>(),
+            std::make_unique<ChunkPool>(),
+            settings.coalesce_requests ? std::make_unique<SingleFlight>(*context.io_context) : nullptr
+        });
+    }
+
+    asio::ip::tcp::resolver resolver{context_pool.get_io_context()};
     asio::ip::tcp::endpoint endpoint = *resolver.resolve(address, port).begin();
-    acceptor_.open(endpoint.protocol());
-    acceptor_.set_option(asio::ip::tcp::acceptor::reuse_address(true));
-    acceptor_.bind(endpoint);
+
+    if (settings_.reuse_port) {
+#ifdef SO_REUSEPORT
+        // Each context accepts connections on its own io_context, the kernel spreads them across the acceptors
+        for (std::size_t i{0}; i < context_pool.num_contexts(); ++i) {
+            acceptors_.push_back(make_acceptor(*context_pool.get_context(i).io_context, endpoint));
+        }
+#else
+        throw std::runtime_error{"SO_REUSEPORT is not supported on this platform"};
+#endif
+    } else {
+        acceptors_.push_back(make_acceptor(context_pool.get_io_context(), endpoint));
+    }
+}
+
+std::unique_ptr<asio::ip::tcp::acceptor> Server::make_acceptor(asio::io_context& io_context, const asio::ip::tcp::endpoint& endpoint) {
+    // Open the acceptor with the option to reuse the address (i.e. SO_REUSEADDR) and optionally the port (i.e. SO_REUSEPORT).
+    auto acceptor = std::make_unique<asio::ip::tcp::acceptor>(io_context);
+    acceptor->open(endpoint.protocol());
+    acceptor->set_option(asio::ip::tcp::acceptor::reuse_address(true));
+#ifdef SO_REUSEPORT
+    if (settings_.reuse_port) {
+        acceptor->set_option(reuse_port(true));
+    }
+#endif
+    acceptor->bind(endpoint);
+    // Non-blocking mode is used just by the synchronous accepts following each wakeup, asynchronous ones are unaffected
+    acceptor->non_blocking(true);
+    return acceptor;
 }
 
 void Server::start() {
-    asio::co_spawn(acceptor_.get_executor(), run(), [&](std::exception_ptr eptr) {
-        if (eptr) std::rethrow_exception(eptr);
-    });
+    for (std::size_t i{0}; i < acceptors_.size(); ++i) {
+        auto& acceptor = *acceptors_[i];
+        Context* dedicated_context = settings_.reuse_port ? &context_pool_.get_context(i) : nullptr;
+        asio::co_spawn(acceptor.get_executor(), run(acceptor, dedicated_context), [&](std::exception_ptr eptr) {
+            if (eptr) std::rethrow_exception(eptr);
+        });
+    }
 }
 
-asio::awaitable<void> Server::run() {
-    acceptor_.listen();
+asio::awaitable<void> Server::run(asio::ip::tcp::acceptor& acceptor, Context* dedicated_context) {
+    acceptor.listen();
 
     try {
-        while (acceptor_.is_open()) {
+        while (acceptor.is_open()) {
             // Get the next context to use chosen round-robin, then get both io_context *and* database from it
-            auto& context = context_pool_.get_context();
-            auto& io_context = context.io_context;
+            auto* context = dedicated_context ? dedicated_context : &context_pool_.get_context();
+            auto& io_context = context->io_context;
 
             SILKRPC_DEBUG << "Server::start accepting using io_context " << io_context << "...\n" << std::flush;
 
-            auto new_connection = std::make_shared<Connection>(context, workers_);
-            co_await acceptor_.async_accept(new_connection->socket(), asio::use_awaitable);
-            if (!acceptor_.is_open()) {
+            auto new_connection = make_connection(*context);
+            co_await acceptor.async_accept(new_connection->socket(), asio::use_awaitable);
+            if (!acceptor.is_open()) {
                 SILKRPC_TRACE << "Server::start returning...\n";
                 co_return;
             }
-
-            new_connection->socket().set_option(asio::ip::tcp::socket::keep_alive(true));
-
-            SILKRPC_TRACE << "Server::start starting connection for socket: " << &new_connection->socket() << "\n";
-            auto new_connection_starter = [=]() -> asio::awaitable<void> { co_await new_connection->start(); };
-
-            // https://github.com/chriskohlhoff/asio/issues/552
-            asio::dispatch(*io_context, [=]() mutable {
-                asio::co_spawn(*io_context, new_connection_starter, [&](std::exception_ptr eptr) {
-                    if (eptr) std::rethrow_exception(eptr);
-                });
-            });
+            start_connection(std::move(new_connection), *io_context);
+
+            // Accept the connections already pending without waiting for the next wakeup
+            for (std::size_t i{1}; i < settings_.max_accepts_per_wakeup; ++i) {
+                context = dedicated_context ? dedicated_context : &context_pool_.get_context();
+                new_connection = make_connection(*context);
+                asio::error_code error;
+                acceptor.accept(new_connection->socket(), error);
+                if (error) {
+                    if (error != asio::error::would_block && error != asio::error::try_again) {
+                        SILKRPC_DEBUG << "Server::start accept error: " << error.message() << "\n" << std::flush;
+                    }
+                    break;
+                }
+                start_connection(std::move(new_connection), *context->io_context);
+            }
         }
     } catch (const std::system_error& se) {
         if (se.code() != asio::error::operation_aborted) {
@@ -92,10 +143,48 @@ asio::awaitable<void> Server::run() {
     SILKRPC_DEBUG << "Server::start exiting...\n" << std::flush;
 }
 
+std::shared_ptr<Connection> Server::make_connection(Context& context) {
+    auto& context_state = context_states_.at(&context);
+    return std::make_shared<Connection>(context, workers_, settings_, broker_, context_state.admission_control.get(), &connection_registry_,
+        context_state.read_buffer_pool.get(), context_state.chunk_pool.get(), context_state.single_flight.get());
+}
+
+void Server::start_connection(std::shared_ptr<Connection> new_connection, asio::io_context& io_context) {
+    if (!connection_registry_.add(new_connection.get())) {
+        SILKRPC_WARN << "Server::start connection cap reached with no idle connection, closing socket: " << &new_connection->socket() << "\n";
+        return;
+    }
+    new_connection->socket().set_option(asio::ip::tcp::socket::keep_alive(true));
+
+    SILKRPC_TRACE << "Server::start starting connection for socket: " << &new_connection->socket() << "\n";
+    auto new_connection_starter = [=]() -> asio::awaitable<void> { co_await new_connection->start(); };
+
+    // https://github.com/chriskohlhoff/asio/issues/552
+    asio::dispatch(io_context, [&io_context, new_connection_starter]() mutable {
+        asio::co_spawn(io_context, new_connection_starter, [&](std::exception_ptr eptr) {
+            if (eptr) std::rethrow_exception(eptr);
+        });
+    });
+}
+
 void Server::stop() {
     // The server is stopped by cancelling all outstanding asynchronous operations.
     SILKRPC_DEBUG << "Server::stop started...\n";
-    acceptor_.close();
+    for (auto& acceptor : acceptors_) {
+        acceptor->close();
+    }
+    const auto& counters = global_admission_.counters();
+    SILKRPC_INFO << "Server::stop connections reaped: " << connection_registry_.reaped() << " rejected: " << connection_registry_.rejected() << "\n";
+    SILKRPC_INFO << "Server::stop requests admitted: " << counters.admitted << " fast lane: " << counters.fast_lane << " delayed: " << counters.delayed << " shed: " << counters.shed << "\n";
+    uint64_t executed{0}, coalesced{0}, unshared{0};
+    for (const auto& [_, context_state] : context_states_) {
+        if (context_state.single_flight) {
+            executed += context_state.single_flight->counters().executed;
+            coalesced += context_state.single_flight->counters().coalesced;
+            unshared += context_state.single_flight->counters().unshared;
+        }
+    }
+    SILKRPC_INFO << "Server::stop calls executed: " << executed << " coalesced: " << coalesced << " unshared: " << unshared << "\n";
     SILKRPC_DEBUG << "Server::stop completed\n" << std::flush;
 }
 
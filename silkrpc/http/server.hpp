@@ -24,7 +24,10 @@
 #define SILKRPC_HTTP_SERVER_HPP_
 
 #include <cstddef>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <silkrpc/config.hpp>
 
@@ -33,32 +36,94 @@
 #include <asio/thread_pool.hpp>
 
 #include <silkrpc/context_pool.hpp>
+#include <silkrpc/http/admission_control.hpp>
+#include <silkrpc/http/chunk_buffer.hpp>
+#include <silkrpc/http/connection_registry.hpp>
+#include <silkrpc/http/read_buffer_pool.hpp>
+#include <silkrpc/http/single_flight.hpp>
+#include <silkrpc/http/server_settings.hpp>
+#include <silkrpc/subscription/broker.hpp>
 
 namespace silkrpc::http {
 
+class Connection;
+
 /// The top-level class of the HTTP server.
 class Server {
 public:
     Server(const Server&) = delete;
     Server& operator=(const Server&) = delete;
 
-    // Construct the server to listen on the specified TCP address and port
-    explicit Server(const std::string& address, const std::string& port, ContextPool& context_pool, std::size_t num_workers);
+    // Construct the server to listen on the specified TCP address and port, accepting WebSocket upgrades if a broker is given
+    explicit Server(const std::string& address, const std::string& port, ContextPool& context_pool, std::size_t num_workers,
+        const ServerSettings& settings = {}, subscription::Broker* broker = nullptr);
 
     void start();
 
     void stop();
 
+    /// The counters of the requests admitted and shed by all the contexts.
+    const AdmissionCounters& admission_counters() const { return global_admission_.counters(); }
+
+    const ServerSettings& settings() const { return settings_; }
+
+    /// The pool of workers running the blocking tasks, shared with the other servers on the same contexts (e.g. IPC).
+    asio::thread_pool& workers() { return workers_; }
+
+    /// The admission control of the context, shared with the other servers on the same contexts so that the limits hold for all the requests.
+    AdmissionControl* admission_control(const Context& context) const { return context_states_.at(&context).admission_control.get(); }
+
+    /// The pool of reply chunks of the context, shared with the other servers on the same contexts.
+    ChunkPool* chunk_pool(const Context& context) const { return context_states_.at(&context).chunk_pool.get(); }
+
 private:
-    asio::awaitable<void> run();
+    // Open the acceptor bound to the endpoint on the specified io_context
+    std::unique_ptr<asio::ip::tcp::acceptor> make_acceptor(asio::io_context& io_context, const asio::ip::tcp::endpoint& endpoint);
+
+    // Accept connections and run them on the dedicated context if any, otherwise on contexts chosen round-robin
+    asio::awaitable<void> run(asio::ip::tcp::acceptor& acceptor, Context* dedicated_context);
+
+    // Create a new connection running on the context
+    std::shared_ptr<Connection> make_connection(Context& context);
+
+    // Register the accepted connection and start it on its own io_context, unless the connection cap has been reached
+    void start_connection(std::shared_ptr<Connection> connection, asio::io_context& io_context);
 
     // The context pool used to perform asynchronous operations
     ContextPool& context_pool_;
 
-    // The acceptor used to listen for incoming TCP connections
-    asio::ip::tcp::acceptor acceptor_;
+    // The acceptors used to listen for incoming TCP connections: one for each context with SO_REUSEPORT, just one otherwise
+    std::vector<std::unique_ptr<asio::ip::tcp::acceptor>> acceptors_;
 
     asio::thread_pool workers_;
+
+    // The settings shared by all the connections
+    ServerSettings settings_;
+
+    // The broker of the eth_subscribe subscriptions, if any
+    subscription::Broker* broker_;
+
+    // The admission state enforcing the server-wide limits
+    GlobalAdmission global_admission_;
+
+    // The state of each context shared by its connections
+    struct ContextState {
+        // The admission control enforcing the per-context limits
+        std::unique_ptr<AdmissionControl> admission_control;
+
+        // The read buffers recycled among the connections
+        std::unique_ptr<ReadBufferPool> read_buffer_pool;
+
+        // The reply chunks recycled among the connections
+        std::unique_ptr<ChunkPool> chunk_pool;
+
+        // The identical calls in flight sharing one execution, if coalescing is enabled
+        std::unique_ptr<SingleFlight> single_flight;
+    };
+    std::map<const Context*, ContextState> context_states_;
+
+    // The registry of the open connections enforcing the connection cap
+    ConnectionRegistry connection_registry_;
 };
 
 } // namespace silkrpc::http
@@ -0,0 +1,99 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_SERVER_SETTINGS_HPP_
+#define SILKRPC_HTTP_SERVER_SETTINGS_HPP_
+
+#include <chrono>
+#include <cstddef>
+
+#include <silkrpc/common/constants.hpp>
+#include "method_table.hpp"
+
+namespace silkrpc::http {
+
+/// The tunable parameters of the HTTP server.
+struct ServerSettings {
+    /// The namespaces whose methods are served, the others are answered as not existent
+    ApiNamespaces api_namespaces{kAllApiNamespaces};
+
+    /// The maximum number of requests accepted in one JSON-RPC batch
+    std::size_t max_batch_size{common::kDefaultMaxBatchSize};
+
+    /// Flag indicating if one SO_REUSEPORT acceptor per context is used instead of one shared acceptor
+    bool reuse_port{false};
+
+    /// The maximum number of connections accepted each time an acceptor wakes up
+    std::size_t max_accepts_per_wakeup{common::kDefaultMaxAcceptsPerWakeup};
+
+    /// The maximum number of notifications queued on one WebSocket connection before closing it as too slow
+    std::size_t max_pending_notifications{common::kDefaultMaxPendingNotifications};
+
+    /// The minimum content size of the replies compressed if the client accepts it, zero disables compression
+    std::size_t compression_threshold{common::kDefaultCompressionThreshold};
+
+    /// The size of the content buffered before sending it as one chunk of a streamed reply, zero disables streaming
+    std::size_t stream_buffer_size{common::kDefaultStreamBufferSize};
+
+    /// The maximum number of requests handled concurrently by the whole server, zero means unlimited
+    std::size_t max_in_flight{common::kDefaultMaxInFlight};
+
+    /// The maximum number of requests waiting to be handled by the whole server, zero means unlimited
+    std::size_t max_queue_depth{common::kDefaultMaxQueueDepth};
+
+    /// The maximum number of requests handled concurrently on each context, zero means unlimited
+    std::size_t max_context_in_flight{common::kDefaultMaxContextInFlight};
+
+    /// The maximum number of requests waiting to be handled on each context, zero means unlimited
+    std::size_t max_context_queue_depth{common::kDefaultMaxContextQueueDepth};
+
+    /// The maximum number of heavy requests (e.g. eth_getLogs, eth_call) handled concurrently on each context, zero means unlimited
+    std::size_t max_context_heavy_in_flight{common::kDefaultMaxContextHeavyInFlight};
+
+    /// The delay suggested to the clients whose requests are shed
+    std::chrono::seconds retry_after{common::kDefaultRetryAfter};
+
+    /// The maximum time to receive the request headers from the first byte, zero disables the timeout
+    std::chrono::milliseconds header_read_timeout{common::kDefaultHeaderReadTimeout};
+
+    /// The maximum time to receive the request content after the headers, zero disables the timeout
+    std::chrono::milliseconds body_read_timeout{common::kDefaultBodyReadTimeout};
+
+    /// The maximum time waiting for the next request on a keep-alive connection, zero disables the timeout
+    std::chrono::milliseconds idle_timeout{common::kDefaultIdleTimeout};
+
+    /// The maximum time to write the replies queued together, zero disables the timeout
+    std::chrono::milliseconds write_timeout{common::kDefaultWriteTimeout};
+
+    /// The maximum number of open connections, beyond which the oldest idle ones are closed, zero means unlimited
+    std::size_t max_connections{common::kDefaultMaxConnections};
+
+    /// The maximum size of the request content, larger requests are rejected before reading it, zero means unlimited
+    std::size_t max_body_size{common::kDefaultMaxBodySize};
+
+    /// Flag indicating if the identical read-only calls in flight on the same context share one execution
+    bool coalesce_requests{common::kDefaultCoalesceRequests};
+
+    /// Flag indicating if the clients starting HTTP/2 with prior knowledge (h2c) are served on the same listener
+    bool http2{false};
+
+    /// The maximum number of streams open at the same time on one HTTP/2 connection
+    std::size_t http2_max_concurrent_streams{common::kDefaultHttp2MaxConcurrentStreams};
+};
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_SERVER_SETTINGS_HPP_
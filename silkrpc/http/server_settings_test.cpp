@@ -0,0 +1,51 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "server_settings.hpp"
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc::http {
+
+using Catch::Matchers::Message;
+
+TEST_CASE("default server settings", "[silkrpc][http][server_settings]") {
+    ServerSettings settings;
+    CHECK(settings.api_namespaces == parse_api_namespaces(common::kDefaultApiSpec));
+    CHECK(settings.max_batch_size == common::kDefaultMaxBatchSize);
+    CHECK(!settings.reuse_port);
+    CHECK(settings.max_accepts_per_wakeup == common::kDefaultMaxAcceptsPerWakeup);
+    CHECK(settings.max_pending_notifications == common::kDefaultMaxPendingNotifications);
+    CHECK(settings.compression_threshold == common::kDefaultCompressionThreshold);
+    CHECK(settings.stream_buffer_size == common::kDefaultStreamBufferSize);
+    CHECK(settings.max_in_flight == common::kDefaultMaxInFlight);
+    CHECK(settings.max_queue_depth == common::kDefaultMaxQueueDepth);
+    CHECK(settings.max_context_in_flight == common::kDefaultMaxContextInFlight);
+    CHECK(settings.max_context_queue_depth == common::kDefaultMaxContextQueueDepth);
+    CHECK(settings.max_context_heavy_in_flight == common::kDefaultMaxContextHeavyInFlight);
+    CHECK(settings.retry_after == common::kDefaultRetryAfter);
+    CHECK(settings.header_read_timeout == common::kDefaultHeaderReadTimeout);
+    CHECK(settings.body_read_timeout == common::kDefaultBodyReadTimeout);
+    CHECK(settings.idle_timeout == common::kDefaultIdleTimeout);
+    CHECK(settings.write_timeout == common::kDefaultWriteTimeout);
+    CHECK(settings.max_connections == common::kDefaultMaxConnections);
+    CHECK(settings.max_body_size == common::kDefaultMaxBodySize);
+    CHECK(settings.coalesce_requests == common::kDefaultCoalesceRequests);
+    CHECK(!settings.http2);
+    CHECK(settings.http2_max_concurrent_streams == common::kDefaultHttp2MaxConcurrentStreams);
+}
+
+} // namespace silkrpc::http
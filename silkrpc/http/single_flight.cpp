@@ -0,0 +1,146 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "single_flight.hpp"
+
+#include <string_view>
+#include <utility>
+
+#include <asio/redirect_error.hpp>
+#include <asio/use_awaitable.hpp>
+
+namespace silkrpc::http {
+
+asio::awaitable<std::shared_ptr<const SingleFlight::Result>> SingleFlight::run(const std::string& key, Execute execute) {
+    if (const auto flight_it = flights_.find(key); flight_it != flights_.end()) {
+        // Keep the flight alive while waiting, the executing call removes it from the group when done
+        const auto flight = flight_it->second;
+        asio::error_code error;
+        co_await flight->done.async_wait(asio::redirect_error(asio::use_awaitable, error));
+        if (!flight->shared) {
+            ++counters_.unshared;
+            co_return std::make_shared<const Result>(co_await execute(Unshare{}));
+        }
+        ++counters_.coalesced;
+        if (flight->error) {
+            std::rethrow_exception(flight->error);
+        }
+        co_return flight->result;
+    }
+
+    auto flight = std::make_shared<Flight>(io_context_);
+    flights_.emplace(key, flight);
+    ++counters_.executed;
+    // Once unshared, the flight leaves the group and the calls waiting for it are woken up to execute on their own
+    const auto unshare = [&]() {
+        if (flight->shared) {
+            flight->shared = false;
+            flights_.erase(key);
+            flight->done.cancel();
+        }
+    };
+    try {
+        flight->result = std::make_shared<const Result>(co_await execute(unshare));
+    } catch (...) {
+        flight->error = std::current_exception();
+    }
+    if (flight->shared) {
+        flights_.erase(key);
+        flight->done.cancel();
+    }
+    if (flight->error) {
+        std::rethrow_exception(flight->error);
+    }
+    co_return flight->result;
+}
+
+std::string SingleFlight::key_of(std::string_view method, std::string_view params) {
+    std::string key;
+    key.reserve(method.size() + 1 + params.size());
+    key.append(method);
+    key.push_back('\0');
+    bool in_string{false};
+    bool escaped{false};
+    for (const char c : params) {
+        if (in_string) {
+            in_string = escaped || c != '"';
+            escaped = !escaped && c == '\\';
+        } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            continue;
+        } else {
+            in_string = c == '"';
+        }
+        key.push_back(c);
+    }
+    return key;
+}
+
+std::string SingleFlight::make_reply(uint32_t id, const Result& result) {
+    // The id member goes first, as it does in the serialized successful replies whose members are sorted
+    std::string reply{"{\"id\":"};
+    reply += std::to_string(id);
+    if (result.content.size() > 2) {
+        reply.push_back(',');
+    }
+    reply.append(result.content, 1);
+    return reply;
+}
+
+asio::awaitable<void> RecordingStreamWriter::write(std::string_view content) {
+    if (!overflowed_ && content_.size() + content.size() > max_size_) {
+        overflowed_ = true;
+        std::string{}.swap(content_);
+        if (unshare_) {
+            unshare_();
+        }
+    }
+    if (!overflowed_) {
+        content_.append(content);
+    }
+    co_await writer_.write(content);
+}
+
+bool RecordingStreamWriter::discard() {
+    content_.clear();
+    if (!writer_.discard()) {
+        aborted_ = true;
+        return false;
+    }
+    return true;
+}
+
+SingleFlight::Result RecordingStreamWriter::result(uint32_t id) {
+    if (overflowed_) {
+        return {Reply::internal_server_error, R"({"error":{"code":100,"message":"streamed reply not recorded"},"jsonrpc":"2.0"})"};
+    }
+    while (!content_.empty() && content_.back() == '\n') {
+        content_.pop_back();
+    }
+    // The successful replies are streamed with the id member first, like the serialized ones whose members are sorted
+    const auto id_member = "{\"id\":" + std::to_string(id) + ",";
+    if (!aborted_ && content_.starts_with(id_member)) {
+        content_.replace(0, id_member.size(), "{");
+        return {Reply::ok, std::move(content_)};
+    }
+    auto reply_json = nlohmann::json::parse(content_, nullptr, /*allow_exceptions=*/false);
+    if (aborted_ || !reply_json.is_object()) {
+        return {Reply::internal_server_error, R"({"error":{"code":100,"message":"streamed reply aborted"},"jsonrpc":"2.0"})"};
+    }
+    reply_json.erase("id");
+    return {Reply::ok, reply_json.dump()};
+}
+
+} // namespace silkrpc::http
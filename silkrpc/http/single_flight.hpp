@@ -0,0 +1,141 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_SINGLE_FLIGHT_HPP_
+#define SILKRPC_HTTP_SINGLE_FLIGHT_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <silkrpc/config.hpp>
+
+#include <asio/awaitable.hpp>
+#include <asio/io_context.hpp>
+#include <asio/steady_timer.hpp>
+#include <nlohmann/json.hpp>
+
+#include <silkrpc/json/stream_writer.hpp>
+#include "reply.hpp"
+
+namespace silkrpc::http {
+
+/// The counters of the coalescing decisions, which can be read from any thread.
+struct SingleFlightCounters {
+    /// The number of calls actually executed
+    std::atomic<uint64_t> executed{0};
+
+    /// The number of calls sharing the result of an identical call already in flight
+    std::atomic<uint64_t> coalesced{0};
+
+    /// The number of calls executed on their own because the identical call they joined stopped sharing its result
+    std::atomic<uint64_t> unshared{0};
+};
+
+/// The group of the calls in flight on one context: identical calls arriving while one is being executed wait for it
+/// and share its serialized result. It must be used just on the context io_context.
+class SingleFlight {
+public:
+    /// The outcome of one call, i.e. the reply status and the serialized reply object without the id member.
+    struct Result {
+        Reply::StatusType status;
+        std::string content;
+    };
+
+    /// Stop sharing the result of the executing call, e.g. when too large to be kept: the calls waiting for it are executed
+    /// on their own, the calls arriving later start a new flight. It is empty for the calls whose result is not shared.
+    typedef std::function<void()> Unshare;
+
+    typedef std::function<asio::awaitable<Result>(const Unshare& unshare)> Execute;
+
+    explicit SingleFlight(asio::io_context& io_context) : io_context_(io_context) {}
+
+    SingleFlight(const SingleFlight&) = delete;
+    SingleFlight& operator=(const SingleFlight&) = delete;
+
+    /// Get the result of the call identified by key, either executing it or waiting for the identical one in flight.
+    asio::awaitable<std::shared_ptr<const Result>> run(const std::string& key, Execute execute);
+
+    /// Check if the call identified by key is in flight.
+    bool contains(const std::string& key) const { return flights_.find(key) != flights_.end(); }
+
+    /// Get the number of distinct calls in flight.
+    std::size_t size() const { return flights_.size(); }
+
+    const SingleFlightCounters& counters() const { return counters_; }
+
+    /// Get the key identifying the request by method and JSON text of the parameters, ignoring the whitespace between tokens.
+    static std::string key_of(std::string_view method, std::string_view params);
+
+    /// Serialize the shared result into a reply to the request having the given id.
+    static std::string make_reply(uint32_t id, const Result& result);
+
+private:
+    struct Flight {
+        explicit Flight(asio::io_context& io_context) : done{io_context, asio::steady_timer::time_point::max()} {}
+
+        asio::steady_timer done;
+        std::shared_ptr<const Result> result;
+        std::exception_ptr error;
+        bool shared{true};
+    };
+
+    asio::io_context& io_context_;
+    std::map<std::string, std::shared_ptr<Flight>> flights_;
+    SingleFlightCounters counters_;
+};
+
+/// Writer forwarding the content of a streamed reply to the destination writer while recording it, so that the calls
+/// joining the streamed one can share its result. The recording stops as soon as it would exceed the maximum size, then
+/// the result is unshared: a large reply is held just by the destination writer, as if it were not coalesced.
+class RecordingStreamWriter : public StreamWriter {
+public:
+    static constexpr std::size_t kDefaultMaxSize{1024 * 1024};
+
+    explicit RecordingStreamWriter(StreamWriter& writer, SingleFlight::Unshare unshare = {}, std::size_t max_size = kDefaultMaxSize)
+    : writer_(writer), unshare_(std::move(unshare)), max_size_{max_size} {}
+
+    asio::awaitable<void> write(std::string_view content) override;
+
+    bool discard() override;
+
+    /// Check if the recording has been stopped because too large.
+    bool overflowed() const { return overflowed_; }
+
+    std::size_t recorded_size() const { return content_.size(); }
+
+    /// Take the result recorded for the call having the given id, an error if the streamed reply has been aborted or
+    /// not recorded because too large.
+    SingleFlight::Result result(uint32_t id);
+
+private:
+    StreamWriter& writer_;
+    SingleFlight::Unshare unshare_;
+    std::size_t max_size_;
+    std::string content_;
+    bool aborted_{false};
+    bool overflowed_{false};
+};
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_SINGLE_FLIGHT_HPP_
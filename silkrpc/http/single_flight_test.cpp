@@ -0,0 +1,250 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "single_flight.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <asio/co_spawn.hpp>
+#include <asio/redirect_error.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asio/use_future.hpp>
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+namespace silkrpc::http {
+
+using namespace std::chrono_literals;
+
+TEST_CASE("SingleFlight::run coalesces identical calls", "[silkrpc][http][single_flight]") {
+    asio::io_context io_context;
+    SingleFlight single_flight{io_context};
+    asio::steady_timer gate{io_context, asio::steady_timer::time_point::max()};
+    int executions{0};
+    auto execute = [&](const SingleFlight::Unshare&) -> asio::awaitable<SingleFlight::Result> {
+        ++executions;
+        asio::error_code error;
+        co_await gate.async_wait(asio::redirect_error(asio::use_awaitable, error));
+        co_return SingleFlight::Result{Reply::ok, R"({"jsonrpc":"2.0","result":"0x1"})"};
+    };
+
+    auto result1 = asio::co_spawn(io_context, single_flight.run("k", execute), asio::use_future);
+    auto result2 = asio::co_spawn(io_context, single_flight.run("k", execute), asio::use_future);
+    auto result3 = asio::co_spawn(io_context, single_flight.run("j", execute), asio::use_future);
+    io_context.poll();
+    CHECK(result1.wait_for(0s) == std::future_status::timeout);
+    CHECK(result2.wait_for(0s) == std::future_status::timeout);
+    CHECK(single_flight.contains("k"));
+    CHECK(single_flight.size() == 2);
+    CHECK(executions == 2);
+
+    gate.cancel();
+    io_context.poll();
+    const auto shared1 = result1.get();
+    const auto shared2 = result2.get();
+    CHECK(shared1 == shared2);
+    CHECK(shared1->content == R"({"jsonrpc":"2.0","result":"0x1"})");
+    CHECK(result3.get() != shared1);
+    CHECK(single_flight.size() == 0);
+    CHECK(single_flight.counters().executed == 2);
+    CHECK(single_flight.counters().coalesced == 1);
+}
+
+TEST_CASE("SingleFlight::run shares the failure", "[silkrpc][http][single_flight]") {
+    asio::io_context io_context;
+    SingleFlight single_flight{io_context};
+    asio::steady_timer gate{io_context, asio::steady_timer::time_point::max()};
+    auto execute = [&](const SingleFlight::Unshare&) -> asio::awaitable<SingleFlight::Result> {
+        asio::error_code error;
+        co_await gate.async_wait(asio::redirect_error(asio::use_awaitable, error));
+        throw std::runtime_error{"failed"};
+    };
+
+    auto result1 = asio::co_spawn(io_context, single_flight.run("k", execute), asio::use_future);
+    auto result2 = asio::co_spawn(io_context, single_flight.run("k", execute), asio::use_future);
+    io_context.poll();
+    gate.cancel();
+    io_context.poll();
+    CHECK_THROWS_AS(result1.get(), std::runtime_error);
+    CHECK_THROWS_AS(result2.get(), std::runtime_error);
+    CHECK(!single_flight.contains("k"));
+}
+
+TEST_CASE("SingleFlight::run executes the calls waiting for an unshared result", "[silkrpc][http][single_flight]") {
+    asio::io_context io_context;
+    SingleFlight single_flight{io_context};
+    asio::steady_timer gate{io_context, asio::steady_timer::time_point::max()};
+    int executions{0};
+    int unshared_executions{0};
+    SingleFlight::Unshare unshare;
+    auto execute = [&](const SingleFlight::Unshare& flight_unshare) -> asio::awaitable<SingleFlight::Result> {
+        ++executions;
+        if (!flight_unshare) {
+            ++unshared_executions;
+            co_return SingleFlight::Result{Reply::ok, R"({"jsonrpc":"2.0","result":"0x2"})"};
+        }
+        unshare = flight_unshare;
+        asio::error_code error;
+        co_await gate.async_wait(asio::redirect_error(asio::use_awaitable, error));
+        co_return SingleFlight::Result{Reply::ok, R"({"jsonrpc":"2.0","result":"0x1"})"};
+    };
+
+    auto result1 = asio::co_spawn(io_context, single_flight.run("k", execute), asio::use_future);
+    auto result2 = asio::co_spawn(io_context, single_flight.run("k", execute), asio::use_future);
+    io_context.poll();
+    CHECK(executions == 1);
+
+    // The waiting call is executed on its own, while the unshared one leaves the group
+    unshare();
+    io_context.poll();
+    CHECK(!single_flight.contains("k"));
+    CHECK(unshared_executions == 1);
+    CHECK(result2.get()->content == R"({"jsonrpc":"2.0","result":"0x2"})");
+
+    // The identical calls arriving later start a new flight
+    auto result3 = asio::co_spawn(io_context, single_flight.run("k", execute), asio::use_future);
+    io_context.poll();
+    CHECK(single_flight.contains("k"));
+    CHECK(executions == 3);
+
+    gate.cancel();
+    io_context.poll();
+    CHECK(result1.get()->content == R"({"jsonrpc":"2.0","result":"0x1"})");
+    CHECK(result3.get()->content == R"({"jsonrpc":"2.0","result":"0x1"})");
+    CHECK(single_flight.size() == 0);
+    CHECK(single_flight.counters().executed == 2);
+    CHECK(single_flight.counters().coalesced == 0);
+    CHECK(single_flight.counters().unshared == 1);
+}
+
+TEST_CASE("SingleFlight::key_of", "[silkrpc][http][single_flight]") {
+    const auto key1 = SingleFlight::key_of("eth_getLogs", R"([{"fromBlock":"0x1","toBlock":"0x2"}])");
+    const auto key2 = SingleFlight::key_of("eth_getLogs", "[ {\"fromBlock\": \"0x1\",\n\t\"toBlock\": \"0x2\"} ]");
+    const auto key3 = SingleFlight::key_of("eth_getLogs", R"([{"fromBlock":"0x1","toBlock":"0x3"}])");
+    CHECK(key1 == key2);
+    CHECK(key1 != key3);
+    CHECK(key1 != SingleFlight::key_of("eth_getLogs", R"([{"toBlock":"0x2","fromBlock":"0x1"}])"));
+    CHECK(SingleFlight::key_of("m", R"(["a b"])") != SingleFlight::key_of("m", R"(["ab"])"));
+    CHECK(SingleFlight::key_of("m", R"(["a\" b"])") != SingleFlight::key_of("m", R"(["a\"b"])"));
+    CHECK(SingleFlight::key_of("eth_blockNumber", "") == std::string{"eth_blockNumber\0", 16});
+}
+
+TEST_CASE("SingleFlight::make_reply", "[silkrpc][http][single_flight]") {
+    const auto reply_json = R"({"jsonrpc":"2.0","id":42,"result":{"number":"0x1"}})"_json;
+    auto result_json = reply_json;
+    result_json.erase("id");
+    const SingleFlight::Result result{Reply::ok, result_json.dump()};
+    CHECK(SingleFlight::make_reply(42, result) == reply_json.dump());
+    CHECK(SingleFlight::make_reply(3, SingleFlight::Result{Reply::ok, "{}"}) == R"({"id":3})");
+}
+
+/// Writer keeping the written content, which is sent once the given size is reached.
+class StringStreamWriter : public StreamWriter {
+public:
+    explicit StringStreamWriter(std::size_t send_size = SIZE_MAX) : send_size_{send_size} {}
+
+    asio::awaitable<void> write(std::string_view content) override {
+        content_.append(content);
+        sent_ = sent_ || content_.size() >= send_size_;
+        co_return;
+    }
+
+    bool discard() override {
+        if (sent_) {
+            return false;
+        }
+        content_.clear();
+        return true;
+    }
+
+    const std::string& content() const { return content_; }
+
+private:
+    std::size_t send_size_;
+    std::string content_;
+    bool sent_{false};
+};
+
+TEST_CASE("RecordingStreamWriter::result", "[silkrpc][http][single_flight]") {
+    asio::io_context io_context;
+    const auto write = [&](StreamWriter& writer, std::string_view content) {
+        auto result = asio::co_spawn(io_context, writer.write(content), asio::use_future);
+        io_context.run();
+        io_context.restart();
+        result.get();
+    };
+
+    SECTION("streamed content") {
+        StringStreamWriter writer;
+        RecordingStreamWriter recording_writer{writer};
+        write(recording_writer, R"({"id":7,"jsonrpc":"2.0","result":[)");
+        write(recording_writer, R"({"address":"0x1"}]})");
+        write(recording_writer, "\n");
+        CHECK(writer.content() == "{\"id\":7,\"jsonrpc\":\"2.0\",\"result\":[{\"address\":\"0x1\"}]}\n");
+        const auto result = recording_writer.result(7);
+        CHECK(result.status == Reply::ok);
+        CHECK(result.content == R"({"jsonrpc":"2.0","result":[{"address":"0x1"}]})");
+        CHECK(SingleFlight::make_reply(8, result) == R"({"id":8,"jsonrpc":"2.0","result":[{"address":"0x1"}]})");
+    }
+
+    SECTION("error replacing the discarded content") {
+        StringStreamWriter writer;
+        RecordingStreamWriter recording_writer{writer};
+        write(recording_writer, R"({"id":7,"jsonrpc":"2.0","result":[)");
+        CHECK(recording_writer.discard());
+        write(recording_writer, R"({"error":{"code":100,"message":"failed"},"id":7,"jsonrpc":"2.0"})" "\n");
+        const auto result = recording_writer.result(7);
+        CHECK(result.status == Reply::ok);
+        CHECK(nlohmann::json::parse(result.content) == R"({"error":{"code":100,"message":"failed"},"jsonrpc":"2.0"})"_json);
+    }
+
+    SECTION("large content not recorded") {
+        StringStreamWriter writer;
+        int unshared{0};
+        RecordingStreamWriter recording_writer{writer, [&]() { ++unshared; }, 64};
+        const std::string log{R"({"address":"0x0000000000000000000000000000000000000001"},)"};
+        write(recording_writer, R"({"id":7,"jsonrpc":"2.0","result":[)");
+        CHECK(recording_writer.recorded_size() > 0);
+        for (int i{0}; i < 1000; ++i) {
+            write(recording_writer, log);
+            CHECK(recording_writer.recorded_size() <= 64);
+        }
+        write(recording_writer, "]}\n");
+        CHECK(recording_writer.overflowed());
+        CHECK(recording_writer.recorded_size() == 0);
+        CHECK(unshared == 1);
+        CHECK(writer.content().size() == 34 + 1000 * log.size() + 3);
+        const auto result = recording_writer.result(7);
+        CHECK(result.status == Reply::internal_server_error);
+    }
+
+    SECTION("aborted transfer") {
+        StringStreamWriter writer{1};
+        RecordingStreamWriter recording_writer{writer};
+        write(recording_writer, R"({"id":7,"jsonrpc":"2.0","result":[)");
+        CHECK(!recording_writer.discard());
+        const auto result = recording_writer.result(7);
+        CHECK(result.status == Reply::internal_server_error);
+        CHECK(nlohmann::json::parse(result.content)["error"]["code"] == 100);
+    }
+}
+
+} // namespace silkrpc::http
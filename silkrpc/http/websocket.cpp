@@ -0,0 +1,263 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "websocket.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/match.h>
+#include <absl/strings/str_split.h>
+
+namespace silkrpc::http::websocket {
+
+bool is_upgrade_request(const Request& request) {
+    if (request.method != "GET" || !absl::EqualsIgnoreCase(request.header_value("Upgrade"), "websocket")) {
+        return false;
+    }
+    // Connection is a comma-separated list of tokens, e.g. "keep-alive, Upgrade"
+    bool connection_upgrade{false};
+    for (const auto token : absl::StrSplit(request.header_value("Connection"), ',')) {
+        if (absl::EqualsIgnoreCase(absl::StripAsciiWhitespace(token), "upgrade")) {
+            connection_upgrade = true;
+            break;
+        }
+    }
+    return connection_upgrade && !request.header_value("Sec-WebSocket-Key").empty();
+}
+
+std::string compute_accept_key(absl::string_view key) {
+    std::string input{key.data(), key.size()};
+    input.append(kAcceptGuid);
+    const auto digest = sha1(input);
+    return base64_encode(digest.data(), digest.size());
+}
+
+std::array<uint8_t, 20> sha1(absl::string_view data) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    // Padding: 0x80, zeros up to 56 mod 64, then the message length in bits as 64-bit big-endian
+    std::string message{data.data(), data.size()};
+    const uint64_t bit_length = static_cast<uint64_t>(data.size()) * 8;
+    message.push_back(static_cast<char>(0x80));
+    while (message.size() % 64 != 56) {
+        message.push_back('\0');
+    }
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        message.push_back(static_cast<char>(bit_length >> shift));
+    }
+
+    const auto rotl = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+    uint32_t w[80];
+    for (std::size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(message.data() + chunk);
+        for (int i = 0; i < 16; ++i) {
+            w[i] = uint32_t{bytes[4*i]} << 24 | uint32_t{bytes[4*i + 1]} << 16 | uint32_t{bytes[4*i + 2]} << 8 | uint32_t{bytes[4*i + 3]};
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            const uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest;
+    for (int i = 0; i < 20; ++i) {
+        digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+    }
+    return digest;
+}
+
+std::string base64_encode(const uint8_t* data, std::size_t size) {
+    static constexpr const char* kAlphabet{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+
+    std::string encoded;
+    encoded.reserve((size + 2) / 3 * 4);
+    std::size_t i{0};
+    for (; i + 2 < size; i += 3) {
+        const uint32_t triple = uint32_t{data[i]} << 16 | uint32_t{data[i + 1]} << 8 | uint32_t{data[i + 2]};
+        encoded.push_back(kAlphabet[(triple >> 18) & 0x3F]);
+        encoded.push_back(kAlphabet[(triple >> 12) & 0x3F]);
+        encoded.push_back(kAlphabet[(triple >> 6) & 0x3F]);
+        encoded.push_back(kAlphabet[triple & 0x3F]);
+    }
+    if (i < size) {
+        const uint32_t triple = uint32_t{data[i]} << 16 | (i + 1 < size ? uint32_t{data[i + 1]} << 8 : 0);
+        encoded.push_back(kAlphabet[(triple >> 18) & 0x3F]);
+        encoded.push_back(kAlphabet[(triple >> 12) & 0x3F]);
+        encoded.push_back(i + 1 < size ? kAlphabet[(triple >> 6) & 0x3F] : '=');
+        encoded.push_back('=');
+    }
+    return encoded;
+}
+
+std::string encode_frame_header(Opcode opcode, std::size_t payload_size) {
+    std::string header;
+    header.push_back(static_cast<char>(0x80 | opcode));
+    if (payload_size < 126) {
+        header.push_back(static_cast<char>(payload_size));
+    } else if (payload_size <= 0xFFFF) {
+        header.push_back(static_cast<char>(126));
+        header.push_back(static_cast<char>(payload_size >> 8));
+        header.push_back(static_cast<char>(payload_size));
+    } else {
+        header.push_back(static_cast<char>(127));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            header.push_back(static_cast<char>(static_cast<uint64_t>(payload_size) >> shift));
+        }
+    }
+    return header;
+}
+
+FrameParser::FrameParser() : state_(header_opcode) {
+}
+
+void FrameParser::reset() {
+    state_ = header_opcode;
+    extended_length_size_ = 0;
+    bytes_needed_ = 0;
+    payload_length_ = 0;
+}
+
+std::tuple<FrameParser::ResultType, const char*> FrameParser::parse(Frame& frame, const char* begin, const char* end) {
+    while (begin != end) {
+        if (state_ == payload) {
+            // The payload is copied and unmasked in bulk
+            const auto offset = frame.payload.size();
+            const auto count = std::min(static_cast<uint64_t>(end - begin), payload_length_ - offset);
+            frame.payload.append(begin, count);
+            unmask(frame.payload.data() + offset, count, offset);
+            begin += count;
+            if (frame.payload.size() == payload_length_) {
+                return std::make_tuple(good, begin);
+            }
+            continue;
+        }
+
+        const auto input = static_cast<uint8_t>(*begin++);
+        switch (state_) {
+            case header_opcode: {
+                frame.fin = (input & 0x80) != 0;
+                frame.opcode = static_cast<Opcode>(input & 0x0F);
+                // No extension is negotiated, so reserved bits must be zero
+                if ((input & 0x70) != 0) {
+                    return std::make_tuple(bad, begin);
+                }
+                const auto op = frame.opcode;
+                if (op != continuation && op != text && op != binary && op != close && op != ping && op != pong) {
+                    return std::make_tuple(bad, begin);
+                }
+                state_ = header_length;
+                break;
+            }
+            case header_length: {
+                // Client frames must be masked [RFC 6455 5.1]
+                if ((input & 0x80) == 0) {
+                    return std::make_tuple(bad, begin);
+                }
+                const uint8_t length = input & 0x7F;
+                // Control frames must not be fragmented and their payload must not exceed 125 bytes [RFC 6455 5.5]
+                if (frame.is_control() && (!frame.fin || length > 125)) {
+                    return std::make_tuple(bad, begin);
+                }
+                payload_length_ = 0;
+                if (length == 126 || length == 127) {
+                    extended_length_size_ = length == 126 ? 2 : 8;
+                    bytes_needed_ = extended_length_size_;
+                    state_ = extended_length;
+                } else {
+                    payload_length_ = length;
+                    bytes_needed_ = masking_key_.size();
+                    state_ = masking_key;
+                }
+                break;
+            }
+            case extended_length:
+                payload_length_ = (payload_length_ << 8) | input;
+                if (--bytes_needed_ == 0) {
+                    if (payload_length_ > kMaxMessageSize) {
+                        return std::make_tuple(bad, begin);
+                    }
+                    bytes_needed_ = masking_key_.size();
+                    state_ = masking_key;
+                }
+                break;
+            case masking_key:
+                masking_key_[masking_key_.size() - bytes_needed_] = input;
+                if (--bytes_needed_ == 0) {
+                    state_ = payload;
+                    frame.payload.reserve(payload_length_);
+                    if (payload_length_ == 0) {
+                        return std::make_tuple(good, begin);
+                    }
+                }
+                break;
+            default:
+                return std::make_tuple(bad, begin);
+        }
+    }
+    return std::make_tuple(indeterminate, begin);
+}
+
+void FrameParser::unmask(char* data, std::size_t size, std::size_t offset) const {
+    // XOR eight bytes at a time using the masking key repeated and aligned to the payload offset
+    uint8_t rotated_key[8];
+    for (std::size_t i = 0; i < sizeof(rotated_key); ++i) {
+        rotated_key[i] = masking_key_[(offset + i) % 4];
+    }
+    uint64_t mask64;
+    std::memcpy(&mask64, rotated_key, sizeof(mask64));
+
+    std::size_t i{0};
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        word ^= mask64;
+        std::memcpy(data + i, &word, sizeof(word));
+    }
+    for (; i < size; ++i) {
+        data[i] = static_cast<char>(data[i] ^ rotated_key[i % 4]);
+    }
+}
+
+} // namespace silkrpc::http::websocket
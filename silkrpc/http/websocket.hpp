@@ -0,0 +1,116 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_WEBSOCKET_HPP_
+#define SILKRPC_HTTP_WEBSOCKET_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+
+#include <absl/strings/string_view.h>
+
+#include "request.hpp"
+
+namespace silkrpc::http::websocket {
+
+/// The maximum size of one (possibly fragmented) incoming message.
+constexpr std::size_t kMaxMessageSize{16 * 1024 * 1024};
+
+/// The GUID appended to the client key to compute the accept key [RFC 6455 1.3].
+constexpr const char* kAcceptGuid{"258EAFA5-E914-47DA-95CA-C5AB0DC85B11"};
+
+/// The frame opcodes [RFC 6455 5.2].
+enum Opcode : uint8_t {
+    continuation = 0x0,
+    text = 0x1,
+    binary = 0x2,
+    close = 0x8,
+    ping = 0x9,
+    pong = 0xA
+};
+
+/// Check if the request asks to upgrade the connection to the WebSocket protocol.
+bool is_upgrade_request(const Request& request);
+
+/// Compute the Sec-WebSocket-Accept value corresponding to the Sec-WebSocket-Key value.
+std::string compute_accept_key(absl::string_view key);
+
+/// Compute the SHA-1 digest of the data.
+std::array<uint8_t, 20> sha1(absl::string_view data);
+
+/// Encode the data in base64 with padding.
+std::string base64_encode(const uint8_t* data, std::size_t size);
+
+/// Render the header of an unfragmented and unmasked server frame.
+std::string encode_frame_header(Opcode opcode, std::size_t payload_size);
+
+/// A frame received from a client, with payload already unmasked.
+struct Frame {
+    bool fin{false};
+    Opcode opcode{continuation};
+    std::string payload;
+
+    void reset() {
+        fin = false;
+        opcode = continuation;
+        payload.clear();
+    }
+
+    bool is_control() const { return (opcode & 0x8) != 0; }
+};
+
+/// Incremental parser for the frames received from a client.
+class FrameParser {
+public:
+    /// Construct ready to parse the frame header.
+    FrameParser();
+
+    /// Reset to initial parser state.
+    void reset();
+
+    /// Result of parse.
+    enum ResultType { good, bad, indeterminate };
+
+    /// Parse some data. The enum return value is good when a complete frame has been parsed, bad if the
+    /// data is invalid (e.g. unmasked or oversized frame), indeterminate when more data is required.
+    /// The pointer return value indicates how much of the input has been consumed.
+    std::tuple<ResultType, const char*> parse(Frame& frame, const char* begin, const char* end);
+
+private:
+    /// Unmask in place the payload bytes starting at the given offset.
+    void unmask(char* data, std::size_t size, std::size_t offset) const;
+
+    /// The current state of the parser.
+    enum State {
+        header_opcode,
+        header_length,
+        extended_length,
+        masking_key,
+        payload
+    } state_;
+
+    std::size_t extended_length_size_{0};
+    std::size_t bytes_needed_{0};
+    uint64_t payload_length_{0};
+    std::array<uint8_t, 4> masking_key_{};
+};
+
+} // namespace silkrpc::http::websocket
+
+#endif // SILKRPC_HTTP_WEBSOCKET_HPP_
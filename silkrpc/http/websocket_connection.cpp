@@ -0,0 +1,335 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "websocket_connection.hpp"
+
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/post.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asio/write.hpp>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/json/types.hpp>
+#include <silkrpc/types/filter.hpp>
+#include "methods.hpp"
+#include "reply.hpp"
+
+namespace silkrpc::http {
+
+/// The close frame payloads carrying the status codes [RFC 6455 7.4.1].
+constexpr std::string_view kCloseProtocolError{"\x03\xEA", 2};
+constexpr std::string_view kCloseMessageTooBig{"\x03\xF1", 2};
+
+void WebSocketConnection::Message::append_to(std::vector<asio::const_buffer>& buffers) const {
+    buffers.push_back(asio::buffer(header));
+    if (!content.empty()) {
+        buffers.push_back(asio::buffer(content));
+    }
+    body.append_to(buffers);
+    if (result) {
+        buffers.push_back(asio::buffer(*result));
+    }
+    if (!suffix.empty()) {
+        buffers.push_back(asio::buffer(suffix));
+    }
+}
+
+WebSocketConnection::WebSocketConnection(asio::ip::tcp::socket&& socket, Context& context, asio::thread_pool& workers,
+    const ServerSettings& settings, subscription::Broker& broker, AdmissionControl* admission_control, SingleFlight* single_flight,
+    ChunkPool* chunk_pool)
+: socket_{std::move(socket)}, chunk_pool_{chunk_pool}, request_handler_{context, workers, settings.max_batch_size, admission_control, settings.retry_after, single_flight, settings.api_namespaces},
+  max_pending_notifications_{settings.max_pending_notifications}, broker_(broker) {
+    SILKRPC_DEBUG << "WebSocketConnection::WebSocketConnection socket " << &socket_ << " created\n";
+}
+
+WebSocketConnection::~WebSocketConnection() {
+    broker_.unsubscribe_all(this);
+    std::error_code ec;
+    socket_.close(ec);
+    SILKRPC_DEBUG << "WebSocketConnection::~WebSocketConnection socket " << &socket_ << " deleted\n";
+}
+
+asio::awaitable<void> WebSocketConnection::start(const Request& upgrade_request, const char* begin, const char* end) {
+    // The data following the upgrade request belongs to the HTTP connection buffer, so it must be saved first
+    const std::string initial_data{begin, end};
+    try {
+        if (upgrade_request.header_value("Sec-WebSocket-Version") != "13") {
+            const std::string response{"HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"};
+            co_await asio::async_write(socket_, asio::buffer(response), asio::use_awaitable);
+            close();
+            co_return;
+        }
+
+        const auto accept_key = websocket::compute_accept_key(upgrade_request.header_value("Sec-WebSocket-Key"));
+        const std::string response{"HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " + accept_key + "\r\n\r\n"};
+        co_await asio::async_write(socket_, asio::buffer(response), asio::use_awaitable);
+        SILKRPC_DEBUG << "WebSocketConnection::start handshake completed for socket " << &socket_ << "\n";
+
+        if (co_await handle_data(initial_data.data(), initial_data.data() + initial_data.size())) {
+            co_await do_read();
+        }
+    } catch (const std::system_error& se) {
+        if (se.code() == asio::error::eof || se.code() == asio::error::connection_reset || se.code() == asio::error::broken_pipe) {
+            SILKRPC_DEBUG << "WebSocketConnection::start close from client with code: " << se.code() << "\n" << std::flush;
+        } else if (se.code() != asio::error::operation_aborted) {
+            SILKRPC_ERROR << "WebSocketConnection::start system_error: " << se.what() << "\n" << std::flush;
+        }
+    }
+    // No more notifications once the client has gone, pending writes (e.g. the close frame) keep the connection alive
+    broker_.unsubscribe_all(this);
+    subscriptions_.clear();
+}
+
+void WebSocketConnection::notify(const std::string& subscription_id, std::shared_ptr<const std::string> result) {
+    asio::post(socket_.get_executor(), [self = shared_from_this(), subscription_id, result = std::move(result)]() {
+        if (self->closed_) {
+            return;
+        }
+        // Backpressure: a client which does not keep up with the notifications is disconnected
+        if (self->pending_notifications_ >= self->max_pending_notifications_) {
+            SILKRPC_WARN << "WebSocketConnection::notify too many pending notifications: " << self->pending_notifications_
+                << ", closing socket: " << &self->socket_ << "\n";
+            self->close();
+            return;
+        }
+        Message message;
+        message.notification = true;
+        message.content = R"({"jsonrpc":"2.0","method":"eth_subscription","params":{"subscription":")" + subscription_id + R"(","result":)";
+        message.result = result;
+        message.suffix = "}}";
+        message.header = websocket::encode_frame_header(websocket::text, message.content.size() + result->size() + message.suffix.size());
+        ++self->pending_notifications_;
+        self->enqueue_message(std::move(message));
+    });
+}
+
+asio::awaitable<void> WebSocketConnection::do_read() {
+    while (true) {
+        SILKRPC_DEBUG << "WebSocketConnection::do_read going to read...\n" << std::flush;
+        std::size_t bytes_read = co_await socket_.async_read_some(asio::buffer(buffer_), asio::use_awaitable);
+        SILKRPC_DEBUG << "WebSocketConnection::do_read bytes_read: " << bytes_read << "\n";
+        if (!co_await handle_data(buffer_.data(), buffer_.data() + bytes_read)) {
+            break;
+        }
+    }
+}
+
+asio::awaitable<bool> WebSocketConnection::handle_data(const char* begin, const char* end) {
+    while (begin != end) {
+        websocket::FrameParser::ResultType result;
+        std::tie(result, begin) = frame_parser_.parse(frame_, begin, end);
+        if (result == websocket::FrameParser::indeterminate) {
+            break;
+        }
+        if (result == websocket::FrameParser::bad) {
+            SILKRPC_DEBUG << "WebSocketConnection::handle_data bad frame, closing socket: " << &socket_ << "\n";
+            close_after_write_ = true;
+            enqueue_frame(websocket::close, std::string{kCloseProtocolError});
+            co_return false;
+        }
+        frame_parser_.reset();
+
+        switch (frame_.opcode) {
+            case websocket::ping:
+                enqueue_frame(websocket::pong, std::move(frame_.payload));
+                break;
+            case websocket::pong:
+                break;
+            case websocket::close:
+                // Echo the status code, if any, then close after writing [RFC 6455 5.5.1]
+                close_after_write_ = true;
+                enqueue_frame(websocket::close, frame_.payload.substr(0, 2));
+                co_return false;
+            case websocket::text:
+            case websocket::binary:
+            case websocket::continuation: {
+                const bool continuation = frame_.opcode == websocket::continuation;
+                if (continuation != fragmented_) {
+                    close_after_write_ = true;
+                    enqueue_frame(websocket::close, std::string{kCloseProtocolError});
+                    co_return false;
+                }
+                if (continuation) {
+                    message_.append(frame_.payload);
+                } else {
+                    message_ = std::move(frame_.payload);
+                }
+                if (message_.size() > websocket::kMaxMessageSize) {
+                    close_after_write_ = true;
+                    enqueue_frame(websocket::close, std::string{kCloseMessageTooBig});
+                    co_return false;
+                }
+                fragmented_ = !frame_.fin;
+                if (frame_.fin) {
+                    co_await handle_message(message_);
+                    message_.clear();
+                }
+                break;
+            }
+        }
+        frame_.reset();
+    }
+    co_return true;
+}
+
+asio::awaitable<void> WebSocketConnection::handle_message(const std::string& message) {
+    SILKRPC_TRACE << "WebSocketConnection::handle_message message: " << message << "\n";
+    Message reply_message;
+    nlohmann::json reply_json;
+    if (handle_subscription_request(message, reply_json)) {
+        reply_message.content = reply_json.dump() + "\n";
+    } else {
+        Request request;
+        request.method = "POST";
+        request.content = message;
+        Reply reply;
+        reply.body = ChunkBuffer{chunk_pool_};
+        co_await request_handler_.handle_request(request, reply);
+        reply_message.content = std::move(reply.content);
+        reply_message.body = std::move(reply.body);
+    }
+    if (reply_message.content.empty() && reply_message.body.empty()) {
+        co_return;
+    }
+    reply_message.header = websocket::encode_frame_header(websocket::text, reply_message.content.size() + reply_message.body.size());
+    enqueue_message(std::move(reply_message));
+}
+
+bool WebSocketConnection::handle_subscription_request(const std::string& message, nlohmann::json& reply_json) {
+    // Avoid parsing twice the requests which are surely handled by the request handler
+    if (message.find(method::k_eth_subscribe) == std::string::npos && message.find(method::k_eth_unsubscribe) == std::string::npos) {
+        return false;
+    }
+    const auto request_json = nlohmann::json::parse(message, nullptr, /*allow_exceptions=*/false);
+    if (!request_json.is_object() || !request_json.contains("method") || !request_json["method"].is_string()) {
+        return false;
+    }
+    const auto method = request_json["method"].get<std::string>();
+    if (method != method::k_eth_subscribe && method != method::k_eth_unsubscribe) {
+        return false;
+    }
+
+    uint32_t request_id{0};
+    try {
+        request_id = request_json["id"].get<uint32_t>();
+        const auto& params = request_json.at("params");
+        if (!params.is_array() || params.empty()) {
+            throw std::invalid_argument{"invalid " + method + " params: " + params.dump()};
+        }
+        if (method == method::k_eth_subscribe) {
+            const auto name = params[0].get<std::string>();
+            std::string subscription_id;
+            if (name == "newHeads") {
+                subscription_id = broker_.subscribe(weak_from_this(), subscription::Kind::new_heads);
+            } else if (name == "logs") {
+                const auto filter = params.size() > 1 ? params[1].get<Filter>() : Filter{};
+                subscription_id = broker_.subscribe(weak_from_this(), subscription::Kind::logs, filter);
+            } else {
+                throw std::invalid_argument{"unsupported subscription: " + name};
+            }
+            subscriptions_.insert(subscription_id);
+            reply_json = make_json_content(request_id, subscription_id);
+        } else {
+            const auto subscription_id = params[0].get<std::string>();
+            const bool removed = subscriptions_.erase(subscription_id) > 0 && broker_.unsubscribe(subscription_id);
+            reply_json = make_json_content(request_id, removed);
+        }
+    } catch (const std::exception& e) {
+        SILKRPC_ERROR << "WebSocketConnection::handle_subscription_request exception: " << e.what() << "\n";
+        reply_json = make_json_error(request_id, 100, e.what());
+    }
+    return true;
+}
+
+void WebSocketConnection::enqueue_frame(websocket::Opcode opcode, std::string payload) {
+    Message message;
+    message.header = websocket::encode_frame_header(opcode, payload.size());
+    message.content = std::move(payload);
+    enqueue_message(std::move(message));
+}
+
+void WebSocketConnection::enqueue_message(Message&& message) {
+    messages_.push_back(std::move(message));
+
+    if (!writing_) {
+        writing_ = true;
+        // The writer keeps this connection alive until all queued messages have been written
+        asio::co_spawn(socket_.get_executor(), [self = shared_from_this()]() { return self->do_write(); }, asio::detached);
+    }
+}
+
+asio::awaitable<void> WebSocketConnection::do_write() {
+    try {
+        std::vector<Message> messages;
+        std::vector<asio::const_buffer> buffers;
+        while (!messages_.empty() && !closed_) {
+            messages.clear();
+            messages.reserve(messages_.size());
+            std::move(messages_.begin(), messages_.end(), std::back_inserter(messages));
+            messages_.clear();
+
+            buffers.clear();
+            for (const auto& message : messages) {
+                message.append_to(buffers);
+            }
+            const auto bytes_transferred = co_await asio::async_write(socket_, buffers, asio::use_awaitable);
+            SILKRPC_TRACE << "WebSocketConnection::do_write messages: " << messages.size() << " bytes_transferred: " << bytes_transferred << "\n";
+            for (const auto& message : messages) {
+                if (message.notification) {
+                    --pending_notifications_;
+                }
+            }
+        }
+        writing_ = false;
+
+        if (close_after_write_) {
+            SILKRPC_DEBUG << "WebSocketConnection::do_write closing socket: " << &socket_ << "\n" << std::flush;
+            std::error_code ec;
+            socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+            close();
+        }
+    } catch (const std::system_error& se) {
+        writing_ = false;
+        if (se.code() != asio::error::operation_aborted) {
+            SILKRPC_DEBUG << "WebSocketConnection::do_write system_error: " << se.what() << "\n" << std::flush;
+        }
+        close();
+    }
+}
+
+void WebSocketConnection::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    messages_.clear();
+    broker_.unsubscribe_all(this);
+    subscriptions_.clear();
+    // Closing the socket cancels any pending read, so that the connection is released
+    std::error_code ec;
+    socket_.close(ec);
+}
+
+} // namespace silkrpc::http
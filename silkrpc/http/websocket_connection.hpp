@@ -0,0 +1,148 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_HTTP_WEBSOCKET_CONNECTION_HPP_
+#define SILKRPC_HTTP_WEBSOCKET_CONNECTION_HPP_
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <silkrpc/config.hpp>
+
+#include <asio/awaitable.hpp>
+#include <asio/buffer.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/thread_pool.hpp>
+#include <nlohmann/json.hpp>
+
+#include <silkrpc/context_pool.hpp>
+#include <silkrpc/subscription/broker.hpp>
+#include "admission_control.hpp"
+#include "chunk_buffer.hpp"
+#include "request.hpp"
+#include "request_handler.hpp"
+#include "server_settings.hpp"
+#include "single_flight.hpp"
+#include "websocket.hpp"
+
+namespace silkrpc::http {
+
+/// Represents a connection from a client upgraded to the WebSocket protocol: each text message is handled
+/// as a JSON-RPC request, eth_subscribe notifications are pushed as they are published by the broker.
+class WebSocketConnection : public std::enable_shared_from_this<WebSocketConnection>, public subscription::Subscriber {
+public:
+    WebSocketConnection(const WebSocketConnection&) = delete;
+    WebSocketConnection& operator=(const WebSocketConnection&) = delete;
+
+    /// Construct a connection taking over the socket of the HTTP connection which received the upgrade request.
+    /// The reply chunks are taken from the pool of the context, if any.
+    explicit WebSocketConnection(asio::ip::tcp::socket&& socket, Context& context, asio::thread_pool& workers,
+        const ServerSettings& settings, subscription::Broker& broker, AdmissionControl* admission_control = nullptr,
+        SingleFlight* single_flight = nullptr, ChunkPool* chunk_pool = nullptr);
+
+    ~WebSocketConnection();
+
+    /// Complete the opening handshake, then handle the incoming frames starting from the data already received.
+    asio::awaitable<void> start(const Request& upgrade_request, const char* begin, const char* end);
+
+    /// Queue the notification for writing on the connection executor, can be called from any thread.
+    void notify(const std::string& subscription_id, std::shared_ptr<const std::string> result) override;
+
+    std::size_t num_pending_notifications() const { return pending_notifications_; }
+
+private:
+    /// An outgoing frame, made of header, content and shared result which are sent in one gathered write.
+    struct Message {
+        std::string header;
+        std::string content;
+        ChunkBuffer body;
+        std::shared_ptr<const std::string> result;
+        std::string suffix;
+        bool notification{false};
+
+        void append_to(std::vector<asio::const_buffer>& buffers) const;
+    };
+
+    /// Handle the frames contained in the data, returning false when the connection must be closed.
+    asio::awaitable<bool> handle_data(const char* begin, const char* end);
+
+    /// Handle the complete text message as a JSON-RPC request.
+    asio::awaitable<void> handle_message(const std::string& message);
+
+    /// Handle eth_subscribe and eth_unsubscribe locally, returning false if the request is not one of them.
+    bool handle_subscription_request(const std::string& message, nlohmann::json& reply_json);
+
+    /// Perform asynchronous read operations until the client or the server closes the connection.
+    asio::awaitable<void> do_read();
+
+    /// Perform asynchronous gathered write operations until the queued messages are exhausted.
+    asio::awaitable<void> do_write();
+
+    /// Queue the payload as one unfragmented frame.
+    void enqueue_frame(websocket::Opcode opcode, std::string payload);
+
+    /// Queue the message for writing and start the writer if idle.
+    void enqueue_message(Message&& message);
+
+    /// Close the connection cancelling any pending operation.
+    void close();
+
+    asio::ip::tcp::socket socket_;
+
+    ChunkPool* chunk_pool_;
+
+    RequestHandler request_handler_;
+
+    /// The maximum number of notifications queued before closing the connection as too slow.
+    std::size_t max_pending_notifications_;
+
+    subscription::Broker& broker_;
+
+    /// The subscriptions created by this connection, the only ones it can remove.
+    std::set<std::string> subscriptions_;
+
+    std::array<char, 8192> buffer_;
+
+    websocket::FrameParser frame_parser_;
+
+    websocket::Frame frame_;
+
+    /// The message being assembled from fragmented frames.
+    std::string message_;
+
+    /// Flag indicating if a fragmented message is being assembled.
+    bool fragmented_{false};
+
+    std::deque<Message> messages_;
+
+    /// The number of notifications queued but not yet written.
+    std::size_t pending_notifications_{0};
+
+    bool writing_{false};
+
+    bool close_after_write_{false};
+
+    bool closed_{false};
+};
+
+} // namespace silkrpc::http
+
+#endif // SILKRPC_HTTP_WEBSOCKET_CONNECTION_HPP_
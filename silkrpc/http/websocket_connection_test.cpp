@@ -0,0 +1,128 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "websocket_connection.hpp"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <asio/buffer.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/address_v4.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/read.hpp>
+#include <asio/read_until.hpp>
+#include <asio/thread_pool.hpp>
+#include <asio/write.hpp>
+#include <catch2/catch.hpp>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/context_pool.hpp>
+#include <silkrpc/subscription/broker.hpp>
+#include "connection.hpp"
+#include "server_settings.hpp"
+
+namespace silkrpc::http {
+
+using Catch::Matchers::Message;
+
+// Build a masked client frame with a short payload
+static std::string make_client_frame(websocket::Opcode opcode, const std::string& payload) {
+    const std::array<uint8_t, 4> key{0x37, 0xfa, 0x21, 0x3d};
+    std::string frame;
+    frame.push_back(static_cast<char>(0x80 | opcode));
+    frame.push_back(static_cast<char>(0x80 | payload.size()));
+    frame.append(key.begin(), key.end());
+    for (std::size_t i{0}; i < payload.size(); ++i) {
+        frame.push_back(static_cast<char>(payload[i] ^ key[i % 4]));
+    }
+    return frame;
+}
+
+// Read one unmasked server frame with a short payload
+static std::string read_server_frame(asio::ip::tcp::socket& client, websocket::Opcode& opcode) {
+    std::array<uint8_t, 2> header{};
+    asio::read(client, asio::buffer(header));
+    opcode = static_cast<websocket::Opcode>(header[0] & 0x0F);
+    std::string payload(header[1] & 0x7F, '\0');
+    asio::read(client, asio::buffer(payload));
+    return payload;
+}
+
+TEST_CASE("upgrade HTTP connection to WebSocket", "[silkrpc][http][websocket_connection]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    // Declared first, so that they outlive the connections destroyed together with the io_context
+    ServerSettings settings;
+    subscription::Broker broker;
+    asio::thread_pool workers{1};
+    Context context;
+    context.io_context = std::make_shared<asio::io_context>();
+
+    asio::ip::tcp::acceptor acceptor{*context.io_context, asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), 0}};
+    asio::ip::tcp::socket client{*context.io_context};
+    client.connect(acceptor.local_endpoint());
+    auto connection = std::make_shared<Connection>(context, workers, settings, &broker);
+    acceptor.accept(connection->socket());
+    asio::co_spawn(*context.io_context, [connection]() { return connection->start(); }, asio::detached);
+    connection.reset();
+    std::thread io_thread{[&]() { context.io_context->run(); }};
+
+    // The upgrade request is a GET without Content-Length, it must reach the upgrade instead of being rejected
+    const std::string upgrade_request_head{"GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"};
+    std::string response;
+
+    SECTION("handshake completed") {
+        asio::write(client, asio::buffer(upgrade_request_head + "Sec-WebSocket-Version: 13\r\n\r\n"));
+        const auto head_size = asio::read_until(client, asio::dynamic_buffer(response), "\r\n\r\n");
+        const auto head = response.substr(0, head_size);
+        CHECK(head.starts_with("HTTP/1.1 101 Switching Protocols\r\n"));
+        CHECK(head.find("Upgrade: websocket\r\n") != std::string::npos);
+        CHECK(head.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n") != std::string::npos);
+        CHECK(response.size() == head_size);
+
+        websocket::Opcode opcode{websocket::continuation};
+        asio::write(client, asio::buffer(make_client_frame(websocket::ping, "hi")));
+        CHECK(read_server_frame(client, opcode) == "hi");
+        CHECK(opcode == websocket::pong);
+
+        asio::write(client, asio::buffer(make_client_frame(websocket::close, std::string{"\x03\xE8", 2})));
+        CHECK(read_server_frame(client, opcode) == std::string{"\x03\xE8", 2});
+        CHECK(opcode == websocket::close);
+
+        std::array<char, 1> byte{};
+        std::error_code ec;
+        asio::read(client, asio::buffer(byte), ec);
+        CHECK(ec == asio::error::eof);
+    }
+
+    SECTION("unsupported version") {
+        asio::write(client, asio::buffer(upgrade_request_head + "Sec-WebSocket-Version: 8\r\n\r\n"));
+        asio::read_until(client, asio::dynamic_buffer(response), "\r\n\r\n");
+        CHECK(response.starts_with("HTTP/1.1 426 Upgrade Required\r\n"));
+        CHECK(response.find("Sec-WebSocket-Version: 13\r\n") != std::string::npos);
+    }
+
+    context.io_context->stop();
+    io_thread.join();
+}
+
+} // namespace silkrpc::http
@@ -0,0 +1,198 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "websocket.hpp"
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc::http::websocket {
+
+using Catch::Matchers::Message;
+
+// Build a masked client frame with the given first byte
+static std::string make_client_frame(uint8_t first_byte, const std::string& payload, const std::array<uint8_t, 4>& key = {0x37, 0xfa, 0x21, 0x3d}) {
+    std::string frame;
+    frame.push_back(static_cast<char>(first_byte));
+    if (payload.size() < 126) {
+        frame.push_back(static_cast<char>(0x80 | payload.size()));
+    } else if (payload.size() <= 0xFFFF) {
+        frame.push_back(static_cast<char>(0x80 | 126));
+        frame.push_back(static_cast<char>(payload.size() >> 8));
+        frame.push_back(static_cast<char>(payload.size()));
+    } else {
+        frame.push_back(static_cast<char>(0x80 | 127));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame.push_back(static_cast<char>(static_cast<uint64_t>(payload.size()) >> shift));
+        }
+    }
+    frame.append(key.begin(), key.end());
+    for (std::size_t i{0}; i < payload.size(); ++i) {
+        frame.push_back(static_cast<char>(payload[i] ^ key[i % 4]));
+    }
+    return frame;
+}
+
+TEST_CASE("is_upgrade_request", "[silkrpc][http][websocket]") {
+    Request request{"GET", "/", 1, 1, {{"Host", "localhost"}, {"Upgrade", "websocket"}, {"Connection", "keep-alive, Upgrade"}, {"Sec-WebSocket-Key", "dGhlIHNhbXBsZSBub25jZQ=="}}};
+    CHECK(is_upgrade_request(request));
+
+    SECTION("missing key") {
+        request.headers.pop_back();
+        CHECK(!is_upgrade_request(request));
+    }
+    SECTION("not upgrade connection") {
+        request.headers[2].value = "keep-alive";
+        CHECK(!is_upgrade_request(request));
+    }
+    SECTION("other protocol") {
+        request.headers[1].value = "h2c";
+        CHECK(!is_upgrade_request(request));
+    }
+    SECTION("POST method") {
+        request.method = "POST";
+        CHECK(!is_upgrade_request(request));
+    }
+}
+
+TEST_CASE("sha1", "[silkrpc][http][websocket]") {
+    const auto to_hex = [](const std::array<uint8_t, 20>& digest) {
+        std::string hex;
+        for (const auto b : digest) {
+            hex.push_back("0123456789abcdef"[b >> 4]);
+            hex.push_back("0123456789abcdef"[b & 0x0F]);
+        }
+        return hex;
+    };
+    CHECK(to_hex(sha1("")) == "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    CHECK(to_hex(sha1("abc")) == "a9993e364706816aba3e25717850c26c9cd0d89d");
+    CHECK(to_hex(sha1("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")) == "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+}
+
+TEST_CASE("base64_encode", "[silkrpc][http][websocket]") {
+    const auto encode = [](const std::string& s) { return base64_encode(reinterpret_cast<const uint8_t*>(s.data()), s.size()); };
+    CHECK(encode("").empty());
+    CHECK(encode("f") == "Zg==");
+    CHECK(encode("fo") == "Zm8=");
+    CHECK(encode("foo") == "Zm9v");
+    CHECK(encode("foobar") == "Zm9vYmFy");
+}
+
+TEST_CASE("compute_accept_key", "[silkrpc][http][websocket]") {
+    CHECK(compute_accept_key("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+TEST_CASE("encode_frame_header", "[silkrpc][http][websocket]") {
+    CHECK(encode_frame_header(text, 5) == std::string{"\x81\x05"});
+    CHECK(encode_frame_header(pong, 0) == std::string{"\x8A\x00", 2});
+    CHECK(encode_frame_header(text, 126) == std::string{"\x81\x7E\x00\x7E", 4});
+    CHECK(encode_frame_header(text, 65536) == std::string{"\x81\x7F\x00\x00\x00\x00\x00\x01\x00\x00", 10});
+}
+
+TEST_CASE("parse frames", "[silkrpc][http][websocket]") {
+    FrameParser parser;
+    Frame frame;
+
+    SECTION("masked text frame") {
+        const auto data = make_client_frame(0x81, "Hello");
+        const auto [result, end] = parser.parse(frame, data.data(), data.data() + data.size());
+        CHECK(result == FrameParser::good);
+        CHECK(end == data.data() + data.size());
+        CHECK(frame.fin);
+        CHECK(frame.opcode == text);
+        CHECK(frame.payload == "Hello");
+    }
+
+    SECTION("byte by byte") {
+        const std::string payload{R"({"jsonrpc":"2.0","id":1,"method":"eth_subscribe","params":["newHeads"]})"};
+        const auto data = make_client_frame(0x81, payload);
+        FrameParser::ResultType result{FrameParser::indeterminate};
+        for (std::size_t i{0}; i < data.size(); ++i) {
+            CHECK(result == FrameParser::indeterminate);
+            std::tie(result, std::ignore) = parser.parse(frame, data.data() + i, data.data() + i + 1);
+        }
+        CHECK(result == FrameParser::good);
+        CHECK(frame.payload == payload);
+    }
+
+    SECTION("16-bit and 64-bit lengths") {
+        for (const std::size_t size : {126, 1000, 65535, 65536, 100000}) {
+            std::string payload(size, 'x');
+            for (std::size_t i{0}; i < size; ++i) payload[i] = static_cast<char>('a' + i % 26);
+            const auto data = make_client_frame(0x82, payload);
+            frame.reset();
+            parser.reset();
+            const auto [result, end] = parser.parse(frame, data.data(), data.data() + data.size());
+            CHECK(result == FrameParser::good);
+            CHECK(end == data.data() + data.size());
+            CHECK(frame.opcode == binary);
+            CHECK(frame.payload == payload);
+        }
+    }
+
+    SECTION("empty ping") {
+        const auto data = make_client_frame(0x89, "");
+        const auto [result, end] = parser.parse(frame, data.data(), data.data() + data.size());
+        CHECK(result == FrameParser::good);
+        CHECK(frame.opcode == ping);
+        CHECK(frame.payload.empty());
+    }
+
+    SECTION("fragmented message") {
+        const auto data = make_client_frame(0x01, "Hel") + make_client_frame(0x80, "lo");
+        auto [result, next] = parser.parse(frame, data.data(), data.data() + data.size());
+        CHECK(result == FrameParser::good);
+        CHECK(!frame.fin);
+        CHECK(frame.opcode == text);
+        CHECK(frame.payload == "Hel");
+        frame.reset();
+        parser.reset();
+        std::tie(result, next) = parser.parse(frame, next, data.data() + data.size());
+        CHECK(result == FrameParser::good);
+        CHECK(frame.fin);
+        CHECK(frame.opcode == continuation);
+        CHECK(frame.payload == "lo");
+    }
+
+    SECTION("unmasked frame") {
+        const std::string data{"\x81\x05Hello"};
+        const auto [result, end] = parser.parse(frame, data.data(), data.data() + data.size());
+        CHECK(result == FrameParser::bad);
+    }
+
+    SECTION("reserved bits") {
+        const auto data = make_client_frame(0xC1, "Hello");
+        CHECK(std::get<0>(parser.parse(frame, data.data(), data.data() + data.size())) == FrameParser::bad);
+    }
+
+    SECTION("unknown opcode") {
+        const auto data = make_client_frame(0x83, "Hello");
+        CHECK(std::get<0>(parser.parse(frame, data.data(), data.data() + data.size())) == FrameParser::bad);
+    }
+
+    SECTION("fragmented control frame") {
+        const auto data = make_client_frame(0x09, "ping");
+        CHECK(std::get<0>(parser.parse(frame, data.data(), data.data() + data.size())) == FrameParser::bad);
+    }
+
+    SECTION("oversized frame") {
+        std::string data{"\x82\xFF\x00\x00\x00\x00\x10\x00\x00\x00", 10};
+        CHECK(std::get<0>(parser.parse(frame, data.data(), data.data() + data.size())) == FrameParser::bad);
+    }
+}
+
+} // namespace silkrpc::http::websocket
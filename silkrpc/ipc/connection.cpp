@@ -0,0 +1,128 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "connection.hpp"
+
+#include <exception>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <asio/buffer.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asio/write.hpp>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/http/request.hpp>
+
+namespace silkrpc::ipc {
+
+Connection::Connection(Context& context, asio::thread_pool& workers, const http::ServerSettings& settings,
+    http::AdmissionControl* admission_control, http::ChunkPool* chunk_pool)
+: socket_{*context.io_context}, chunk_pool_{chunk_pool}, request_handler_{context, workers, settings.max_batch_size, admission_control, settings.retry_after, nullptr, settings.api_namespaces} {
+    SILKRPC_DEBUG << "ipc::Connection::Connection socket " << &socket_ << " created\n";
+}
+
+Connection::~Connection() {
+    std::error_code ec;
+    socket_.close(ec);
+    SILKRPC_DEBUG << "ipc::Connection::~Connection socket " << &socket_ << " deleted\n";
+}
+
+asio::awaitable<void> Connection::start() {
+    co_await do_read();
+}
+
+asio::awaitable<void> Connection::do_read() {
+    try {
+        while (socket_.is_open()) {
+            std::size_t bytes_read = co_await socket_.async_read_some(asio::buffer(buffer_), asio::use_awaitable);
+            SILKRPC_TRACE << "ipc::Connection::do_read bytes_read: " << bytes_read << "\n";
+
+            // The buffer may contain many pipelined messages: handle all the complete ones, keep parsing state for the last one
+            const char* begin = buffer_.data();
+            const char* end = buffer_.data() + bytes_read;
+            while (begin != end) {
+                MessageParser::ResultType result;
+                std::tie(result, begin) = message_parser_.parse(message_, begin, end);
+                if (result == MessageParser::good) {
+                    co_await handle_message(message_);
+                    message_ = Message{};
+                } else if (result == MessageParser::bad) {
+                    SILKRPC_WARN << "ipc::Connection::do_read message too large, closing socket: " << &socket_ << "\n";
+                    co_await do_write();
+                    co_return;
+                }
+            }
+            co_await do_write();
+        }
+    } catch (const std::system_error& se) {
+        if (se.code() == asio::error::eof || se.code() == asio::error::connection_reset || se.code() == asio::error::broken_pipe) {
+            SILKRPC_DEBUG << "ipc::Connection::do_read close from client with code: " << se.code() << "\n" << std::flush;
+        } else if (se.code() != asio::error::operation_aborted) {
+            SILKRPC_ERROR << "ipc::Connection::do_read system_error: " << se.what() << "\n" << std::flush;
+        } else {
+            SILKRPC_DEBUG << "ipc::Connection::do_read operation_aborted: " << se.what() << "\n" << std::flush;
+        }
+    } catch (const std::exception& e) {
+        SILKRPC_ERROR << "ipc::Connection::do_read exception: " << e.what() << "\n" << std::flush;
+    }
+}
+
+asio::awaitable<void> Connection::handle_message(const Message& message) {
+    http::Request request;
+    request.method = "POST";
+    request.content = message.content;
+
+    FramedReply framed_reply;
+    framed_reply.framing = message.framing;
+    framed_reply.reply.body = http::ChunkBuffer{chunk_pool_};
+    co_await request_handler_.handle_request(request, framed_reply.reply);
+
+    // An empty message gets no reply, as a blank line would not
+    auto& reply = framed_reply.reply;
+    if (reply.content.empty() && reply.body.empty()) {
+        co_return;
+    }
+    if (framed_reply.framing == Framing::length_prefixed) {
+        framed_reply.prefix = encode_length_prefix(reply.content.size() + reply.body.size());
+    }
+    replies_.push_back(std::move(framed_reply));
+}
+
+asio::awaitable<void> Connection::do_write() {
+    if (replies_.empty()) {
+        co_return;
+    }
+    // Unlike HTTP, the replies are just the JSON content: every reply already ends with a newline
+    std::vector<asio::const_buffer> buffers;
+    for (const auto& framed_reply : replies_) {
+        if (framed_reply.framing == Framing::length_prefixed) {
+            buffers.push_back(asio::buffer(framed_reply.prefix));
+        }
+        if (!framed_reply.reply.content.empty()) {
+            buffers.push_back(asio::buffer(framed_reply.reply.content));
+        }
+        framed_reply.reply.body.append_to(buffers);
+    }
+    const auto bytes_transferred = co_await asio::async_write(socket_, buffers, asio::use_awaitable);
+    SILKRPC_TRACE << "ipc::Connection::do_write replies: " << replies_.size() << " bytes_transferred: " << bytes_transferred << "\n" << std::flush;
+    replies_.clear();
+}
+
+} // namespace silkrpc::ipc
@@ -0,0 +1,100 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_IPC_CONNECTION_HPP_
+#define SILKRPC_IPC_CONNECTION_HPP_
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <silkrpc/config.hpp>
+
+#include <asio/awaitable.hpp>
+#include <asio/local/stream_protocol.hpp>
+#include <asio/thread_pool.hpp>
+
+#include <silkrpc/context_pool.hpp>
+#include <silkrpc/http/admission_control.hpp>
+#include <silkrpc/http/chunk_buffer.hpp>
+#include <silkrpc/http/reply.hpp>
+#include <silkrpc/http/request_handler.hpp>
+#include <silkrpc/http/server_settings.hpp>
+#include <silkrpc/ipc/framing.hpp>
+
+namespace silkrpc::ipc {
+
+/// Represents a single connection from a local client on the Unix domain socket. The messages are handled in order
+/// and the replies to the messages received together are written together, each one framed as its request.
+class Connection : public std::enable_shared_from_this<Connection> {
+public:
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /// Construct a connection running within the given execution context, whose requests are subject to the
+    /// admission control of the context, if any. The reply chunks are taken from the pool of the context, if any.
+    explicit Connection(Context& context, asio::thread_pool& workers, const http::ServerSettings& settings,
+        http::AdmissionControl* admission_control = nullptr, http::ChunkPool* chunk_pool = nullptr);
+
+    ~Connection();
+
+    asio::local::stream_protocol::socket& socket() { return socket_; }
+
+    /// Start the first asynchronous operation for the connection.
+    asio::awaitable<void> start();
+
+private:
+    /// The reply to one message, ready to be written.
+    struct FramedReply {
+        std::array<char, kLengthPrefixSize> prefix{};
+        Framing framing{Framing::newline};
+        http::Reply reply;
+    };
+
+    /// Perform asynchronous read operations, handling the complete messages as they are received.
+    asio::awaitable<void> do_read();
+
+    /// Handle one message, queueing its reply if any.
+    asio::awaitable<void> handle_message(const Message& message);
+
+    /// Write all the queued replies at once.
+    asio::awaitable<void> do_write();
+
+    /// Socket for the connection.
+    asio::local::stream_protocol::socket socket_;
+
+    /// The pool of memory chunks of the context used by the reply bodies, if any.
+    http::ChunkPool* chunk_pool_;
+
+    /// The handler used to process the incoming messages, shared with the HTTP connections.
+    http::RequestHandler request_handler_;
+
+    /// Buffer for incoming data.
+    std::array<char, 8192> buffer_;
+
+    /// The incoming message being parsed.
+    Message message_;
+
+    /// The parser for the incoming messages.
+    MessageParser message_parser_;
+
+    /// The replies waiting to be written.
+    std::vector<FramedReply> replies_;
+};
+
+} // namespace silkrpc::ipc
+
+#endif // SILKRPC_IPC_CONNECTION_HPP_
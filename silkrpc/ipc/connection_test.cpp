@@ -0,0 +1,105 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "connection.hpp"
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <asio/buffer.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/read.hpp>
+#include <asio/read_until.hpp>
+#include <asio/thread_pool.hpp>
+#include <asio/write.hpp>
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+#include <silkrpc/common/log.hpp>
+
+namespace silkrpc::ipc {
+
+// Read one reply in the given framing from the client socket
+static std::string read_reply(asio::local::stream_protocol::socket& client, Framing framing) {
+    std::string reply;
+    if (framing == Framing::newline) {
+        const auto size = asio::read_until(client, asio::dynamic_buffer(reply), '\n');
+        reply.resize(size);
+        return reply;
+    }
+    std::array<uint8_t, kLengthPrefixSize> prefix{};
+    asio::read(client, asio::buffer(prefix));
+    reply.resize((std::size_t{prefix[0]} << 24) | (std::size_t{prefix[1]} << 16) | (std::size_t{prefix[2]} << 8) | prefix[3]);
+    asio::read(client, asio::buffer(reply));
+    return reply;
+}
+
+TEST_CASE("ipc::Connection round trip", "[silkrpc][ipc][connection]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    // Declared first, so that they outlive the connection destroyed together with the io_context
+    const http::ServerSettings settings;
+    asio::thread_pool workers{1};
+    Context context;
+    context.io_context = std::make_shared<asio::io_context>();
+
+    const auto path = (std::filesystem::temp_directory_path() / "silkrpc_ipc_connection_test.sock").string();
+    std::remove(path.c_str());
+    asio::local::stream_protocol::acceptor acceptor{*context.io_context, asio::local::stream_protocol::endpoint{path}};
+    asio::local::stream_protocol::socket client{*context.io_context};
+    client.connect(acceptor.local_endpoint());
+    auto connection = std::make_shared<Connection>(context, workers, settings);
+    acceptor.accept(connection->socket());
+    asio::co_spawn(*context.io_context, [connection]() { return connection->start(); }, asio::detached);
+    connection.reset();
+    std::thread io_thread{[&]() { context.io_context->run(); }};
+
+    const std::string request{R"({"jsonrpc":"2.0","id":1,"method":"net_listening","params":[]})"};
+    const auto expected_reply = R"({"jsonrpc":"2.0","id":1,"result":true})"_json;
+
+    SECTION("newline-delimited") {
+        asio::write(client, asio::buffer(request + "\n"));
+        const auto reply = read_reply(client, Framing::newline);
+        CHECK(reply.back() == '\n');
+        CHECK(nlohmann::json::parse(reply) == expected_reply);
+    }
+
+    SECTION("length-prefixed") {
+        const auto prefix = encode_length_prefix(request.size());
+        asio::write(client, asio::buffer(std::string{prefix.data(), prefix.size()} + request));
+        CHECK(nlohmann::json::parse(read_reply(client, Framing::length_prefixed)) == expected_reply);
+    }
+
+    SECTION("pipelined in both framings") {
+        const auto prefix = encode_length_prefix(request.size());
+        asio::write(client, asio::buffer(request + "\n" + std::string{prefix.data(), prefix.size()} + request));
+        CHECK(nlohmann::json::parse(read_reply(client, Framing::newline)) == expected_reply);
+        CHECK(nlohmann::json::parse(read_reply(client, Framing::length_prefixed)) == expected_reply);
+    }
+
+    client.close();
+    context.io_context->stop();
+    io_thread.join();
+    std::remove(path.c_str());
+}
+
+} // namespace silkrpc::ipc
@@ -0,0 +1,101 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "framing.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace silkrpc::ipc {
+
+void MessageParser::reset() {
+    state_ = message_start;
+    prefix_size_ = 0;
+    content_length_ = 0;
+}
+
+std::tuple<MessageParser::ResultType, const char*> MessageParser::parse(Message& message, const char* begin, const char* end) {
+    while (begin != end) {
+        switch (state_) {
+            case message_start: {
+                const char c = *begin;
+                if (c == '\n' || c == '\r' || c == ' ' || c == '\t') {
+                    ++begin;
+                } else if (c == '{' || c == '[') {
+                    message.framing = Framing::newline;
+                    state_ = newline_content;
+                } else {
+                    message.framing = Framing::length_prefixed;
+                    prefix_size_ = 0;
+                    state_ = length_prefix;
+                }
+                break;
+            }
+            case newline_content: {
+                const auto* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+                const auto* content_end = newline != nullptr ? newline : end;
+                if (message.content.size() + (content_end - begin) > kMaxMessageSize) {
+                    return std::make_tuple(bad, begin);
+                }
+                message.content.append(begin, content_end);
+                if (newline == nullptr) {
+                    return std::make_tuple(indeterminate, end);
+                }
+                state_ = message_start;
+                return std::make_tuple(good, newline + 1);
+            }
+            case length_prefix: {
+                prefix_[prefix_size_++] = static_cast<uint8_t>(*begin++);
+                if (prefix_size_ < kLengthPrefixSize) {
+                    break;
+                }
+                content_length_ = (std::size_t{prefix_[0]} << 24) | (std::size_t{prefix_[1]} << 16) | (std::size_t{prefix_[2]} << 8) | prefix_[3];
+                if (content_length_ > kMaxMessageSize) {
+                    return std::make_tuple(bad, begin);
+                }
+                message.content.reserve(content_length_);
+                if (content_length_ == 0) {
+                    state_ = message_start;
+                    return std::make_tuple(good, begin);
+                }
+                state_ = length_content;
+                break;
+            }
+            case length_content: {
+                const auto length = std::min<std::size_t>(end - begin, content_length_ - message.content.size());
+                message.content.append(begin, length);
+                begin += length;
+                if (message.content.size() == content_length_) {
+                    state_ = message_start;
+                    return std::make_tuple(good, begin);
+                }
+                break;
+            }
+        }
+    }
+    return std::make_tuple(indeterminate, begin);
+}
+
+std::array<char, kLengthPrefixSize> encode_length_prefix(std::size_t length) {
+    return {
+        static_cast<char>((length >> 24) & 0xFF),
+        static_cast<char>((length >> 16) & 0xFF),
+        static_cast<char>((length >> 8) & 0xFF),
+        static_cast<char>(length & 0xFF)
+    };
+}
+
+} // namespace silkrpc::ipc
@@ -0,0 +1,83 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_IPC_FRAMING_HPP_
+#define SILKRPC_IPC_FRAMING_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+
+namespace silkrpc::ipc {
+
+/// The maximum size of one message, which bounds the memory used by each connection.
+constexpr std::size_t kMaxMessageSize{16 * 1024 * 1024};
+
+/// The size of the length prefix of the length-delimited messages.
+constexpr std::size_t kLengthPrefixSize{4};
+
+/// The delimitation of the JSON-RPC messages on the stream, chosen by the client for each request and used
+/// also for its reply.
+enum class Framing {
+    newline,            // the message is terminated by '\n', as in geth IPC
+    length_prefixed     // the message is preceded by its size as 32-bit big-endian integer
+};
+
+/// One JSON-RPC message exchanged on the stream.
+struct Message {
+    std::string content;
+    Framing framing{Framing::newline};
+};
+
+/// Parser splitting the stream into messages. A message starting with '{' or '[' is newline-delimited, otherwise
+/// it is length-prefixed: any valid length is below kMaxMessageSize, so its first byte can never be mistaken for
+/// those characters or for the whitespace skipped between messages.
+class MessageParser {
+public:
+    /// Reset to initial parser state.
+    void reset();
+
+    /// Result of parse.
+    enum ResultType { good, bad, indeterminate };
+
+    /// Parse some data. The enum return value is good when a complete message has been parsed, bad if the data
+    /// is invalid (i.e. the message is too large), indeterminate when more data is required. The pointer return
+    /// value indicates how much of the input has been consumed. The content is copied in bulk.
+    std::tuple<ResultType, const char*> parse(Message& message, const char* begin, const char* end);
+
+private:
+    /// The current state of the parser.
+    enum State {
+        message_start,
+        newline_content,
+        length_prefix,
+        length_content
+    } state_{message_start};
+
+    /// The length prefix bytes read so far and the content size announced by them.
+    std::array<uint8_t, kLengthPrefixSize> prefix_{};
+    std::size_t prefix_size_{0};
+    std::size_t content_length_{0};
+};
+
+/// Encode the length prefix of a length-delimited message.
+std::array<char, kLengthPrefixSize> encode_length_prefix(std::size_t length);
+
+} // namespace silkrpc::ipc
+
+#endif // SILKRPC_IPC_FRAMING_HPP_
@@ -0,0 +1,121 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "framing.hpp"
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc::ipc {
+
+static std::string length_prefixed(const std::string& content) {
+    const auto prefix = encode_length_prefix(content.size());
+    return std::string{prefix.data(), prefix.size()} + content;
+}
+
+TEST_CASE("encode_length_prefix", "[silkrpc][ipc][framing]") {
+    CHECK(encode_length_prefix(0) == std::array<char, 4>{0, 0, 0, 0});
+    CHECK(encode_length_prefix(0x2A) == std::array<char, 4>{0, 0, 0, 0x2A});
+    CHECK(encode_length_prefix(0x01020304) == std::array<char, 4>{1, 2, 3, 4});
+}
+
+TEST_CASE("MessageParser::parse newline-delimited", "[silkrpc][ipc][framing]") {
+    MessageParser parser;
+    Message message;
+
+    SECTION("one message") {
+        const std::string data{"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"eth_blockNumber\"}\n"};
+        const auto [result, consumed] = parser.parse(message, data.data(), data.data() + data.size());
+        CHECK(result == MessageParser::good);
+        CHECK(consumed == data.data() + data.size());
+        CHECK(message.framing == Framing::newline);
+        CHECK(message.content == "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"eth_blockNumber\"}");
+    }
+
+    SECTION("message split across reads") {
+        const std::string data1{"\r\n[{\"id\":1},"};
+        const std::string data2{"{\"id\":2}]\n{"};
+        auto [result1, consumed1] = parser.parse(message, data1.data(), data1.data() + data1.size());
+        CHECK(result1 == MessageParser::indeterminate);
+        CHECK(consumed1 == data1.data() + data1.size());
+        auto [result2, consumed2] = parser.parse(message, data2.data(), data2.data() + data2.size());
+        CHECK(result2 == MessageParser::good);
+        CHECK(consumed2 == data2.data() + data2.size() - 1);
+        CHECK(message.content == "[{\"id\":1},{\"id\":2}]");
+    }
+}
+
+TEST_CASE("MessageParser::parse length-prefixed", "[silkrpc][ipc][framing]") {
+    MessageParser parser;
+
+    SECTION("pipelined messages") {
+        const std::string data{length_prefixed("{\"id\":1}") + length_prefixed("{\"id\":2}")};
+        const char* begin = data.data();
+        const char* end = data.data() + data.size();
+        Message message1;
+        auto [result1, consumed1] = parser.parse(message1, begin, end);
+        CHECK(result1 == MessageParser::good);
+        CHECK(message1.framing == Framing::length_prefixed);
+        CHECK(message1.content == "{\"id\":1}");
+        Message message2;
+        auto [result2, consumed2] = parser.parse(message2, consumed1, end);
+        CHECK(result2 == MessageParser::good);
+        CHECK(consumed2 == end);
+        CHECK(message2.content == "{\"id\":2}");
+    }
+
+    SECTION("prefix split across reads") {
+        const std::string data{length_prefixed("{\"id\":1}\n")};
+        Message message;
+        auto [result1, consumed1] = parser.parse(message, data.data(), data.data() + 2);
+        CHECK(result1 == MessageParser::indeterminate);
+        auto [result2, consumed2] = parser.parse(message, consumed1, data.data() + data.size());
+        CHECK(result2 == MessageParser::good);
+        CHECK(message.content == "{\"id\":1}\n");
+    }
+
+    SECTION("empty message") {
+        const std::string data{length_prefixed("")};
+        Message message;
+        auto [result, consumed] = parser.parse(message, data.data(), data.data() + data.size());
+        CHECK(result == MessageParser::good);
+        CHECK(message.content.empty());
+    }
+
+    SECTION("too large message") {
+        const auto prefix = encode_length_prefix(kMaxMessageSize + 1);
+        Message message;
+        auto [result, consumed] = parser.parse(message, prefix.data(), prefix.data() + prefix.size());
+        CHECK(result == MessageParser::bad);
+    }
+}
+
+TEST_CASE("MessageParser::reset", "[silkrpc][ipc][framing]") {
+    MessageParser parser;
+    Message message;
+    const std::string data{"{\"id\":"};
+    parser.parse(message, data.data(), data.data() + data.size());
+    parser.reset();
+    message = Message{};
+    const auto other = length_prefixed("[]");
+    auto [result, consumed] = parser.parse(message, other.data(), other.data() + other.size());
+    CHECK(result == MessageParser::good);
+    CHECK(message.framing == Framing::length_prefixed);
+    CHECK(message.content == "[]");
+}
+
+} // namespace silkrpc::ipc
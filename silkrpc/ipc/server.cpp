@@ -0,0 +1,99 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "server.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <asio/co_spawn.hpp>
+#include <asio/dispatch.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/ipc/connection.hpp>
+
+namespace silkrpc::ipc {
+
+Server::Server(const std::string& path, ContextPool& context_pool, http::Server& http_server)
+: context_pool_(context_pool), path_{path}, acceptor_{context_pool.get_io_context()}, http_server_(http_server) {
+    // A socket file left by a previous run would make the bind fail
+    std::remove(path_.c_str());
+
+    const asio::local::stream_protocol::endpoint endpoint{path_};
+    acceptor_.open(endpoint.protocol());
+    acceptor_.bind(endpoint);
+}
+
+void Server::start() {
+    asio::co_spawn(acceptor_.get_executor(), run(), [&](std::exception_ptr eptr) {
+        if (eptr) std::rethrow_exception(eptr);
+    });
+}
+
+asio::awaitable<void> Server::run() {
+    acceptor_.listen();
+
+    try {
+        while (acceptor_.is_open()) {
+            // Get the next context to use chosen round-robin, then get both io_context *and* database from it
+            auto& context = context_pool_.get_context();
+
+            SILKRPC_DEBUG << "ipc::Server::run accepting using io_context " << context.io_context << "...\n" << std::flush;
+
+            auto new_connection = std::make_shared<Connection>(context, http_server_.workers(), http_server_.settings(), http_server_.admission_control(context),
+                http_server_.chunk_pool(context));
+            co_await acceptor_.async_accept(new_connection->socket(), asio::use_awaitable);
+            if (!acceptor_.is_open()) {
+                SILKRPC_TRACE << "ipc::Server::run returning...\n";
+                co_return;
+            }
+            start_connection(std::move(new_connection), *context.io_context);
+        }
+    } catch (const std::system_error& se) {
+        if (se.code() != asio::error::operation_aborted) {
+            SILKRPC_ERROR << "ipc::Server::run system_error: " << se.what() << "\n" << std::flush;
+            std::rethrow_exception(std::make_exception_ptr(se));
+        } else {
+            SILKRPC_DEBUG << "ipc::Server::run operation_aborted: " << se.what() << "\n" << std::flush;
+        }
+    }
+    SILKRPC_DEBUG << "ipc::Server::run exiting...\n" << std::flush;
+}
+
+void Server::start_connection(std::shared_ptr<Connection> new_connection, asio::io_context& io_context) {
+    SILKRPC_TRACE << "ipc::Server::run starting connection for socket: " << &new_connection->socket() << "\n";
+    auto new_connection_starter = [=]() -> asio::awaitable<void> { co_await new_connection->start(); };
+
+    // https://github.com/chriskohlhoff/asio/issues/552
+    asio::dispatch(io_context, [&io_context, new_connection_starter]() mutable {
+        asio::co_spawn(io_context, new_connection_starter, [&](std::exception_ptr eptr) {
+            if (eptr) std::rethrow_exception(eptr);
+        });
+    });
+}
+
+void Server::stop() {
+    // The server is stopped by cancelling all outstanding asynchronous operations.
+    SILKRPC_DEBUG << "ipc::Server::stop started...\n";
+    acceptor_.close();
+    std::remove(path_.c_str());
+    SILKRPC_DEBUG << "ipc::Server::stop completed\n" << std::flush;
+}
+
+} // namespace silkrpc::ipc
@@ -0,0 +1,71 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_IPC_SERVER_HPP_
+#define SILKRPC_IPC_SERVER_HPP_
+
+#include <memory>
+#include <string>
+
+#include <silkrpc/config.hpp>
+
+#include <asio/awaitable.hpp>
+#include <asio/local/stream_protocol.hpp>
+
+#include <silkrpc/context_pool.hpp>
+#include <silkrpc/http/server.hpp>
+
+namespace silkrpc::ipc {
+
+class Connection;
+
+/// The IPC server serving JSON-RPC requests to local clients over a Unix domain socket, without HTTP framing.
+class Server {
+public:
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    // Construct the server to listen on the Unix domain socket at the specified path, replacing any stale socket file.
+    // The requests are handled with the settings, the workers and the admission control of the HTTP server on the same contexts.
+    explicit Server(const std::string& path, ContextPool& context_pool, http::Server& http_server);
+
+    void start();
+
+    void stop();
+
+private:
+    // Accept connections and run them on contexts chosen round-robin
+    asio::awaitable<void> run();
+
+    // Start the connection on its own io_context
+    void start_connection(std::shared_ptr<Connection> connection, asio::io_context& io_context);
+
+    // The context pool used to perform asynchronous operations
+    ContextPool& context_pool_;
+
+    // The path of the socket file, removed when the server is stopped
+    std::string path_;
+
+    // The acceptor used to listen for incoming connections
+    asio::local::stream_protocol::acceptor acceptor_;
+
+    // The HTTP server sharing its workers and admission limits with the IPC requests
+    http::Server& http_server_;
+};
+
+} // namespace silkrpc::ipc
+
+#endif // SILKRPC_IPC_SERVER_HPP_
@@ -0,0 +1,86 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "server.hpp"
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include <asio/buffer.hpp>
+#include <asio/io_context.hpp>
+#include <asio/read.hpp>
+#include <asio/read_until.hpp>
+#include <asio/write.hpp>
+#include <catch2/catch.hpp>
+#include <grpcpp/grpcpp.h>
+#include <nlohmann/json.hpp>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/ipc/framing.hpp>
+
+namespace silkrpc::ipc {
+
+TEST_CASE("ipc::Server round trip", "[silkrpc][ipc][server]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    ChannelFactory create_channel = []() { return grpc::CreateChannel("localhost", grpc::InsecureChannelCredentials()); };
+    ContextPool context_pool{2, create_channel};
+    http::Server http_server{"127.0.0.1", "0", context_pool, 1};
+    const auto path = (std::filesystem::temp_directory_path() / "silkrpc_ipc_server_test.sock").string();
+    Server ipc_server{path, context_pool, http_server};
+    ipc_server.start();
+    auto context_pool_thread = std::thread([&]() { context_pool.run(); });
+
+    asio::io_context io_context;
+    asio::local::stream_protocol::socket client{io_context};
+    client.connect(asio::local::stream_protocol::endpoint{path});
+
+    const std::string request{R"({"jsonrpc":"2.0","id":1,"method":"net_listening","params":[]})"};
+    const auto expected_reply = R"({"jsonrpc":"2.0","id":1,"result":true})"_json;
+
+    // Newline-delimited request and reply
+    asio::write(client, asio::buffer(request + "\n"));
+    std::string reply;
+    const auto reply_size = asio::read_until(client, asio::dynamic_buffer(reply), '\n');
+    CHECK(reply_size == reply.size());
+    CHECK(nlohmann::json::parse(reply) == expected_reply);
+
+    // Length-prefixed request and reply
+    const auto prefix = encode_length_prefix(request.size());
+    asio::write(client, asio::buffer(std::string{prefix.data(), prefix.size()} + request));
+    std::array<char, kLengthPrefixSize> reply_prefix{};
+    asio::read(client, asio::buffer(reply_prefix));
+    reply.resize((std::size_t{static_cast<uint8_t>(reply_prefix[2])} << 8) | static_cast<uint8_t>(reply_prefix[3]));
+    CHECK(reply_prefix[0] == 0);
+    CHECK(reply_prefix[1] == 0);
+    asio::read(client, asio::buffer(reply));
+    CHECK(nlohmann::json::parse(reply) == expected_reply);
+
+    // The IPC requests are admitted by the HTTP server admission control
+    CHECK(http_server.admission_counters().admitted == 2);
+
+    client.close();
+    ipc_server.stop();
+    http_server.stop();
+    context_pool.stop();
+    context_pool_thread.join();
+    CHECK(!std::filesystem::exists(path));
+}
+
+} // namespace silkrpc::ipc
@@ -0,0 +1,182 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "request_view.hpp"
+
+#include <cstdint>
+
+#include <silkrpc/http/scanner.hpp>
+
+namespace silkrpc::json {
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline const char* skip_space(const char* p, const char* end) {
+    while (p != end && is_space(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Skip the string opened by the quote at p, return the position after the closing quote or nullptr if unterminated
+static const char* skip_string(const char* p, const char* end) {
+    ++p;
+    while (true) {
+        p = http::scanner::find_quote_or_backslash(p, end);
+        if (p == end) {
+            return nullptr;
+        }
+        if (*p == '"') {
+            return p + 1;
+        }
+        if (end - p < 2) {
+            return nullptr;
+        }
+        p += 2;
+    }
+}
+
+// The nesting depth of the values skipped in place, the deeper ones are left to the DOM parser
+constexpr std::size_t kMaxSkipDepth{64};
+
+// Skip the value starting at p, return the position after it or nullptr if malformed: the nested values are just balanced
+// by matching brackets, leaving any further validation to the DOM parser when needed
+static const char* skip_value(const char* p, const char* end) {
+    if (p == end) {
+        return nullptr;
+    }
+    if (*p == '"') {
+        return skip_string(p, end);
+    }
+    if (*p == '{' || *p == '[') {
+        // One bit per open bracket, set for the objects, so that each closing bracket is checked against its opening one
+        uint64_t objects{0};
+        std::size_t depth{0};
+        while (p != end) {
+            const char c = *p;
+            if (c == '"') {
+                p = skip_string(p, end);
+                if (p == nullptr) {
+                    return nullptr;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                if (depth == kMaxSkipDepth) {
+                    return nullptr;
+                }
+                objects = (objects << 1) | (c == '{' ? 1 : 0);
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if ((objects & 1) != (c == '}' ? 1 : 0)) {
+                    return nullptr;
+                }
+                objects >>= 1;
+                if (--depth == 0) {
+                    return p + 1;
+                }
+            }
+            ++p;
+        }
+        return nullptr;
+    }
+    const char* start = p;
+    while (p != end && !is_space(*p) && *p != ',' && *p != '}' && *p != ']') {
+        ++p;
+    }
+    return p != start ? p : nullptr;
+}
+
+std::optional<RequestView> RequestView::parse(std::string_view content) {
+    const char* end = content.data() + content.size();
+    const char* p = skip_space(content.data(), end);
+    if (p == end || *p != '{') {
+        return std::nullopt;
+    }
+    RequestView view;
+    bool has_method{false};
+    p = skip_space(p + 1, end);
+    if (p != end && *p == '}') {
+        ++p;
+    } else {
+        while (true) {
+            if (p == end || *p != '"') {
+                return std::nullopt;
+            }
+            const char* key_end = skip_string(p, end);
+            if (key_end == nullptr) {
+                return std::nullopt;
+            }
+            const std::string_view key{p + 1, static_cast<std::size_t>(key_end - p - 2)};
+            p = skip_space(key_end, end);
+            if (p == end || *p != ':') {
+                return std::nullopt;
+            }
+            p = skip_space(p + 1, end);
+            const char* value_end = skip_value(p, end);
+            if (value_end == nullptr) {
+                return std::nullopt;
+            }
+            const std::string_view value{p, static_cast<std::size_t>(value_end - p)};
+            if (key == "id") {
+                view.id_ = value;
+            } else if (key == "method") {
+                // The escaped names are left to the DOM parser, no method has any
+                if (value.front() != '"' || value.find('\\') != std::string_view::npos) {
+                    return std::nullopt;
+                }
+                view.method_ = value.substr(1, value.size() - 2);
+                has_method = true;
+            } else if (key == "params") {
+                view.params_ = value;
+            }
+            p = skip_space(value_end, end);
+            if (p != end && *p == ',') {
+                p = skip_space(p + 1, end);
+            } else if (p != end && *p == '}') {
+                ++p;
+                break;
+            } else {
+                return std::nullopt;
+            }
+        }
+    }
+    if (!has_method || skip_space(p, end) != end) {
+        return std::nullopt;
+    }
+    return view;
+}
+
+std::optional<uint32_t> RequestView::id() const {
+    if (id_.empty() || id_.size() > 10) {
+        return std::nullopt;
+    }
+    uint64_t id{0};
+    for (const char c : id_) {
+        if (c < '0' || c > '9') {
+            return std::nullopt;
+        }
+        id = id * 10 + static_cast<uint64_t>(c - '0');
+    }
+    if (id > UINT32_MAX || (id_.size() > 1 && id_.front() == '0')) {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(id);
+}
+
+} // namespace silkrpc::json
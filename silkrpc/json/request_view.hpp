@@ -0,0 +1,58 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_JSON_REQUEST_VIEW_HPP_
+#define SILKRPC_JSON_REQUEST_VIEW_HPP_
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace silkrpc::json {
+
+/// On-demand reader of one JSON-RPC request object: the id, method and params members are located in the content without
+/// building any DOM, validating just the structure needed to skip over the values. The content must outlive the view.
+/// The view serves just the coalescing and admission decisions, which may spare the DOM of the calls joining an identical
+/// one in flight and of the requests shed. The requests executed are still parsed into the DOM, from which the handlers
+/// read their params: no handler takes typed params read in place yet.
+class RequestView {
+public:
+    /// Read the request, nothing if the content is not one JSON object with a method string without escapes (e.g. a batch).
+    static std::optional<RequestView> parse(std::string_view content);
+
+    /// The method name.
+    std::string_view method() const { return method_; }
+
+    /// The id if it is an unsigned integer fitting 32 bits.
+    std::optional<uint32_t> id() const;
+
+    /// The JSON text of the id, empty if missing.
+    std::string_view raw_id() const { return id_; }
+
+    /// The JSON text of the params, empty if missing.
+    std::string_view params() const { return params_; }
+
+private:
+    RequestView() = default;
+
+    std::string_view id_;
+    std::string_view method_;
+    std::string_view params_;
+};
+
+} // namespace silkrpc::json
+
+#endif // SILKRPC_JSON_REQUEST_VIEW_HPP_
@@ -0,0 +1,87 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "request_view.hpp"
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc {
+
+using Catch::Matchers::Message;
+
+TEST_CASE("parse request view", "[silkrpc][json][request_view]") {
+    SECTION("members located in place") {
+        const std::string content{R"( {"jsonrpc": "2.0", "id": 42, "method": "eth_getBalance",
+            "params": ["0x0715a7794a1dc8e42615f059dd6e406a6594651a", "latest"]} )"};
+        const auto view = json::RequestView::parse(content);
+        REQUIRE(view);
+        CHECK(view->method() == "eth_getBalance");
+        CHECK(view->id() == 42);
+        CHECK(view->raw_id() == "42");
+        CHECK(view->params() == R"(["0x0715a7794a1dc8e42615f059dd6e406a6594651a", "latest"])");
+        CHECK(view->method().data() > content.data());
+        CHECK(view->method().data() < content.data() + content.size());
+    }
+
+    SECTION("nested values skipped") {
+        const auto view = json::RequestView::parse(R"({"params":[{"a":["]}\"",{"b":[]}]},null],"method":"m","id":"x"})");
+        REQUIRE(view);
+        CHECK(view->method() == "m");
+        CHECK(view->raw_id() == R"("x")");
+        CHECK(!view->id());
+        CHECK(view->params() == R"([{"a":["]}\"",{"b":[]}]},null])");
+    }
+
+    SECTION("id") {
+        CHECK(json::RequestView::parse(R"({"id":4294967295,"method":"m"})")->id() == 4294967295u);
+        CHECK(!json::RequestView::parse(R"({"id":4294967296,"method":"m"})")->id());
+        CHECK(!json::RequestView::parse(R"({"id":-1,"method":"m"})")->id());
+        CHECK(!json::RequestView::parse(R"({"id":1.5,"method":"m"})")->id());
+        CHECK(!json::RequestView::parse(R"({"id":01,"method":"m"})")->id());
+        CHECK(!json::RequestView::parse(R"({"method":"m"})")->id());
+    }
+
+    SECTION("not a single request") {
+        CHECK(!json::RequestView::parse(""));
+        CHECK(!json::RequestView::parse("[]"));
+        CHECK(!json::RequestView::parse(R"([{"id":1,"method":"m"}])"));
+        CHECK(!json::RequestView::parse(R"({"id":1})"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":2})"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m"} x)"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m",})"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m")"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m","params":["unterminated]})"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m","params":[[1]})"));
+    }
+
+    SECTION("mismatched brackets") {
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m","params":[}})"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m","params":{]})"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m","params":[{"a":1]}]})"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m","params":[[1}]})"));
+        CHECK(json::RequestView::parse(R"({"id":1,"method":"m","params":[{"a":"]}"},[{}]]})"));
+    }
+
+    SECTION("deep nesting left to the DOM parser") {
+        const std::string deep_params(64, '[');
+        CHECK(json::RequestView::parse(R"({"id":1,"method":"m","params":)" + deep_params + std::string(64, ']') + "}"));
+        CHECK(!json::RequestView::parse(R"({"id":1,"method":"m","params":[)" + deep_params + std::string(65, ']') + "}"));
+    }
+}
+
+} // namespace silkrpc
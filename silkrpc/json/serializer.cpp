@@ -0,0 +1,320 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "serializer.hpp"
+
+#include <cstring>
+
+#include <evmc/evmc.hpp>
+#include <intx/intx.hpp>
+#include <silkworm/common/util.hpp>
+#include <silkworm/rlp/encode.hpp>
+
+#include <silkrpc/common/hex.hpp>
+#include <silkrpc/common/util.hpp>
+
+namespace silkrpc::json {
+
+static void append_hex(std::string& out, const uint8_t* data, std::size_t size) {
+    const auto offset = out.size();
+    out.resize(offset + 2 * size);
+    hex::encode(data, size, out.data() + offset);
+}
+
+static inline void append_bytes(std::string& out, silkworm::ByteView bytes) {
+    out.append("\"0x");
+    append_hex(out, bytes.data(), bytes.size());
+    out.push_back('"');
+}
+
+static inline void append_address(std::string& out, const evmc::address& address) {
+    append_bytes(out, {address.bytes, sizeof(address.bytes)});
+}
+
+static inline void append_bytes32(std::string& out, const evmc::bytes32& bytes32) {
+    append_bytes(out, {bytes32.bytes, sizeof(bytes32.bytes)});
+}
+
+// Same as to_quantity(silkworm::ByteView)
+static void append_quantity(std::string& out, silkworm::ByteView bytes) {
+    const auto offset = out.size();
+    out.resize(offset + 3 + 2 * bytes.size() + 1);
+    char* dest = out.data() + offset;
+    std::memcpy(dest, "\"0x", 3);
+    const auto num_digits = hex::encode_no_leading_zeros(bytes.data(), bytes.size(), dest + 3);
+    dest[3 + num_digits] = '"';
+    out.resize(offset + 3 + num_digits + 1);
+}
+
+// Same as to_quantity(uint64_t)
+static inline void append_quantity(std::string& out, uint64_t number) {
+    char quantity[20]{'"', '0', 'x'};
+    const auto num_digits = hex::encode_no_leading_zeros(number, quantity + 3);
+    quantity[3 + num_digits] = '"';
+    out.append(quantity, 3 + num_digits + 1);
+}
+
+// Same as to_quantity(intx::uint256)
+static inline void append_quantity(std::string& out, const intx::uint256& number) {
+    if (number == 0) {
+        out.append(R"("0x0")");
+    } else {
+        append_quantity(out, silkworm::rlp::big_endian(number));
+    }
+}
+
+// The fields available only for a transaction included in a block
+struct TransactionLocation {
+    const evmc::bytes32& block_hash;
+    uint64_t block_number;
+    uint64_t transaction_index;
+};
+
+static void serialize(std::string& out, const silkworm::Transaction& transaction, const TransactionLocation* location) {
+    if (!transaction.from) {
+        (const_cast<silkworm::Transaction&>(transaction)).recover_sender();
+    }
+    out.push_back('{');
+    if (location != nullptr) {
+        out.append(R"("blockHash":)");
+        append_bytes32(out, location->block_hash);
+        out.append(R"(,"blockNumber":)");
+        append_quantity(out, location->block_number);
+        out.push_back(',');
+    }
+    if (transaction.from) {
+        out.append(R"("from":)");
+        append_address(out, *transaction.from);
+        out.push_back(',');
+    }
+    out.append(R"("gas":)");
+    append_quantity(out, transaction.gas_limit);
+    out.append(R"(,"gasPrice":)");
+    append_quantity(out, transaction.gas_price);
+    out.append(R"(,"hash":)");
+    const auto ethash_hash{hash_of_transaction(transaction)};
+    append_bytes(out, {ethash_hash.bytes, silkworm::kHashLength});
+    out.append(R"(,"input":)");
+    append_bytes(out, transaction.data);
+    out.append(R"(,"nonce":)");
+    append_quantity(out, transaction.nonce);
+    out.append(R"(,"r":)");
+    append_quantity(out, silkworm::rlp::big_endian(transaction.r));
+    out.append(R"(,"s":)");
+    append_quantity(out, silkworm::rlp::big_endian(transaction.s));
+    out.append(R"(,"to":)");
+    if (transaction.to) {
+        append_address(out, *transaction.to);
+    } else {
+        out.append("null");
+    }
+    if (location != nullptr) {
+        out.append(R"(,"transactionIndex":)");
+        append_quantity(out, location->transaction_index);
+    }
+    out.append(R"(,"v":)");
+    append_quantity(out, silkworm::rlp::big_endian(transaction.v()));
+    out.append(R"(,"value":)");
+    append_quantity(out, transaction.value);
+    out.push_back('}');
+}
+
+void serialize(std::string& out, const Log& log) {
+    out.append(R"({"address":)");
+    append_address(out, log.address);
+    out.append(R"(,"blockHash":)");
+    append_bytes32(out, log.block_hash);
+    out.append(R"(,"blockNumber":)");
+    append_quantity(out, log.block_number);
+    out.append(R"(,"data":)");
+    append_bytes(out, log.data);
+    out.append(R"(,"logIndex":)");
+    append_quantity(out, log.index);
+    out.append(log.removed ? R"(,"removed":true,"topics":[)" : R"(,"removed":false,"topics":[)");
+    for (std::size_t i{0}; i < log.topics.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        append_bytes32(out, log.topics[i]);
+    }
+    out.append(R"(],"transactionHash":)");
+    append_bytes32(out, log.tx_hash);
+    out.append(R"(,"transactionIndex":)");
+    append_quantity(out, log.tx_index);
+    out.push_back('}');
+}
+
+void serialize(std::string& out, const Logs& logs) {
+    out.push_back('[');
+    for (std::size_t i{0}; i < logs.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        serialize(out, logs[i]);
+    }
+    out.push_back(']');
+}
+
+void serialize(std::string& out, const Receipt& receipt) {
+    out.append(R"({"blockHash":)");
+    append_bytes32(out, receipt.block_hash);
+    out.append(R"(,"blockNumber":)");
+    append_quantity(out, receipt.block_number);
+    out.append(R"(,"contractAddress":)");
+    if (receipt.contract_address) {
+        append_address(out, receipt.contract_address);
+    } else {
+        out.append("null");
+    }
+    out.append(R"(,"cumulativeGasUsed":)");
+    append_quantity(out, receipt.cumulative_gas_used);
+    out.append(R"(,"from":)");
+    append_address(out, receipt.from.value_or(evmc::address{}));
+    out.append(R"(,"gasUsed":)");
+    append_quantity(out, receipt.gas_used);
+    out.append(R"(,"logs":)");
+    serialize(out, receipt.logs);
+    out.append(R"(,"logsBloom":)");
+    append_bytes(out, silkworm::full_view(receipt.bloom));
+    out.append(receipt.success ? R"(,"status":"0x1","to":)" : R"(,"status":"0x0","to":)");
+    append_address(out, receipt.to.value_or(evmc::address{}));
+    out.append(R"(,"transactionHash":)");
+    append_bytes32(out, receipt.tx_hash);
+    out.append(R"(,"transactionIndex":)");
+    append_quantity(out, receipt.tx_index);
+    out.append(R"(,"type":)");
+    append_quantity(out, receipt.type ? receipt.type.value() : 0);
+    out.push_back('}');
+}
+
+void serialize(std::string& out, const Receipts& receipts) {
+    out.push_back('[');
+    for (std::size_t i{0}; i < receipts.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        serialize(out, receipts[i]);
+    }
+    out.push_back(']');
+}
+
+void serialize(std::string& out, const silkworm::BlockHeader& header) {
+    out.append(R"({"difficulty":)");
+    append_quantity(out, silkworm::rlp::big_endian(header.difficulty));
+    out.append(R"(,"extraData":)");
+    append_bytes(out, header.extra_data);
+    out.append(R"(,"gasLimit":)");
+    append_quantity(out, header.gas_limit);
+    out.append(R"(,"gasUsed":)");
+    append_quantity(out, header.gas_used);
+    out.append(R"(,"logsBloom":)");
+    append_bytes(out, silkworm::full_view(header.logs_bloom));
+    out.append(R"(,"miner":)");
+    append_address(out, header.beneficiary);
+    out.append(R"(,"mixHash":)");
+    append_bytes32(out, header.mix_hash);
+    out.append(R"(,"nonce":)");
+    append_quantity(out, {header.nonce.data(), header.nonce.size()});
+    out.append(R"(,"number":)");
+    append_quantity(out, header.number);
+    out.append(R"(,"parentHash":)");
+    append_bytes32(out, header.parent_hash);
+    out.append(R"(,"receiptsRoot":)");
+    append_bytes32(out, header.receipts_root);
+    out.append(R"(,"sha3Uncles":)");
+    append_bytes32(out, header.ommers_hash);
+    out.append(R"(,"stateRoot":)");
+    append_bytes32(out, header.state_root);
+    out.append(R"(,"timestamp":)");
+    append_quantity(out, header.timestamp);
+    out.append(R"(,"transactionsRoot":)");
+    append_bytes32(out, header.transactions_root);
+    out.push_back('}');
+}
+
+void serialize(std::string& out, const silkworm::Transaction& transaction) {
+    serialize(out, transaction, nullptr);
+}
+
+void serialize(std::string& out, const Transaction& transaction) {
+    const TransactionLocation location{transaction.block_hash, transaction.block_number, transaction.transaction_index};
+    serialize(out, transaction, &location);
+}
+
+void serialize(std::string& out, const Block& b) {
+    const auto& header = b.block.header;
+    out.append(R"({"difficulty":)");
+    append_quantity(out, silkworm::rlp::big_endian(header.difficulty));
+    out.append(R"(,"extraData":)");
+    append_bytes(out, header.extra_data);
+    out.append(R"(,"gasLimit":)");
+    append_quantity(out, header.gas_limit);
+    out.append(R"(,"gasUsed":)");
+    append_quantity(out, header.gas_used);
+    out.append(R"(,"hash":)");
+    append_bytes32(out, b.hash);
+    out.append(R"(,"logsBloom":)");
+    append_bytes(out, silkworm::full_view(header.logs_bloom));
+    out.append(R"(,"miner":)");
+    append_address(out, header.beneficiary);
+    out.append(R"(,"mixHash":)");
+    append_bytes32(out, header.mix_hash);
+    out.append(R"(,"nonce":)");
+    append_quantity(out, {header.nonce.data(), header.nonce.size()});
+    out.append(R"(,"number":)");
+    append_quantity(out, header.number);
+    out.append(R"(,"parentHash":)");
+    append_bytes32(out, header.parent_hash);
+    out.append(R"(,"receiptsRoot":)");
+    append_bytes32(out, header.receipts_root);
+    out.append(R"(,"sha3Uncles":)");
+    append_bytes32(out, header.ommers_hash);
+    out.append(R"(,"size":)");
+    silkworm::Bytes block_rlp{};
+    silkworm::rlp::encode(block_rlp, b.block);
+    append_quantity(out, block_rlp.length());
+    out.append(R"(,"stateRoot":)");
+    append_bytes32(out, header.state_root);
+    out.append(R"(,"timestamp":)");
+    append_quantity(out, header.timestamp);
+    out.append(R"(,"totalDifficulty":)");
+    append_quantity(out, silkworm::rlp::big_endian(b.total_difficulty));
+    out.append(R"(,"transactions":[)");
+    for (std::size_t i{0}; i < b.block.transactions.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        if (b.full_tx) {
+            const TransactionLocation location{b.hash, header.number, i};
+            serialize(out, b.block.transactions[i], &location);
+        } else {
+            const auto ethash_hash{hash_of_transaction(b.block.transactions[i])};
+            append_bytes(out, {ethash_hash.bytes, silkworm::kHashLength});
+        }
+    }
+    out.append(R"(],"transactionsRoot":)");
+    append_bytes32(out, header.transactions_root);
+    out.append(R"(,"uncles":[)");
+    for (std::size_t i{0}; i < b.block.ommers.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        append_bytes32(out, b.block.ommers[i].hash());
+    }
+    out.append("]}");
+}
+
+} // namespace silkrpc::json
@@ -0,0 +1,61 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_JSON_SERIALIZER_HPP_
+#define SILKRPC_JSON_SERIALIZER_HPP_
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+
+#include <silkrpc/types/block.hpp>
+#include <silkrpc/types/log.hpp>
+#include <silkrpc/types/receipt.hpp>
+#include <silkrpc/types/transaction.hpp>
+#include <silkworm/types/block.hpp>
+#include <silkworm/types/transaction.hpp>
+
+namespace silkrpc::json {
+
+// Writers of the JSON text of the hot reply types straight into the output, with no intermediate nlohmann::json tree.
+// Each one appends exactly the same bytes as nlohmann::json(value).dump(), i.e. compact and with the keys sorted.
+
+void serialize(std::string& out, const Log& log);
+void serialize(std::string& out, const Logs& logs);
+
+void serialize(std::string& out, const Receipt& receipt);
+void serialize(std::string& out, const Receipts& receipts);
+
+void serialize(std::string& out, const silkworm::BlockHeader& header);
+
+void serialize(std::string& out, const silkworm::Transaction& transaction);
+void serialize(std::string& out, const Transaction& transaction);
+
+void serialize(std::string& out, const Block& block);
+
+/// Append the same bytes as make_json_content(id, result).dump(), the result being serialized directly.
+template <typename T>
+void serialize_content(std::string& out, uint32_t id, const T& result) {
+    char id_digits[10];
+    const auto id_end = std::to_chars(id_digits, id_digits + sizeof(id_digits), id).ptr;
+    out.append(R"({"id":)").append(id_digits, id_end).append(R"(,"jsonrpc":"2.0","result":)");
+    serialize(out, result);
+    out.push_back('}');
+}
+
+} // namespace silkrpc::json
+
+#endif  // SILKRPC_JSON_SERIALIZER_HPP_
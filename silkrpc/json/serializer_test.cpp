@@ -0,0 +1,198 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "serializer.hpp"
+
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+#include <intx/intx.hpp>
+#include <nlohmann/json.hpp>
+#include <silkworm/common/util.hpp>
+
+#include <silkrpc/json/types.hpp>
+
+namespace silkrpc::json {
+
+using evmc::literals::operator""_address, evmc::literals::operator""_bytes32;
+
+template <typename T>
+static std::string serialize(const T& value) {
+    std::string out;
+    serialize(out, value);
+    return out;
+}
+
+static silkworm::Transaction make_legacy_transaction() {
+    return silkworm::Transaction{
+        std::nullopt,
+        0,
+        intx::uint256{0},
+        uint64_t{0},
+        0x0715a7794a1dc8e42615f059dd6e406a6594651a_address,
+        intx::uint256{0},
+        *silkworm::from_hex("001122aabbcc"),
+        false,
+        intx::uint256{1},
+        intx::uint256{18},
+        intx::uint256{36},
+        std::vector<silkworm::AccessListEntry>{},
+        0x007fb8417eb9ad4d958b050fc3720d5b46a2c053_address
+    };
+}
+
+TEST_CASE("serialize log", "[silkrpc][json][serializer]") {
+    SECTION("empty log") {
+        Log log{{}, {}, {}};
+        CHECK(serialize(log) == nlohmann::json(log).dump());
+    }
+    SECTION("full log") {
+        Log log{
+            0x0715a7794a1dc8e42615f059dd6e406a6594651a_address,
+            {0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32, 0x0000000000000000000000000000000000000000000000000000000000000001_bytes32},
+            *silkworm::from_hex("0001ff0100"),
+            4206337,
+            0x474f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126d_bytes32,
+            3,
+            0xb02a3b0ee16c858afaa34bcd6770b3c20ee56aa2f75858733eb0e927b5b7126f_bytes32,
+            17,
+            true
+        };
+        CHECK(serialize(log) == nlohmann::json(log).dump());
+    }
+    SECTION("logs") {
+        Logs logs{Log{}, Log{{}, {}, {}, 4206337}};
+        CHECK(serialize(logs) == nlohmann::json(logs).dump());
+        CHECK(serialize(Logs{}) == "[]");
+    }
+}
+
+TEST_CASE("serialize receipt", "[silkrpc][json][serializer]") {
+    SECTION("empty receipt") {
+        Receipt receipt{};
+        CHECK(serialize(receipt) == nlohmann::json(receipt).dump());
+    }
+    SECTION("full receipt") {
+        Receipt receipt{
+            true,
+            454647,
+            silkworm::Bloom{},
+            Logs{Log{}, Log{{}, {}, {}, 4206337}},
+            0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32,
+            0x0715a7794a1dc8e42615f059dd6e406a6594651a_address,
+            10,
+            0xb02a3b0ee16c858afaa34bcd6770b3c20ee56aa2f75858733eb0e927b5b7126f_bytes32,
+            5000000,
+            3,
+            0x22ea9f6b28db76a7162054c05ed812deb2f519cd_address,
+            0x22ea9f6b28db76a7162054c05ed812deb2f519cd_address,
+            1
+        };
+        receipt.bloom[0] = 0x80;
+        CHECK(serialize(receipt) == nlohmann::json(receipt).dump());
+        CHECK(serialize(Receipts{receipt, Receipt{}}) == nlohmann::json(Receipts{receipt, Receipt{}}).dump());
+    }
+}
+
+TEST_CASE("serialize block header", "[silkrpc][json][serializer]") {
+    SECTION("empty block header") {
+        silkworm::BlockHeader header{};
+        CHECK(serialize(header) == nlohmann::json(header).dump());
+    }
+    SECTION("full block header") {
+        silkworm::BlockHeader header{
+            0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32,
+            0x474f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126d_bytes32,
+            0x0715a7794a1dc8e42615f059dd6e406a6594651a_address,
+            0xb02a3b0ee16c858afaa34bcd6770b3c20ee56aa2f75858733eb0e927b5b7126d_bytes32,
+            0xb02a3b0ee16c858afaa34bcd6770b3c20ee56aa2f75858733eb0e927b5b7126e_bytes32,
+            0xb02a3b0ee16c858afaa34bcd6770b3c20ee56aa2f75858733eb0e927b5b7126f_bytes32,
+            silkworm::Bloom{},
+            intx::uint256{0x0f0102},
+            uint64_t(5),
+            uint64_t(1000000),
+            uint64_t(1000000),
+            uint64_t(5405021),
+            *silkworm::from_hex("0001FF0100"),
+            0x0000000000000000000000000000000000000000000000000000000000000001_bytes32,
+            {0, 0, 0, 0, 0, 0, 0, 255}
+        };
+        CHECK(serialize(header) == nlohmann::json(header).dump());
+    }
+}
+
+TEST_CASE("serialize transaction", "[silkrpc][json][serializer]") {
+    SECTION("empty transaction") {
+        silkworm::Transaction transaction{};
+        CHECK(serialize(transaction) == nlohmann::json(transaction).dump());
+    }
+    SECTION("transaction from zero address") {
+        silkworm::Transaction transaction{};
+        transaction.from = 0x0000000000000000000000000000000000000000_address;
+        CHECK(serialize(transaction) == nlohmann::json(transaction).dump());
+    }
+    SECTION("legacy transaction") {
+        const auto transaction{make_legacy_transaction()};
+        CHECK(serialize(transaction) == nlohmann::json(transaction).dump());
+    }
+    SECTION("EIP-2930 transaction") {
+        auto transaction{make_legacy_transaction()};
+        transaction.type = silkworm::kEip2930TransactionType;
+        CHECK(serialize(transaction) == nlohmann::json(transaction).dump());
+    }
+    SECTION("transaction in block") {
+        Transaction transaction{make_legacy_transaction()};
+        transaction.block_hash = 0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32;
+        transaction.block_number = 123123;
+        transaction.transaction_index = 3;
+        CHECK(serialize(transaction) == nlohmann::json(transaction).dump());
+    }
+}
+
+TEST_CASE("serialize block", "[silkrpc][json][serializer]") {
+    SECTION("empty block") {
+        Block block{};
+        CHECK(serialize(block) == nlohmann::json(block).dump());
+    }
+    SECTION("block with transaction hashes") {
+        Block block{};
+        block.hash = 0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32;
+        block.block.header.number = 5;
+        block.block.transactions = {make_legacy_transaction(), silkworm::Transaction{}};
+        block.block.ommers = {silkworm::BlockHeader{}};
+        block.total_difficulty = intx::uint256{0x10000};
+        CHECK(serialize(block) == nlohmann::json(block).dump());
+    }
+    SECTION("block with full transactions") {
+        Block block{};
+        block.hash = 0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32;
+        block.block.header.number = 5;
+        block.block.transactions = {make_legacy_transaction(), silkworm::Transaction{}};
+        block.full_tx = true;
+        CHECK(serialize(block) == nlohmann::json(block).dump());
+    }
+}
+
+TEST_CASE("serialize json content", "[silkrpc][json][serializer]") {
+    Log log{{}, {}, {}, 4206337};
+    std::string out;
+    serialize_content(out, 42, log);
+    CHECK(out == make_json_content(42, log).dump());
+}
+
+} // namespace silkrpc::json
@@ -0,0 +1,43 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_JSON_STREAM_WRITER_HPP_
+#define SILKRPC_JSON_STREAM_WRITER_HPP_
+
+#include <silkrpc/config.hpp>
+
+#include <string_view>
+
+#include <asio/awaitable.hpp>
+
+namespace silkrpc {
+
+/// Destination of a JSON reply content written incrementally, so that it can be sent before being complete.
+class StreamWriter {
+public:
+    virtual ~StreamWriter() = default;
+
+    /// Write some content, suspending while too much written content is waiting to be sent (i.e. backpressure).
+    virtual asio::awaitable<void> write(std::string_view content) = 0;
+
+    /// Discard the content written but not sent yet. Return true if nothing has been sent, so that another content
+    /// can be written instead, false otherwise: the partially sent content is broken and its transfer is aborted.
+    virtual bool discard() = 0;
+};
+
+} // namespace silkrpc
+
+#endif // SILKRPC_JSON_STREAM_WRITER_HPP_
@@ -20,56 +20,47 @@
 #include <cstring>
 #include <utility>
 
-#include <boost/endian/conversion.hpp>
 #include <intx/intx.hpp>
 #include <silkworm/common/util.hpp>
 #include <silkworm/db/silkworm/db/util.hpp>
 
+#include <silkrpc/common/hex.hpp>
 #include <silkrpc/common/log.hpp>
 #include <silkrpc/common/util.hpp>
 
 namespace silkrpc {
 
-std::string to_hex_no_leading_zeros(silkworm::ByteView bytes) {
-    static const char* kHexDigits{"0123456789abcdef"};
-
-    std::string out{};
-    out.reserve(2 * bytes.length());
-
-    bool found_nonzero{false};
-    for (size_t i{0}; i < bytes.length(); ++i) {
-        uint8_t x{bytes[i]};
-        char lo{kHexDigits[x & 0x0f]};
-        char hi{kHexDigits[x >> 4]};
-        if (!found_nonzero && hi != '0') {
-            found_nonzero = true;
-        }
-        if (found_nonzero) {
-            out.push_back(hi);
-        }
-        if (!found_nonzero && lo != '0') {
-            found_nonzero = true;
-        }
-        if (found_nonzero || i == bytes.length() - 1) {
-            out.push_back(lo);
-        }
-    }
+// Same as "0x" + silkworm::to_hex, without the intermediate strings
+static std::string to_prefixed_hex(const uint8_t* data, std::size_t size) {
+    std::string out(2 + 2 * size, '\0');
+    out[0] = '0';
+    out[1] = 'x';
+    hex::encode(data, size, out.data() + 2);
+    return out;
+}
 
+std::string to_hex_no_leading_zeros(silkworm::ByteView bytes) {
+    std::string out(2 * bytes.length(), '\0');
+    out.resize(hex::encode_no_leading_zeros(bytes.data(), bytes.length(), out.data()));
     return out;
 }
 
 std::string to_hex_no_leading_zeros(uint64_t number) {
-    silkworm::Bytes number_bytes(8, '\0');
-    boost::endian::store_big_u64(&number_bytes[0], number);
-    return to_hex_no_leading_zeros(number_bytes);
+    char digits[16];
+    return std::string(digits, hex::encode_no_leading_zeros(number, digits));
 }
 
 std::string to_quantity(silkworm::ByteView bytes) {
-    return "0x" + to_hex_no_leading_zeros(bytes);
+    std::string out(2 + 2 * bytes.length(), '\0');
+    out[0] = '0';
+    out[1] = 'x';
+    out.resize(2 + hex::encode_no_leading_zeros(bytes.data(), bytes.length(), out.data() + 2));
+    return out;
 }
 
 std::string to_quantity(uint64_t number) {
-    return "0x" + to_hex_no_leading_zeros(number);
+    char digits[18]{'0', 'x'};
+    return std::string(digits, 2 + hex::encode_no_leading_zeros(number, digits + 2));
 }
 
 std::string to_quantity(intx::uint256 number) {
@@ -84,19 +75,25 @@ std::string to_quantity(intx::uint256 number) {
 namespace evmc {
 
 void to_json(nlohmann::json& json, const address& addr) {
-    json = "0x" + silkworm::to_hex(addr);
+    json = silkrpc::to_prefixed_hex(addr.bytes, sizeof(addr.bytes));
 }
 
 void from_json(const nlohmann::json& json, address& addr) {
+    if (json.is_string() && silkrpc::hex::decode_prefixed(json.get_ref<const std::string&>(), addr.bytes, sizeof(addr.bytes))) {
+        return;
+    }
     const auto address_bytes = silkworm::from_hex(json.get<std::string>());
     addr = silkworm::to_address(address_bytes.value_or(silkworm::Bytes{}));
 }
 
 void to_json(nlohmann::json& json, const bytes32& b32) {
-    json = "0x" + silkworm::to_hex(b32);
+    json = silkrpc::to_prefixed_hex(b32.bytes, sizeof(b32.bytes));
 }
 
 void from_json(const nlohmann::json& json, bytes32& b32) {
+    if (json.is_string() && silkrpc::hex::decode_prefixed(json.get_ref<const std::string&>(), b32.bytes, sizeof(b32.bytes))) {
+        return;
+    }
     const auto b32_bytes = silkworm::from_hex(json.get<std::string>());
     b32 = silkworm::to_bytes32(b32_bytes.value_or(silkworm::Bytes{}));
 }
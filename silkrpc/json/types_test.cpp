@@ -42,6 +42,15 @@ TEST_CASE("convert positive uint256 to quantity", "[silkrpc][to_quantity]") {
     CHECK(positive_quantity == "0x64");
 }
 
+TEST_CASE("convert bytes to quantity", "[silkrpc][to_quantity]") {
+    CHECK(to_quantity(silkworm::ByteView{}) == "0x");
+    CHECK(to_quantity(*silkworm::from_hex("0000000000000000")) == "0x0");
+    CHECK(to_quantity(*silkworm::from_hex("000000000000000000000000000000000000000000000000000000000000000f")) == "0xf");
+    CHECK(to_quantity(*silkworm::from_hex("0000000000000000000000000000000000000000000000000de0b6b3a7640000")) == "0xde0b6b3a7640000");
+    CHECK(to_quantity(uint64_t{0}) == "0x0");
+    CHECK(to_quantity(uint64_t{0xffffffffffffffff}) == "0xffffffffffffffff");
+}
+
 TEST_CASE("serialize empty address", "[silkrpc][to_json]") {
     evmc::address address{};
     nlohmann::json j = address;
@@ -20,6 +20,7 @@
 #include <exception>
 #include <filesystem>
 #include <iostream>
+#include <memory>
 #include <thread>
 
 #include <absl/flags/flag.h>
@@ -37,16 +38,50 @@
 #include <silkrpc/context_pool.hpp>
 #include <silkrpc/common/constants.hpp>
 #include <silkrpc/common/log.hpp>
+#include <silkrpc/http/method_table.hpp>
 #include <silkrpc/http/server.hpp>
+#include <silkrpc/ipc/server.hpp>
 #include <silkrpc/ethdb/kv/remote_database.hpp>
 #include <silkrpc/ethdb/kv/version.hpp>
+#ifdef SILKRPC_HAS_MDBX
+#include <silkrpc/ethdb/local/local_database.hpp>
+#endif
+#include <silkrpc/ethdb/pooled_database.hpp>
+#include <silkrpc/subscription/broker.hpp>
+#include <silkrpc/subscription/state_changes_consumer.hpp>
 
 ABSL_FLAG(std::string, chaindata, silkrpc::common::kEmptyChainData, "chain data path as string");
 ABSL_FLAG(std::string, local, silkrpc::common::kDefaultLocal, "HTTP JSON local binding as string <address>:<port>");
+ABSL_FLAG(std::string, ipc, silkrpc::common::kEmptyIpcPath, "IPC Unix domain socket path as string (empty disables IPC)");
 ABSL_FLAG(std::string, target, silkrpc::common::kDefaultTarget, "TG Core gRPC service location as string <address>:<port>");
 ABSL_FLAG(uint32_t, numContexts, std::thread::hardware_concurrency() / 2, "number of running I/O contexts as 32-bit integer");
 ABSL_FLAG(uint32_t, numWorkers, std::thread::hardware_concurrency(), "number of worker threads as 32-bit integer");
 ABSL_FLAG(uint32_t, timeout, silkrpc::common::kDefaultTimeout.count(), "gRPC call timeout as 32-bit integer");
+ABSL_FLAG(uint32_t, maxBatchSize, silkrpc::common::kDefaultMaxBatchSize, "maximum number of requests in one JSON-RPC batch as 32-bit integer");
+ABSL_FLAG(bool, reusePort, false, "use one SO_REUSEPORT acceptor per I/O context");
+ABSL_FLAG(uint32_t, maxAcceptsPerWakeup, silkrpc::common::kDefaultMaxAcceptsPerWakeup, "maximum number of connections accepted per wakeup as 32-bit integer");
+ABSL_FLAG(uint32_t, compressionThreshold, silkrpc::common::kDefaultCompressionThreshold, "minimum size of the replies compressed if accepted by the client as 32-bit integer (0 disables)");
+ABSL_FLAG(uint32_t, streamBufferSize, silkrpc::common::kDefaultStreamBufferSize, "size of the chunks sent by streamed replies as 32-bit integer (0 disables streaming)");
+ABSL_FLAG(uint32_t, maxInFlight, silkrpc::common::kDefaultMaxInFlight, "maximum number of requests handled concurrently as 32-bit integer (0 means unlimited)");
+ABSL_FLAG(uint32_t, maxQueueDepth, silkrpc::common::kDefaultMaxQueueDepth, "maximum number of requests waiting to be handled as 32-bit integer (0 means unlimited)");
+ABSL_FLAG(uint32_t, maxContextInFlight, silkrpc::common::kDefaultMaxContextInFlight, "maximum number of requests handled concurrently per I/O context as 32-bit integer (0 means unlimited)");
+ABSL_FLAG(uint32_t, maxContextQueueDepth, silkrpc::common::kDefaultMaxContextQueueDepth, "maximum number of requests waiting to be handled per I/O context as 32-bit integer (0 means unlimited)");
+ABSL_FLAG(uint32_t, maxContextHeavyInFlight, silkrpc::common::kDefaultMaxContextHeavyInFlight, "maximum number of heavy requests (e.g. eth_getLogs, eth_call) handled concurrently per I/O context as 32-bit integer (0 means unlimited)");
+ABSL_FLAG(uint32_t, retryAfter, silkrpc::common::kDefaultRetryAfter.count(), "delay in seconds suggested to the clients whose requests are shed as 32-bit integer");
+ABSL_FLAG(uint32_t, headerReadTimeout, silkrpc::common::kDefaultHeaderReadTimeout.count(), "HTTP request headers read timeout in milliseconds as 32-bit integer (0 disables)");
+ABSL_FLAG(uint32_t, bodyReadTimeout, silkrpc::common::kDefaultBodyReadTimeout.count(), "HTTP request content read timeout in milliseconds as 32-bit integer (0 disables)");
+ABSL_FLAG(uint32_t, idleTimeout, silkrpc::common::kDefaultIdleTimeout.count(), "HTTP keep-alive idle timeout in milliseconds as 32-bit integer (0 disables)");
+ABSL_FLAG(uint32_t, writeTimeout, silkrpc::common::kDefaultWriteTimeout.count(), "HTTP reply write timeout in milliseconds as 32-bit integer (0 disables)");
+ABSL_FLAG(uint32_t, maxConnections, silkrpc::common::kDefaultMaxConnections, "maximum number of HTTP connections, closing the oldest idle ones beyond it, as 32-bit integer (0 means unlimited)");
+ABSL_FLAG(uint32_t, maxBodySize, silkrpc::common::kDefaultMaxBodySize, "maximum size of the HTTP request content in bytes as 32-bit integer (0 means unlimited)");
+ABSL_FLAG(bool, coalesceRequests, silkrpc::common::kDefaultCoalesceRequests, "share one execution among the identical read-only calls in flight");
+ABSL_FLAG(bool, http2, false, "serve HTTP/2 cleartext (h2c) clients with prior knowledge on the same listener");
+ABSL_FLAG(uint32_t, http2MaxConcurrentStreams, silkrpc::common::kDefaultHttp2MaxConcurrentStreams, "maximum number of concurrent streams per HTTP/2 connection as 32-bit integer");
+ABSL_FLAG(std::string, api, silkrpc::common::kDefaultApiSpec, "comma-separated list of the enabled JSON-RPC API namespaces as string");
+ABSL_FLAG(bool, websocket, false, "accept WebSocket upgrades serving eth_subscribe notifications");
+ABSL_FLAG(uint32_t, maxPendingNotifications, silkrpc::common::kDefaultMaxPendingNotifications, "maximum number of notifications queued per WebSocket connection as 32-bit integer");
+ABSL_FLAG(uint32_t, txPoolSize, silkrpc::common::kDefaultTxPoolSize, "maximum number of idle KV transactions kept open for reuse per I/O context as 32-bit integer (0 disables pooling)");
+ABSL_FLAG(uint32_t, txMaxAge, silkrpc::common::kDefaultTxMaxAge.count(), "maximum age in milliseconds of the KV transactions reused from the pool as 32-bit integer");
 ABSL_FLAG(silkrpc::LogLevel, logLevel, silkrpc::LogLevel::Critical, "logging level");
 
 constexpr auto KV_SERVICE_API_VERSION = silkrpc::ethdb::kv::ProtocolVersion{3, 0, 0};
@@ -78,6 +113,13 @@ int main(int argc, char* argv[]) {
             SILKRPC_ERROR << "Use --chaindata flag to specify the path of Erigon database\n";
             return -1;
         }
+#ifndef SILKRPC_HAS_MDBX
+        if (!chaindata.empty()) {
+            SILKRPC_ERROR << "Parameter chaindata is not supported: Silkrpc built without MDBX\n";
+            SILKRPC_ERROR << "Use --target flag to specify the location of Erigon running instance\n";
+            return -1;
+        }
+#endif
 
         auto local{absl::GetFlag(FLAGS_local)};
         if (!local.empty() && local.find(kAddressPortSeparator) == std::string::npos) {
@@ -120,6 +162,35 @@ int main(int argc, char* argv[]) {
             return -1;
         }
 
+        auto maxBatchSize{absl::GetFlag(FLAGS_maxBatchSize)};
+        if (maxBatchSize == 0) {
+            SILKRPC_ERROR << "Parameter maxBatchSize is invalid: [" << maxBatchSize << "]\n";
+            SILKRPC_ERROR << "Use --maxBatchSize flag to specify the maximum number of requests in one JSON-RPC batch\n";
+            return -1;
+        }
+
+        auto maxAcceptsPerWakeup{absl::GetFlag(FLAGS_maxAcceptsPerWakeup)};
+        if (maxAcceptsPerWakeup == 0) {
+            SILKRPC_ERROR << "Parameter maxAcceptsPerWakeup is invalid: [" << maxAcceptsPerWakeup << "]\n";
+            SILKRPC_ERROR << "Use --maxAcceptsPerWakeup flag to specify the maximum number of connections accepted per wakeup\n";
+            return -1;
+        }
+
+        auto maxPendingNotifications{absl::GetFlag(FLAGS_maxPendingNotifications)};
+        if (maxPendingNotifications == 0) {
+            SILKRPC_ERROR << "Parameter maxPendingNotifications is invalid: [" << maxPendingNotifications << "]\n";
+            SILKRPC_ERROR << "Use --maxPendingNotifications flag to specify the maximum number of notifications queued per WebSocket connection\n";
+            return -1;
+        }
+
+        auto api{absl::GetFlag(FLAGS_api)};
+        const auto api_namespaces = silkrpc::http::parse_api_namespaces(api);
+        if (!api_namespaces) {
+            SILKRPC_ERROR << "Parameter api is invalid: [" << api << "]\n";
+            SILKRPC_ERROR << "Use --api flag to specify the enabled namespaces among web3, net, eth, debug, trace, tg, parity\n";
+            return -1;
+        }
+
         if (chaindata.empty()) {
             SILKRPC_LOG << "Silkrpc launched with target " << target << " using " << numContexts << " contexts\n";
         } else {
@@ -132,22 +203,81 @@ int main(int argc, char* argv[]) {
         };
 
         // Check KV protocol version compatibility
-        using std::chrono_literals::operator""ms;
-        silkrpc::ethdb::kv::ProtocolVersionCheck version_check;
-        while (!(version_check = silkrpc::ethdb::kv::check_protocol_version(create_channel(), KV_SERVICE_API_VERSION))) {
-            std::this_thread::sleep_for(1000ms);
+        if (!target.empty()) {
+            using std::chrono_literals::operator""ms;
+            silkrpc::ethdb::kv::ProtocolVersionCheck version_check;
+            while (!(version_check = silkrpc::ethdb::kv::check_protocol_version(create_channel(), KV_SERVICE_API_VERSION))) {
+                std::this_thread::sleep_for(1000ms);
+            }
+            if (!version_check.value().compatible) {
+                throw std::runtime_error{version_check.value().result};
+            }
+            SILKRPC_LOG << version_check.value().result << "\n";
         }
-        if (!version_check.value().compatible) {
-            throw std::runtime_error{version_check.value().result};
-        }
-        SILKRPC_LOG << version_check.value().result << "\n";
 
-        // TODO(canepat): handle also local (shared-memory) database
-        silkrpc::ContextPool context_pool{numContexts, create_channel};
+        // Pooled KV transactions are reused only until the state changes stream notifies a new block
+        const auto txPoolSize{absl::GetFlag(FLAGS_txPoolSize)};
+        auto head_version = std::make_shared<silkrpc::ethdb::ChainHeadVersion>();
+        silkrpc::ethdb::TransactionPoolSettings tx_pool_settings{txPoolSize, std::chrono::milliseconds{absl::GetFlag(FLAGS_txMaxAge)}, head_version};
+
+        // Co-located with Erigon the chain data is read from the shared-memory MDBX environment, the blocking reads running on dedicated workers
+        silkrpc::DatabaseFactory create_database;
+#ifdef SILKRPC_HAS_MDBX
+        std::shared_ptr<silkrpc::ethdb::local::Environment> chaindata_env;
+        std::unique_ptr<asio::thread_pool> chaindata_workers;
+        if (!chaindata.empty()) {
+            chaindata_env = std::make_shared<silkrpc::ethdb::local::Environment>(chaindata);
+            chaindata_workers = std::make_unique<asio::thread_pool>(numWorkers);
+            create_database = [&](asio::io_context& io_context) {
+                return std::make_unique<silkrpc::ethdb::local::LocalDatabase>(io_context, chaindata_env, *chaindata_workers);
+            };
+        }
+#endif
+        silkrpc::ContextPool context_pool{numContexts, create_channel, tx_pool_settings, create_database};
 
         const auto http_host = local.substr(0, local.find(kAddressPortSeparator));
         const auto http_port = local.substr(local.find(kAddressPortSeparator) + 1, std::string::npos);
-        silkrpc::http::Server http_server{http_host, http_port, context_pool, numWorkers};
+        silkrpc::http::ServerSettings http_settings;
+        http_settings.api_namespaces = *api_namespaces;
+        http_settings.max_batch_size = maxBatchSize;
+        http_settings.reuse_port = absl::GetFlag(FLAGS_reusePort);
+        http_settings.max_accepts_per_wakeup = maxAcceptsPerWakeup;
+        http_settings.max_pending_notifications = maxPendingNotifications;
+        http_settings.compression_threshold = absl::GetFlag(FLAGS_compressionThreshold);
+        http_settings.stream_buffer_size = absl::GetFlag(FLAGS_streamBufferSize);
+        http_settings.max_in_flight = absl::GetFlag(FLAGS_maxInFlight);
+        http_settings.max_queue_depth = absl::GetFlag(FLAGS_maxQueueDepth);
+        http_settings.max_context_in_flight = absl::GetFlag(FLAGS_maxContextInFlight);
+        http_settings.max_context_queue_depth = absl::GetFlag(FLAGS_maxContextQueueDepth);
+        http_settings.max_context_heavy_in_flight = absl::GetFlag(FLAGS_maxContextHeavyInFlight);
+        http_settings.retry_after = std::chrono::seconds{absl::GetFlag(FLAGS_retryAfter)};
+        http_settings.header_read_timeout = std::chrono::milliseconds{absl::GetFlag(FLAGS_headerReadTimeout)};
+        http_settings.body_read_timeout = std::chrono::milliseconds{absl::GetFlag(FLAGS_bodyReadTimeout)};
+        http_settings.idle_timeout = std::chrono::milliseconds{absl::GetFlag(FLAGS_idleTimeout)};
+        http_settings.write_timeout = std::chrono::milliseconds{absl::GetFlag(FLAGS_writeTimeout)};
+        http_settings.max_connections = absl::GetFlag(FLAGS_maxConnections);
+        http_settings.max_body_size = absl::GetFlag(FLAGS_maxBodySize);
+        http_settings.coalesce_requests = absl::GetFlag(FLAGS_coalesceRequests);
+        http_settings.http2 = absl::GetFlag(FLAGS_http2);
+        http_settings.http2_max_concurrent_streams = absl::GetFlag(FLAGS_http2MaxConcurrentStreams);
+
+        // Just one consumer of the KV state changes feeds all the WebSocket subscriptions and keeps the pooled transactions fresh
+        const auto websocket{absl::GetFlag(FLAGS_websocket)};
+        std::unique_ptr<silkrpc::subscription::Broker> broker;
+        std::unique_ptr<silkrpc::subscription::StateChangesConsumer> state_changes_consumer;
+        if (websocket || (txPoolSize > 0 && chaindata.empty())) {
+            broker = std::make_unique<silkrpc::subscription::Broker>();
+            state_changes_consumer = std::make_unique<silkrpc::subscription::StateChangesConsumer>(context_pool.get_context(), create_channel, *broker, head_version.get());
+            state_changes_consumer->start();
+        }
+        silkrpc::http::Server http_server{http_host, http_port, context_pool, numWorkers, http_settings, websocket ? broker.get() : nullptr};
+
+        // Co-located clients can skip TCP and HTTP framing using the IPC endpoint
+        const auto ipc_path{absl::GetFlag(FLAGS_ipc)};
+        std::unique_ptr<silkrpc::ipc::Server> ipc_server;
+        if (!ipc_path.empty()) {
+            ipc_server = std::make_unique<silkrpc::ipc::Server>(ipc_path, context_pool, http_server);
+        }
 
         auto& io_context = context_pool.get_io_context();
         asio::signal_set signals{io_context, SIGINT, SIGTERM};
@@ -155,11 +285,21 @@ int main(int argc, char* argv[]) {
         signals.async_wait([&](const asio::system_error& error, int signal_number) {
             std::cout << "\n";
             SILKRPC_INFO << "Signal caught, error: " << error.what() << " number: " << signal_number << "\n" << std::flush;
+            if (state_changes_consumer) {
+                state_changes_consumer->stop();
+            }
             context_pool.stop();
             http_server.stop();
+            if (ipc_server) {
+                ipc_server->stop();
+            }
         });
 
         http_server.start();
+        if (ipc_server) {
+            ipc_server->start();
+            SILKRPC_LOG << "Silkrpc IPC endpoint at " << ipc_path << "\n";
+        }
 
         SILKRPC_LOG << "Silkrpc running at " << local << " [pid=" << pid << ", main thread: " << tid << "]\n";
 
@@ -0,0 +1,150 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "broker.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/json/types.hpp>
+
+namespace silkrpc::subscription {
+
+Broker::Broker() : generator_{std::random_device{}()} {
+}
+
+std::string Broker::subscribe(std::weak_ptr<Subscriber> subscriber, Kind kind, const Filter& filter) {
+    const Subscriber* owner = subscriber.lock().get();
+    std::lock_guard lock{mutex_};
+    std::string subscription_id;
+    do {
+        subscription_id = to_quantity(generator_());
+    } while (subscriptions_.find(subscription_id) != subscriptions_.end());
+    subscriptions_.emplace(subscription_id, Subscription{std::move(subscriber), owner, kind, filter});
+    SILKRPC_DEBUG << "Broker::subscribe subscription_id: " << subscription_id << " #subscriptions: " << subscriptions_.size() << "\n";
+    return subscription_id;
+}
+
+bool Broker::unsubscribe(const std::string& subscription_id) {
+    std::lock_guard lock{mutex_};
+    return subscriptions_.erase(subscription_id) > 0;
+}
+
+void Broker::unsubscribe_all(const Subscriber* subscriber) {
+    std::lock_guard lock{mutex_};
+    for (auto it = subscriptions_.begin(); it != subscriptions_.end();) {
+        // No subscriber is locked here: releasing the last reference under the mutex would destroy it, re-entering the broker
+        if (it->second.owner == subscriber || it->second.subscriber.expired()) {
+            it = subscriptions_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool Broker::has_subscriptions(Kind kind) const {
+    std::lock_guard lock{mutex_};
+    return std::any_of(subscriptions_.begin(), subscriptions_.end(), [&](const auto& entry) { return entry.second.kind == kind; });
+}
+
+std::size_t Broker::num_subscriptions() const {
+    std::lock_guard lock{mutex_};
+    return subscriptions_.size();
+}
+
+void Broker::publish_new_head(const silkworm::BlockHeader& header, const evmc::bytes32& block_hash) {
+    const auto new_head_targets = targets(Kind::new_heads);
+    if (new_head_targets.empty()) {
+        return;
+    }
+
+    nlohmann::json header_json = header;
+    header_json["hash"] = block_hash;
+    const auto result = std::make_shared<const std::string>(header_json.dump());
+    for (const auto& target : new_head_targets) {
+        target.subscriber->notify(target.subscription_id, result);
+    }
+    SILKRPC_DEBUG << "Broker::publish_new_head number: " << header.number << " #subscribers: " << new_head_targets.size() << "\n";
+}
+
+void Broker::publish_logs(const std::vector<Log>& logs) {
+    const auto log_targets = targets(Kind::logs);
+    if (log_targets.empty() || logs.empty()) {
+        return;
+    }
+
+    // Serialize each log lazily, only if at least one filter matches it
+    std::vector<std::shared_ptr<const std::string>> results(logs.size());
+    for (std::size_t i{0}; i < logs.size(); ++i) {
+        for (const auto& target : log_targets) {
+            if (!matches(target.filter, logs[i])) {
+                continue;
+            }
+            if (!results[i]) {
+                results[i] = std::make_shared<const std::string>(nlohmann::json(logs[i]).dump());
+            }
+            target.subscriber->notify(target.subscription_id, results[i]);
+        }
+    }
+    SILKRPC_DEBUG << "Broker::publish_logs #logs: " << logs.size() << " #subscribers: " << log_targets.size() << "\n";
+}
+
+bool Broker::matches(const Filter& filter, const Log& log) {
+    if (filter.addresses && !filter.addresses->empty()) {
+        const auto& addresses = filter.addresses.value();
+        if (std::find(addresses.begin(), addresses.end(), log.address) == addresses.end()) {
+            return false;
+        }
+    }
+    if (filter.topics) {
+        const auto& topics = filter.topics.value();
+        if (topics.size() > log.topics.size()) {
+            return false;
+        }
+        for (std::size_t i{0}; i < topics.size(); ++i) {
+            const auto& subtopics = topics[i];
+            // Empty rule set is a wildcard
+            if (!subtopics.empty() && std::find(subtopics.begin(), subtopics.end(), log.topics[i]) == subtopics.end()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<Broker::Target> Broker::targets(Kind kind) {
+    std::vector<Target> kind_targets;
+    std::lock_guard lock{mutex_};
+    for (auto it = subscriptions_.begin(); it != subscriptions_.end();) {
+        if (it->second.subscriber.expired()) {
+            it = subscriptions_.erase(it);
+            continue;
+        }
+        if (it->second.kind == kind) {
+            // The locked subscribers are released by the caller, out of the mutex
+            if (auto subscriber = it->second.subscriber.lock()) {
+                kind_targets.push_back(Target{it->first, std::move(subscriber), it->second.filter});
+            }
+        }
+        ++it;
+    }
+    return kind_targets;
+}
+
+} // namespace silkrpc::subscription
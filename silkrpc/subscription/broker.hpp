@@ -0,0 +1,107 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_SUBSCRIPTION_BROKER_HPP_
+#define SILKRPC_SUBSCRIPTION_BROKER_HPP_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <evmc/evmc.hpp>
+#include <silkworm/types/block.hpp>
+
+#include <silkrpc/types/filter.hpp>
+#include <silkrpc/types/log.hpp>
+
+namespace silkrpc::subscription {
+
+/// The receiver of subscription notifications, it must accept notifications from any thread.
+class Subscriber {
+public:
+    virtual ~Subscriber() = default;
+
+    /// Deliver the JSON-serialized notification result for the given subscription.
+    virtual void notify(const std::string& subscription_id, std::shared_ptr<const std::string> result) = 0;
+};
+
+/// The kinds of subscription supported by eth_subscribe.
+enum class Kind {
+    new_heads,
+    logs
+};
+
+/// Registry of the active subscriptions, fanning out the published events to the matching subscribers.
+/// Each event result is serialized just once and shared by all the notified subscribers.
+class Broker {
+public:
+    Broker();
+
+    Broker(const Broker&) = delete;
+    Broker& operator=(const Broker&) = delete;
+
+    /// Register a new subscription for the subscriber, returning the subscription identifier.
+    std::string subscribe(std::weak_ptr<Subscriber> subscriber, Kind kind, const Filter& filter = {});
+
+    /// Remove the subscription, returning true if it was active.
+    bool unsubscribe(const std::string& subscription_id);
+
+    /// Remove all the subscriptions of the subscriber.
+    void unsubscribe_all(const Subscriber* subscriber);
+
+    /// Check if there is any subscription of the given kind.
+    bool has_subscriptions(Kind kind) const;
+
+    std::size_t num_subscriptions() const;
+
+    /// Notify the new block header to the newHeads subscriptions.
+    void publish_new_head(const silkworm::BlockHeader& header, const evmc::bytes32& block_hash);
+
+    /// Notify each log to the logs subscriptions whose filter matches it.
+    void publish_logs(const std::vector<Log>& logs);
+
+    /// Check if the log matches the addresses and topics of the filter.
+    static bool matches(const Filter& filter, const Log& log);
+
+private:
+    struct Subscription {
+        std::weak_ptr<Subscriber> subscriber;
+        const Subscriber* owner; // never dereferenced, just to identify the subscriber without locking it
+        Kind kind;
+        Filter filter;
+    };
+
+    struct Target {
+        std::string subscription_id;
+        std::shared_ptr<Subscriber> subscriber;
+        Filter filter;
+    };
+
+    /// Get the live subscriptions of the given kind, pruning the ones whose subscriber has gone.
+    std::vector<Target> targets(Kind kind);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Subscription> subscriptions_;
+    std::mt19937_64 generator_;
+};
+
+} // namespace silkrpc::subscription
+
+#endif // SILKRPC_SUBSCRIPTION_BROKER_HPP_
@@ -0,0 +1,139 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "broker.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+#include <nlohmann/json.hpp>
+
+namespace silkrpc::subscription {
+
+using Catch::Matchers::Message;
+using evmc::literals::operator""_address, evmc::literals::operator""_bytes32;
+
+class MockSubscriber : public Subscriber {
+public:
+    void notify(const std::string& subscription_id, std::shared_ptr<const std::string> result) override {
+        notifications.emplace_back(subscription_id, std::move(result));
+    }
+
+    std::vector<std::pair<std::string, std::shared_ptr<const std::string>>> notifications;
+};
+
+TEST_CASE("subscribe and unsubscribe", "[silkrpc][subscription][broker]") {
+    Broker broker;
+    auto subscriber = std::make_shared<MockSubscriber>();
+    CHECK(!broker.has_subscriptions(Kind::new_heads));
+
+    const auto id1 = broker.subscribe(subscriber, Kind::new_heads);
+    const auto id2 = broker.subscribe(subscriber, Kind::logs);
+    CHECK(id1 != id2);
+    CHECK(id1.substr(0, 2) == "0x");
+    CHECK(broker.num_subscriptions() == 2);
+    CHECK(broker.has_subscriptions(Kind::new_heads));
+    CHECK(broker.has_subscriptions(Kind::logs));
+
+    CHECK(broker.unsubscribe(id1));
+    CHECK(!broker.unsubscribe(id1));
+    CHECK(!broker.has_subscriptions(Kind::new_heads));
+
+    broker.unsubscribe_all(subscriber.get());
+    CHECK(broker.num_subscriptions() == 0);
+}
+
+TEST_CASE("publish new head", "[silkrpc][subscription][broker]") {
+    Broker broker;
+    auto subscriber1 = std::make_shared<MockSubscriber>();
+    auto subscriber2 = std::make_shared<MockSubscriber>();
+    const auto id1 = broker.subscribe(subscriber1, Kind::new_heads);
+    const auto id2 = broker.subscribe(subscriber2, Kind::new_heads);
+    broker.subscribe(subscriber2, Kind::logs);
+
+    silkworm::BlockHeader header{};
+    header.number = 5;
+    broker.publish_new_head(header, 0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32);
+
+    REQUIRE(subscriber1->notifications.size() == 1);
+    REQUIRE(subscriber2->notifications.size() == 1);
+    CHECK(subscriber1->notifications[0].first == id1);
+    CHECK(subscriber2->notifications[0].first == id2);
+    // The result is serialized once and shared by all the subscribers
+    CHECK(subscriber1->notifications[0].second == subscriber2->notifications[0].second);
+    const auto result = nlohmann::json::parse(*subscriber1->notifications[0].second);
+    CHECK(result["number"] == "0x5");
+    CHECK(result["hash"] == "0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c");
+}
+
+TEST_CASE("publish logs", "[silkrpc][subscription][broker]") {
+    Broker broker;
+    const auto address1{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+    const auto address2{0x1715a7794a1dc8e42615f059dd6e406a6594651a_address};
+    const auto topic{0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32};
+
+    auto all_subscriber = std::make_shared<MockSubscriber>();
+    auto address_subscriber = std::make_shared<MockSubscriber>();
+    auto topic_subscriber = std::make_shared<MockSubscriber>();
+    broker.subscribe(all_subscriber, Kind::logs);
+    broker.subscribe(address_subscriber, Kind::logs, Filter{{}, {}, FilterAddresses{address2}, {}, {}});
+    broker.subscribe(topic_subscriber, Kind::logs, Filter{{}, {}, {}, FilterTopics{{topic}}, {}});
+
+    std::vector<Log> logs(2);
+    logs[0].address = address1;
+    logs[0].topics = {topic};
+    logs[1].address = address2;
+    broker.publish_logs(logs);
+
+    CHECK(all_subscriber->notifications.size() == 2);
+    REQUIRE(address_subscriber->notifications.size() == 1);
+    REQUIRE(topic_subscriber->notifications.size() == 1);
+    CHECK(address_subscriber->notifications[0].second == all_subscriber->notifications[1].second);
+    CHECK(topic_subscriber->notifications[0].second == all_subscriber->notifications[0].second);
+}
+
+TEST_CASE("matches", "[silkrpc][subscription][broker]") {
+    const auto address{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+    const auto topic1{0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32};
+    const auto topic2{0x474f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126d_bytes32};
+    Log log{address, {topic1, topic2}};
+
+    CHECK(Broker::matches(Filter{}, log));
+    CHECK(Broker::matches(Filter{{}, {}, FilterAddresses{}, {}, {}}, log));
+    CHECK(Broker::matches(Filter{{}, {}, FilterAddresses{address}, {}, {}}, log));
+    CHECK(!Broker::matches(Filter{{}, {}, FilterAddresses{0x1715a7794a1dc8e42615f059dd6e406a6594651a_address}, {}, {}}, log));
+    CHECK(Broker::matches(Filter{{}, {}, {}, FilterTopics{{}, {topic2}}, {}}, log));
+    CHECK(Broker::matches(Filter{{}, {}, {}, FilterTopics{{topic1, topic2}}, {}}, log));
+    CHECK(!Broker::matches(Filter{{}, {}, {}, FilterTopics{{topic2}}, {}}, log));
+    CHECK(!Broker::matches(Filter{{}, {}, {}, FilterTopics{{}, {}, {}}, {}}, log));
+}
+
+TEST_CASE("expired subscribers", "[silkrpc][subscription][broker]") {
+    Broker broker;
+    auto subscriber = std::make_shared<MockSubscriber>();
+    broker.subscribe(subscriber, Kind::new_heads);
+    broker.subscribe(subscriber, Kind::logs);
+    subscriber.reset();
+
+    broker.publish_new_head(silkworm::BlockHeader{}, evmc::bytes32{});
+    CHECK(broker.num_subscriptions() == 0);
+}
+
+} // namespace silkrpc::subscription
@@ -0,0 +1,80 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "state_changes_consumer.hpp"
+
+#include <exception>
+#include <vector>
+
+#include <silkrpc/common/log.hpp>
+#include <silkrpc/core/rawdb/chain.hpp>
+#include <silkrpc/core/receipts.hpp>
+#include <silkrpc/ethdb/transaction_database.hpp>
+#include <silkrpc/types/log.hpp>
+
+namespace silkrpc::subscription {
+
+void StateChangesConsumer::start() {
+    stream_.open([this](const remote::StateChange& state_change) { return publish(state_change); }, [this](bool opened) {
+        if (head_version_) {
+            head_version_->set_tracked(opened);
+        }
+    });
+}
+
+void StateChangesConsumer::stop() {
+    stream_.close();
+}
+
+asio::awaitable<void> StateChangesConsumer::publish(const remote::StateChange& state_change) {
+    // Any change (unwinds included) makes the snapshots taken so far stale, also the one used below must be fresh
+    if (head_version_) {
+        head_version_->advance();
+    }
+    // Blocks are notified only when added to the canonical chain, unwound ones are not notified as removed
+    if (state_change.direction() != remote::Direction::FORWARD) {
+        co_return;
+    }
+    const bool notify_new_heads = broker_.has_subscriptions(Kind::new_heads);
+    const bool notify_logs = broker_.has_subscriptions(Kind::logs);
+    if (!notify_new_heads && !notify_logs) {
+        co_return;
+    }
+
+    const auto block_number = state_change.blockheight();
+    auto tx = co_await context_.database->begin();
+    try {
+        ethdb::TransactionDatabase tx_database{*tx};
+        const auto block_hash = co_await core::rawdb::read_canonical_block_hash(tx_database, block_number);
+        if (notify_new_heads) {
+            const auto header = co_await core::rawdb::read_header(tx_database, block_hash, block_number);
+            broker_.publish_new_head(header, block_hash);
+        }
+        if (notify_logs) {
+            const auto receipts = co_await core::get_receipts(tx_database, block_hash, block_number);
+            std::vector<Log> logs;
+            for (const auto& receipt : receipts) {
+                logs.insert(logs.end(), receipt.logs.begin(), receipt.logs.end());
+            }
+            broker_.publish_logs(logs);
+        }
+    } catch (const std::exception& e) {
+        SILKRPC_ERROR << "StateChangesConsumer::publish block: " << block_number << " exception: " << e.what() << "\n";
+    }
+    co_await tx->close();
+}
+
+} // namespace silkrpc::subscription
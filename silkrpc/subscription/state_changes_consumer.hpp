@@ -0,0 +1,59 @@
+/*
+    Copyright 2021 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SILKRPC_SUBSCRIPTION_STATE_CHANGES_CONSUMER_HPP_
+#define SILKRPC_SUBSCRIPTION_STATE_CHANGES_CONSUMER_HPP_
+
+#include <silkrpc/config.hpp>
+
+#include <asio/awaitable.hpp>
+
+#include <silkrpc/context_pool.hpp>
+#include <silkrpc/ethdb/pooled_database.hpp>
+#include <silkrpc/ethdb/kv/state_changes_stream.hpp>
+#include <silkrpc/interfaces/remote/kv.pb.h>
+#include <silkrpc/subscription/broker.hpp>
+
+namespace silkrpc::subscription {
+
+/// The single consumer of the KV state changes shared by all the subscriptions: at each new block it reads
+/// header and receipts just once and publishes them to the broker, which fans them out to the subscribers.
+/// If given, the chain head version is advanced at each change so that the pooled transactions become stale.
+class StateChangesConsumer {
+public:
+    explicit StateChangesConsumer(Context& context, ChannelFactory create_channel, Broker& broker, ethdb::ChainHeadVersion* head_version = nullptr)
+    : context_(context), broker_(broker), head_version_(head_version), stream_{context, create_channel} {}
+
+    StateChangesConsumer(const StateChangesConsumer&) = delete;
+    StateChangesConsumer& operator=(const StateChangesConsumer&) = delete;
+
+    void start();
+
+    void stop();
+
+    /// Publish the new block notified by the state change, if anyone is interested.
+    asio::awaitable<void> publish(const remote::StateChange& state_change);
+
+private:
+    Context& context_;
+    Broker& broker_;
+    ethdb::ChainHeadVersion* head_version_;
+    ethdb::kv::StateChangesStream stream_;
+};
+
+} // namespace silkrpc::subscription
+
+#endif // SILKRPC_SUBSCRIPTION_STATE_CHANGES_CONSUMER_HPP_
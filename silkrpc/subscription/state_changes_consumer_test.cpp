@@ -0,0 +1,71 @@
+/*
+   Copyright 2021 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "state_changes_consumer.hpp"
+
+#include <memory>
+#include <string>
+
+#include <asio/co_spawn.hpp>
+#include <asio/use_future.hpp>
+#include <catch2/catch.hpp>
+
+namespace silkrpc::subscription {
+
+using Catch::Matchers::Message;
+
+class NullSubscriber : public Subscriber {
+public:
+    void notify(const std::string& /*subscription_id*/, std::shared_ptr<const std::string> /*result*/) override {}
+};
+
+TEST_CASE("StateChangesConsumer::publish", "[silkrpc][subscription][state_changes_consumer]") {
+    // No database in the context: any read attempt would fail
+    Context context{std::make_shared<asio::io_context>(), std::make_unique<grpc::CompletionQueue>()};
+    ChannelFactory create_channel = []() { return grpc::CreateChannel("localhost:12345", grpc::InsecureChannelCredentials()); };
+    Broker broker;
+    StateChangesConsumer consumer{context, create_channel, broker};
+    remote::StateChange state_change;
+    state_change.set_blockheight(1);
+
+    SECTION("no subscriptions, no reads") {
+        state_change.set_direction(remote::Direction::FORWARD);
+        auto result = asio::co_spawn(*context.io_context, consumer.publish(state_change), asio::use_future);
+        context.io_context->run();
+        CHECK_NOTHROW(result.get());
+    }
+
+    SECTION("unwind is not notified") {
+        auto subscriber = std::make_shared<NullSubscriber>();
+        broker.subscribe(subscriber, Kind::new_heads);
+        state_change.set_direction(remote::Direction::UNWIND);
+        auto result = asio::co_spawn(*context.io_context, consumer.publish(state_change), asio::use_future);
+        context.io_context->run();
+        CHECK_NOTHROW(result.get());
+    }
+
+    SECTION("head version is advanced by any change") {
+        ethdb::ChainHeadVersion head_version;
+        StateChangesConsumer versioned_consumer{context, create_channel, broker, &head_version};
+        state_change.set_direction(remote::Direction::UNWIND);
+        auto result = asio::co_spawn(*context.io_context, versioned_consumer.publish(state_change), asio::use_future);
+        context.io_context->run();
+        CHECK_NOTHROW(result.get());
+        CHECK(head_version.current() == 1);
+    }
+}
+
+} // namespace silkrpc::subscription